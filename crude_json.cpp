@@ -14,6 +14,7 @@
 # include <clocale>
 # include <cmath>
 # include <cstring>
+# include <deque>
 
 
 namespace crude_json {
@@ -317,453 +318,324 @@ void value::dump(dump_context_t& context, int level) const
 
 struct value::parser
 {
-    parser(const char* begin, const char* end)
+    parser(const char* begin, const char* end, event_handler& handler)
         : m_Cursor(begin)
         , m_End(end)
+        , m_Handler(&handler)
     {
     }
 
-    value parse()
+    bool parse()
     {
-        value v;
-
-        // Switch to C locale to make strtod and strtol work as expected
+        // Switch to C locale to make strtod work as expected
         auto previous_locale = std::setlocale(LC_NUMERIC, "C");
 
         // Accept single value only when end of the stream is reached.
-        if (!accept_element(v) || !eof())
-            v = value(type_t::discarded);
+        skip_ws();
+        auto result = parse_value();
+        skip_ws();
+        result = result && eof();
 
         if (previous_locale && strcmp(previous_locale, "C") != 0)
             std::setlocale(LC_NUMERIC, previous_locale);
 
-        return v;
+        return result;
     }
 
 private:
-    struct cursor_state
+    bool parse_value()
     {
-        cursor_state(parser* p)
-            : m_Owner(p)
-            , m_LastCursor(p->m_Cursor)
-        {
-        }
+        if (!m_Handler->want_raw_value())
+            return parse_events();
 
-        void reset()
-        {
-            m_Owner->m_Cursor = m_LastCursor;
-        }
+        // Walk over value with handler that ignores everything.
+        event_handler skip_handler;
 
-        bool operator()(bool accept)
-        {
-            if (!accept)
-                reset();
-            else
-                m_LastCursor = m_Owner->m_Cursor;
-            return accept;
-        }
-
-    private:
-        parser*     m_Owner;
-        const char* m_LastCursor;
-    };
-
-    cursor_state state()
-    {
-        return cursor_state(this);
-    }
+        auto start   = m_Cursor;
+        auto handler = m_Handler;
+        m_Handler = &skip_handler;
+        auto result = parse_events();
+        m_Handler = handler;
 
-    bool accept_value(value& result)
-    {
-        return accept_object(result)
-            || accept_array(result)
-            || accept_string(result)
-            || accept_number(result)
-            || accept_boolean(result)
-            || accept_null(result);
+        return result && m_Handler->on_raw_value(start, static_cast<size_t>(m_Cursor - start));
     }
 
-    bool accept_object(value& result)
+    bool parse_events()
     {
-        auto s = state();
-
-        object o;
-        if (s(accept('{') && accept_ws() && accept('}')))
-        {
-            result = o;
-            return true;
-        }
-        else if (s(accept('{') && accept_members(o) && accept('}')))
+        switch (peek())
         {
-            result = std::move(o);
-            return true;
+            case '{': return parse_object();
+            case '[': return parse_array();
+            case '\"':
+            {
+                const char* data = nullptr;
+                size_t      size = 0;
+                return parse_string(data, size) && m_Handler->on_string(data, size);
+            }
+            case 't': return accept("true")  && m_Handler->on_boolean(true);
+            case 'f': return accept("false") && m_Handler->on_boolean(false);
+            case 'n': return accept("null")  && m_Handler->on_null();
+            default:  return parse_number();
         }
-
-        return false;
     }
 
-    bool accept_members(object& o)
+    bool parse_object()
     {
-        if (!accept_member(o))
+        ++m_Cursor; // '{'
+
+        if (!m_Handler->on_object_begin())
             return false;
 
+        skip_ws();
+        if (accept('}'))
+            return m_Handler->on_object_end();
+
         while (true)
         {
-            auto s = state();
-            if (!s(accept(',') && accept_member(o)))
-                break;
-        }
+            const char* key  = nullptr;
+            size_t      size = 0;
 
-        return true;
-    }
-
-    bool accept_member(object& o)
-    {
-        auto s = state();
-
-        value key;
-        value v;
-        if (s(accept_ws() && accept_string(key) && accept_ws() && accept(':') && accept_element(v)))
-        {
-            o.emplace(std::move(key.get<string>()), std::move(v));
-            return true;
-        }
+            if (peek() != '\"' || !parse_string(key, size) || !m_Handler->on_key(key, size))
+                return false;
 
-        return false;
-    }
+            skip_ws();
+            if (!accept(':'))
+                return false;
 
-    bool accept_array(value& result)
-    {
-        auto s = state();
+            skip_ws();
+            if (!parse_value())
+                return false;
 
-        if (s(accept('[') && accept_ws() && accept(']')))
-        {
-            result = array();
-            return true;
-        }
+            skip_ws();
+            if (accept(','))
+            {
+                skip_ws();
+                continue;
+            }
 
-        array a;
-        if (s(accept('[') && accept_elements(a) && accept(']')))
-        {
-            result = std::move(a);
-            return true;
+            return accept('}') && m_Handler->on_object_end();
         }
-
-        return false;
     }
 
-    bool accept_elements(array& a)
+    bool parse_array()
     {
-        value v;
-        if (!accept_element(v))
+        ++m_Cursor; // '['
+
+        if (!m_Handler->on_array_begin())
             return false;
 
-        a.emplace_back(std::move(v));
+        skip_ws();
+        if (accept(']'))
+            return m_Handler->on_array_end();
+
         while (true)
         {
-            auto s = state();
-            v = nullptr;
-            if (!s(accept(',') && accept_element(v)))
-                break;
-            a.emplace_back(std::move(v));
-        }
-
-        return true;
-    }
-
-    bool accept_element(value& result)
-    {
-        auto s = state();
-        return s(accept_ws() && accept_value(result) && accept_ws());
-    }
+            if (!parse_value())
+                return false;
 
-    bool accept_string(value& result)
-    {
-        auto s = state();
+            skip_ws();
+            if (accept(','))
+            {
+                skip_ws();
+                continue;
+            }
 
-        string v;
-        if (s(accept('\"') && accept_characters(v) && accept('\"')))
-        {
-            result = std::move(v);
-            return true;
+            return accept(']') && m_Handler->on_array_end();
         }
-        else
-            return false;
     }
 
-    bool accept_characters(string& result)
+    // Strings without escape sequences are passed straight from the input,
+    // other are decoded to scratch buffer.
+    bool parse_string(const char*& data, size_t& size)
     {
-        int c;
-        while (accept_character(c))
-        {
-            CRUDE_ASSERT(c < 128); // #todo: convert characters > 127 to UTF-8
-            result.push_back(static_cast<char>(c));
-        }
+        ++m_Cursor; // '"'
 
-        return true;
-    }
-
-    bool accept_character(int& c)
-    {
-        auto s = state();
+        auto start = m_Cursor;
+        while (m_Cursor < m_End && *m_Cursor != '\"' && *m_Cursor != '\\')
+            ++m_Cursor;
 
-        if (accept('\\'))
-        {
-            return accept_escape(c);
-        }
-        else if (expect('\"'))
+        if (m_Cursor == m_End)
             return false;
 
-        // #todo: Handle UTF-8 sequences.
-        return s((c = peek()) >= 0) && advance();
-    }
-
-    bool accept_escape(int& c)
-    {
-        if (accept('\"')) { c = '\"'; return true; }
-        if (accept('\\')) { c = '\\'; return true; }
-        if (accept('/'))  { c = '/';  return true; }
-        if (accept('b'))  { c = '\b'; return true; }
-        if (accept('f'))  { c = '\f'; return true; }
-        if (accept('n'))  { c = '\n'; return true; }
-        if (accept('r'))  { c = '\r'; return true; }
-        if (accept('t'))  { c = '\t'; return true; }
-
-        auto s = state();
-
-        string hex;
-        hex.reserve(4);
-        if (s(accept('u') && accept_hex(hex) && accept_hex(hex) && accept_hex(hex) && accept_hex(hex)))
+        if (*m_Cursor == '\"')
         {
-            char* end = nullptr;
-            auto v = std::strtol(hex.c_str(), &end, 16);
-            if (end != hex.c_str() + hex.size())
-                return false;
-
-            c = v;
+            data = start;
+            size = static_cast<size_t>(m_Cursor - start);
+            ++m_Cursor;
             return true;
         }
 
-        return false;
-    }
+        m_Scratch.assign(start, m_Cursor);
 
-    bool accept_hex(string& result)
-    {
-        if (accept_digit(result))
-            return true;
-
-        auto c = peek();
-        if ((c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))
+        while (m_Cursor < m_End)
         {
-            advance();
-            result.push_back(static_cast<char>(c));
-            return true;
-        }
-
-        return false;
-    }
-
-    bool accept_number(value& result)
-    {
-        auto s = state();
-
-        string n;
-        if (s(accept_int(n) && accept_frac(n) && accept_exp(n)))
-        {
-            char* end = nullptr;
-            auto v = std::strtod(n.c_str(), &end);
-            if (end != n.c_str() + n.size())
-                return false;
+            auto c = *m_Cursor++;
+            if (c == '\"')
+            {
+                data = m_Scratch.data();
+                size = m_Scratch.size();
+                return true;
+            }
+            else if (c != '\\')
+            {
+                m_Scratch.push_back(c);
+                continue;
+            }
 
-            if (v != 0 && !std::isnormal(v))
+            if (m_Cursor == m_End)
                 return false;
 
-            result = v;
-            return true;
+            switch (*m_Cursor++)
+            {
+                case '\"': m_Scratch.push_back('\"'); break;
+                case '\\': m_Scratch.push_back('\\'); break;
+                case '/':  m_Scratch.push_back('/');  break;
+                case 'b':  m_Scratch.push_back('\b'); break;
+                case 'f':  m_Scratch.push_back('\f'); break;
+                case 'n':  m_Scratch.push_back('\n'); break;
+                case 'r':  m_Scratch.push_back('\r'); break;
+                case 't':  m_Scratch.push_back('\t'); break;
+                case 'u':
+                {
+                    unsigned int code = 0;
+                    if (!parse_hex4(code))
+                        return false;
+                    append_utf8(code);
+                    break;
+                }
+                default:
+                    return false;
+            }
         }
 
         return false;
     }
 
-    bool accept_int(string& result)
+    bool parse_hex4(unsigned int& result)
     {
-        auto s = state();
-
-        string part;
-        if (s(accept_onenine(part) && accept_digits(part)))
-        {
-            result += std::move(part);
-            return true;
-        }
-
-        part.resize(0);
-        if (accept_digit(part))
-        {
-            result += std::move(part);
-            return true;
-        }
-
-        part.resize(0);
-        if (s(accept('-') && accept_onenine(part) && accept_digits(part)))
-        {
-            result += '-';
-            result += std::move(part);
-            return true;
-        }
+        if (m_End - m_Cursor < 4)
+            return false;
 
-        part.resize(0);
-        if (s(accept('-') && accept_digit(part)))
+        result = 0;
+        for (int i = 0; i < 4; ++i)
         {
-            result += '-';
-            result += std::move(part);
-            return true;
+            auto c = *m_Cursor++;
+            result <<= 4;
+                 if (c >= '0' && c <= '9') result |= static_cast<unsigned int>(c - '0');
+            else if (c >= 'A' && c <= 'F') result |= static_cast<unsigned int>(c - 'A' + 10);
+            else if (c >= 'a' && c <= 'f') result |= static_cast<unsigned int>(c - 'a' + 10);
+            else return false;
         }
 
-        return false;
-    }
-
-    bool accept_digits(string& result)
-    {
-        string part;
-        if (!accept_digit(part))
-            return false;
-
-        while (accept_digit(part))
-            ;
-
-        result += std::move(part);
-
         return true;
     }
 
-    bool accept_digit(string& result)
+    void append_utf8(unsigned int code)
     {
-        if (accept('0'))
+        if (code < 0x80)
+            m_Scratch.push_back(static_cast<char>(code));
+        else if (code < 0x800)
         {
-            result.push_back('0');
-            return true;
+            m_Scratch.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            m_Scratch.push_back(static_cast<char>(0x80 | (code & 0x3F)));
         }
-        else if (accept_onenine(result))
-            return true;
-
-        return false;
-    }
-
-    bool accept_onenine(string& result)
-    {
-        auto c = peek();
-        if (c >= '1' && c <= '9')
+        else
         {
-            result.push_back(static_cast<char>(c));
-            return advance();
+            m_Scratch.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            m_Scratch.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            m_Scratch.push_back(static_cast<char>(0x80 | (code & 0x3F)));
         }
-
-        return false;
     }
 
-    bool accept_frac(string& result)
+    bool parse_number()
     {
-        auto s = state();
+        auto start = m_Cursor;
 
-        string part;
-        if (s(accept('.') && accept_digits(part)))
+        auto accept_digits = [this]()
         {
-            result += '.';
-            result += std::move(part);
-        }
+            auto first = m_Cursor;
+            while (m_Cursor < m_End && *m_Cursor >= '0' && *m_Cursor <= '9')
+                ++m_Cursor;
+            return m_Cursor != first;
+        };
 
-        return true;
-    }
+        accept('-');
 
-    bool accept_exp(string& result)
-    {
-        auto s = state();
+        // int: '0' or onenine digits
+        if (accept('0'))
+            ;
+        else if (peek() >= '1' && peek() <= '9')
+            accept_digits();
+        else
+            return false;
 
-        string part;
-        if (s(accept('e') && accept_sign(part) && accept_digits(part)))
+        // frac: optional, '.' must be followed by digits
+        if (peek() == '.')
         {
-            result += 'e';
-            result += std::move(part);
-            return true;
+            auto dot = m_Cursor++;
+            if (!accept_digits())
+                m_Cursor = dot;
         }
-        part.resize(0);
-        if (s(accept('E') && accept_sign(part) && accept_digits(part)))
+
+        // exp: optional, has to be complete to be consumed
+        if (peek() == 'e' || peek() == 'E')
         {
-            result += 'E';
-            result += std::move(part);
+            auto exp = m_Cursor++;
+            if (peek() == '+' || peek() == '-')
+                ++m_Cursor;
+            if (!accept_digits())
+                m_Cursor = exp;
         }
 
-        return true;
-    }
-
-    bool accept_sign(string& result)
-    {
-        if (accept('+'))
-            result.push_back('+');
-        else if (accept('-'))
-            result.push_back('-');
-
-        return true;
-    }
-
-    bool accept_ws()
-    {
-        while (expect('\x09') || expect('\x0A') || expect('\x0D') || expect('\x20'))
-            advance();
-        return true;
-    }
-
-    bool accept_boolean(value& result)
-    {
-        if (accept("true"))
+        // Input is not null terminated, copy number to feed strtod.
+        char buffer[64];
+        const auto length = static_cast<size_t>(m_Cursor - start);
+        std::string long_buffer;
+        char* text = buffer;
+        if (length < sizeof(buffer))
         {
-            result = true;
-            return true;
+            memcpy(buffer, start, length);
+            buffer[length] = '\0';
         }
-        else if (accept("false"))
+        else
         {
-            result = false;
-            return true;
+            long_buffer.assign(start, length);
+            text = &long_buffer[0];
         }
 
-        return false;
+        char* end = nullptr;
+        auto v = std::strtod(text, &end);
+        if (end != text + length)
+            return false;
+
+        if (v != 0 && !std::isnormal(v))
+            return false;
+
+        return m_Handler->on_number(v);
     }
 
-    bool accept_null(value& result)
+    void skip_ws()
     {
-        if (accept("null"))
-        {
-            result = nullptr;
-            return true;
-        }
-
-        return false;
+        while (m_Cursor < m_End && (*m_Cursor == '\x09' || *m_Cursor == '\x0A' || *m_Cursor == '\x0D' || *m_Cursor == '\x20'))
+            ++m_Cursor;
     }
 
     bool accept(char c)
     {
-        if (expect(c))
-            return advance();
-        else
+        if (peek() != c)
             return false;
+
+        ++m_Cursor;
+        return true;
     }
 
     bool accept(const char* str)
     {
-        auto last = m_Cursor;
-
-        while (*str)
-        {
-            if (eof() || *str != *m_Cursor)
-            {
-                m_Cursor = last;
-                return false;
-            }
-
-            advance();
-            ++str;
-        }
+        const auto length = strlen(str);
+        if (static_cast<size_t>(m_End - m_Cursor) < length || memcmp(m_Cursor, str, length) != 0)
+            return false;
 
+        m_Cursor += length;
         return true;
     }
 
@@ -775,40 +647,92 @@ private:
             return -1;
     }
 
-    bool expect(char c)
+    bool eof() const
     {
-        return peek() == c;
+        return m_Cursor == m_End;
     }
 
-    bool advance(int count = 1)
+    const char*    m_Cursor;
+    const char*    m_End;
+    event_handler* m_Handler;
+    std::string    m_Scratch;
+};
+
+// Builds value tree from parser events.
+struct value::builder final: event_handler
+{
+    value m_Result;
+
+    bool on_null() override                                 { return add(value(nullptr)); }
+    bool on_boolean(bool v) override                        { return add(value(v)); }
+    bool on_number(double v) override                       { return add(value(v)); }
+    bool on_string(const char* data, size_t size) override  { return add(value(string(data, size))); }
+    bool on_object_begin() override                         { return open(value(type_t::object)); }
+    bool on_key(const char* data, size_t size) override     { m_Key.assign(data, size); return true; }
+    bool on_object_end() override                           { m_Stack.pop_back(); return true; }
+    bool on_array_begin() override                          { return open(value(type_t::array)); }
+    bool on_array_end() override                            { m_Stack.pop_back(); return true; }
+
+private:
+    value& next()
     {
-        if (m_Cursor + count > m_End)
+        if (m_Stack.empty())
+            return m_Result;
+
+        auto& parent = *m_Stack.back();
+        if (parent.is_array())
         {
-            m_Cursor = m_End;
-            return false;
+            auto& a = *array_ptr(parent.m_Storage);
+            a.emplace_back();
+            return a.back();
         }
 
-        m_Cursor += count;
+        // First occurrence of a key wins, duplicates are parsed and dropped.
+        auto& o = *object_ptr(parent.m_Storage);
+        auto result = o.emplace(m_Key, value());
+        if (!result.second)
+        {
+            m_Discarded.emplace_back();
+            return m_Discarded.back();
+        }
+
+        return result.first->second;
+    }
 
+    bool add(value&& v)
+    {
+        next() = std::move(v);
         return true;
     }
 
-    bool eof() const
+    bool open(value&& v)
     {
-        return m_Cursor == m_End;
+        auto& slot = next();
+        slot = std::move(v);
+        m_Stack.push_back(&slot);
+        return true;
     }
 
-    const char* m_Cursor;
-    const char* m_End;
+    std::vector<value*> m_Stack;
+    string              m_Key;
+    std::deque<value>   m_Discarded;
 };
 
 value value::parse(const string& data)
 {
-    auto p = parser(data.c_str(), data.c_str() + data.size());
+    builder b;
+
+    if (!parse(data.c_str(), data.size(), b))
+        return value(type_t::discarded);
 
-    auto v = p.parse();
+    return std::move(b.m_Result);
+}
+
+bool value::parse(const char* data, size_t size, event_handler& handler)
+{
+    auto p = parser(data, data + size, handler);
 
-    return v;
+    return p.parse();
 }
 
 } // namespace crude_json
@@ -46,6 +46,29 @@ enum class type_t
     discarded
 };
 
+// Receives events from event based value::parse(). Strings and keys are
+// already unescaped and valid only for the duration of the call.
+// Returning false stops parsing.
+struct event_handler
+{
+    virtual ~event_handler() = default;
+
+    virtual bool on_null()                                 { return true; }
+    virtual bool on_boolean(bool value)                    { (void)value; return true; }
+    virtual bool on_number(double value)                   { (void)value; return true; }
+    virtual bool on_string(const char* data, size_t size)  { (void)data; (void)size; return true; }
+    virtual bool on_object_begin()                         { return true; }
+    virtual bool on_key(const char* data, size_t size)     { (void)data; (void)size; return true; }
+    virtual bool on_object_end()                           { return true; }
+    virtual bool on_array_begin()                          { return true; }
+    virtual bool on_array_end()                            { return true; }
+
+    // Returning true makes next value to be validated and reported
+    // as raw text to on_raw_value() instead of individual events.
+    virtual bool want_raw_value()                          { return false; }
+    virtual bool on_raw_value(const char* data, size_t size) { (void)data; (void)size; return true; }
+};
+
 struct value
 {
     value(type_t type = type_t::null): m_Type(construct(m_Storage, type)) {}
@@ -114,8 +137,13 @@ struct value
     // Returns discarded value for invalid inputs.
     static value parse(const string& data);
 
+    // Reports parsed values to handler without building value tree.
+    // Returns false for invalid inputs or when handler stopped parsing.
+    static bool parse(const char* data, size_t size, event_handler& handler);
+
 private:
     struct parser;
+    struct builder;
 
     // VS2015: std::max() is not constexpr yet.
 # define CRUDE_MAX2(a, b)           ((a) < (b) ? (b) : (a))
@@ -9,7 +9,8 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <utility>
 
@@ -86,6 +87,7 @@ struct Pin
     std::string Name;
     PinType     Type;
     PinKind     Kind;
+    std::vector<ed::LinkId> Links; // Connected links, kept by AddLink() and RemoveLink().
 
     Pin(int id, const char* name, PinType type):
         ID(id), Node(nullptr), Name(name), Type(type), Kind(PinKind::Input)
@@ -135,6 +137,7 @@ static ImTextureID          s_HeaderBackground = nullptr;
 //static ImTextureID          s_SampleImage = nullptr;
 static ImTextureID          s_SaveIcon = nullptr;
 static ImTextureID          s_RestoreIcon = nullptr;
+static bool                 s_ShowMinimap = false;
 
 struct NodeIdLess
 {
@@ -144,8 +147,29 @@ struct NodeIdLess
     }
 };
 
+struct IdHash
+{
+    template <typename T>
+    size_t operator()(const T& id) const
+    {
+        return std::hash<uintptr_t>()(id.Get());
+    }
+};
+
+// Lookups by id are used every frame, so graph is indexed instead of searched.
+// Node and pin indices are rebuilt by BuildNodes() after nodes are added or
+// removed, links are indexed by AddLink() and RemoveLink().
+static std::unordered_map<ed::NodeId, int,  IdHash> s_NodeIndex; // into s_Nodes
+static std::unordered_map<ed::PinId,  Pin*, IdHash> s_PinIndex;
+static std::unordered_map<ed::LinkId, int,  IdHash> s_LinkIndex; // into s_Links
+
 static const float          s_TouchTime = 1.0f;
-static std::map<ed::NodeId, float, NodeIdLess> s_NodeTouchTime;
+static std::unordered_map<ed::NodeId, float, IdHash> s_NodeTouchTime;
+
+// Procedurally generated graph shown by stress mode.
+static bool                 s_StressMode = false;
+static int                  s_StressNodeCount = 20000;
+static std::vector<ed::NodeId> s_StressNodes;
 
 static int s_NextId = 1;
 static int GetNextId()
@@ -179,28 +203,32 @@ static float GetTouchProgress(ed::NodeId id)
 
 static void UpdateTouch()
 {
+    // Only nodes touched recently are kept.
     const auto deltaTime = ImGui::GetIO().DeltaTime;
-    for (auto& entry : s_NodeTouchTime)
+    for (auto it = s_NodeTouchTime.begin(); it != s_NodeTouchTime.end(); )
     {
-        if (entry.second > 0.0f)
-            entry.second -= deltaTime;
+        it->second -= deltaTime;
+        if (it->second <= 0.0f)
+            it = s_NodeTouchTime.erase(it);
+        else
+            ++it;
     }
 }
 
 static Node* FindNode(ed::NodeId id)
 {
-    for (auto& node : s_Nodes)
-        if (node.ID == id)
-            return &node;
+    auto it = s_NodeIndex.find(id);
+    if (it != s_NodeIndex.end())
+        return &s_Nodes[it->second];
 
     return nullptr;
 }
 
 static Link* FindLink(ed::LinkId id)
 {
-    for (auto& link : s_Links)
-        if (link.ID == id)
-            return &link;
+    auto it = s_LinkIndex.find(id);
+    if (it != s_LinkIndex.end())
+        return &s_Links[it->second];
 
     return nullptr;
 }
@@ -210,30 +238,34 @@ static Pin* FindPin(ed::PinId id)
     if (!id)
         return nullptr;
 
-    for (auto& node : s_Nodes)
-    {
-        for (auto& pin : node.Inputs)
-            if (pin.ID == id)
-                return &pin;
-
-        for (auto& pin : node.Outputs)
-            if (pin.ID == id)
-                return &pin;
-    }
+    auto it = s_PinIndex.find(id);
+    if (it != s_PinIndex.end())
+        return it->second;
 
     return nullptr;
 }
 
 static bool IsPinLinked(ed::PinId id)
 {
-    if (!id)
+    auto pin = FindPin(id);
+
+    return pin && !pin->Links.empty();
+}
+
+// Editor reports nodes it did not measure yet as visible. Nodes placed by
+// application far outside of view wait until view gets close to them, laying
+// out thousands of nodes in one frame would stall it.
+static bool IsNodeVisible(const Node& node, const ImRect& viewRect)
+{
+    if (!ed::IsNodeVisible(node.ID))
         return false;
 
-    for (auto& link : s_Links)
-        if (link.StartPinID == id || link.EndPinID == id)
-            return true;
+    if (ed::GetNodeSize(node.ID).x > 0.0f || viewRect.GetWidth() <= 0.0f)
+        return true;
+
+    const auto position = ed::GetNodePosition(node.ID);
 
-    return false;
+    return position.x == FLT_MAX || viewRect.Contains(position);
 }
 
 static bool CanCreateLink(Pin* a, Pin* b)
@@ -478,10 +510,92 @@ static Node* SpawnHoudiniGroupNode()
     return &s_Nodes.back();
 }
 
+// Pin index points into nodes, so this has to be called after s_Nodes is
+// changed and before pins are looked up again.
 void BuildNodes()
 {
-    for (auto& node : s_Nodes)
+    s_NodeIndex.clear();
+    s_PinIndex.clear();
+    s_NodeIndex.reserve(s_Nodes.size());
+
+    for (int i = 0; i < static_cast<int>(s_Nodes.size()); ++i)
+    {
+        auto& node = s_Nodes[i];
         BuildNode(&node);
+
+        s_NodeIndex[node.ID] = i;
+        for (auto& input : node.Inputs)
+            s_PinIndex[input.ID] = &input;
+        for (auto& output : node.Outputs)
+            s_PinIndex[output.ID] = &output;
+    }
+}
+
+static Link* AddLink(ed::PinId startPinId, ed::PinId endPinId)
+{
+    s_Links.emplace_back(Link(GetNextLinkId(), startPinId, endPinId));
+
+    auto& link = s_Links.back();
+    s_LinkIndex[link.ID] = static_cast<int>(s_Links.size()) - 1;
+
+    if (auto startPin = FindPin(startPinId))
+        startPin->Links.push_back(link.ID);
+    if (auto endPin = FindPin(endPinId))
+        endPin->Links.push_back(link.ID);
+
+    return &link;
+}
+
+static void RemoveLink(ed::LinkId id)
+{
+    auto it = s_LinkIndex.find(id);
+    if (it == s_LinkIndex.end())
+        return;
+
+    const auto index = it->second;
+    s_LinkIndex.erase(it);
+
+    for (auto pinId : { s_Links[index].StartPinID, s_Links[index].EndPinID })
+    {
+        if (auto pin = FindPin(pinId))
+            pin->Links.erase(std::remove(pin->Links.begin(), pin->Links.end(), id), pin->Links.end());
+    }
+
+    // Order of links does not matter, last one takes place of removed one.
+    if (index != static_cast<int>(s_Links.size()) - 1)
+    {
+        s_Links[index] = s_Links.back();
+        s_LinkIndex[s_Links[index].ID] = index;
+    }
+    s_Links.pop_back();
+}
+
+// Removes nodes with their links in one pass over s_Nodes.
+static void RemoveNodes(const std::vector<ed::NodeId>& ids)
+{
+    if (ids.empty())
+        return;
+
+    std::unordered_set<ed::NodeId, IdHash> removed;
+    for (auto id : ids)
+    {
+        auto node = FindNode(id);
+        if (!node)
+            continue;
+
+        for (auto pins : { &node->Inputs, &node->Outputs })
+            for (auto& pin : *pins)
+                while (!pin.Links.empty())
+                    RemoveLink(pin.Links.back());
+
+        s_NodeTouchTime.erase(id);
+        ed::ForgetNode(id);
+        removed.insert(id);
+    }
+
+    s_Nodes.erase(std::remove_if(s_Nodes.begin(), s_Nodes.end(), [&removed](const Node& node) { return removed.count(node.ID) != 0; }), s_Nodes.end());
+
+    BuildNodes();
 }
 
 const char* Application_GetName()
@@ -495,6 +609,9 @@ void Application_Initialize()
 
     config.SettingsFile = "Blueprints.json";
 
+    // Nodes outside of the view are not submitted, see ed::IsNodeVisible().
+    config.RetainNodes = true;
+
     config.LoadNodeSettings = [](ed::NodeId nodeId, char* data, void* userPointer) -> size_t
     {
         auto node = FindNode(nodeId);
@@ -548,10 +665,10 @@ void Application_Initialize()
 
     BuildNodes();
 
-    s_Links.push_back(Link(GetNextLinkId(), s_Nodes[5].Outputs[0].ID, s_Nodes[6].Inputs[0].ID));
-    s_Links.push_back(Link(GetNextLinkId(), s_Nodes[5].Outputs[0].ID, s_Nodes[7].Inputs[0].ID));
+    AddLink(s_Nodes[5].Outputs[0].ID, s_Nodes[6].Inputs[0].ID);
+    AddLink(s_Nodes[5].Outputs[0].ID, s_Nodes[7].Inputs[0].ID);
 
-    s_Links.push_back(Link(GetNextLinkId(), s_Nodes[14].Outputs[0].ID, s_Nodes[15].Inputs[0].ID));
+    AddLink(s_Nodes[14].Outputs[0].ID, s_Nodes[15].Inputs[0].ID);
 
     s_HeaderBackground = Application_LoadTexture("Data/BlueprintBackground.png");
     s_SaveIcon         = Application_LoadTexture("Data/ic_save_white_24dp.png");
@@ -611,6 +728,70 @@ ImColor GetIconColor(PinType type)
     }
 };
 
+// Grid of regular nodes below the demo graph. Every node is linked to its
+// right and bottom neighbor through first pins of matching type, which gives
+// about two links per node.
+static void SpawnStressGraph(int nodeCount)
+{
+    using Spawner = Node* (*)();
+    static const Spawner spawners[] =
+    {
+        SpawnBranchNode, SpawnPrintStringNode, SpawnDoNNode, SpawnLessNode, SpawnSetTimerNode, SpawnWeirdNode
+    };
+    const int spawnerCount = sizeof(spawners) / sizeof(*spawners);
+
+    const int    columns = ImMax(1, static_cast<int>(ImSqrt(static_cast<float>(nodeCount))));
+    const ImVec2 origin(-400.0f, 1000.0f);
+    const ImVec2 spacing(360.0f, 260.0f);
+
+    const auto first = static_cast<int>(s_Nodes.size());
+    s_Nodes.reserve(s_Nodes.size() + nodeCount);
+
+    std::vector<ed::NodeId> ids;
+    std::vector<ImVec2>     positions;
+    ids.reserve(nodeCount);
+    positions.reserve(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        auto node = spawners[(i + i / columns) % spawnerCount]();
+        ids.push_back(node->ID);
+        positions.push_back(origin + ImVec2(static_cast<float>(i % columns), static_cast<float>(i / columns)) * spacing);
+    }
+
+    BuildNodes();
+
+    ed::SetNodePositions(ids.data(), positions.data(), nodeCount);
+
+    auto linkFirstMatching = [](Node& from, Node& to)
+    {
+        for (auto& output : from.Outputs)
+            for (auto& input : to.Inputs)
+                if (CanCreateLink(&output, &input))
+                {
+                    AddLink(output.ID, input.ID)->Color = GetIconColor(output.Type);
+                    return;
+                }
+    };
+
+    s_Links.reserve(s_Links.size() + nodeCount * 2);
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        auto& node = s_Nodes[first + i];
+        if ((i + 1) % columns != 0 && i + 1 < nodeCount)
+            linkFirstMatching(node, s_Nodes[first + i + 1]);
+        if (i + columns < nodeCount)
+            linkFirstMatching(node, s_Nodes[first + i + columns]);
+    }
+
+    s_StressNodes = std::move(ids);
+}
+
+static void ClearStressGraph()
+{
+    RemoveNodes(s_StressNodes);
+    s_StressNodes.clear();
+}
+
 void DrawPinIcon(const Pin& pin, bool connected, int alpha)
 {
     IconType iconType;
@@ -674,6 +855,9 @@ void ShowStyleEditor(bool* show = nullptr)
     //float   PinArrowWidth;
     ImGui::DragFloat("Group Rounding", &editorStyle.GroupRounding, 0.1f, 0.0f, 40.0f);
     ImGui::DragFloat("Group Border Width", &editorStyle.GroupBorderWidth, 0.1f, 0.0f, 15.0f);
+    ImGui::DragFloat("LOD Reduced Zoom", &editorStyle.LodReducedZoom, 0.01f, 0.0f, 1.0f);
+    ImGui::DragFloat("LOD Overview Zoom", &editorStyle.LodOverviewZoom, 0.01f, 0.0f, 1.0f);
+    ImGui::DragFloat("LOD Anti-Alias Zoom", &editorStyle.LodAntiAliasZoom, 0.01f, 0.0f, 1.0f);
 
     ImGui::Separator();
 
@@ -726,6 +910,11 @@ void ShowLeftPane(float paneWidth)
         for (auto& link : s_Links)
             ed::Flow(link.ID);
     }
+    ImGui::Spring(0.0f);
+    if (ImGui::Button("Auto Layout"))
+        ed::AutoLayout();
+    ImGui::Spring(0.0f);
+    ImGui::Checkbox("Minimap", &s_ShowMinimap);
     ImGui::Spring();
     if (ImGui::Button("Edit Style"))
         showStyleEditor = true;
@@ -734,6 +923,40 @@ void ShowLeftPane(float paneWidth)
     if (showStyleEditor)
         ShowStyleEditor(&showStyleEditor);
 
+    ImGui::GetWindowDrawList()->AddRectFilled(
+        ImGui::GetCursorScreenPos(),
+        ImGui::GetCursorScreenPos() + ImVec2(paneWidth, ImGui::GetTextLineHeight()),
+        ImColor(ImGui::GetStyle().Colors[ImGuiCol_HeaderActive]), ImGui::GetTextLineHeight() * 0.25f);
+    ImGui::Spacing(); ImGui::SameLine();
+    ImGui::TextUnformatted("Stress Test");
+    ImGui::Indent();
+    ImGui::BeginHorizontal("Stress Mode", ImVec2(paneWidth - ImGui::GetStyle().IndentSpacing, 0));
+    if (ImGui::Checkbox("Stress", &s_StressMode))
+    {
+        if (s_StressMode)
+            SpawnStressGraph(s_StressNodeCount);
+        else
+            ClearStressGraph();
+    }
+    ImGui::Spring(0.0f);
+    ImGui::PushItemWidth(120.0f);
+    if (!s_StressMode)
+        ImGui::DragInt("Nodes", &s_StressNodeCount, 100.0f, 100, 100000);
+    else
+        ImGui::Text("%d nodes, %d links", static_cast<int>(s_Nodes.size()), static_cast<int>(s_Links.size()));
+    ImGui::PopItemWidth();
+    ImGui::EndHorizontal();
+    if (s_StressMode)
+    {
+        const auto stats = ed::GetFrameStats();
+        const auto& frame = stats.Phases[static_cast<int>(ed::FramePhase::Frame)];
+        ImGui::Text("Editor frame: %.2f ms avg, %.2f ms max", frame.Average, frame.Max);
+        ImGui::Text("End(): %.2f ms", stats.EndTime);
+        ImGui::Text("Vertices: %d, draw commands: %d", stats.VertexCount, stats.DrawCommandCount);
+        ImGui::Text("Channels: %d, quality level: %d", stats.ChannelCount, stats.QualityLevel);
+    }
+    ImGui::Unindent();
+
     std::vector<ed::NodeId> selectedNodes;
     std::vector<ed::LinkId> selectedLinks;
     selectedNodes.resize(ed::GetSelectedObjectCount());
@@ -745,6 +968,8 @@ void ShowLeftPane(float paneWidth)
     selectedNodes.resize(nodeCount);
     selectedLinks.resize(linkCount);
 
+    std::sort(selectedNodes.begin(), selectedNodes.end(), NodeIdLess());
+
     int saveIconWidth     = Application_GetTextureWidth(s_SaveIcon);
     int saveIconHeight    = Application_GetTextureWidth(s_SaveIcon);
     int restoreIconWidth  = Application_GetTextureWidth(s_RestoreIcon);
@@ -757,96 +982,103 @@ void ShowLeftPane(float paneWidth)
     ImGui::Spacing(); ImGui::SameLine();
     ImGui::TextUnformatted("Nodes");
     ImGui::Indent();
-    for (auto& node : s_Nodes)
+    // Only visible rows are built, list may hold tens of thousands of nodes.
+    ImGuiListClipper nodeClipper(static_cast<int>(s_Nodes.size()));
+    while (nodeClipper.Step())
     {
-        ImGui::PushID(node.ID.AsPointer());
-        auto start = ImGui::GetCursorScreenPos();
-
-        if (const auto progress = GetTouchProgress(node.ID))
+        for (int i = nodeClipper.DisplayStart; i < nodeClipper.DisplayEnd; ++i)
         {
-            ImGui::GetWindowDrawList()->AddLine(
-                start + ImVec2(-8, 0),
-                start + ImVec2(-8, ImGui::GetTextLineHeight()),
-                IM_COL32(255, 0, 0, 255 - (int)(255 * progress)), 4.0f);
-        }
+            auto& node = s_Nodes[i];
 
-        bool isSelected = std::find(selectedNodes.begin(), selectedNodes.end(), node.ID) != selectedNodes.end();
-        if (ImGui::Selectable((node.Name + "##" + std::to_string(reinterpret_cast<uintptr_t>(node.ID.AsPointer()))).c_str(), &isSelected))
-        {
-            if (io.KeyCtrl)
+            ImGui::PushID(node.ID.AsPointer());
+            auto start = ImGui::GetCursorScreenPos();
+
+            if (const auto progress = GetTouchProgress(node.ID))
             {
-                if (isSelected)
-                    ed::SelectNode(node.ID, true);
-                else
-                    ed::DeselectNode(node.ID);
+                ImGui::GetWindowDrawList()->AddLine(
+                    start + ImVec2(-8, 0),
+                    start + ImVec2(-8, ImGui::GetTextLineHeight()),
+                    IM_COL32(255, 0, 0, 255 - (int)(255 * progress)), 4.0f);
             }
-            else
-                ed::SelectNode(node.ID, false);
 
-            ed::NavigateToSelection();
-        }
-        if (ImGui::IsItemHovered() && !node.State.empty())
-            ImGui::SetTooltip("State: %s", node.State.c_str());
-
-        auto id = std::string("(") + std::to_string(reinterpret_cast<uintptr_t>(node.ID.AsPointer())) + ")";
-        auto textSize = ImGui::CalcTextSize(id.c_str(), nullptr);
-        auto iconPanelPos = start + ImVec2(
-            paneWidth - ImGui::GetStyle().FramePadding.x - ImGui::GetStyle().IndentSpacing - saveIconWidth - restoreIconWidth - ImGui::GetStyle().ItemInnerSpacing.x * 1,
-            (ImGui::GetTextLineHeight() - saveIconHeight) / 2);
-        ImGui::GetWindowDrawList()->AddText(
-            ImVec2(iconPanelPos.x - textSize.x - ImGui::GetStyle().ItemInnerSpacing.x, start.y),
-            IM_COL32(255, 255, 255, 255), id.c_str(), nullptr);
-
-        auto drawList = ImGui::GetWindowDrawList();
-        ImGui::SetCursorScreenPos(iconPanelPos);
-        ImGui::SetItemAllowOverlap();
-        if (node.SavedState.empty())
-        {
-            if (ImGui::InvisibleButton("save", ImVec2((float)saveIconWidth, (float)saveIconHeight)))
-                node.SavedState = node.State;
+            bool isSelected = std::binary_search(selectedNodes.begin(), selectedNodes.end(), node.ID, NodeIdLess());
+            if (ImGui::Selectable((node.Name + "##" + std::to_string(reinterpret_cast<uintptr_t>(node.ID.AsPointer()))).c_str(), &isSelected))
+            {
+                if (io.KeyCtrl)
+                {
+                    if (isSelected)
+                        ed::SelectNode(node.ID, true);
+                    else
+                        ed::DeselectNode(node.ID);
+                }
+                else
+                    ed::SelectNode(node.ID, false);
 
-            if (ImGui::IsItemActive())
-                drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 96));
-            else if (ImGui::IsItemHovered())
-                drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 255));
-            else
-                drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 160));
-        }
-        else
-        {
-            ImGui::Dummy(ImVec2((float)saveIconWidth, (float)saveIconHeight));
-            drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 32));
-        }
+                ed::NavigateToSelection();
+            }
+            if (ImGui::IsItemHovered() && !node.State.empty())
+                ImGui::SetTooltip("State: %s", node.State.c_str());
+
+            auto id = std::string("(") + std::to_string(reinterpret_cast<uintptr_t>(node.ID.AsPointer())) + ")";
+            auto textSize = ImGui::CalcTextSize(id.c_str(), nullptr);
+            auto iconPanelPos = start + ImVec2(
+                paneWidth - ImGui::GetStyle().FramePadding.x - ImGui::GetStyle().IndentSpacing - saveIconWidth - restoreIconWidth - ImGui::GetStyle().ItemInnerSpacing.x * 1,
+                (ImGui::GetTextLineHeight() - saveIconHeight) / 2);
+            ImGui::GetWindowDrawList()->AddText(
+                ImVec2(iconPanelPos.x - textSize.x - ImGui::GetStyle().ItemInnerSpacing.x, start.y),
+                IM_COL32(255, 255, 255, 255), id.c_str(), nullptr);
+
+            auto drawList = ImGui::GetWindowDrawList();
+            ImGui::SetCursorScreenPos(iconPanelPos);
+            ImGui::SetItemAllowOverlap();
+            if (node.SavedState.empty())
+            {
+                if (ImGui::InvisibleButton("save", ImVec2((float)saveIconWidth, (float)saveIconHeight)))
+                    node.SavedState = node.State;
 
-        ImGui::SameLine(0, ImGui::GetStyle().ItemInnerSpacing.x);
-        ImGui::SetItemAllowOverlap();
-        if (!node.SavedState.empty())
-        {
-            if (ImGui::InvisibleButton("restore", ImVec2((float)restoreIconWidth, (float)restoreIconHeight)))
+                if (ImGui::IsItemActive())
+                    drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 96));
+                else if (ImGui::IsItemHovered())
+                    drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 255));
+                else
+                    drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 160));
+            }
+            else
             {
-                node.State = node.SavedState;
-                ed::RestoreNodeState(node.ID);
-                node.SavedState.clear();
+                ImGui::Dummy(ImVec2((float)saveIconWidth, (float)saveIconHeight));
+                drawList->AddImage(s_SaveIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 32));
             }
 
-            if (ImGui::IsItemActive())
-                drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 96));
-            else if (ImGui::IsItemHovered())
-                drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 255));
+            ImGui::SameLine(0, ImGui::GetStyle().ItemInnerSpacing.x);
+            ImGui::SetItemAllowOverlap();
+            if (!node.SavedState.empty())
+            {
+                if (ImGui::InvisibleButton("restore", ImVec2((float)restoreIconWidth, (float)restoreIconHeight)))
+                {
+                    node.State = node.SavedState;
+                    ed::RestoreNodeState(node.ID);
+                    node.SavedState.clear();
+                }
+
+                if (ImGui::IsItemActive())
+                    drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 96));
+                else if (ImGui::IsItemHovered())
+                    drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 255));
+                else
+                    drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 160));
+            }
             else
-                drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 160));
-        }
-        else
-        {
-            ImGui::Dummy(ImVec2((float)restoreIconWidth, (float)restoreIconHeight));
-            drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 32));
-        }
+            {
+                ImGui::Dummy(ImVec2((float)restoreIconWidth, (float)restoreIconHeight));
+                drawList->AddImage(s_RestoreIcon, ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImVec2(0, 0), ImVec2(1, 1), IM_COL32(255, 255, 255, 32));
+            }
 
-        ImGui::SameLine(0, 0);
-        ImGui::SetItemAllowOverlap();
-        ImGui::Dummy(ImVec2(0, (float)restoreIconHeight));
+            ImGui::SameLine(0, 0);
+            ImGui::SetItemAllowOverlap();
+            ImGui::Dummy(ImVec2(0, (float)restoreIconHeight));
 
-        ImGui::PopID();
+            ImGui::PopID();
+        }
     }
     ImGui::Unindent();
 
@@ -866,8 +1098,17 @@ void ShowLeftPane(float paneWidth)
         ed::ClearSelection();
     ImGui::EndHorizontal();
     ImGui::Indent();
-    for (int i = 0; i < nodeCount; ++i) ImGui::Text("Node (%p)", selectedNodes[i].AsPointer());
-    for (int i = 0; i < linkCount; ++i) ImGui::Text("Link (%p)", selectedLinks[i].AsPointer());
+    ImGuiListClipper selectionClipper(nodeCount + linkCount);
+    while (selectionClipper.Step())
+    {
+        for (int i = selectionClipper.DisplayStart; i < selectionClipper.DisplayEnd; ++i)
+        {
+            if (i < nodeCount)
+                ImGui::Text("Node (%p)", selectedNodes[i].AsPointer());
+            else
+                ImGui::Text("Link (%p)", selectedLinks[i - nodeCount].AsPointer());
+        }
+    }
     ImGui::Unindent();
 
     if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Z)))
@@ -917,15 +1158,24 @@ void Application_Frame()
 
     ImGui::SameLine(0.0f, 12.0f);
 
+    // Canvas area shown in last frame, with margin for nodes partially in view.
+    const auto viewOrigin = ImGui::GetCursorScreenPos();
+    auto viewRect = ImRect(ed::ScreenToCanvas(viewOrigin), ed::ScreenToCanvas(viewOrigin + ed::GetScreenSize()));
+    if (viewRect.GetWidth() > 0.0f)
+        viewRect.Expand(500.0f);
+
     ed::Begin("Node editor");
     {
         auto cursorTopLeft = ImGui::GetCursorScreenPos();
 
+        if (s_ShowMinimap)
+            ed::ShowMinimap();
+
         util::BlueprintNodeBuilder builder(s_HeaderBackground, Application_GetTextureWidth(s_HeaderBackground), Application_GetTextureHeight(s_HeaderBackground));
 
         for (auto& node : s_Nodes)
         {
-            if (node.Type != NodeType::Blueprint && node.Type != NodeType::Simple)
+            if ((node.Type != NodeType::Blueprint && node.Type != NodeType::Simple) || !IsNodeVisible(node, viewRect))
                 continue;
 
             const auto isSimple = node.Type == NodeType::Simple;
@@ -1063,7 +1313,7 @@ void Application_Frame()
 
         for (auto& node : s_Nodes)
         {
-            if (node.Type != NodeType::Tree)
+            if (node.Type != NodeType::Tree || !IsNodeVisible(node, viewRect))
                 continue;
 
             const float rounding = 5.0f;
@@ -1200,7 +1450,7 @@ void Application_Frame()
 
         for (auto& node : s_Nodes)
         {
-            if (node.Type != NodeType::Houdini)
+            if (node.Type != NodeType::Houdini || !IsNodeVisible(node, viewRect))
                 continue;
 
             const float rounding = 10.0f;
@@ -1357,7 +1607,7 @@ void Application_Frame()
 
         for (auto& node : s_Nodes)
         {
-            if (node.Type != NodeType::Comment)
+            if (node.Type != NodeType::Comment || !IsNodeVisible(node, viewRect))
                 continue;
 
             const float commentAlpha = 0.75f;
@@ -1479,10 +1729,7 @@ void Application_Frame()
                         {
                             showLabel("+ Create Link", ImColor(32, 45, 32, 180));
                             if (ed::AcceptNewItem(ImColor(128, 255, 128), 4.0f))
-                            {
-                                s_Links.emplace_back(Link(GetNextId(), startPinId, endPinId));
-                                s_Links.back().Color = GetIconColor(startPin->Type);
-                            }
+                                AddLink(startPinId, endPinId)->Color = GetIconColor(startPin->Type);
                         }
                     }
                 }
@@ -1516,23 +1763,18 @@ void Application_Frame()
                 while (ed::QueryDeletedLink(&linkId))
                 {
                     if (ed::AcceptDeletedItem())
-                    {
-                        auto id = std::find_if(s_Links.begin(), s_Links.end(), [linkId](auto& link) { return link.ID == linkId; });
-                        if (id != s_Links.end())
-                            s_Links.erase(id);
-                    }
+                        RemoveLink(linkId);
                 }
 
+                // Nodes are removed together, deleting whole selection stays linear.
+                std::vector<ed::NodeId> deletedNodes;
                 ed::NodeId nodeId = 0;
                 while (ed::QueryDeletedNode(&nodeId))
                 {
                     if (ed::AcceptDeletedItem())
-                    {
-                        auto id = std::find_if(s_Nodes.begin(), s_Nodes.end(), [nodeId](auto& node) { return node.ID == nodeId; });
-                        if (id != s_Nodes.end())
-                            s_Nodes.erase(id);
-                    }
+                        deletedNodes.push_back(nodeId);
                 }
+                RemoveNodes(deletedNodes);
             }
             ed::EndDelete();
         }
@@ -1627,6 +1869,9 @@ void Application_Frame()
         //auto drawList = ImGui::GetWindowDrawList();
         //drawList->AddCircleFilled(ImGui::GetMousePosOnOpeningCurrentPopup(), 10.0f, 0xFFFF00FF);
 
+        // Spawning may move pins in memory, link pin is found again by id.
+        const auto newNodeLinkPinId = newNodeLinkPin ? newNodeLinkPin->ID : ed::PinId();
+
         Node* node = nullptr;
         if (ImGui::MenuItem("Input Action"))
             node = SpawnInputActionNode();
@@ -1673,7 +1918,7 @@ void Application_Frame()
 
             ed::SetNodePosition(node->ID, newNodePostion);
 
-            if (auto startPin = newNodeLinkPin)
+            if (auto startPin = FindPin(newNodeLinkPinId))
             {
                 auto& pins = startPin->Kind == PinKind::Input ? node->Outputs : node->Inputs;
 
@@ -1685,8 +1930,7 @@ void Application_Frame()
                         if (startPin->Kind == PinKind::Input)
                             std::swap(startPin, endPin);
 
-                        s_Links.emplace_back(Link(GetNextId(), startPin->ID, endPin->ID));
-                        s_Links.back().Color = GetIconColor(startPin->Type);
+                        AddLink(startPin->ID, endPin->ID)->Color = GetIconColor(startPin->Type);
 
                         break;
                     }
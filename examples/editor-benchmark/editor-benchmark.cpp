@@ -0,0 +1,1298 @@
+# include <imgui.h>
+# define IMGUI_DEFINE_MATH_OPERATORS
+# include <imgui_internal.h>
+# include <imgui_node_editor.h>
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <new>
+# include <string>
+# include <thread>
+# include <vector>
+# if defined(_WIN32)
+#   include <malloc.h>
+# endif
+
+namespace ed = ax::NodeEditor;
+
+// Headless stress benchmark for editor core.
+//
+// Editor is driven without window or renderer. Draw data is built by ImGui
+// and dropped, input is simulated and every frame advances by fixed time
+// step, so runs are reproducible. For each scenario and graph size time of
+// full frames and number of memory allocations are reported.
+//
+// Usage: editor-benchmark [--nodes 1000,10000] [--frames 120] [--scenario drag,zoom] [--threads 4]
+//        editor-benchmark --replay trace.bin
+//
+// With --record every run is saved as trace, see ed::BeginTraceRecording().
+// --replay runs trace recorded here or by an application and reports time
+// of every frame.
+//
+// --check runs correctness checks instead of benchmarks, exit code is
+// non-zero when any of them fails.
+//
+// Build with '#define IMGUI_NODE_EDITOR_PROFILER() 1' in imconfig.h to have
+// time of editor phases printed too.
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Allocation tracking
+//
+//------------------------------------------------------------------------------
+// Atomic since links may be tessellated on worker threads, see --threads.
+static std::atomic<size_t> g_AllocationCount(0);
+static std::atomic<size_t> g_AllocationBytes(0);
+
+static void* TrackedAlloc(size_t size)
+{
+    ++g_AllocationCount;
+    g_AllocationBytes += size;
+    return malloc(size);
+}
+
+// Kept out of line, GCC otherwise sees free() called on pointer returned by
+// inlined operator new and warns (-Wmismatched-new-delete).
+# if defined(__GNUC__)
+__attribute__((noinline))
+# endif
+static void TrackedFree(void* ptr)
+{
+    free(ptr);
+}
+
+void* operator new(size_t size)
+{
+    if (auto ptr = TrackedAlloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+// Nothrow forms are used by standard algorithms (std::stable_partition),
+// they have to pair with replaced delete.
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAlloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAlloc(size ? size : 1);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    TrackedFree(ptr);
+}
+
+# if defined(__cpp_aligned_new)
+// Over-aligned types, C++17 only. Freed with matching aligned function.
+static void* TrackedAlignedAlloc(size_t size, size_t alignment)
+{
+    ++g_AllocationCount;
+    g_AllocationBytes += size;
+#   if defined(_WIN32)
+    return _aligned_malloc(size ? size : 1, alignment);
+#   else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1) != 0)
+        return nullptr;
+    return ptr;
+#   endif
+}
+
+static void TrackedAlignedFree(void* ptr)
+{
+#   if defined(_WIN32)
+    _aligned_free(ptr);
+#   else
+    free(ptr);
+#   endif
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (auto ptr = TrackedAlignedAlloc(size, static_cast<size_t>(alignment)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TrackedAlignedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return TrackedAlignedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    TrackedAlignedFree(ptr);
+}
+# endif
+
+static void* ImGuiAlloc(size_t size, void* userData)
+{
+    IM_UNUSED(userData);
+    return TrackedAlloc(size);
+}
+
+static void ImGuiFree(void* ptr, void* userData)
+{
+    IM_UNUSED(userData);
+    TrackedFree(ptr);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Parallel for
+//
+//------------------------------------------------------------------------------
+static int g_ThreadCount = 1;
+
+// Splits range evenly between threads started for the call, calling thread
+// takes first part. Simple, but cost of starting threads is measured too.
+static void ParallelFor(int count, ed::ConfigParallelForJob job, void* jobData, void* userPointer)
+{
+    IM_UNUSED(userPointer);
+
+    const auto threadCount = ImMin(g_ThreadCount, count);
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; ++i)
+        threads.emplace_back(job, count * i / threadCount, count * (i + 1) / threadCount, jobData);
+
+    job(0, count / threadCount, jobData);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Synthetic graph
+//
+//------------------------------------------------------------------------------
+static const int    c_Columns       = 40;                   // Multiple of c_GroupSide
+static const int    c_GroupSide     = 4;                    // Group encloses c_GroupSide x c_GroupSide nodes
+static const ImVec2 c_NodeSpacing   = ImVec2(200.0f, 150.0f);
+static const int    c_PinsPerSide   = 2;
+static const float  c_DeltaTime     = 1.0f / 60.0f;
+static const ImVec2 c_DisplaySize   = ImVec2(1920.0f, 1080.0f);
+
+// Id spaces of nodes, pins and links do not overlap.
+static const uintptr_t c_PinIdBase  = 0x10000000;
+static const uintptr_t c_LinkIdBase = 0x20000000;
+static const uintptr_t c_GroupIdBase = 0x30000000;
+
+struct Graph
+{
+    int  NodeCount;
+    bool HasGroups;
+
+    int  GetGroupCount() const { return HasGroups ? NodeCount / (c_GroupSide * c_GroupSide) : 0; }
+    int  GetLinkCount() const  { return NodeCount > 1 ? NodeCount * c_PinsPerSide : 0; }
+};
+
+static ed::NodeId GetNodeId(int index)           { return static_cast<uintptr_t>(index + 1); }
+static ed::PinId  GetInputPinId(int index, int pin)  { return c_PinIdBase + static_cast<uintptr_t>(index) * c_PinsPerSide * 2 + pin + 1; }
+static ed::PinId  GetOutputPinId(int index, int pin) { return c_PinIdBase + static_cast<uintptr_t>(index) * c_PinsPerSide * 2 + c_PinsPerSide + pin + 1; }
+static ed::LinkId GetLinkId(int index, int pin)   { return c_LinkIdBase + static_cast<uintptr_t>(index) * c_PinsPerSide + pin + 1; }
+static ed::NodeId GetGroupId(int index)           { return c_GroupIdBase + static_cast<uintptr_t>(index) + 1; }
+
+static ImVec2 GetNodePosition(int index)
+{
+    return ImVec2((index % c_Columns) * c_NodeSpacing.x, (index / c_Columns) * c_NodeSpacing.y);
+}
+
+// Groups cover blocks of nodes, nodes of a block are not consecutive.
+static void GetGroupBounds(int index, ImVec2& position, ImVec2& size)
+{
+    const int groupsPerRow = c_Columns / c_GroupSide;
+    const auto block = ImVec2(static_cast<float>(index % groupsPerRow), static_cast<float>(index / groupsPerRow)) * static_cast<float>(c_GroupSide);
+
+    position = ImVec2(block.x * c_NodeSpacing.x - 20.0f, block.y * c_NodeSpacing.y - 40.0f);
+    size     = c_NodeSpacing * static_cast<float>(c_GroupSide) - ImVec2(20.0f, 10.0f);
+}
+
+static void SubmitGraph(const Graph& graph, bool placeNodes)
+{
+    for (int i = 0; i < graph.GetGroupCount(); ++i)
+    {
+        ImVec2 position, size;
+        GetGroupBounds(i, position, size);
+        if (placeNodes)
+            ed::SetNodePosition(GetGroupId(i), position);
+
+        ed::BeginNode(GetGroupId(i));
+        ImGui::Text("Group %d", i);
+        ed::Group(size);
+        ed::EndNode();
+    }
+
+    for (int i = 0; i < graph.NodeCount; ++i)
+    {
+        if (placeNodes)
+            ed::SetNodePosition(GetNodeId(i), GetNodePosition(i));
+
+        ed::BeginNode(GetNodeId(i));
+        ImGui::Text("Node %d", i);
+        ImGui::BeginGroup();
+        for (int pin = 0; pin < c_PinsPerSide; ++pin)
+        {
+            ed::BeginPin(GetInputPinId(i, pin), ed::PinKind::Input);
+            ImGui::Text("-> In");
+            ed::EndPin();
+        }
+        ImGui::EndGroup();
+        ImGui::SameLine();
+        ImGui::BeginGroup();
+        for (int pin = 0; pin < c_PinsPerSide; ++pin)
+        {
+            ed::BeginPin(GetOutputPinId(i, pin), ed::PinKind::Output);
+            ImGui::Text("Out ->");
+            ed::EndPin();
+        }
+        ImGui::EndGroup();
+        ed::EndNode();
+    }
+
+    // First output goes to next node, second to a distant one.
+    for (int i = 0; graph.NodeCount > 1 && i < graph.NodeCount; ++i)
+    {
+        ed::Link(GetLinkId(i, 0), GetOutputPinId(i, 0), GetInputPinId((i + 1) % graph.NodeCount, 0));
+        ed::Link(GetLinkId(i, 1), GetOutputPinId(i, 1), GetInputPinId((i * 7 + 13) % graph.NodeCount, 1));
+    }
+}
+
+// Same graph as SubmitGraph() submitted through handles acquired once
+// per editor with --handles.
+struct GraphHandles
+{
+    std::vector<ed::NodeHandle> Nodes;
+    std::vector<ed::PinHandle>  Inputs;
+    std::vector<ed::PinHandle>  Outputs;
+    std::vector<ed::LinkHandle> Links;
+
+    void Acquire(const Graph& graph)
+    {
+        Nodes.clear(); Inputs.clear(); Outputs.clear(); Links.clear();
+        for (int i = 0; i < graph.NodeCount; ++i)
+        {
+            Nodes.push_back(ed::AcquireNode(GetNodeId(i)));
+            for (int pin = 0; pin < c_PinsPerSide; ++pin)
+            {
+                Inputs.push_back(ed::AcquirePin(GetInputPinId(i, pin)));
+                Outputs.push_back(ed::AcquirePin(GetOutputPinId(i, pin)));
+                Links.push_back(ed::AcquireLink(GetLinkId(i, pin)));
+            }
+        }
+    }
+
+    void Clear()
+    {
+        Nodes.clear(); Inputs.clear(); Outputs.clear(); Links.clear();
+    }
+};
+
+static bool         g_UseHandles = false;
+static GraphHandles g_Handles;
+
+static void SubmitGraphHandles(const Graph& graph, bool placeNodes)
+{
+    if (static_cast<int>(g_Handles.Nodes.size()) != graph.NodeCount)
+        g_Handles.Acquire(graph);
+
+    for (int i = 0; i < graph.GetGroupCount(); ++i)
+    {
+        ImVec2 position, size;
+        GetGroupBounds(i, position, size);
+        if (placeNodes)
+            ed::SetNodePosition(GetGroupId(i), position);
+
+        ed::BeginNode(GetGroupId(i));
+        ImGui::Text("Group %d", i);
+        ed::Group(size);
+        ed::EndNode();
+    }
+
+    for (int i = 0; i < graph.NodeCount; ++i)
+    {
+        if (placeNodes)
+            ed::SetNodePosition(GetNodeId(i), GetNodePosition(i));
+
+        ed::BeginNode(g_Handles.Nodes[i]);
+        ImGui::Text("Node %d", i);
+        ImGui::BeginGroup();
+        for (int pin = 0; pin < c_PinsPerSide; ++pin)
+        {
+            ed::BeginPin(g_Handles.Inputs[i * c_PinsPerSide + pin], ed::PinKind::Input);
+            ImGui::Text("-> In");
+            ed::EndPin();
+        }
+        ImGui::EndGroup();
+        ImGui::SameLine();
+        ImGui::BeginGroup();
+        for (int pin = 0; pin < c_PinsPerSide; ++pin)
+        {
+            ed::BeginPin(g_Handles.Outputs[i * c_PinsPerSide + pin], ed::PinKind::Output);
+            ImGui::Text("Out ->");
+            ed::EndPin();
+        }
+        ImGui::EndGroup();
+        ed::EndNode();
+    }
+
+    for (int i = 0; graph.NodeCount > 1 && i < graph.NodeCount; ++i)
+    {
+        const int next    = (i + 1) % graph.NodeCount;
+        const int distant = (i * 7 + 13) % graph.NodeCount;
+        ed::Link(g_Handles.Links[i * c_PinsPerSide + 0], g_Handles.Outputs[i * c_PinsPerSide + 0], g_Handles.Inputs[next * c_PinsPerSide + 0]);
+        ed::Link(g_Handles.Links[i * c_PinsPerSide + 1], g_Handles.Outputs[i * c_PinsPerSide + 1], g_Handles.Inputs[distant * c_PinsPerSide + 1]);
+    }
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Scenarios
+//
+//------------------------------------------------------------------------------
+struct Input
+{
+    ImVec2 MousePos    = ImVec2(-FLT_MAX, -FLT_MAX);
+    bool   MouseDown   = false;
+    float  MouseWheel  = 0.0f;
+    bool   FlowLinks   = false;
+    bool   MoveNode    = false;
+    bool   ShowMinimap = false;
+    bool   Hibernate   = false;
+    bool   SaveState   = false; // push snapshot to undo stack after frame
+    bool   UndoState   = false; // pop and restore snapshot after frame
+    bool   SelectAll   = false;
+    bool   AutoLayout  = false;
+    float  AntiAliasZoom = 0.0f; // Style::LodAntiAliasZoom
+};
+
+// Returns input for given frame, frames are counted from 0.
+using ScenarioInput = Input (*)(int frame, int frameCount);
+
+struct Scenario
+{
+    const char*   Name;
+    const char*   Description;
+    bool          HasGroups;
+    bool          MeasureLoad;  // Time first frame of new editor loading saved settings
+    ScenarioInput GetInput;
+};
+
+static Input IdleInput(int frame, int frameCount)
+{
+    IM_UNUSED(frame);
+    IM_UNUSED(frameCount);
+    return Input();
+}
+
+static Input HoverInput(int frame, int frameCount)
+{
+    IM_UNUSED(frameCount);
+    Input input;
+    input.MousePos = ImVec2(fmodf(frame * 37.0f, c_DisplaySize.x), fmodf(frame * 23.0f, c_DisplaySize.y));
+    return input;
+}
+
+static Input DragInput(int frame, int frameCount)
+{
+    // Grab title of the first node, move it and let go in the last frame.
+    Input input;
+    input.MousePos  = ImVec2(20.0f, 10.0f) + ImVec2(3.0f, 2.0f) * static_cast<float>(frame);
+    input.MouseDown = frame < frameCount - 1;
+    return input;
+}
+
+static Input DragSelectionInput(int frame, int frameCount)
+{
+    // Select everything, then drag it by title of the first node.
+    auto input = DragInput(frame, frameCount);
+    input.SelectAll = frame == 0;
+    return input;
+}
+
+static Input SelectInput(int frame, int frameCount)
+{
+    // Drag marquee from background between nodes over most of the view.
+    const auto start = c_NodeSpacing * 0.8f;
+    const auto end   = c_DisplaySize - ImVec2(10.0f, 10.0f);
+    const auto t     = ImMin(1.0f, frame / ImMax(1.0f, frameCount - 2.0f));
+
+    Input input;
+    input.MousePos  = ImLerp(start, end, t);
+    input.MouseDown = frame < frameCount - 1;
+    return input;
+}
+
+static Input ZoomInput(int frame, int frameCount)
+{
+    // Zoom out during first half, back in during the second.
+    Input input;
+    input.MousePos   = c_DisplaySize * 0.5f;
+    input.MouseWheel = frame % 4 != 0 ? 0.0f : (frame < frameCount / 2 ? -1.0f : 1.0f);
+    return input;
+}
+
+static Input OverviewInput(int frame, int frameCount)
+{
+    // Zoom out as far as possible during first half, then stay there.
+    Input input;
+    input.MousePos      = c_DisplaySize * 0.5f;
+    input.MouseWheel    = frame % 2 == 0 && frame < frameCount / 2 ? -1.0f : 0.0f;
+    input.AntiAliasZoom = 0.5f;
+    return input;
+}
+
+static Input FlowInput(int frame, int frameCount)
+{
+    IM_UNUSED(frameCount);
+    Input input;
+    input.FlowLinks = frame % 30 == 0;
+    return input;
+}
+
+static Input SettingsInput(int frame, int frameCount)
+{
+    IM_UNUSED(frame);
+    IM_UNUSED(frameCount);
+    Input input;
+    input.MoveNode = true;
+    return input;
+}
+
+static Input MinimapInput(int frame, int frameCount)
+{
+    // Drag across default minimap in bottom right corner, view follows.
+    const auto minimapMax = c_DisplaySize - ImVec2(12.0f, 12.0f);
+    const auto minimapMin = minimapMax - ImVec2(196.0f, 146.0f);
+    const auto t          = ImMin(1.0f, frame / ImMax(1.0f, frameCount - 2.0f));
+
+    Input input;
+    input.MousePos    = ImLerp(minimapMin, minimapMax, t);
+    input.MouseDown   = frame < frameCount - 1;
+    input.ShowMinimap = true;
+    return input;
+}
+
+static Input WakeInput(int frame, int frameCount)
+{
+    IM_UNUSED(frame);
+    IM_UNUSED(frameCount);
+    Input input;
+    input.Hibernate = true;
+    return input;
+}
+
+static Input UndoInput(int frame, int frameCount)
+{
+    // Node moved and snapshot saved in first half, undone in the second.
+    Input input;
+    input.MoveNode  = frame < frameCount / 2;
+    input.SaveState = frame < frameCount / 2;
+    input.UndoState = frame >= frameCount / 2;
+    return input;
+}
+
+static Input LayoutInput(int frame, int frameCount)
+{
+    // Layout computed on worker thread, frames keep going while it runs.
+    IM_UNUSED(frameCount);
+    Input input;
+    input.AutoLayout = frame == 0;
+    return input;
+}
+
+static const Scenario c_Scenarios[] =
+{
+    { "idle",     "static graph, no input",                           false, false, IdleInput     },
+    { "hover",    "mouse moving over canvas",                         false, false, HoverInput    },
+    { "drag",     "dragging a node",                                  false, false, DragInput     },
+    { "dragall",  "dragging selection of every node",                 false, false, DragSelectionInput },
+    { "select",   "growing selection rectangle",                      false, false, SelectInput   },
+    { "zoom",     "zooming out and in with mouse wheel",              false, false, ZoomInput     },
+    { "overview", "zoomed out, anti-aliasing off below 50%",          false, false, OverviewInput },
+    { "groups",   "static graph with group nodes",                    true,  false, IdleInput     },
+    { "flow",     "flow animation on every link",                     false, false, FlowInput     },
+    { "settings", "node moved every frame, settings saved, reloaded", false, true,  SettingsInput },
+    { "minimap",  "dragging view over minimap",                       false, false, MinimapInput  },
+    { "wake",     "editor hibernated after every frame",              false, false, WakeInput     },
+    { "undo",     "delta snapshots saved, then restored in reverse",  false, false, UndoInput     },
+    { "layout",   "layered auto layout applied in batches, animated", false, false, LayoutInput   },
+};
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Benchmark
+//
+//------------------------------------------------------------------------------
+// Settings are passed in chunks with --stream.
+static bool g_StreamSettings = false;
+
+// Config::FrameBudget set with --budget.
+static float g_FrameBudget = 0.0f;
+
+// Runs are recorded to '<prefix><scenario>-<nodes>.trace' with --record.
+static const char* g_RecordPrefix = nullptr;
+
+struct Settings
+{
+    std::string Data;
+    int         SaveCount = 0;
+    std::string Written;     // chunks of save in progress, see WriteSettings()
+    size_t      ReadOffset = 0;
+};
+
+static bool SaveSettings(const char* data, size_t size, ed::SaveReasonFlags reason, void* userPointer)
+{
+    IM_UNUSED(reason);
+    auto settings = reinterpret_cast<Settings*>(userPointer);
+    settings->Data.assign(data, size);
+    ++settings->SaveCount;
+    return true;
+}
+
+static size_t LoadSettings(char* data, void* userPointer)
+{
+    auto settings = reinterpret_cast<Settings*>(userPointer);
+    if (data)
+        memcpy(data, settings->Data.data(), settings->Data.size());
+    return settings->Data.size();
+}
+
+static bool WriteSettings(const char* data, size_t size, ed::SaveReasonFlags reason, void* userPointer)
+{
+    IM_UNUSED(reason);
+    auto settings = reinterpret_cast<Settings*>(userPointer);
+    if (data)
+    {
+        settings->Written.append(data, size);
+        return true;
+    }
+
+    settings->Data.swap(settings->Written);
+    settings->Written.resize(0);
+    ++settings->SaveCount;
+    return true;
+}
+
+static size_t ReadSettings(char* data, size_t size, void* userPointer)
+{
+    auto settings = reinterpret_cast<Settings*>(userPointer);
+    size = ImMin(size, settings->Data.size() - settings->ReadOffset);
+    memcpy(data, settings->Data.data() + settings->ReadOffset, size);
+    settings->ReadOffset += size;
+    return size;
+}
+
+struct FrameSample
+{
+    double Milliseconds;
+    size_t Allocations;
+    size_t AllocatedBytes;
+};
+
+static std::vector<ed::StateSnapshot*> g_UndoStack;
+
+// Full screen window editor lives in. Replayed traces expect this one.
+static void BeginHostWindow()
+{
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+    ImGui::Begin("Benchmark", nullptr,
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoSavedSettings);
+    ImGui::PopStyleVar();
+}
+
+static FrameSample RunFrame(ed::EditorContext* editor, const Graph& graph, const Input& input, int frame)
+{
+    auto& io = ImGui::GetIO();
+    io.DisplaySize = c_DisplaySize;
+    io.DeltaTime   = c_DeltaTime;
+    io.MousePos    = input.MousePos;
+    io.MouseDown[0] = input.MouseDown;
+    io.MouseWheel  = input.MouseWheel;
+
+    const auto allocationCount = g_AllocationCount.load();
+    const auto allocationBytes = g_AllocationBytes.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    ImGui::NewFrame();
+
+    BeginHostWindow();
+
+    ed::SetCurrentEditor(editor);
+    ed::GetStyle().LodAntiAliasZoom = input.AntiAliasZoom;
+    ed::Begin("Benchmark Editor");
+
+    if (input.ShowMinimap)
+        ed::ShowMinimap();
+
+    if (g_UseHandles)
+        SubmitGraphHandles(graph, frame == 0);
+    else
+        SubmitGraph(graph, frame == 0);
+
+    if (input.SelectAll)
+        for (int i = 0; i < graph.NodeCount; ++i)
+            ed::SelectNode(GetNodeId(i), true);
+
+    if (input.MoveNode && graph.NodeCount > 0)
+        ed::SetNodePosition(GetNodeId(0), GetNodePosition(0) + ImVec2(static_cast<float>(frame % 20), 0.0f));
+
+    if (input.AutoLayout)
+        ed::AutoLayout();
+
+    if (input.FlowLinks)
+        for (int i = 0; i < graph.GetLinkCount() / c_PinsPerSide; ++i)
+            ed::Flow(GetLinkId(i, 0));
+
+    ed::End();
+
+    if (input.SaveState)
+        g_UndoStack.push_back(ed::SaveStateSnapshot(g_UndoStack.empty() ? nullptr : g_UndoStack.back()));
+
+    if (input.UndoState && !g_UndoStack.empty())
+    {
+        ed::RestoreStateSnapshot(g_UndoStack.back());
+        ed::DestroyStateSnapshot(g_UndoStack.back());
+        g_UndoStack.pop_back();
+    }
+
+    ed::SetCurrentEditor(nullptr);
+
+    if (input.Hibernate)
+        ed::HibernateEditor(editor);
+
+    ImGui::End();
+    ImGui::Render();
+
+    const auto end = std::chrono::steady_clock::now();
+
+    FrameSample sample;
+    sample.Milliseconds   = std::chrono::duration<double, std::milli>(end - start).count();
+    sample.Allocations    = g_AllocationCount - allocationCount;
+    sample.AllocatedBytes = g_AllocationBytes - allocationBytes;
+    return sample;
+}
+
+static void PrintHeader()
+{
+    printf("%-10s %7s %7s %6s %9s %9s %9s %9s %11s %11s %9s\n",
+        "scenario", "nodes", "links", "frames", "avg ms", "min ms", "p95 ms", "max ms", "allocs/fr", "KB/frame", "vertices");
+}
+
+// Negative counts are unknown, as for replayed trace.
+static void PrintRow(const char* name, int nodeCount, int linkCount, std::vector<FrameSample>& samples, const ed::FrameStats& stats)
+{
+    if (samples.empty())
+        return;
+
+    double total = 0.0;
+    size_t allocations = 0, bytes = 0;
+    for (auto& sample : samples)
+    {
+        total       += sample.Milliseconds;
+        allocations += sample.Allocations;
+        bytes       += sample.AllocatedBytes;
+    }
+
+    std::sort(samples.begin(), samples.end(), [](const FrameSample& lhs, const FrameSample& rhs) { return lhs.Milliseconds < rhs.Milliseconds; });
+
+    char nodes[16] = "-", links[16] = "-";
+    if (nodeCount >= 0)
+        snprintf(nodes, sizeof(nodes), "%d", nodeCount);
+    if (linkCount >= 0)
+        snprintf(links, sizeof(links), "%d", linkCount);
+
+    const auto count = samples.size();
+    printf("%-10s %7s %7s %6d %9.3f %9.3f %9.3f %9.3f %11.1f %11.1f %9d\n",
+        name, nodes, links, static_cast<int>(count),
+        total / count, samples.front().Milliseconds, samples[(count * 95) / 100 < count ? (count * 95) / 100 : count - 1].Milliseconds, samples.back().Milliseconds,
+        static_cast<double>(allocations) / count, static_cast<double>(bytes) / count / 1024.0, stats.VertexCount);
+}
+
+static void PrintPhases(const ed::FrameStats& stats)
+{
+    static const char* const phaseNames[] = { "Frame", "BuildControl", "DrawNodes", "DrawLinks", "ReorderChannels", "MergeChannels", "LeaveLocalSpace", "SaveSettings" };
+    static_assert(IM_ARRAYSIZE(phaseNames) == static_cast<int>(ed::FramePhase::Count), "Every frame phase needs a name.");
+
+    if (stats.Phases[static_cast<int>(ed::FramePhase::Frame)].Max == 0.0f)
+        return;
+
+    for (int i = 0; i < static_cast<int>(ed::FramePhase::Count); ++i)
+    {
+        const auto& timing = stats.Phases[i];
+        printf("    %-16s avg %8.3f ms  min %8.3f ms  max %8.3f ms\n", phaseNames[i], timing.Average, timing.Min, timing.Max);
+    }
+}
+
+static void PrintQuality(const ed::FrameStats& stats)
+{
+    if (g_FrameBudget <= 0.0f)
+        return;
+
+    printf("    %-16s level %d, End() %.3f ms of %.3f ms budget\n", "Quality", stats.QualityLevel, stats.EndTime, g_FrameBudget);
+}
+
+static void PrintMemory(const char* label, const ed::MemoryStats& stats)
+{
+    printf("    %-16s objects %8.1f KB  channels %8.1f KB  settings %8.1f KB  animations %8.1f KB  caches %8.1f KB  total %8.1f KB\n",
+        label, stats.Objects / 1024.0, stats.Channels / 1024.0, stats.Settings / 1024.0, stats.Animations / 1024.0, stats.Caches / 1024.0, stats.Total / 1024.0);
+}
+
+static void WriteTraceFile(const char* path, const ed::Trace* trace)
+{
+    const auto size = ed::GetTraceSize(trace);
+
+    auto file = fopen(path, "wb");
+    const auto written = file ? fwrite(ed::GetTraceData(trace), 1, size, file) : 0;
+    if (file)
+        fclose(file);
+
+    if (written != size)
+        printf("    %-16s failed to write %s\n", "Trace", path);
+    else
+        printf("    %-16s %s, %d frames, %.1f KB\n", "Trace", path, ed::GetTraceFrameCount(trace), size / 1024.0);
+}
+
+static ed::Trace* ReadTraceFile(const char* path)
+{
+    std::string data;
+    if (auto file = fopen(path, "rb"))
+    {
+        char buffer[64 * 1024];
+        while (auto size = fread(buffer, 1, sizeof(buffer), file))
+            data.append(buffer, size);
+        fclose(file);
+    }
+
+    return data.empty() ? nullptr : ed::LoadTrace(data.data(), data.size());
+}
+
+static void RunScenario(const Scenario& scenario, int nodeCount, int frameCount, int warmupFrames)
+{
+    Graph graph;
+    graph.NodeCount = nodeCount;
+    graph.HasGroups = scenario.HasGroups;
+
+    Settings settings;
+
+    ed::Config config;
+    config.SettingsFile = nullptr;
+    config.SaveSettings = SaveSettings;
+    config.LoadSettings = LoadSettings;
+    if (g_StreamSettings)
+    {
+        config.WriteSettings = WriteSettings;
+        config.ReadSettings  = ReadSettings;
+    }
+    config.UserPointer  = &settings;
+    if (g_ThreadCount > 1)
+        config.ParallelFor = ParallelFor;
+    config.FrameBudget = g_FrameBudget;
+
+    auto editor = ed::CreateEditor(&config);
+
+    if (g_RecordPrefix)
+    {
+        ed::SetCurrentEditor(editor);
+        ed::BeginTraceRecording();
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    // Let node sizes settle before measuring.
+    for (int frame = 0; frame < warmupFrames; ++frame)
+        RunFrame(editor, graph, Input(), frame);
+
+    std::vector<FrameSample> samples;
+    samples.reserve(frameCount);
+    for (int frame = 0; frame < frameCount; ++frame)
+        samples.push_back(RunFrame(editor, graph, scenario.GetInput(frame, frameCount), warmupFrames + frame));
+
+    ed::SetCurrentEditor(editor);
+    auto trace = ed::EndTraceRecording();
+    const auto stats = ed::GetFrameStats();
+    const auto memory = ed::GetMemoryStats();
+    ed::TrimMemory();
+    const auto trimmedMemory = ed::GetMemoryStats();
+    ed::SetCurrentEditor(nullptr);
+
+    PrintRow(scenario.Name, graph.NodeCount, graph.GetLinkCount(), samples, stats);
+    PrintPhases(stats);
+    PrintQuality(stats);
+    PrintMemory("Memory", memory);
+    PrintMemory("Trimmed", trimmedMemory);
+
+    if (trace)
+    {
+        const auto path = std::string(g_RecordPrefix) + scenario.Name + "-" + std::to_string(nodeCount) + ".trace";
+        WriteTraceFile(path.c_str(), trace);
+        ed::DestroyTrace(trace);
+    }
+
+    for (auto snapshot : g_UndoStack)
+        ed::DestroyStateSnapshot(snapshot);
+    g_UndoStack.clear();
+
+    ed::DestroyEditor(editor);
+    g_Handles.Clear();
+
+    // Settings written during the run are loaded by new editor in its first frame.
+    if (scenario.MeasureLoad && settings.SaveCount > 0)
+    {
+        auto loadedEditor = ed::CreateEditor(&config);
+
+        std::vector<FrameSample> loadSamples = { RunFrame(loadedEditor, graph, Input(), 1) };
+
+        ed::SetCurrentEditor(loadedEditor);
+        const auto loadStats = ed::GetFrameStats();
+        ed::SetCurrentEditor(nullptr);
+
+        PrintRow("load", graph.NodeCount, graph.GetLinkCount(), loadSamples, loadStats);
+
+        ed::DestroyEditor(loadedEditor);
+        g_Handles.Clear();
+    }
+}
+
+// Input comes from trace, editor calls are replayed in place of graph submission.
+static FrameSample RunReplayFrame(ed::EditorContext* editor, const ed::Trace* trace, int frame)
+{
+    ed::ApplyTraceInput(trace, frame);
+
+    const auto allocationCount = g_AllocationCount.load();
+    const auto allocationBytes = g_AllocationBytes.load();
+    const auto start = std::chrono::steady_clock::now();
+
+    ImGui::NewFrame();
+
+    BeginHostWindow();
+
+    ed::SetCurrentEditor(editor);
+    ed::ReplayTraceFrame(trace, frame);
+    ed::SetCurrentEditor(nullptr);
+
+    ImGui::End();
+    ImGui::Render();
+
+    const auto end = std::chrono::steady_clock::now();
+
+    FrameSample sample;
+    sample.Milliseconds   = std::chrono::duration<double, std::milli>(end - start).count();
+    sample.Allocations    = g_AllocationCount - allocationCount;
+    sample.AllocatedBytes = g_AllocationBytes - allocationBytes;
+    return sample;
+}
+
+static bool RunReplay(const char* path)
+{
+    auto trace = ReadTraceFile(path);
+    if (!trace)
+    {
+        printf("Cannot load trace from %s\n", path);
+        return false;
+    }
+
+    ed::Config config;
+    config.SettingsFile = nullptr;
+    if (g_ThreadCount > 1)
+        config.ParallelFor = ParallelFor;
+    config.FrameBudget = g_FrameBudget;
+
+    auto editor = ed::CreateEditor(&config);
+
+    const auto frameCount = ed::GetTraceFrameCount(trace);
+
+    std::vector<FrameSample> samples;
+    samples.reserve(frameCount);
+    for (int frame = 0; frame < frameCount; ++frame)
+        samples.push_back(RunReplayFrame(editor, trace, frame));
+
+    ed::SetCurrentEditor(editor);
+    const auto stats = ed::GetFrameStats();
+    ed::SetCurrentEditor(nullptr);
+
+    // Frames are reported in order, before PrintRow() sorts them.
+    for (int frame = 0; frame < frameCount; ++frame)
+        printf("    frame %6d %9.3f ms %9d allocs %9.1f KB\n", frame,
+            samples[frame].Milliseconds, static_cast<int>(samples[frame].Allocations), samples[frame].AllocatedBytes / 1024.0);
+
+    PrintRow("replay", -1, -1, samples, stats);
+    PrintPhases(stats);
+    PrintQuality(stats);
+
+    ed::DestroyEditor(editor);
+    ed::DestroyTrace(trace);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//
+// Checks
+//
+//------------------------------------------------------------------------------
+// Correctness checks run by --check. Each returns false and prints reason on
+// failure.
+struct Check
+{
+    const char* Name;
+    const char* Description;
+    bool      (*Run)();
+};
+
+// Editor opens new command when channel it switches to lags behind current
+// vertex offset (16-bit indices only). Clip rect or texture change bringing
+// back state of previous command must not merge it away, drawing would
+// continue against old offset.
+static bool CheckVtxOffsetAfterClipChange()
+{
+    if (sizeof(ImDrawIdx) != 2)
+        return true;
+
+    const auto texture = reinterpret_cast<ImTextureID>(1);
+
+    ImDrawListSharedData sharedData;
+    ImDrawList drawList(&sharedData);
+    drawList.Flags |= ImDrawListFlags_AllowVtxOffset;
+    drawList.PushClipRectFullScreen();
+    drawList.PushTextureID(texture);
+
+    drawList.ChannelsSplit(2);
+    drawList.ChannelsSetCurrent(0);
+    drawList.AddRectFilled(ImVec2(0, 0), ImVec2(1, 1), IM_COL32_WHITE);
+
+    // Use up 16-bit indices in other channel.
+    drawList.ChannelsSetCurrent(1);
+    while (drawList._VtxCurrentOffset == 0)
+        drawList.AddRectFilled(ImVec2(0, 0), ImVec2(1, 1), IM_COL32_WHITE);
+
+    // Same as ImDrawList_SyncVtxOffset() does for command already in use.
+    drawList.ChannelsSetCurrent(0);
+    drawList.AddDrawCmd();
+
+    const auto offset = drawList._VtxCurrentOffset;
+    const auto clipRect = drawList._ClipRectStack.back();
+    drawList.PushClipRect(ImVec2(clipRect.x, clipRect.y), ImVec2(clipRect.z, clipRect.w));
+    drawList.PopClipRect();
+    drawList.PushTextureID(texture);
+    drawList.PopTextureID();
+
+    const auto& cmd = drawList.CmdBuffer.back();
+    const auto result = cmd.VtxOffset == offset && drawList.CmdBuffer.Size == 2;
+    if (!result)
+        printf("    command has vertex offset %u, expected %u, %d commands\n", cmd.VtxOffset, offset, drawList.CmdBuffer.Size);
+
+    drawList.ChannelsMerge();
+
+    return result;
+}
+
+// Auto layout is not replayed itself, trace has to carry positions it gives
+// to nodes. Replayed editor has to end with nodes where recorded one had them.
+static bool CheckLayoutReplay()
+{
+    const int c_FrameLimit = 600;
+
+    Graph graph;
+    graph.NodeCount = 2 * c_Columns;
+
+    ed::Config config;
+    config.SettingsFile = nullptr;
+
+    auto editor = ed::CreateEditor(&config);
+    ed::SetCurrentEditor(editor);
+    ed::BeginTraceRecording();
+    ed::SetCurrentEditor(nullptr);
+
+    auto running = true;
+    for (int frame = 0; running && frame < c_FrameLimit; ++frame)
+    {
+        RunFrame(editor, graph, LayoutInput(frame, c_FrameLimit), frame);
+
+        ed::SetCurrentEditor(editor);
+        running = frame == 0 || ed::IsAutoLayoutRunning();
+        ed::SetCurrentEditor(nullptr);
+    }
+
+    ed::SetCurrentEditor(editor);
+    auto trace = ed::EndTraceRecording();
+    std::vector<ImVec2> positions;
+    for (int i = 0; i < graph.NodeCount; ++i)
+        positions.push_back(ed::GetNodePosition(GetNodeId(i)));
+    ed::SetCurrentEditor(nullptr);
+    ed::DestroyEditor(editor);
+
+    if (running || !trace)
+    {
+        printf("    %s\n", running ? "layout did not finish" : "nothing recorded");
+        ed::DestroyTrace(trace);
+        return false;
+    }
+
+    auto replayEditor = ed::CreateEditor(&config);
+    for (int frame = 0; frame < ed::GetTraceFrameCount(trace); ++frame)
+        RunReplayFrame(replayEditor, trace, frame);
+
+    auto result = true;
+    auto moved  = false;
+    ed::SetCurrentEditor(replayEditor);
+    for (int i = 0; i < graph.NodeCount; ++i)
+    {
+        const auto position = ed::GetNodePosition(GetNodeId(i));
+        moved = moved || position.x != GetNodePosition(i).x || position.y != GetNodePosition(i).y;
+        if (result && (position.x != positions[i].x || position.y != positions[i].y))
+        {
+            printf("    node %d replayed at (%g, %g), recorded at (%g, %g)\n", i, position.x, position.y, positions[i].x, positions[i].y);
+            result = false;
+        }
+    }
+    ed::SetCurrentEditor(nullptr);
+    ed::DestroyEditor(replayEditor);
+    ed::DestroyTrace(trace);
+
+    if (result && !moved)
+    {
+        printf("    layout moved no nodes\n");
+        result = false;
+    }
+
+    return result;
+}
+
+static const Check c_Checks[] =
+{
+    { "vtxoffset", "vertex offset kept over clip rect and texture changes", CheckVtxOffsetAfterClipChange },
+    { "layout",    "nodes moved by auto layout are replayed from trace",    CheckLayoutReplay            },
+};
+
+static bool RunChecks()
+{
+    auto result = true;
+    for (auto& check : c_Checks)
+    {
+        const auto passed = check.Run();
+        printf("%-12s %-6s %s\n", check.Name, passed ? "ok" : "FAILED", check.Description);
+        result = result && passed;
+    }
+    return result;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Main
+//
+//------------------------------------------------------------------------------
+static std::vector<int> ParseIntList(const char* text)
+{
+    std::vector<int> result;
+    while (text && *text)
+    {
+        char* end = nullptr;
+        const auto value = strtol(text, &end, 10);
+        if (end == text)
+            break;
+        if (value > 0)
+            result.push_back(static_cast<int>(value));
+        text = *end == ',' ? end + 1 : end;
+    }
+    return result;
+}
+
+static bool IsScenarioSelected(const char* list, const char* name)
+{
+    if (!list)
+        return true;
+
+    const auto length = strlen(name);
+    for (auto item = list; item && *item; )
+    {
+        auto separator = strchr(item, ',');
+        const auto itemLength = separator ? static_cast<size_t>(separator - item) : strlen(item);
+        if (itemLength == length && strncmp(item, name, length) == 0)
+            return true;
+        item = separator ? separator + 1 : nullptr;
+    }
+
+    return false;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: editor-benchmark [--nodes 1000,10000] [--frames 120] [--warmup 5] [--scenario name,...] [--threads 1] [--stream] [--handles] [--budget ms] [--record prefix]\n");
+    printf("       editor-benchmark --replay trace [--threads 1] [--budget ms]\n");
+    printf("       editor-benchmark --check\n\n");
+    printf("Scenarios:\n");
+    for (auto& scenario : c_Scenarios)
+        printf("    %-10s %s\n", scenario.Name, scenario.Description);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> nodeCounts = { 1000, 10000 };
+    int         frameCount   = 120;
+    int         warmupFrames = 5;
+    const char* scenarios    = nullptr;
+    const char* replayPath   = nullptr;
+    bool        runChecks    = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--nodes") == 0 && hasValue)
+            nodeCounts = ParseIntList(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            frameCount = ImMax(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+            warmupFrames = ImMax(2, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--scenario") == 0 && hasValue)
+            scenarios = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+            g_ThreadCount = ImMax(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--stream") == 0)
+            g_StreamSettings = true;
+        else if (strcmp(argv[i], "--budget") == 0 && hasValue)
+            g_FrameBudget = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--handles") == 0)
+            g_UseHandles = true;
+        else if (strcmp(argv[i], "--record") == 0 && hasValue)
+            g_RecordPrefix = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && hasValue)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--check") == 0)
+            runChecks = true;
+        else
+        {
+            PrintUsage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    ImGui::SetAllocatorFunctions(ImGuiAlloc, ImGuiFree);
+    ImGui::CreateContext();
+
+    // Null backend, font atlas is built but never uploaded.
+    auto& io = ImGui::GetIO();
+    io.IniFilename  = nullptr;
+    io.LogFilename  = nullptr;
+    io.DisplaySize  = c_DisplaySize;
+    io.DeltaTime    = c_DeltaTime;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->TexID = reinterpret_cast<ImTextureID>(1);
+
+    if (!runChecks)
+        PrintHeader();
+
+    auto result = 0;
+    if (runChecks)
+        result = RunChecks() ? 0 : 1;
+    else if (replayPath)
+        result = RunReplay(replayPath) ? 0 : 1;
+    else
+    {
+        for (auto nodeCount : nodeCounts)
+            for (auto& scenario : c_Scenarios)
+                if (IsScenarioSelected(scenarios, scenario.Name))
+                    RunScenario(scenario, nodeCount, frameCount, warmupFrames);
+    }
+
+    ImGui::DestroyContext();
+
+    return result;
+}
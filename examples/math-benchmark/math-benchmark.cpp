@@ -0,0 +1,600 @@
+# include <imgui.h>
+# define IMGUI_DEFINE_MATH_OPERATORS
+# include <imgui_internal.h>
+# include "imgui_extra_math.h"
+# include "imgui_bezier_math.h"
+# include "imgui_canvas.h"
+# include <algorithm>
+# include <chrono>
+# include <cstdarg>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <vector>
+
+// Micro-benchmarks for imgui_bezier_math, imgui_extra_math and canvas
+// transform kernels.
+//
+// Every kernel is timed over a set of curve shapes and its result compared
+// against a reference computed in double precision by brute force. Batch
+// kernels are compared against their single curve versions, results are
+// expected to match exactly.
+//
+// Usage: math-benchmark [--filter text] [--repeat 5]
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Reference math
+//
+//------------------------------------------------------------------------------
+struct DVec2
+{
+    double x, y;
+
+    DVec2(): x(0.0), y(0.0) {}
+    DVec2(double x, double y): x(x), y(y) {}
+    DVec2(const ImVec2& v): x(v.x), y(v.y) {}
+};
+
+static DVec2  operator+(const DVec2& a, const DVec2& b) { return DVec2(a.x + b.x, a.y + b.y); }
+static DVec2  operator-(const DVec2& a, const DVec2& b) { return DVec2(a.x - b.x, a.y - b.y); }
+static DVec2  operator*(const DVec2& a, double s)       { return DVec2(a.x * s, a.y * s); }
+static double Length(const DVec2& v)                    { return std::sqrt(v.x * v.x + v.y * v.y); }
+
+static DVec2 Evaluate(const ImCubicBezierPoints& curve, double t)
+{
+    const auto u = 1.0 - t;
+    const auto w0 = u * u * u;
+    const auto w1 = 3.0 * u * u * t;
+    const auto w2 = 3.0 * u * t * t;
+    const auto w3 = t * t * t;
+    return DVec2(curve.P0) * w0 + DVec2(curve.P1) * w1 + DVec2(curve.P2) * w2 + DVec2(curve.P3) * w3;
+}
+
+static const int c_ReferenceSegments = 100000;
+
+static double ReferenceLength(const ImCubicBezierPoints& curve)
+{
+    auto length   = 0.0;
+    auto previous = Evaluate(curve, 0.0);
+    for (int i = 1; i <= c_ReferenceSegments; ++i)
+    {
+        const auto point = Evaluate(curve, static_cast<double>(i) / c_ReferenceSegments);
+        length  += Length(point - previous);
+        previous = point;
+    }
+    return length;
+}
+
+static void ReferenceBounds(const ImCubicBezierPoints& curve, DVec2& min, DVec2& max)
+{
+    min = max = Evaluate(curve, 0.0);
+    for (int i = 1; i <= c_ReferenceSegments; ++i)
+    {
+        const auto point = Evaluate(curve, static_cast<double>(i) / c_ReferenceSegments);
+        min = DVec2(std::min(min.x, point.x), std::min(min.y, point.y));
+        max = DVec2(std::max(max.x, point.x), std::max(max.y, point.y));
+    }
+}
+
+// Distance from point to curve, dense sampling refined by golden section search.
+static double ReferenceDistance(const ImCubicBezierPoints& curve, const DVec2& point)
+{
+    const int samples = 4000;
+
+    auto distance = [&curve, &point](double t) { return Length(Evaluate(curve, t) - point); };
+
+    int  best         = 0;
+    auto bestDistance = distance(0.0);
+    for (int i = 1; i <= samples; ++i)
+    {
+        const auto d = distance(static_cast<double>(i) / samples);
+        if (d < bestDistance)
+        {
+            bestDistance = d;
+            best         = i;
+        }
+    }
+
+    const auto ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+    auto a = std::max(0.0, (best - 1.0) / samples);
+    auto b = std::min(1.0, (best + 1.0) / samples);
+    for (int i = 0; i < 80; ++i)
+    {
+        const auto c = b - (b - a) * ratio;
+        const auto d = a + (b - a) * ratio;
+        if (distance(c) < distance(d))
+            b = d;
+        else
+            a = c;
+    }
+
+    return std::min(bestDistance, distance(0.5 * (a + b)));
+}
+
+// Point at given arc length, found on dense polyline.
+static DVec2 ReferencePointAtLength(const ImCubicBezierPoints& curve, double target)
+{
+    auto length   = 0.0;
+    auto previous = Evaluate(curve, 0.0);
+    for (int i = 1; i <= c_ReferenceSegments; ++i)
+    {
+        const auto point   = Evaluate(curve, static_cast<double>(i) / c_ReferenceSegments);
+        const auto segment = Length(point - previous);
+        if (length + segment >= target && segment > 0.0)
+            return previous + (point - previous) * ((target - length) / segment);
+        length  += segment;
+        previous = point;
+    }
+    return previous;
+}
+
+// Number of crossings of infinite line through a and b, counted on dense sampling.
+// Only strict side changes count. Sample landing on the line (within rounding
+// of evaluation) belongs to neither side, so crossing through it is counted
+// once and curve lying on the line is not crossing it.
+static int ReferenceLineCrossings(const ImCubicBezierPoints& curve, const ImVec2& a, const ImVec2& b)
+{
+    const auto direction = DVec2(b) - DVec2(a);
+    const auto tolerance = 1e-9 * Length(direction); // 1e-9 px from the line
+    auto side = [&](const DVec2& p)
+    {
+        const auto d     = p - DVec2(a);
+        const auto cross = direction.x * d.y - direction.y * d.x;
+        return std::abs(cross) <= tolerance ? 0.0 : cross;
+    };
+
+    int  crossings = 0;
+    auto previous  = side(Evaluate(curve, 0.0)); // last non-zero side, 0 until first one
+    for (int i = 1; i <= c_ReferenceSegments; ++i)
+    {
+        const auto current = side(Evaluate(curve, static_cast<double>(i) / c_ReferenceSegments));
+        if (current == 0.0)
+            continue;
+        if ((previous < 0.0 && current > 0.0) || (previous > 0.0 && current < 0.0))
+            ++crossings;
+        previous = current;
+    }
+    return crossings;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Curve shapes
+//
+//------------------------------------------------------------------------------
+struct Shape
+{
+    const char*         Name;
+    ImCubicBezierPoints Curve;
+};
+
+static const Shape c_Shapes[] =
+{
+    { "short",     { ImVec2(10.0f, 10.0f),  ImVec2(14.0f, 10.0f),  ImVec2(16.0f, 14.0f),   ImVec2(20.0f, 14.0f)   } },
+    { "link",      { ImVec2(100.0f, 100.0f), ImVec2(200.0f, 100.0f), ImVec2(300.0f, 400.0f), ImVec2(400.0f, 400.0f) } },
+    { "long",      { ImVec2(-2000.0f, 300.0f), ImVec2(1500.0f, -800.0f), ImVec2(-900.0f, 2500.0f), ImVec2(3000.0f, 1200.0f) } },
+    { "s-shape",   { ImVec2(0.0f, 0.0f),    ImVec2(600.0f, 0.0f),  ImVec2(-200.0f, 300.0f), ImVec2(400.0f, 300.0f) } },
+    { "loop",      { ImVec2(0.0f, 0.0f),    ImVec2(500.0f, 300.0f), ImVec2(-200.0f, 300.0f), ImVec2(300.0f, 0.0f)  } },
+    { "line",      { ImVec2(0.0f, 0.0f),    ImVec2(100.0f, 50.0f),  ImVec2(200.0f, 100.0f), ImVec2(300.0f, 150.0f) } },
+    { "point",     { ImVec2(50.0f, 50.0f),  ImVec2(50.0f, 50.0f),   ImVec2(50.0f, 50.0f),   ImVec2(50.0f, 50.0f)   } },
+};
+
+static ImRect GetShapeBounds(const ImCubicBezierPoints& curve)
+{
+    DVec2 min, max;
+    ReferenceBounds(curve, min, max);
+    return ImRect(ImVec2(static_cast<float>(min.x), static_cast<float>(min.y)), ImVec2(static_cast<float>(max.x), static_cast<float>(max.y)));
+}
+
+// Query points spread over bounds of the curve grown by a margin.
+static std::vector<ImVec2> GetQueryPoints(const ImCubicBezierPoints& curve, int side)
+{
+    auto bounds = GetShapeBounds(curve);
+    bounds.Expand(ImMax(10.0f, 0.25f * ImMax(bounds.GetWidth(), bounds.GetHeight())));
+
+    std::vector<ImVec2> points;
+    for (int y = 0; y < side; ++y)
+        for (int x = 0; x < side; ++x)
+            points.push_back(ImLerp(bounds.Min, bounds.Max, ImVec2((x + 0.5f) / side, (y + 0.5f) / side)));
+    return points;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Benchmark harness
+//
+//------------------------------------------------------------------------------
+static int         g_Repeat = 5;
+static const char* g_Filter = nullptr;
+static volatile float g_Sink = 0.0f;
+
+// Returns best time of a single call in nanoseconds.
+template <typename F>
+static double Measure(int calls, F&& f)
+{
+    auto best = 1e300;
+    for (int round = 0; round < g_Repeat; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i)
+            f(i);
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / calls);
+    }
+    return best;
+}
+
+static bool IsSelected(const char* kernel)
+{
+    return !g_Filter || strstr(kernel, g_Filter) != nullptr;
+}
+
+static void PrintHeader()
+{
+    printf("%-32s %-9s %12s   %s\n", "kernel", "shape", "ns/call", "accuracy");
+}
+
+static void PrintRow(const char* kernel, const char* shape, double nanoseconds, const char* format, ...) IM_FMTARGS(4);
+
+static void PrintRow(const char* kernel, const char* shape, double nanoseconds, const char* format, ...)
+{
+    char accuracy[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(accuracy, sizeof(accuracy), format, args);
+    va_end(args);
+
+    printf("%-32s %-9s %12.1f   %s\n", kernel, shape, nanoseconds, accuracy);
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Bezier kernels
+//
+//------------------------------------------------------------------------------
+static void BenchmarkLength(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierLength"))
+        return;
+
+    const auto& curve = shape.Curve;
+    const auto time = Measure(20000, [&](int) { g_Sink = g_Sink + ImCubicBezierLength(curve); });
+
+    const auto reference = ReferenceLength(curve);
+    const auto length    = ImCubicBezierLength(curve);
+    const auto error     = std::fabs(length - reference);
+
+    PrintRow("ImCubicBezierLength", shape.Name, time, "abs error %.3g px, rel error %.3g", error, reference > 1e-3 ? error / reference : 0.0);
+}
+
+static void BenchmarkBoundingRect(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierBoundingRect"))
+        return;
+
+    const auto& curve = shape.Curve;
+    const auto time = Measure(20000, [&](int) { g_Sink = g_Sink + ImCubicBezierBoundingRect(curve).Min.x; });
+
+    DVec2 min, max;
+    ReferenceBounds(curve, min, max);
+    const auto rect  = ImCubicBezierBoundingRect(curve);
+    const auto error = std::max(std::max(std::fabs(rect.Min.x - min.x), std::fabs(rect.Min.y - min.y)), std::max(std::fabs(rect.Max.x - max.x), std::fabs(rect.Max.y - max.y)));
+
+    PrintRow("ImCubicBezierBoundingRect", shape.Name, time, "max edge error %.3g px", error);
+}
+
+static void BenchmarkProject(const Shape& shape)
+{
+    if (!IsSelected("ImProjectOnCubicBezier"))
+        return;
+
+    const auto& curve  = shape.Curve;
+    const auto  points = GetQueryPoints(curve, 8);
+    const auto  count  = static_cast<int>(points.size());
+
+    for (int subdivisions : { 50, 100 })
+    {
+        const auto time = Measure(2000, [&](int i) { g_Sink = g_Sink + ImProjectOnCubicBezier(points[i % count], curve, subdivisions).Distance; });
+
+        auto maxError = 0.0;
+        for (auto& point : points)
+        {
+            const auto result = ImProjectOnCubicBezier(point, curve, subdivisions);
+            maxError = std::max(maxError, std::fabs(result.Distance - ReferenceDistance(curve, point)));
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "ImProjectOnCubicBezier/%d", subdivisions);
+        PrintRow(name, shape.Name, time, "max distance error %.3g px", maxError);
+    }
+}
+
+static void BenchmarkLineIntersect(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierLineIntersect"))
+        return;
+
+    // Lines through center of the curve bounds at different angles.
+    const auto& curve  = shape.Curve;
+    const auto  bounds = GetShapeBounds(curve);
+    const auto  center = bounds.GetCenter();
+    const auto  radius = ImMax(10.0f, ImLength(bounds.GetSize()));
+
+    std::vector<ImLine> lines;
+    for (int i = 0; i < 16; ++i)
+    {
+        const auto angle     = IM_PI * (i + 0.37f) / 16;
+        const auto direction = ImVec2(cosf(angle), sinf(angle)) * radius;
+        lines.push_back(ImLine{ center - direction, center + direction });
+    }
+    const auto count = static_cast<int>(lines.size());
+
+    const auto time = Measure(5000, [&](int i) { g_Sink = g_Sink + static_cast<float>(ImCubicBezierLineIntersect(curve, lines[i % count]).Count); });
+
+    int    countMismatches = 0;
+    double maxResidual     = 0.0;
+    for (auto& line : lines)
+    {
+        const auto result = ImCubicBezierLineIntersect(curve, line);
+        if (result.Count != ReferenceLineCrossings(curve, line.A, line.B))
+            ++countMismatches;
+        for (int i = 0; i < result.Count; ++i)
+            maxResidual = std::max(maxResidual, ReferenceDistance(curve, result.Points[i]));
+    }
+
+    PrintRow("ImCubicBezierLineIntersect", shape.Name, time, "count mismatches %d/%d, max off-curve %.3g px", countMismatches, count, maxResidual);
+}
+
+static void BenchmarkSubdivide(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierSubdivide"))
+        return;
+
+    struct Polyline
+    {
+        std::vector<ImVec2> Points;
+    };
+
+    const auto& curve = shape.Curve;
+
+    Polyline polyline;
+    auto collect = [&polyline](const ImCubicBezierSubdivideSample& sample) { polyline.Points.push_back(sample.Point); };
+
+    const auto time = Measure(5000, [&](int) { polyline.Points.clear(); ImCubicBezierSubdivide(collect, curve); });
+
+    polyline.Points.clear();
+    ImCubicBezierSubdivide(collect, curve);
+
+    auto polylineLength = 0.0;
+    for (size_t i = 1; i < polyline.Points.size(); ++i)
+        polylineLength += Length(DVec2(polyline.Points[i]) - DVec2(polyline.Points[i - 1]));
+
+    const auto reference = ReferenceLength(curve);
+    PrintRow("ImCubicBezierSubdivide", shape.Name, time, "%d points, polyline length error %.3g px",
+        static_cast<int>(polyline.Points.size()), std::fabs(polylineLength - reference));
+}
+
+static void BenchmarkFixedStep(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierFixedStep"))
+        return;
+
+    const auto& curve = shape.Curve;
+    const auto  step  = 10.0f;
+
+    std::vector<ImVec2> samples;
+    auto collect = [&samples](ImCubicBezierFixedStepSample& sample) { samples.push_back(sample.Point); };
+
+    const auto time = Measure(500, [&](int) { samples.clear(); ImCubicBezierFixedStep(collect, curve, step); });
+
+    samples.clear();
+    ImCubicBezierFixedStep(collect, curve, step);
+
+    // Samples are expected to be spread by step measured along the curve.
+    auto maxError = 0.0;
+    for (size_t i = 1; i < samples.size(); ++i)
+    {
+        const auto expected = ReferencePointAtLength(curve, step * i);
+        maxError = std::max(maxError, Length(DVec2(samples[i]) - expected));
+    }
+
+    PrintRow("ImCubicBezierFixedStep", shape.Name, time, "%d samples, max position error %.3g px", static_cast<int>(samples.size()), maxError);
+}
+
+static void BenchmarkArcLengthTable(const Shape& shape)
+{
+    if (!IsSelected("ImCubicBezierArcLengthTable"))
+        return;
+
+    const auto& curve = shape.Curve;
+
+    ImCubicBezierArcLengthTable table;
+    const auto buildTime = Measure(5000, [&](int) { table.Build(curve); });
+    PrintRow("ImCubicBezierArcLengthTable", shape.Name, buildTime, "build, 32 segments");
+
+    const auto length = table.GetLength();
+    const auto sampleCount = 64;
+    const auto sampleTime = Measure(20000, [&](int i) { g_Sink = g_Sink + table.Sample(length * (i % sampleCount) / sampleCount).x; });
+
+    auto maxError = 0.0;
+    for (int i = 0; i <= sampleCount; ++i)
+    {
+        const auto distance = length * i / sampleCount;
+        maxError = std::max(maxError, Length(DVec2(table.Sample(distance)) - ReferencePointAtLength(curve, distance)));
+    }
+
+    PrintRow("ImCubicBezierArcLengthTable", shape.Name, sampleTime, "sample, max position error %.3g px", maxError);
+}
+
+// Batch kernels are timed per curve over many copies of the same shape.
+static void BenchmarkBatches(const Shape& shape)
+{
+    const int count = 1024;
+
+    std::vector<ImCubicBezierPoints> curves(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const auto offset = ImVec2(static_cast<float>(i % 32), static_cast<float>(i / 32)) * 3.0f;
+        const auto& curve = shape.Curve;
+        curves[i] = ImCubicBezierPoints{ curve.P0 + offset, curve.P1 + offset, curve.P2 + offset, curve.P3 + offset };
+    }
+
+    if (IsSelected("ImProjectOnCubicBezierBatch"))
+    {
+        const auto point = GetShapeBounds(shape.Curve).GetCenter() + ImVec2(7.0f, 5.0f);
+
+        std::vector<ImProjectResult> results(count);
+        const auto batchTime = Measure(5, [&](int) { ImProjectOnCubicBezierBatch(point, curves.data(), count, results.data(), 50); }) / count;
+        const auto singleTime = Measure(5, [&](int) { for (int i = 0; i < count; ++i) results[i] = ImProjectOnCubicBezier(point, curves[i], 50); }) / count;
+
+        ImProjectOnCubicBezierBatch(point, curves.data(), count, results.data(), 50);
+        int mismatches = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto expected = ImProjectOnCubicBezier(point, curves[i], 50);
+            if (memcmp(&expected, &results[i], sizeof(ImProjectResult)) != 0)
+                ++mismatches;
+        }
+
+        PrintRow("ImProjectOnCubicBezier/50", shape.Name, singleTime, "per curve, %d curves in loop", count);
+        PrintRow("ImProjectOnCubicBezierBatch/50", shape.Name, batchTime, "per curve, mismatches %d/%d", mismatches, count);
+    }
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Extra math and canvas kernels
+//
+//------------------------------------------------------------------------------
+static void BenchmarkClosestLine()
+{
+    if (!IsSelected("ImRect_ClosestLine"))
+        return;
+
+    // Pin rects around a node, as used when links are routed.
+    std::vector<ImRect> rects;
+    for (int i = 0; i < 64; ++i)
+    {
+        const auto position = ImVec2(static_cast<float>((i * 37) % 500), static_cast<float>((i * 91) % 300));
+        rects.push_back(ImRect(position, position + ImVec2(20.0f + i % 7, 12.0f + i % 5)));
+    }
+    const auto count = static_cast<int>(rects.size());
+
+    const auto time = Measure(20000, [&](int i) { g_Sink = g_Sink + ImRect_ClosestLine(rects[i % count], rects[(i * 7 + 3) % count]).A.x; });
+    const auto radiusTime = Measure(20000, [&](int i) { g_Sink = g_Sink + ImRect_ClosestLine(rects[i % count], rects[(i * 7 + 3) % count], 4.0f, 6.0f).A.x; });
+
+    PrintRow("ImRect_ClosestLine", "rects", time, "-");
+    PrintRow("ImRect_ClosestLine/radius", "rects", radiusTime, "-");
+}
+
+static void ScalarTransformVertices(ImDrawVert* vertices, int count, float scale, const ImVec2& offset)
+{
+    for (int i = 0; i < count; ++i)
+        vertices[i].pos = vertices[i].pos * scale + offset;
+}
+
+static void BenchmarkCanvasTransform()
+{
+    const int count = 65536;
+
+    std::vector<ImDrawVert> source(count);
+    for (int i = 0; i < count; ++i)
+    {
+        source[i].pos = ImVec2(static_cast<float>(i % 1000) * 1.37f - 300.0f, static_cast<float>(i / 1000) * 2.11f - 50.0f);
+        source[i].uv  = ImVec2(0.5f, 0.5f);
+        source[i].col = IM_COL32_WHITE;
+    }
+
+    const auto scale  = 0.731f;
+    const auto offset = ImVec2(123.25f, -45.5f);
+
+    if (IsSelected("TransformVertices"))
+    {
+        auto vertices = source;
+        const auto simdTime   = Measure(20, [&](int) { ImGuiEx::TransformVertices(vertices.data(), count, scale, offset); }) / count;
+        const auto scalarTime = Measure(20, [&](int) { ScalarTransformVertices(vertices.data(), count, scale, offset); }) / count;
+
+        auto expected = source;
+        vertices = source;
+        ScalarTransformVertices(expected.data(), count, scale, offset);
+        ImGuiEx::TransformVertices(vertices.data(), count, scale, offset);
+
+        int mismatches = 0;
+        for (int i = 0; i < count; ++i)
+            if (memcmp(&expected[i], &vertices[i], sizeof(ImDrawVert)) != 0)
+                ++mismatches;
+
+        PrintRow("TransformVertices/scalar", "vertices", scalarTime, "per vertex");
+        PrintRow("TransformVertices", "vertices", simdTime, "per vertex, mismatches %d/%d", mismatches, count);
+    }
+
+    if (IsSelected("TransformClipRects"))
+    {
+        const int commandCount = 4096;
+
+        std::vector<ImDrawCmd> commands(commandCount);
+        for (int i = 0; i < commandCount; ++i)
+            commands[i].ClipRect = ImVec4(i * 0.5f, i * 0.25f, i * 0.5f + 100.0f, i * 0.25f + 80.0f);
+
+        const auto time = Measure(200, [&](int) { ImGuiEx::TransformClipRects(commands.data(), commandCount, 1.0f, ImVec2(0.0f, 0.0f)); }) / commandCount;
+
+        PrintRow("TransformClipRects", "commands", time, "per command");
+    }
+}
+
+
+
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue)
+            g_Filter = argv[++i];
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue)
+            g_Repeat = ImMax(1, atoi(argv[++i]));
+        else
+        {
+            printf("Usage: math-benchmark [--filter text] [--repeat 5]\n");
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    PrintHeader();
+
+    for (auto& shape : c_Shapes)
+    {
+        BenchmarkLength(shape);
+        BenchmarkBoundingRect(shape);
+        BenchmarkProject(shape);
+        BenchmarkLineIntersect(shape);
+        BenchmarkSubdivide(shape);
+        BenchmarkFixedStep(shape);
+        BenchmarkArcLengthTable(shape);
+        BenchmarkBatches(shape);
+    }
+
+    BenchmarkClosestLine();
+    BenchmarkCanvasTransform();
+
+    return 0;
+}
@@ -80,6 +80,14 @@ inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImVec2& p0,
 inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImCubicBezierPoints& curve, const int subdivisions = 100);
 
 
+// Batch version of ImProjectOnCubicBezier().
+//
+// With SSE2 curves are processed in groups of four, transposed to one lane
+// per curve. Otherwise, or with IMGUI_BEZIER_MATH_DISABLE_SIMD defined, curves
+// are processed one by one. Results match ones of single curve function.
+inline void ImProjectOnCubicBezierBatch(const ImVec2& p, const ImCubicBezierPoints* curves, int count, ImProjectResult* results, const int subdivisions = 100);
+
+
 // Calculate intersection between line and a Cubic Bezier curve.
 struct ImCubicBezierIntersectResult
 {
@@ -134,6 +142,30 @@ template <typename F> inline void ImCubicBezierFixedStep(F& callback, const ImVe
 template <typename F> inline void ImCubicBezierFixedStep(F& callback, const ImCubicBezierPoints& curve, float step, bool overshoot = false, float max_value_error = 1e-3f, float max_t_error = 1e-5f);
 
 
+// Arc-length parameterization of Cubic Bezier curve.
+//
+// Curve is sampled at uniform steps of t, cumulative chord lengths are kept in
+// a table. Distance is mapped back to t by binary search. Variants taking
+// a cursor walk forward from the last found segment instead, which makes
+// sampling at increasing distances linear in the number of samples.
+struct ImCubicBezierArcLengthTable
+{
+    ImCubicBezierPoints Curve;
+    ImVector<float>     Lengths; // Length of curve at t = i / (Lengths.Size - 1)
+
+    inline void   Build(const ImCubicBezierPoints& curve, int segments = 32);
+    inline void   Clear();
+
+    bool          IsEmpty() const   { return Lengths.Size < 2; }
+    float         GetLength() const { return Lengths.Size > 0 ? Lengths.back() : 0.0f; }
+
+    inline float  GetTime(float distance) const;
+    inline float  GetTime(float distance, int& cursor) const;
+    inline ImVec2 Sample(float distance) const;
+    inline ImVec2 Sample(float distance, int& cursor) const;
+};
+
+
 //------------------------------------------------------------------------------
 # include "imgui_bezier_math.inl"
 
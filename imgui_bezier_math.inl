@@ -16,6 +16,13 @@
 # include "imgui_bezier_math.h"
 # include <map> // used in ImCubicBezierFixedStep
 
+# if !defined(IMGUI_BEZIER_MATH_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#     define IMGUI_BEZIER_MATH_SSE2() 1
+#     include <emmintrin.h>
+# else
+#     define IMGUI_BEZIER_MATH_SSE2() 0
+# endif
+
 
 //------------------------------------------------------------------------------
 template <typename T>
@@ -344,6 +351,168 @@ inline ImProjectResult ImProjectOnCubicBezier(const ImVec2& p, const ImCubicBezi
     return ImProjectOnCubicBezier(p, curve.P0, curve.P1, curve.P2, curve.P3, subdivisions);
 }
 
+//------------------------------------------------------------------------------
+# if IMGUI_BEZIER_MATH_SSE2()
+// Four float lanes used by batch functions. Operations mirror scalar ones
+// exactly, ImMin/ImMax keep ImGui semantic for equal values.
+namespace ImBezierBatchDetail {
+
+struct Lanes
+{
+    __m128 v;
+
+    Lanes() = default;
+    Lanes(__m128 value): v(value) {}
+    Lanes(float value): v(_mm_set1_ps(value)) {}
+
+    static Lanes Load(const float* p) { return _mm_loadu_ps(p); }
+    void Store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+using Mask = Lanes;
+
+inline Lanes operator+(Lanes lhs, Lanes rhs)  { return _mm_add_ps(lhs.v, rhs.v); }
+inline Lanes operator-(Lanes lhs, Lanes rhs)  { return _mm_sub_ps(lhs.v, rhs.v); }
+inline Lanes operator*(Lanes lhs, Lanes rhs)  { return _mm_mul_ps(lhs.v, rhs.v); }
+inline Lanes operator/(Lanes lhs, Lanes rhs)  { return _mm_div_ps(lhs.v, rhs.v); }
+inline Lanes operator-(Lanes value)           { return _mm_xor_ps(value.v, _mm_set1_ps(-0.0f)); }
+inline Lanes Abs(Lanes value)                 { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value.v); }
+inline Lanes Sqrt(Lanes value)                { return _mm_sqrt_ps(value.v); }
+inline Mask  Less(Lanes lhs, Lanes rhs)       { return _mm_cmplt_ps(lhs.v, rhs.v); }
+inline Mask  LessEqual(Lanes lhs, Lanes rhs)  { return _mm_cmple_ps(lhs.v, rhs.v); }
+inline Mask  Equal(Lanes lhs, Lanes rhs)      { return _mm_cmpeq_ps(lhs.v, rhs.v); }
+inline Mask  And(Mask lhs, Mask rhs)          { return _mm_and_ps(lhs.v, rhs.v); }
+inline Mask  Or(Mask lhs, Mask rhs)           { return _mm_or_ps(lhs.v, rhs.v); }
+inline Mask  AndNot(Mask lhs, Mask rhs)       { return _mm_andnot_ps(rhs.v, lhs.v); } // lhs & ~rhs
+inline bool  Any(Mask mask)                   { return _mm_movemask_ps(mask.v) != 0; }
+inline Lanes Select(Mask mask, Lanes lhs, Lanes rhs) { return _mm_or_ps(_mm_and_ps(mask.v, lhs.v), _mm_andnot_ps(mask.v, rhs.v)); }
+
+inline Lanes Min(Lanes lhs, Lanes rhs) { return Select(Less(lhs, rhs), lhs, rhs); }
+inline Lanes Max(Lanes lhs, Lanes rhs) { return Select(Less(lhs, rhs), rhs, lhs); }
+
+// Same operation order as ImCubicBezier().
+inline Lanes CubicBezier(Lanes p0, Lanes p1, Lanes p2, Lanes p3, Lanes t)
+{
+    const auto a = Lanes(1.0f) - t;
+    const auto b = a * a * a;
+    const auto c = t * t * t;
+    const auto three = Lanes(3.0f);
+
+    return b * p0 + three * t * a * a * p1 + three * t * t * a * p2 + c * p3;
+}
+
+// Control points of up to four curves, one lane per curve. Missing curves
+// are filled with copies of the last one.
+struct CurveLanes
+{
+    Lanes X[4];
+    Lanes Y[4];
+
+    CurveLanes(const ImCubicBezierPoints* curves, int count)
+    {
+        float x[4][4], y[4][4];
+        for (int i = 0; i < 4; ++i)
+        {
+            const auto& curve = curves[i < count ? i : count - 1];
+            x[0][i] = curve.P0.x; y[0][i] = curve.P0.y;
+            x[1][i] = curve.P1.x; y[1][i] = curve.P1.y;
+            x[2][i] = curve.P2.x; y[2][i] = curve.P2.y;
+            x[3][i] = curve.P3.x; y[3][i] = curve.P3.y;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            X[i] = Lanes::Load(x[i]);
+            Y[i] = Lanes::Load(y[i]);
+        }
+    }
+
+    Lanes SampleX(Lanes t) const { return CubicBezier(X[0], X[1], X[2], X[3], t); }
+    Lanes SampleY(Lanes t) const { return CubicBezier(Y[0], Y[1], Y[2], Y[3], t); }
+};
+
+} // namespace ImBezierBatchDetail
+
+inline void ImProjectOnCubicBezierBatch(const ImVec2& point, const ImCubicBezierPoints* curves, int count, ImProjectResult* results, const int subdivisions)
+{
+    using namespace ImBezierBatchDetail;
+
+    // Same steps as ImProjectOnCubicBezier(), lanes which finish early are masked.
+    const float epsilon    = 1e-5f;
+    const float fixed_step = 1.0f / static_cast<float>(subdivisions - 1);
+
+    const auto point_x = Lanes(point.x);
+    const auto point_y = Lanes(point.y);
+
+    for (int first = 0; first < count; first += 4)
+    {
+        const auto lanes = ImMin(count - first, 4);
+        const auto curve = CurveLanes(curves + first, lanes);
+
+        auto result_x = point_x;
+        auto result_y = point_y;
+        auto result_t = Lanes(0.0f);
+        auto result_d = Lanes(FLT_MAX);
+
+        auto test = [&](Lanes t, Mask active)
+        {
+            const auto p_x = curve.SampleX(t);
+            const auto p_y = curve.SampleY(t);
+            const auto s_x = point_x - p_x;
+            const auto s_y = point_y - p_y;
+            const auto d   = s_x * s_x + s_y * s_y;
+
+            const auto closer = And(active, Less(d, result_d));
+            result_x = Select(closer, p_x, result_x);
+            result_y = Select(closer, p_y, result_y);
+            result_t = Select(closer, t,   result_t);
+            result_d = Select(closer, d,   result_d);
+        };
+
+        // Step 1: Coarse check
+        const auto all = Equal(Lanes(0.0f), Lanes(0.0f));
+        for (int i = 0; i < subdivisions; ++i)
+            test(Lanes(i * fixed_step), all);
+
+        // Step 2: Fine check
+        const auto done  = Or(Equal(result_t, Lanes(0.0f)), LessEqual(Abs(result_t - Lanes(1.0f)), Lanes(epsilon)));
+        const auto step  = Lanes(fixed_step * 0.1f);
+        const auto limit = (result_t + Lanes(fixed_step)) + step;
+
+        auto t      = result_t - Lanes(fixed_step);
+        auto active = AndNot(Less(t, limit), done);
+        while (Any(active))
+        {
+            test(t, active);
+            t      = t + step;
+            active = And(active, Less(t, limit));
+        }
+
+        result_d = Sqrt(result_d);
+
+        float values[4][4];
+        result_x.Store(values[0]);
+        result_y.Store(values[1]);
+        result_t.Store(values[2]);
+        result_d.Store(values[3]);
+
+        for (int i = 0; i < lanes; ++i)
+        {
+            auto& result = results[first + i];
+            result.Point    = ImVec2(values[0][i], values[1][i]);
+            result.Time     = values[2][i];
+            result.Distance = values[3][i];
+        }
+    }
+}
+# else
+inline void ImProjectOnCubicBezierBatch(const ImVec2& point, const ImCubicBezierPoints* curves, int count, ImProjectResult* results, const int subdivisions)
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = ImProjectOnCubicBezier(point, curves[i], subdivisions);
+}
+# endif
+
 inline ImCubicBezierIntersectResult ImCubicBezierLineIntersect(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& a0, const ImVec2& a1)
 {
     auto cubic_roots = [](float a, float b, float c, float d, float* roots) -> int
@@ -665,6 +834,88 @@ inline void ImCubicBezierFixedStep(F& callback, const ImCubicBezierPoints& curve
     ImCubicBezierFixedStep(handler, &callback, curve.P0, curve.P1, curve.P2, curve.P3, step, overshoot, max_value_error, max_t_error);
 }
 
+inline void ImCubicBezierArcLengthTable::Build(const ImCubicBezierPoints& curve, int segments)
+{
+    if (segments < 1)
+        segments = 1;
+
+    Curve = curve;
+    Lengths.resize(segments + 1);
+
+    auto length   = 0.0f;
+    auto previous = curve.P0;
+    Lengths[0] = 0.0f;
+    for (int i = 1; i <= segments; ++i)
+    {
+        const auto point = ImCubicBezier(curve.P0, curve.P1, curve.P2, curve.P3, static_cast<float>(i) / segments);
+        length  += ImLength(point - previous);
+        previous = point;
+        Lengths[i] = length;
+    }
+}
+
+inline void ImCubicBezierArcLengthTable::Clear()
+{
+    Lengths.clear();
+}
+
+inline float ImCubicBezierArcLengthTable::GetTime(float distance) const
+{
+    int cursor = -1;
+    return GetTime(distance, cursor);
+}
+
+inline float ImCubicBezierArcLengthTable::GetTime(float distance, int& cursor) const
+{
+    const int last = Lengths.Size - 1;
+    if (last < 1 || distance <= 0.0f)
+    {
+        cursor = 0;
+        return 0.0f;
+    }
+
+    if (distance >= Lengths[last])
+    {
+        cursor = last - 1;
+        return 1.0f;
+    }
+
+    if (cursor < 0 || cursor >= last || Lengths[cursor] > distance)
+    {
+        // Find segment with Lengths[lo] <= distance < Lengths[lo + 1].
+        int lo = 0, hi = last;
+        while (hi - lo > 1)
+        {
+            const int mid = (lo + hi) / 2;
+            if (Lengths[mid] <= distance)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        cursor = lo;
+    }
+    else
+    {
+        // Stops before last segment ends, distance is less than total length.
+        while (Lengths[cursor + 1] <= distance)
+            ++cursor;
+    }
+
+    const auto u = (distance - Lengths[cursor]) / (Lengths[cursor + 1] - Lengths[cursor]);
+
+    return (cursor + u) / last;
+}
+
+inline ImVec2 ImCubicBezierArcLengthTable::Sample(float distance) const
+{
+    return ImCubicBezier(Curve.P0, Curve.P1, Curve.P2, Curve.P3, GetTime(distance));
+}
+
+inline ImVec2 ImCubicBezierArcLengthTable::Sample(float distance, int& cursor) const
+{
+    return ImCubicBezier(Curve.P0, Curve.P1, Curve.P2, Curve.P3, GetTime(distance, cursor));
+}
+
 
 //------------------------------------------------------------------------------
 # endif // __IMGUI_BEZIER_MATH_INL__
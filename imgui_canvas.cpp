@@ -2,6 +2,20 @@
 # include "imgui_canvas.h"
 # include <type_traits>
 
+# if !defined(IMGUI_EX_CANVAS_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#     define IMGUI_EX_CANVAS_SSE2() 1
+#     include <emmintrin.h>
+# else
+#     define IMGUI_EX_CANVAS_SSE2() 0
+# endif
+
+# if !defined(IMGUI_EX_CANVAS_DISABLE_SIMD) && !IMGUI_EX_CANVAS_SSE2() && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#     define IMGUI_EX_CANVAS_NEON() 1
+#     include <arm_neon.h>
+# else
+#     define IMGUI_EX_CANVAS_NEON() 0
+# endif
+
 // https://stackoverflow.com/a/36079786
 # define DECLARE_HAS_MEMBER(__trait_name__, __member_name__)                         \
                                                                                      \
@@ -85,6 +99,103 @@ static inline unsigned int& ImVtxOffsetRef(ImDrawList* drawList)
 
 static inline ImVec2 ImSelectPositive(const ImVec2& lhs, const ImVec2& rhs) { return ImVec2(lhs.x > 0.0f ? lhs.x : rhs.x, lhs.y > 0.0f ? lhs.y : rhs.y); }
 
+void ImGuiEx::TransformVertices(ImDrawVert* vertices, int count, float scale, const ImVec2& offset)
+{
+    auto vertex    = vertices;
+    auto vertexEnd = vertices + count;
+
+    // Positions are interleaved with other attributes, pairs of them
+    // are gathered into single register.
+# if IMGUI_EX_CANVAS_SSE2()
+    const auto offset4 = _mm_setr_ps(offset.x, offset.y, offset.x, offset.y);
+    const auto scale4  = _mm_set1_ps(scale);
+
+    if (scale != 1.0f)
+    {
+        for (; vertex + 2 <= vertexEnd; vertex += 2)
+        {
+            auto p = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&vertex[0].pos));
+            p = _mm_loadh_pi(p, reinterpret_cast<const __m64*>(&vertex[1].pos));
+            p = _mm_add_ps(_mm_mul_ps(p, scale4), offset4);
+            _mm_storel_pi(reinterpret_cast<__m64*>(&vertex[0].pos), p);
+            _mm_storeh_pi(reinterpret_cast<__m64*>(&vertex[1].pos), p);
+        }
+    }
+    else
+    {
+        for (; vertex + 2 <= vertexEnd; vertex += 2)
+        {
+            auto p = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&vertex[0].pos));
+            p = _mm_loadh_pi(p, reinterpret_cast<const __m64*>(&vertex[1].pos));
+            p = _mm_add_ps(p, offset4);
+            _mm_storel_pi(reinterpret_cast<__m64*>(&vertex[0].pos), p);
+            _mm_storeh_pi(reinterpret_cast<__m64*>(&vertex[1].pos), p);
+        }
+    }
+# elif IMGUI_EX_CANVAS_NEON()
+    const auto offset4 = vcombine_f32(vld1_f32(&offset.x), vld1_f32(&offset.x));
+
+    if (scale != 1.0f)
+    {
+        for (; vertex + 2 <= vertexEnd; vertex += 2)
+        {
+            auto p = vcombine_f32(vld1_f32(&vertex[0].pos.x), vld1_f32(&vertex[1].pos.x));
+            p = vmlaq_n_f32(offset4, p, scale);
+            vst1_f32(&vertex[0].pos.x, vget_low_f32(p));
+            vst1_f32(&vertex[1].pos.x, vget_high_f32(p));
+        }
+    }
+    else
+    {
+        for (; vertex + 2 <= vertexEnd; vertex += 2)
+        {
+            auto p = vcombine_f32(vld1_f32(&vertex[0].pos.x), vld1_f32(&vertex[1].pos.x));
+            p = vaddq_f32(p, offset4);
+            vst1_f32(&vertex[0].pos.x, vget_low_f32(p));
+            vst1_f32(&vertex[1].pos.x, vget_high_f32(p));
+        }
+    }
+# endif
+
+    // If canvas view is not scaled take a faster path.
+    if (scale != 1.0f)
+    {
+        for (; vertex < vertexEnd; ++vertex)
+        {
+            vertex->pos.x = vertex->pos.x * scale + offset.x;
+            vertex->pos.y = vertex->pos.y * scale + offset.y;
+        }
+    }
+    else
+    {
+        for (; vertex < vertexEnd; ++vertex)
+        {
+            vertex->pos.x = vertex->pos.x + offset.x;
+            vertex->pos.y = vertex->pos.y + offset.y;
+        }
+    }
+}
+
+void ImGuiEx::TransformClipRects(ImDrawCmd* commands, int count, float scale, const ImVec2& offset)
+{
+    for (auto command = commands, commandEnd = commands + count; command < commandEnd; ++command)
+    {
+        auto& clipRect = command->ClipRect;
+# if IMGUI_EX_CANVAS_SSE2()
+        const auto offset4 = _mm_setr_ps(offset.x, offset.y, offset.x, offset.y);
+        _mm_storeu_ps(&clipRect.x, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&clipRect.x), _mm_set1_ps(scale)), offset4));
+# elif IMGUI_EX_CANVAS_NEON()
+        const auto offset4 = vcombine_f32(vld1_f32(&offset.x), vld1_f32(&offset.x));
+        vst1q_f32(&clipRect.x, vmlaq_n_f32(offset4, vld1q_f32(&clipRect.x), scale));
+# else
+        clipRect.x = clipRect.x * scale + offset.x;
+        clipRect.y = clipRect.y * scale + offset.y;
+        clipRect.z = clipRect.z * scale + offset.x;
+        clipRect.w = clipRect.w * scale + offset.y;
+# endif
+    }
+}
+
 bool ImGuiEx::Canvas::Begin(const char* id, const ImVec2& size)
 {
     return Begin(ImGui::GetID(id), size);
@@ -157,6 +268,10 @@ void ImGuiEx::Canvas::End()
 
     LeaveLocalSpace();
 
+# if IMGUI_EX_CANVAS_DEFERED()
+    TransformRanges();
+# endif
+
     // Emit dummy widget matching bounds of the canvas.
     ImGui::SetCursorScreenPos(m_WidgetPosition);
     ImGui::Dummy(m_WidgetSize);
@@ -167,6 +282,15 @@ void ImGuiEx::Canvas::End()
     m_InBeginEnd = false;
 }
 
+void ImGuiEx::Canvas::ClearFreeMemory()
+{
+    IM_ASSERT(m_InBeginEnd == false);
+
+# if IMGUI_EX_CANVAS_DEFERED()
+    m_Ranges.clear();
+# endif
+}
+
 void ImGuiEx::Canvas::SetView(const ImVec2& origin, float scale)
 {
     SetView(CanvasView(origin, scale));
@@ -405,8 +529,9 @@ void ImGuiEx::Canvas::EnterLocalSpace()
 # if IMGUI_EX_CANVAS_DEFERED()
     m_Ranges.resize(m_Ranges.Size + 1);
     m_CurrentRange = &m_Ranges.back();
-    m_CurrentRange->BeginComandIndex = ImMax(m_DrawList->CmdBuffer.Size - 1, 0);
     m_CurrentRange->BeginVertexIndex = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+    m_CurrentRange->Scale            = m_View.Scale;
+    m_CurrentRange->Offset           = m_ViewTransformPosition;
 # endif
     m_DrawListCommadBufferSize       = ImMax(m_DrawList->CmdBuffer.Size - 1, 0);
     m_DrawListStartVertexIndex       = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
@@ -453,59 +578,36 @@ void ImGuiEx::Canvas::LeaveLocalSpace()
 # if IMGUI_EX_CANVAS_DEFERED()
     IM_ASSERT(m_CurrentRange != nullptr);
 
-    m_CurrentRange->EndVertexIndex  = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
-    m_CurrentRange->EndCommandIndex = m_DrawList->CmdBuffer.size();
+    m_CurrentRange->EndVertexIndex = m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
+
+    auto previousRange = m_Ranges.Size > 1 ? m_CurrentRange - 1 : nullptr;
     if (m_CurrentRange->BeginVertexIndex == m_CurrentRange->EndVertexIndex)
     {
         // Drop empty range
         m_Ranges.resize(m_Ranges.Size - 1);
     }
+    else if (previousRange && previousRange->EndVertexIndex == m_CurrentRange->BeginVertexIndex &&
+        previousRange->Scale    == m_CurrentRange->Scale &&
+        previousRange->Offset.x == m_CurrentRange->Offset.x &&
+        previousRange->Offset.y == m_CurrentRange->Offset.y)
+    {
+        // Nothing was drawn while canvas was left, extend previous range
+        previousRange->EndVertexIndex = m_CurrentRange->EndVertexIndex;
+        m_Ranges.resize(m_Ranges.Size - 1);
+    }
     m_CurrentRange = nullptr;
-# endif
-
+# else
     // Move vertices to screen space.
     auto vertex    = m_DrawList->VtxBuffer.Data + m_DrawListStartVertexIndex;
     auto vertexEnd = m_DrawList->VtxBuffer.Data + m_DrawList->_VtxCurrentIdx + ImVtxOffsetRef(m_DrawList);
 
-    // If canvas view is not scaled take a faster path.
-    if (m_View.Scale != 1.0f)
-    {
-        while (vertex < vertexEnd)
-        {
-            vertex->pos.x = vertex->pos.x * m_View.Scale + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y * m_View.Scale + m_ViewTransformPosition.y;
-            ++vertex;
-        }
-
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListCommadBufferSize; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y * m_View.Scale + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z * m_View.Scale + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w * m_View.Scale + m_ViewTransformPosition.y;
-        }
-    }
-    else
-    {
-        while (vertex < vertexEnd)
-        {
-            vertex->pos.x = vertex->pos.x + m_ViewTransformPosition.x;
-            vertex->pos.y = vertex->pos.y + m_ViewTransformPosition.y;
-            ++vertex;
-        }
+    TransformVertices(vertex, static_cast<int>(vertexEnd - vertex), m_View.Scale, m_ViewTransformPosition);
+# endif
 
-        // Move clip rectangles to screen space.
-        for (int i = m_DrawListCommadBufferSize; i < m_DrawList->CmdBuffer.size(); ++i)
-        {
-            auto& command = m_DrawList->CmdBuffer[i];
-            command.ClipRect.x = command.ClipRect.x + m_ViewTransformPosition.x;
-            command.ClipRect.y = command.ClipRect.y + m_ViewTransformPosition.y;
-            command.ClipRect.z = command.ClipRect.z + m_ViewTransformPosition.x;
-            command.ClipRect.w = command.ClipRect.w + m_ViewTransformPosition.y;
-        }
-    }
+    // Move clip rectangles to screen space. This is done right away, since
+    // ImDrawList compares clip rect of last command with new ones.
+    // Commands are few compared to vertices.
+    TransformClipRects(m_DrawList->CmdBuffer.Data + m_DrawListCommadBufferSize, m_DrawList->CmdBuffer.size() - m_DrawListCommadBufferSize, m_View.Scale, m_ViewTransformPosition);
 
     auto& fringeScale = ImFringeScaleRef(m_DrawList);
     fringeScale = m_LastFringeScale;
@@ -516,3 +618,13 @@ void ImGuiEx::Canvas::LeaveLocalSpace()
     RestoreInputState();
     RestoreViewportState();
 }
+
+# if IMGUI_EX_CANVAS_DEFERED()
+void ImGuiEx::Canvas::TransformRanges()
+{
+    for (auto& range : m_Ranges)
+        TransformVertices(m_DrawList->VtxBuffer.Data + range.BeginVertexIndex, range.EndVertexIndex - range.BeginVertexIndex, range.Scale, range.Offset);
+
+    m_Ranges.resize(0);
+}
+# endif
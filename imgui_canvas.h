@@ -49,6 +49,15 @@
 # include <imgui.h>
 # include <imgui_internal.h> // ImRect, ImFloor
 
+// When enabled vertices drawn on canvas are moved to screen space once in
+// End(), instead of every time canvas is left. Suspend()/Resume() become cheap
+// then, but vertex positions are in canvas space until End() is called.
+//
+// Enable with '#define IMGUI_EX_CANVAS_DEFERED() 1' in imconfig.h.
+# ifndef IMGUI_EX_CANVAS_DEFERED
+#     define IMGUI_EX_CANVAS_DEFERED() 0
+# endif
+
 namespace ImGuiEx {
 
 struct CanvasView
@@ -163,6 +172,11 @@ struct Canvas
     ImVec2 ToLocalV(const ImVec2& vector) const;
     ImVec2 ToLocalV(const ImVec2& vector, const CanvasView& view) const;
 
+    // Releases memory used to track draw list ranges.
+    //
+    // Must not be called between Begin() and End().
+    void ClearFreeMemory();
+
     // Returns widget bounds.
     //
     // Note:
@@ -193,16 +207,17 @@ struct Canvas
     bool IsSuspended() const { return m_SuspendCounter > 0; }
 
 private:
-# define IMGUI_EX_CANVAS_DEFERED() 0
-
 # if IMGUI_EX_CANVAS_DEFERED()
+    // Vertices drawn in local space with single view transform.
     struct Range
     {
-        int BeginVertexIndex = 0;
-        int EndVertexIndex   = 0;
-        int BeginComandIndex = 0;
-        int EndCommandIndex  = 0;
+        int    BeginVertexIndex = 0;
+        int    EndVertexIndex   = 0;
+        float  Scale            = 1.0f;
+        ImVec2 Offset;
     };
+
+    void TransformRanges();
 # endif
 
     void UpdateViewTransformPosition();
@@ -253,6 +268,13 @@ private:
 # endif
 };
 
+// Transforms vertex positions and clip rectangles in place: p * scale + offset.
+//
+// This is how canvas moves its content to screen space. Uses SSE2 or NEON
+// when available, define IMGUI_EX_CANVAS_DISABLE_SIMD to use scalar code.
+void TransformVertices(ImDrawVert* vertices, int count, float scale, const ImVec2& offset);
+void TransformClipRects(ImDrawCmd* commands, int count, float scale, const ImVec2& offset);
+
 } // namespace ImGuiEx
 
 # endif // __IMGUI_EX_CANVAS_H__
\ No newline at end of file
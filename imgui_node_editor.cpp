@@ -13,10 +13,15 @@
 # include <fstream>
 # include <bitset>
 # include <climits>
+# include <limits>
 # include <algorithm>
 # include <sstream>
 # include <streambuf>
 # include <type_traits>
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <atomic>
 
 // https://stackoverflow.com/a/8597498
 # define DECLARE_HAS_NESTED(Name, Member)                                          \
@@ -111,7 +116,17 @@ static const float c_LinkSelectThickness        = 5.0f;  // canvas pixels
 static const float c_NavigationZoomMargin       = 0.1f;  // percentage of visible bounds
 static const float c_MouseZoomDuration          = 0.15f; // seconds
 static const float c_SelectionFadeOutDuration   = 0.15f; // seconds
+static const float c_SettingsWritePollInterval  = 0.1f;  // seconds, result of background settings write is checked by End()
 static const auto  c_ScrollButtonIndex          = 1;
+static const int   c_ReducedLinkSegments        = 8;     // link tessellation at LevelOfDetail::Reduced
+
+// Most geometry single link can emit. Curve is subdivided at most 10 times
+// (PathBezierToCasteljau), thick anti-aliased polyline emits 4 vertices and
+// 18 indices per point and each arrow is anti-aliased triangle.
+static const int   c_MaxLinkPathPoints          = (1 << 10) + 1;
+static const int   c_MaxLinkVertices            = c_MaxLinkPathPoints * 4 + 2 * 6;
+static const int   c_MaxLinkIndices             = c_MaxLinkPathPoints * 18 + 2 * 21;
+static const float c_MinVisibleRounding         = 2.0f;  // screen pixels
 
 
 //------------------------------------------------------------------------------
@@ -199,31 +214,107 @@ static void ImDrawList_ChannelsGrow(ImDrawList* draw_list, int channels_count)
 	ImDrawListSplitter_Grow(draw_list, &draw_list->_Splitter, channels_count);
 }
 
-static void ImDrawListSplitter_SwapChannels(ImDrawListSplitter* splitter, int left, int right)
-{
-	IM_ASSERT(left < splitter->_Count && right < splitter->_Count);
-	if (left == right)
-		return;
-
-	auto currentChannel = splitter->_Current;
+// Makes sure current draw command use current vertex offset.
+//
+// With 16-bit indices ImDrawList::PrimReserve() starts new vertex offset each
+// time 64k vertices are used up. Only current channel gets new command, ones
+// left in other channels still refer to old offset. Drawing into them after
+// switching would produce indices relative to wrong base. Command opened here
+// stays open over clip rect and texture changes only because ImDrawList
+// compares VtxOffset before merging it with previous one (see --check in
+// editor-benchmark).
+static void ImDrawList_SyncVtxOffset(ImDrawList* drawList)
+{
+    if (sizeof(ImDrawIdx) != 2 || drawList->CmdBuffer.Size == 0)
+        return;
 
-	auto* leftCmdBuffer  = &splitter->_Channels[left]._CmdBuffer;
-	auto* leftIdxBuffer  = &splitter->_Channels[left]._IdxBuffer;
-	auto* rightCmdBuffer = &splitter->_Channels[right]._CmdBuffer;
-	auto* rightIdxBuffer = &splitter->_Channels[right]._IdxBuffer;
+    auto& cmd = drawList->CmdBuffer.back();
+    if (cmd.VtxOffset == drawList->_VtxCurrentOffset)
+        return;
 
-	leftCmdBuffer->swap(*rightCmdBuffer);
-	leftIdxBuffer->swap(*rightIdxBuffer);
+    if (cmd.ElemCount == 0 && !cmd.UserCallback)
+        cmd.VtxOffset = drawList->_VtxCurrentOffset;
+    else
+        drawList->AddDrawCmd();
+}
 
-	if (currentChannel == left)
-		splitter->_Current = right;
-	else if (currentChannel == right)
-		splitter->_Current = left;
+// Like ImDrawList::ChannelsSetCurrent() but safe for graphs that does not fit
+// in 16-bit indices.
+static void ImDrawList_ChannelsSetCurrent(ImDrawList* drawList, int channel)
+{
+    drawList->ChannelsSetCurrent(channel);
+    ImDrawList_SyncVtxOffset(drawList);
 }
 
-static void ImDrawList_SwapChannels(ImDrawList* drawList, int left, int right)
+// Merges channels into channel 0 in specified order, like ImDrawListSplitter::Merge()
+// does for natural order. Channels not listed are discarded, empty are skipped.
+static void ImDrawList_ChannelsMerge(ImDrawList* drawList, const std::vector<int>& order)
 {
-	ImDrawListSplitter_SwapChannels(&drawList->_Splitter, left, right);
+    auto& splitter = drawList->_Splitter;
+    if (splitter._Count <= 1)
+        return;
+
+    auto canMerge = [](const ImDrawCmd* a, const ImDrawCmd* b)
+    {
+        return memcmp(&a->ClipRect, &b->ClipRect, sizeof(a->ClipRect)) == 0 && a->TextureId == b->TextureId && a->VtxOffset == b->VtxOffset && !a->UserCallback && !b->UserCallback;
+    };
+
+    splitter.SetCurrentChannel(drawList, 0);
+    if (drawList->CmdBuffer.Size != 0 && drawList->CmdBuffer.back().ElemCount == 0)
+        drawList->CmdBuffer.pop_back();
+
+    int newCmdBufferCount = 0;
+    int newIdxBufferCount = 0;
+    ImDrawCmd* lastCmd = drawList->CmdBuffer.Size > 0 ? &drawList->CmdBuffer.back() : nullptr;
+    unsigned int idxOffset = lastCmd ? lastCmd->IdxOffset + lastCmd->ElemCount : 0;
+    for (auto index : order)
+    {
+        IM_ASSERT(index > 0 && index < splitter._Count);
+
+        ImDrawChannel& channel = splitter._Channels[index];
+        if (channel._CmdBuffer.Size > 0 && channel._CmdBuffer.back().ElemCount == 0)
+            channel._CmdBuffer.pop_back();
+        if (channel._CmdBuffer.Size == 0)
+            continue;
+
+        if (lastCmd && canMerge(lastCmd, &channel._CmdBuffer[0]))
+        {
+            lastCmd->ElemCount += channel._CmdBuffer[0].ElemCount;
+            idxOffset += channel._CmdBuffer[0].ElemCount;
+            channel._CmdBuffer.erase(channel._CmdBuffer.Data);
+        }
+        if (channel._CmdBuffer.Size > 0)
+            lastCmd = &channel._CmdBuffer.back();
+        newCmdBufferCount += channel._CmdBuffer.Size;
+        newIdxBufferCount += channel._IdxBuffer.Size;
+        for (auto& cmd : channel._CmdBuffer)
+        {
+            cmd.IdxOffset = idxOffset;
+            idxOffset += cmd.ElemCount;
+        }
+    }
+
+    drawList->CmdBuffer.resize(drawList->CmdBuffer.Size + newCmdBufferCount);
+    drawList->IdxBuffer.resize(drawList->IdxBuffer.Size + newIdxBufferCount);
+
+    ImDrawCmd* cmdWrite = drawList->CmdBuffer.Data + drawList->CmdBuffer.Size - newCmdBufferCount;
+    ImDrawIdx* idxWrite = drawList->IdxBuffer.Data + drawList->IdxBuffer.Size - newIdxBufferCount;
+    for (auto index : order)
+    {
+        ImDrawChannel& channel = splitter._Channels[index];
+        if (int size = channel._CmdBuffer.Size) { memcpy(cmdWrite, channel._CmdBuffer.Data, size * sizeof(ImDrawCmd)); cmdWrite += size; }
+        if (int size = channel._IdxBuffer.Size) { memcpy(idxWrite, channel._IdxBuffer.Data, size * sizeof(ImDrawIdx)); idxWrite += size; }
+
+        // Channel may be listed only once.
+        channel._CmdBuffer.resize(0);
+        channel._IdxBuffer.resize(0);
+    }
+
+    drawList->_IdxWritePtr = idxWrite;
+    drawList->UpdateClipRect();
+    drawList->UpdateTextureID();
+    ImDrawList_SyncVtxOffset(drawList);
+    splitter._Count = 1;
 }
 
 static void ImDrawList_SwapSplitter(ImDrawList* drawList, ImDrawListSplitter& splitter)
@@ -235,6 +326,26 @@ static void ImDrawList_SwapSplitter(ImDrawList* drawList, ImDrawListSplitter& sp
     currentSplitter._Channels.swap(splitter._Channels);
 }
 
+// Heap memory held by channels, including ones not used this frame.
+static size_t ImDrawListSplitter_GetMemoryUsage(const ImDrawListSplitter& splitter)
+{
+    size_t size = ed::HeapSize(splitter._Channels);
+    for (auto& channel : splitter._Channels)
+        size += ed::HeapSize(channel._CmdBuffer) + ed::HeapSize(channel._IdxBuffer);
+    return size;
+}
+
+static size_t ImDrawList_GetMemoryUsage(const ImDrawList& drawList)
+{
+    return ed::HeapSize(drawList.CmdBuffer)
+        + ed::HeapSize(drawList.IdxBuffer)
+        + ed::HeapSize(drawList.VtxBuffer)
+        + ed::HeapSize(drawList._ClipRectStack)
+        + ed::HeapSize(drawList._TextureIdStack)
+        + ed::HeapSize(drawList._Path)
+        + ImDrawListSplitter_GetMemoryUsage(drawList._Splitter);
+}
+
 //static void ImDrawList_TransformChannel_Inner(ImVector<ImDrawVert>& vtxBuffer, const ImVector<ImDrawIdx>& idxBuffer, const ImVector<ImDrawCmd>& cmdBuffer, const ImVec2& preOffset, const ImVec2& scale, const ImVec2& postOffset)
 //{
 //    auto idxRead = idxBuffer.Data;
@@ -334,7 +445,8 @@ static void ImDrawList_PathBezierOffset(ImDrawList* drawList, float offset, cons
         drawList->PathLineTo(r.Point + ImNormalized(ImVec2(-r.Tangent.y, r.Tangent.x)) * offset);
     };
 
-    ImCubicBezierSubdivide(acceptPoint, p0, p1, p2, p3);
+    // Same error as ImDrawList::PathBezierCurveTo(), subdivision takes unsquared tolerance.
+    ImCubicBezierSubdivide(acceptPoint, p0, p1, p2, p3, ImSqrt(drawList->_Data->CurveTessellationTol));
 }
 
 /*
@@ -537,18 +649,24 @@ static void ImDrawList_AddBezierWithArrows(ImDrawList* drawList, const ImCubicBe
 //------------------------------------------------------------------------------
 void ed::Pin::Draw(ImDrawList* drawList, DrawFlags flags)
 {
+    // Retained pins have no channels assigned this frame.
+    if (m_IsRetained || Editor->GetLOD() != LevelOfDetail::Full)
+        return;
+
     if (flags & Hovered)
     {
-        drawList->ChannelsSetCurrent(m_Node->m_Channel + c_NodePinChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, m_Node->m_Channel + c_NodePinChannel);
+
+        const auto rounding = Editor->GetVisibleRounding(m_Rounding);
 
         drawList->AddRectFilled(m_Bounds.Min, m_Bounds.Max,
-            m_Color, m_Rounding, m_Corners);
+            m_Color, rounding, m_Corners);
 
         if (m_BorderWidth > 0.0f)
         {
             FringeScaleScope fringe(1.0f);
             drawList->AddRect(m_Bounds.Min, m_Bounds.Max,
-                m_BorderColor, m_Rounding, m_Corners, m_BorderWidth);
+                m_BorderColor, rounding, m_Corners, m_BorderWidth);
         }
 
         if (!Editor->IsSelected(m_Node))
@@ -566,6 +684,17 @@ ImLine ed::Pin::GetClosestLine(const Pin* pin) const
     return ImRect_ClosestLine(m_Pivot, pin->m_Pivot, m_Radius + m_ArrowSize, pin->m_Radius + pin->m_ArrowSize);
 }
 
+ed::Pin::GeometryKey ed::Pin::MakeGeometryKey() const
+{
+    GeometryKey key;
+    key.m_Pivot     = m_Pivot;
+    key.m_Dir       = m_Dir;
+    key.m_Strength  = m_Strength;
+    key.m_Radius    = m_Radius;
+    key.m_ArrowSize = m_ArrowSize;
+    return key;
+}
+
 
 
 
@@ -585,6 +714,7 @@ void ed::Node::UpdateDrag(const ImVec2& offset)
     auto size = m_Bounds.GetSize();
     m_Bounds.Min = ImFloor(m_DragStart + offset);
     m_Bounds.Max = m_Bounds.Min + size;
+    Editor->NotifyNodeBoundsChanged(this);
 }
 
 bool ed::Node::EndDrag()
@@ -594,21 +724,39 @@ bool ed::Node::EndDrag()
 
 void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
 {
-    if (flags == Detail::Object::None)
+    // Retained nodes have no channels assigned this frame.
+    if (m_IsRetained)
+        return;
+
+    if (flags == Detail::Object::None && Editor->GetLOD() == LevelOfDetail::Overview)
+    {
+        ImDrawList_ChannelsSetCurrent(drawList, m_Channel + c_NodeBackgroundChannel);
+
+        if (IsGroup(this))
+            drawList->AddRectFilled(m_GroupBounds.Min, m_GroupBounds.Max, m_GroupColor);
+
+        drawList->AddRectFilled(m_Bounds.Min, m_Bounds.Max, m_Color | IM_COL32_A_MASK);
+    }
+    else if (flags == Detail::Object::None)
     {
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBackgroundChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, m_Channel + c_NodeBackgroundChannel);
+
+        if (m_HasImpostor && Editor->DrawNodeImpostor(drawList, this))
+            return;
 
         drawList->AddRectFilled(
             m_Bounds.Min,
             m_Bounds.Max,
-            m_Color, m_Rounding);
+            m_Color, Editor->GetVisibleRounding(m_Rounding));
 
         if (IsGroup(this))
         {
+            const auto groupRounding = Editor->GetVisibleRounding(m_GroupRounding);
+
             drawList->AddRectFilled(
                 m_GroupBounds.Min,
                 m_GroupBounds.Max,
-                m_GroupColor, m_GroupRounding);
+                m_GroupColor, groupRounding);
 
             if (m_GroupBorderWidth > 0.0f)
             {
@@ -617,7 +765,7 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
                 drawList->AddRect(
                     m_GroupBounds.Min,
                     m_GroupBounds.Max,
-                    m_GroupBorderColor, m_GroupRounding, 15, m_GroupBorderWidth);
+                    m_GroupBorderColor, groupRounding, 15, m_GroupBorderWidth);
             }
         }
 
@@ -648,7 +796,7 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
         const auto  borderColor = Editor->GetColor(StyleColor_SelNodeBorder);
         const auto& editorStyle = Editor->GetStyle();
 
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBaseChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, m_Channel + c_NodeBaseChannel);
 
         DrawBorder(drawList, borderColor, editorStyle.SelectedNodeBorderWidth);
     }
@@ -657,7 +805,7 @@ void ed::Node::Draw(ImDrawList* drawList, DrawFlags flags)
         const auto  borderColor = Editor->GetColor(StyleColor_HovNodeBorder);
         const auto& editorStyle = Editor->GetStyle();
 
-        drawList->ChannelsSetCurrent(m_Channel + c_NodeBaseChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, m_Channel + c_NodeBaseChannel);
 
         DrawBorder(drawList, borderColor, editorStyle.HoveredNodeBorderWidth);
     }
@@ -668,7 +816,7 @@ void ed::Node::DrawBorder(ImDrawList* drawList, ImU32 color, float thickness)
     if (thickness > 0.0f)
     {
         drawList->AddRect(m_Bounds.Min, m_Bounds.Max,
-            color, m_Rounding, 15, thickness);
+            color, Editor->GetVisibleRounding(m_Rounding), 15, thickness);
     }
 }
 
@@ -680,11 +828,7 @@ void ed::Node::GetGroupedNodes(std::vector<Node*>& result, bool append)
     if (!IsGroup(this))
         return;
 
-    const auto firstNodeIndex = result.size();
-    Editor->FindNodesInRect(m_GroupBounds, result, true, false);
-
-    for (auto index = firstNodeIndex; index < result.size(); ++index)
-        result[index]->GetGroupedNodes(result, true);
+    Editor->GetGroupedNodes(this, result);
 }
 
 ImRect ed::Node::GetRegionBounds(NodeRegion region) const
@@ -829,15 +973,15 @@ void ed::Link::Draw(ImDrawList* drawList, DrawFlags flags)
 {
     if (flags == None)
     {
-        drawList->ChannelsSetCurrent(c_LinkChannel_Links);
+        ImDrawList_ChannelsSetCurrent(drawList, c_LinkChannel_Links);
 
-        Draw(drawList, m_Color, 0.0f);
+        DrawCached(drawList);
     }
     else if (flags & Selected)
     {
         const auto borderColor = Editor->GetColor(StyleColor_SelLinkBorder);
 
-        drawList->ChannelsSetCurrent(c_LinkChannel_Selection);
+        ImDrawList_ChannelsSetCurrent(drawList, c_LinkChannel_Selection);
 
         Draw(drawList, borderColor, 4.5f);
     }
@@ -845,7 +989,7 @@ void ed::Link::Draw(ImDrawList* drawList, DrawFlags flags)
     {
         const auto borderColor = Editor->GetColor(StyleColor_HovLinkBorder);
 
-        drawList->ChannelsSetCurrent(c_LinkChannel_Selection);
+        ImDrawList_ChannelsSetCurrent(drawList, c_LinkChannel_Selection);
 
         Draw(drawList, borderColor, 2.0f);
     }
@@ -853,10 +997,24 @@ void ed::Link::Draw(ImDrawList* drawList, DrawFlags flags)
 
 void ed::Link::Draw(ImDrawList* drawList, ImU32 color, float extraThickness) const
 {
-    if (!m_IsLive)
+    if (!IsLive())
         return;
 
-    const auto curve = GetCurve();
+    const auto& curve = GetCurve();
+
+    switch (Editor->GetLOD())
+    {
+        case LevelOfDetail::Overview:
+            drawList->AddLine(curve.P0, curve.P3, color, m_Thickness + extraThickness);
+            return;
+
+        case LevelOfDetail::Reduced:
+            drawList->AddBezierCurve(curve.P0, curve.P1, curve.P2, curve.P3, color, m_Thickness + extraThickness, c_ReducedLinkSegments);
+            return;
+
+        case LevelOfDetail::Full:
+            break;
+    }
 
     ImDrawList_AddBezierWithArrows(drawList, curve, m_Thickness + extraThickness,
         m_StartPin && m_StartPin->m_ArrowSize  > 0.0f ? m_StartPin->m_ArrowSize  + extraThickness : 0.0f,
@@ -866,14 +1024,207 @@ void ed::Link::Draw(ImDrawList* drawList, ImU32 color, float extraThickness) con
         true, color, 1.0f);
 }
 
+ed::Link::GeometryKey ed::Link::MakeGeometryKey(const ImDrawList* drawList) const
+{
+    GeometryKey key = {};
+    key.m_Curve                 = m_Curve;
+    key.m_Thickness             = m_Thickness;
+    key.m_StartArrowSize        = m_StartPin ? m_StartPin->m_ArrowSize  : 0.0f;
+    key.m_StartArrowWidth       = m_StartPin ? m_StartPin->m_ArrowWidth : 0.0f;
+    key.m_EndArrowSize          = m_EndPin   ? m_EndPin->m_ArrowSize    : 0.0f;
+    key.m_EndArrowWidth         = m_EndPin   ? m_EndPin->m_ArrowWidth   : 0.0f;
+    key.m_Color                 = m_Color;
+    key.m_FringeScale           = drawList->_FringeScale;
+    key.m_TessellationTolerance = drawList->_Data->CurveTessellationTol;
+    key.m_TexUvWhitePixel       = drawList->_Data->TexUvWhitePixel;
+    key.m_Flags                 = drawList->Flags;
+    key.m_LOD                   = Editor->GetLOD();
+    return key;
+}
+
+bool ed::Link::HasGeometry(const ImDrawList* drawList) const
+{
+    const auto key = MakeGeometryKey(drawList);
+    return m_HasGeometry && memcmp(&key, &m_GeometryKey, sizeof(GeometryKey)) == 0;
+}
+
+bool ed::Link::TessellateGeometry(ImDrawList* scratch, const ImDrawList* drawList) const
+{
+    // Scratch list mirrors state of target list, vertices are the same as
+    // ones DrawCached() would record. Clearing keeps reserved buffers.
+    scratch->Clear();
+    scratch->Flags        = drawList->Flags;
+    scratch->_FringeScale = drawList->_FringeScale;
+    scratch->AddDrawCmd();
+
+    const auto vertexCapacity = scratch->VtxBuffer.Capacity;
+    const auto indexCapacity  = scratch->IdxBuffer.Capacity;
+
+    Draw(scratch, m_Color, 0.0f);
+
+    IM_ASSERT(scratch->VtxBuffer.Capacity == vertexCapacity && scratch->IdxBuffer.Capacity == indexCapacity && "Scratch list grew, c_MaxLinkVertices is too small.");
+    IM_UNUSED(vertexCapacity);
+    IM_UNUSED(indexCapacity);
+
+    return scratch->_VtxCurrentOffset == 0;
+}
+
+void ed::Link::SetGeometry(const ImDrawList* drawList, const ImDrawVert* vertices, int vertexCount, const ImDrawIdx* indices, int indexCount)
+{
+    m_GeometryKey = MakeGeometryKey(drawList);
+    m_HasGeometry = true;
+
+    m_GeometryVertices.resize(vertexCount);
+    if (vertexCount > 0)
+        memcpy(m_GeometryVertices.Data, vertices, vertexCount * sizeof(ImDrawVert));
+
+    m_GeometryIndices.resize(indexCount);
+    if (indexCount > 0)
+        memcpy(m_GeometryIndices.Data, indices, indexCount * sizeof(ImDrawIdx));
+}
+
+void ed::Link::ClearGeometry()
+{
+    m_HasGeometry = false;
+    m_GeometryVertices.clear();
+    m_GeometryIndices.clear();
+}
+
+void ed::Link::DrawCached(ImDrawList* drawList)
+{
+    if (!IsLive())
+        return;
+
+    const auto key = MakeGeometryKey(drawList);
+
+    if (m_HasGeometry && memcmp(&key, &m_GeometryKey, sizeof(GeometryKey)) == 0)
+    {
+        const auto vertexCount = m_GeometryVertices.Size;
+        const auto indexCount  = m_GeometryIndices.Size;
+        if (vertexCount == 0)
+            return;
+
+        drawList->PrimReserve(indexCount, vertexCount);
+
+        memcpy(drawList->_VtxWritePtr, m_GeometryVertices.Data, vertexCount * sizeof(ImDrawVert));
+
+        const auto baseIndex = drawList->_VtxCurrentIdx;
+        for (int i = 0; i < indexCount; ++i)
+            drawList->_IdxWritePtr[i] = static_cast<ImDrawIdx>(baseIndex + m_GeometryIndices.Data[i]);
+
+        drawList->_VtxWritePtr   += vertexCount;
+        drawList->_IdxWritePtr   += indexCount;
+        drawList->_VtxCurrentIdx += vertexCount;
+        return;
+    }
+
+    const auto firstVertex = drawList->VtxBuffer.Size;
+    const auto firstIndex  = drawList->IdxBuffer.Size;
+    const auto baseIndex   = drawList->_VtxCurrentIdx;
+
+    Draw(drawList, m_Color, 0.0f);
+
+    const auto vertexCount = drawList->VtxBuffer.Size - firstVertex;
+    const auto indexCount  = drawList->IdxBuffer.Size - firstIndex;
+
+    // Geometry split by vertex offset change cannot be replayed as single block.
+    m_HasGeometry = (drawList->_VtxCurrentIdx == baseIndex + static_cast<unsigned int>(vertexCount));
+    if (!m_HasGeometry)
+        return;
+
+    m_GeometryKey = key;
+
+    m_GeometryVertices.resize(vertexCount);
+    if (vertexCount > 0)
+        memcpy(m_GeometryVertices.Data, drawList->VtxBuffer.Data + firstVertex, vertexCount * sizeof(ImDrawVert));
+
+    m_GeometryIndices.resize(indexCount);
+    for (int i = 0; i < indexCount; ++i)
+        m_GeometryIndices.Data[i] = static_cast<ImDrawIdx>(drawList->IdxBuffer.Data[firstIndex + i] - baseIndex);
+}
+
 void ed::Link::UpdateEndpoints()
 {
+    // Neither pin changed since curve was computed, there is nothing to do.
+    if (m_HasCurve && m_StartPinVersion == m_StartPin->m_GeometryVersion && m_EndPinVersion == m_EndPin->m_GeometryVersion)
+        return;
+
+    m_StartPinVersion = m_StartPin->m_GeometryVersion;
+    m_EndPinVersion   = m_EndPin->m_GeometryVersion;
+
     const auto line = m_StartPin->GetClosestLine(m_EndPin);
-    m_Start = line.A;
-    m_End   = line.B;
+    m_Start  = line.A;
+    m_End    = line.B;
+
+    CurveKey key;
+    key.m_Start          = m_Start;
+    key.m_End            = m_End;
+    key.m_StartDir       = m_StartPin->m_Dir;
+    key.m_EndDir         = m_EndPin->m_Dir;
+    key.m_StartStrength  = m_StartPin->m_Strength;
+    key.m_EndStrength    = m_EndPin->m_Strength;
+    key.m_StartArrowSize = m_StartPin->m_ArrowSize;
+    key.m_EndArrowSize   = m_EndPin->m_ArrowSize;
+
+    // Links mostly stay where they are, skip curve math when nothing changed.
+    if (m_HasCurve && memcmp(&key, &m_CurveKey, sizeof(CurveKey)) == 0)
+        return;
+
+    // Both ends moved by the same offset, like link between nodes dragged
+    // together. Shape is the same, move what was computed for it.
+    if (m_HasCurve)
+    {
+        auto moved = m_CurveKey;
+        moved.m_Start = key.m_Start;
+        moved.m_End   = key.m_End;
+
+        const auto offset = key.m_Start - m_CurveKey.m_Start;
+        if (memcmp(&key, &moved, sizeof(CurveKey)) == 0 && key.m_End - m_CurveKey.m_End == offset)
+        {
+            m_CurveKey = key;
+            Translate(offset);
+            if (m_States)
+                m_States->m_Bounds[m_StateIndex] = m_Bounds;
+
+            Editor->NotifyGeometryChanged();
+            return;
+        }
+    }
+
+    m_CurveKey = key;
+    m_HasCurve = true;
+    m_Curve    = CalculateCurve();
+    m_Bounds   = CalculateBounds();
+    if (m_States)
+        m_States->m_Bounds[m_StateIndex] = m_Bounds;
+
+    UpdateSegmentBounds();
+
+    Editor->NotifyGeometryChanged();
+}
+
+void ed::Link::Translate(const ImVec2& offset)
+{
+    // Cached geometry is moved along only when it was built for current curve.
+    const auto moveGeometry = m_HasGeometry && memcmp(&m_GeometryKey.m_Curve, &m_Curve, sizeof(m_Curve)) == 0;
+
+    m_Curve.P0 += offset;
+    m_Curve.P1 += offset;
+    m_Curve.P2 += offset;
+    m_Curve.P3 += offset;
+    m_Bounds.Translate(offset);
+    for (auto& bounds : m_SegmentBounds)
+        bounds.Translate(offset);
+
+    if (moveGeometry)
+    {
+        for (auto& vertex : m_GeometryVertices)
+            vertex.pos += offset;
+        m_GeometryKey.m_Curve = m_Curve;
+    }
 }
 
-ImCubicBezierPoints ed::Link::GetCurve() const
+ImCubicBezierPoints ed::Link::CalculateCurve() const
 {
     auto easeLinkStrength = [](const ImVec2& a, const ImVec2& b, float strength)
     {
@@ -904,7 +1255,7 @@ ImCubicBezierPoints ed::Link::GetCurve() const
 
 bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
 {
-    if (!m_IsLive)
+    if (!IsLive())
         return false;
 
     auto bounds = GetBounds();
@@ -914,7 +1265,10 @@ bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
     if (!bounds.Contains(point))
         return false;
 
-    const auto bezier = GetCurve();
+    if (!TestSegmentBounds(point, m_Thickness + extraThickness))
+        return false;
+
+    const auto& bezier = GetCurve();
     const auto result = ImProjectOnCubicBezier(point, bezier.P0, bezier.P1, bezier.P2, bezier.P3, 50);
 
     return result.Distance <= m_Thickness + extraThickness;
@@ -922,7 +1276,7 @@ bool ed::Link::TestHit(const ImVec2& point, float extraThickness) const
 
 bool ed::Link::TestHit(const ImRect& rect, bool allowIntersect) const
 {
-    if (!m_IsLive)
+    if (!IsLive())
         return false;
 
     const auto bounds = GetBounds();
@@ -933,7 +1287,7 @@ bool ed::Link::TestHit(const ImRect& rect, bool allowIntersect) const
     if (!allowIntersect || !rect.Overlaps(bounds))
         return false;
 
-    const auto bezier = GetCurve();
+    const auto& bezier = GetCurve();
 
     const auto p0 = rect.GetTL();
     const auto p1 = rect.GetTR();
@@ -952,1538 +1306,5701 @@ bool ed::Link::TestHit(const ImRect& rect, bool allowIntersect) const
     return false;
 }
 
-ImRect ed::Link::GetBounds() const
+bool ed::Link::TestSegmentBounds(const ImVec2& point, float distance) const
 {
-    if (m_IsLive)
-    {
-        const auto curve = GetCurve();
-        auto bounds = ImCubicBezierBoundingRect(curve.P0, curve.P1, curve.P2, curve.P3);
+    // Sampled curve points lie in segment hulls up to rounding errors,
+    // small margin keeps this test conservative.
+    const auto margin = distance + 0.01f;
 
-        if (bounds.GetWidth() == 0.0f)
-        {
-            bounds.Min.x -= 0.5f;
-            bounds.Max.x += 0.5f;
-        }
+    for (auto& bounds : m_SegmentBounds)
+    {
+        if (point.x >= bounds.Min.x - margin && point.x <= bounds.Max.x + margin &&
+            point.y >= bounds.Min.y - margin && point.y <= bounds.Max.y + margin)
+            return true;
+    }
 
-        if (bounds.GetHeight() == 0.0f)
-        {
-            bounds.Min.y -= 0.5f;
-            bounds.Max.y += 0.5f;
-        }
+    return false;
+}
 
-        if (m_StartPin->m_ArrowSize)
-        {
-            const auto start_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
-            const auto p0 = curve.P0;
-            const auto p1 = curve.P0 - start_dir * m_StartPin->m_ArrowSize;
-            const auto min = ImMin(p0, p1);
-            const auto max = ImMax(p0, p1);
-            auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
-            bounds.Add(arrowBounds);
-        }
+void ed::Link::UpdateSegmentBounds()
+{
+    for (int i = 0; i < c_SegmentCount; ++i)
+    {
+        const auto t0 = static_cast<float>(i)     / c_SegmentCount;
+        const auto t1 = static_cast<float>(i + 1) / c_SegmentCount;
 
-        if (m_EndPin->m_ArrowSize)
-        {
-            const auto end_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
-            const auto p0 = curve.P3;
-            const auto p1 = curve.P3 + end_dir * m_EndPin->m_ArrowSize;
-            const auto min = ImMin(p0, p1);
-            const auto max = ImMax(p0, p1);
-            auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
-            bounds.Add(arrowBounds);
-        }
+        // Cut [0, t1] span, then [t0, t1] from its reversed copy. Only left
+        // half of a split is used, order of points does not matter for hull.
+        auto segment = ImCubicBezierSplit(m_Curve, t1).Left;
+        if (i > 0)
+            segment = ImCubicBezierSplit(segment.P3, segment.P2, segment.P1, segment.P0, (t1 - t0) / t1).Left;
 
-        return bounds;
+        auto& bounds = m_SegmentBounds[i];
+        bounds.Min = ImMin(ImMin(segment.P0, segment.P1), ImMin(segment.P2, segment.P3));
+        bounds.Max = ImMax(ImMax(segment.P0, segment.P1), ImMax(segment.P2, segment.P3));
     }
+}
+
+ImRect ed::Link::GetBounds() const
+{
+    if (IsLive())
+        return m_Bounds;
     else
         return ImRect();
 }
 
+ImRect ed::Link::CalculateBounds() const
+{
+    const auto& curve = m_Curve;
+    auto bounds = ImCubicBezierBoundingRect(curve.P0, curve.P1, curve.P2, curve.P3);
+
+    if (bounds.GetWidth() == 0.0f)
+    {
+        bounds.Min.x -= 0.5f;
+        bounds.Max.x += 0.5f;
+    }
+
+    if (bounds.GetHeight() == 0.0f)
+    {
+        bounds.Min.y -= 0.5f;
+        bounds.Max.y += 0.5f;
+    }
+
+    if (m_StartPin->m_ArrowSize)
+    {
+        const auto start_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 0.0f));
+        const auto p0 = curve.P0;
+        const auto p1 = curve.P0 - start_dir * m_StartPin->m_ArrowSize;
+        const auto min = ImMin(p0, p1);
+        const auto max = ImMax(p0, p1);
+        auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
+        bounds.Add(arrowBounds);
+    }
+
+    if (m_EndPin->m_ArrowSize)
+    {
+        const auto end_dir = ImNormalized(ImCubicBezierTangent(curve.P0, curve.P1, curve.P2, curve.P3, 1.0f));
+        const auto p0 = curve.P3;
+        const auto p1 = curve.P3 + end_dir * m_EndPin->m_ArrowSize;
+        const auto min = ImMin(p0, p1);
+        const auto max = ImMax(p0, p1);
+        auto arrowBounds = ImRect(min, ImMax(max, min + ImVec2(1, 1)));
+        bounds.Add(arrowBounds);
+    }
+
+    return bounds;
+}
+
 
 
 
 //------------------------------------------------------------------------------
 //
-// Editor Context
+// Spatial Index
 //
 //------------------------------------------------------------------------------
-ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
-    : m_IsFirstFrame(true)
-    , m_IsWindowActive(false)
-    , m_ShortcutsEnabled(true)
-    , m_Style()
-    , m_Nodes()
-    , m_Pins()
-    , m_Links()
-    , m_SelectionId(1)
-    , m_LastActiveLink(nullptr)
-    , m_Canvas()
-    , m_IsCanvasVisible(false)
-    , m_NodeBuilder(this)
-    , m_HintBuilder(this)
-    , m_CurrentAction(nullptr)
-    , m_NavigateAction(this, m_Canvas)
-    , m_SizeAction(this)
-    , m_DragAction(this)
-    , m_SelectAction(this)
-    , m_ContextMenuAction(this)
-    , m_ShortcutAction(this)
-    , m_CreateItemAction(this)
-    , m_DeleteItemsAction(this)
-    , m_AnimationControllers{ &m_FlowAnimationController }
-    , m_FlowAnimationController(this)
-    , m_DoubleClickedNode(0)
-    , m_DoubleClickedPin(0)
-    , m_DoubleClickedLink(0)
-    , m_BackgroundClicked(false)
-    , m_BackgroundDoubleClicked(false)
-    , m_IsInitialized(false)
-    , m_Settings()
-    , m_Config(config)
-    , m_ExternalChannel(0)
+ed::SpatialIndex::SpatialIndex(float cellSize)
+    : m_CellSize(cellSize)
+    , m_InvCellSize(1.0f / cellSize)
+    , m_QueryStamp(0)
 {
 }
 
-ed::EditorContext::~EditorContext()
+void ed::SpatialIndex::Update(Object* object, const ImRect& bounds)
 {
-    if (m_IsInitialized)
-        SaveSettings();
+    auto result = m_Entries.emplace(object, Entry());
+    auto& entry = result.first->second;
 
-    for (auto link  : m_Links)  delete link.m_Object;
-    for (auto pin   : m_Pins)   delete pin.m_Object;
-    for (auto node  : m_Nodes)  delete node.m_Object;
+    const auto cells = GetCellRange(bounds);
 
-    m_Splitter.ClearFreeMemory();
+    if (result.second)
+    {
+        entry.m_Object     = object;
+        entry.m_Bounds     = bounds;
+        entry.m_Cells      = cells;
+        entry.m_IsLarge    = IsLarge(cells);
+        entry.m_QueryStamp = m_QueryStamp;
+        AddToCells(entry);
+        return;
+    }
+
+    entry.m_Bounds = bounds;
+    if (entry.m_Cells == cells)
+        return;
+
+    RemoveFromCells(entry);
+    entry.m_Cells   = cells;
+    entry.m_IsLarge = IsLarge(cells);
+    AddToCells(entry);
 }
 
-void ed::EditorContext::Begin(const char* id, const ImVec2& size)
+bool ed::SpatialIndex::GetBounds(Object* object, ImRect& result) const
 {
-    if (!m_IsInitialized)
-    {
-        LoadSettings();
-        m_IsInitialized = true;
-    }
+    auto entryIt = m_Entries.find(object);
+    if (entryIt == m_Entries.end())
+        return false;
 
-    //ImGui::LogToClipboard();
-    //Log("---- begin ----");
+    result = entryIt->second.m_Bounds;
+    return true;
+}
 
-    for (auto node  : m_Nodes)   node->Reset();
-    for (auto pin   : m_Pins)     pin->Reset();
-    for (auto link  : m_Links)   link->Reset();
+void ed::SpatialIndex::Remove(Object* object)
+{
+    auto entryIt = m_Entries.find(object);
+    if (entryIt == m_Entries.end())
+        return;
 
-    auto drawList = ImGui::GetWindowDrawList();
+    RemoveFromCells(entryIt->second);
+    m_Entries.erase(entryIt);
+}
 
-    ImDrawList_SwapSplitter(drawList, m_Splitter);
-    m_ExternalChannel = drawList->_Splitter._Current;
+void ed::SpatialIndex::Clear()
+{
+    m_Entries.clear();
+    m_Cells.clear();
+    m_LargeEntries.clear();
+}
 
-    ImGui::PushID(id);
+size_t ed::SpatialIndex::GetMemoryUsage() const
+{
+    size_t size = HeapSize(m_Entries) + HeapSize(m_Cells) + HeapSize(m_LargeEntries);
+    for (auto& cell : m_Cells)
+        size += HeapSize(cell.second);
+    return size;
+}
 
-    auto availableContentSize = ImGui::GetContentRegionAvail();
-    ImVec2 canvasSize = ImFloor(size);
-    if (canvasSize.x <= 0.0f)
-        canvasSize.x = ImMax(4.0f, availableContentSize.x);
-    if (canvasSize.y <= 0.0f)
-        canvasSize.y = ImMax(4.0f, availableContentSize.y);
+void ed::SpatialIndex::Query(const ImRect& rect, vector<Object*>& result)
+{
+    if (m_Entries.empty())
+        return;
 
-    m_IsCanvasVisible = m_Canvas.Begin(id, canvasSize);
+    // Stamp is used to report objects spanning multiple cells only once.
+    if (++m_QueryStamp == 0)
+    {
+        for (auto& entry : m_Entries)
+            entry.second.m_QueryStamp = 0;
+        m_QueryStamp = 1;
+    }
 
-    //ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0, 0, 0, 0));
-    //ImGui::BeginChild(id, size, false,
-    //    ImGuiWindowFlags_NoMove |
-    //    ImGuiWindowFlags_NoScrollbar |
-    //    ImGuiWindowFlags_NoScrollWithMouse);
+    auto collect = [this, &rect, &result](Entry& entry)
+    {
+        if (entry.m_QueryStamp == m_QueryStamp)
+            return;
 
-    //ImGui::CaptureKeyboardFromApp();
+        entry.m_QueryStamp = m_QueryStamp;
 
-    m_IsWindowActive = ImGui::IsWindowFocused();
+        if (Touches(entry.m_Bounds, rect))
+            result.push_back(entry.m_Object);
+    };
 
-    //
-	m_NavigateAction.SetWindow(m_Canvas.ViewRect().Min, m_Canvas.ViewRect().GetSize());
+    const auto cells     = GetCellRange(rect);
+    const auto cellCount = static_cast<long long>(cells.MaxX - cells.MinX + 1) * (cells.MaxY - cells.MinY + 1);
 
-    if (m_CurrentAction && m_CurrentAction->IsDragging() && m_NavigateAction.MoveOverEdge())
+    // Visiting cells is pointless when query covers more of them than
+    // there are objects in the index.
+    if (cellCount > static_cast<long long>(m_Entries.size()))
     {
-        auto& io = ImGui::GetIO();
-        auto offset = m_NavigateAction.GetMoveOffset();
-        for (int i = 0; i < 5; ++i)
-            io.MouseClickedPos[i] = io.MouseClickedPos[i] - offset;
+        for (auto& entry : m_Entries)
+            collect(entry.second);
+        return;
     }
-    else
-        m_NavigateAction.StopMoveOverEdge();
-
-    m_Canvas.SetView(m_NavigateAction.GetView());
-
-    // #debug #clip
-    //ImGui::Text("CLIP = { x=%g y=%g w=%g h=%g r=%g b=%g }",
-    //    clipMin.x, clipMin.y, clipMax.x - clipMin.x, clipMax.y - clipMin.y, clipMax.x, clipMax.y);
 
-    // Reserve channels for background and links
-    ImDrawList_ChannelsGrow(drawList, c_NodeStartChannel);
+    for (auto entry : m_LargeEntries)
+        collect(*entry);
 
-    if (HasSelectionChanged())
-        ++m_SelectionId;
+    for (int y = cells.MinY; y <= cells.MaxY; ++y)
+    {
+        for (int x = cells.MinX; x <= cells.MaxX; ++x)
+        {
+            auto cellIt = m_Cells.find(MakeCellKey(x, y));
+            if (cellIt == m_Cells.end())
+                continue;
 
-    m_LastSelectedObjects = m_SelectedObjects;
+            for (auto entry : cellIt->second)
+                collect(*entry);
+        }
+    }
 }
 
-void ed::EditorContext::End()
+ed::SpatialIndex::CellRange ed::SpatialIndex::GetCellRange(const ImRect& rect) const
 {
-    //auto& io          = ImGui::GetIO();
-    auto  control     = BuildControl(m_CurrentAction && m_CurrentAction->IsDragging()); // NavigateAction.IsMovingOverEdge()
-    auto  drawList    = ImGui::GetWindowDrawList();
-    //auto& editorStyle = GetStyle();
+    // Keep cell coordinates in range where key packing and counting are safe.
+    const float limit = static_cast<float>(1 << 24);
 
-    m_DoubleClickedNode       = control.DoubleClickedNode ? control.DoubleClickedNode->m_ID : 0;
-    m_DoubleClickedPin        = control.DoubleClickedPin  ? control.DoubleClickedPin->m_ID  : 0;
-    m_DoubleClickedLink       = control.DoubleClickedLink ? control.DoubleClickedLink->m_ID : 0;
-    m_BackgroundClicked       = control.BackgroundClicked;
-    m_BackgroundDoubleClicked = control.BackgroundDoubleClicked;
+    auto toCell = [this, limit](float value)
+    {
+        return static_cast<int>(ImFloor(ImClamp(value * m_InvCellSize, -limit, limit)));
+    };
 
-    //if (DoubleClickedNode) LOG_TRACE(0, "DOUBLE CLICK NODE: %d", DoubleClickedNode);
-    //if (DoubleClickedPin)  LOG_TRACE(0, "DOUBLE CLICK PIN:  %d", DoubleClickedPin);
-    //if (DoubleClickedLink) LOG_TRACE(0, "DOUBLE CLICK LINK: %d", DoubleClickedLink);
-    //if (BackgroundDoubleClicked) LOG_TRACE(0, "DOUBLE CLICK BACKGROUND", DoubleClickedLink);
+    CellRange range;
+    range.MinX = toCell(ImMin(rect.Min.x, rect.Max.x));
+    range.MinY = toCell(ImMin(rect.Min.y, rect.Max.y));
+    range.MaxX = toCell(ImMax(rect.Min.x, rect.Max.x));
+    range.MaxY = toCell(ImMax(rect.Min.y, rect.Max.y));
+    return range;
+}
 
-    const bool isSelecting = m_CurrentAction && m_CurrentAction->AsSelect() != nullptr;
-    const bool isDragging  = m_CurrentAction && m_CurrentAction->AsDrag()   != nullptr;
-    //const bool isSizing    = CurrentAction && CurrentAction->AsSize()   != nullptr;
+bool ed::SpatialIndex::IsLarge(const CellRange& range) const
+{
+    // Big objects (like groups) are kept aside instead of being
+    // copied to dozens of cells.
+    const int c_MaxCellsPerObject = 16;
 
-    // Draw nodes
-    for (auto node : m_Nodes)
-        if (node->m_IsLive && node->IsVisible())
-            node->Draw(drawList);
+    return (range.MaxX - range.MinX + 1) * (range.MaxY - range.MinY + 1) > c_MaxCellsPerObject;
+}
 
-    // Draw links
-    for (auto link : m_Links)
-        if (link->m_IsLive && link->IsVisible())
-            link->Draw(drawList);
+void ed::SpatialIndex::AddToCells(Entry& entry)
+{
+    if (entry.m_IsLarge)
+    {
+        m_LargeEntries.push_back(&entry);
+        return;
+    }
+
+    for (int y = entry.m_Cells.MinY; y <= entry.m_Cells.MaxY; ++y)
+        for (int x = entry.m_Cells.MinX; x <= entry.m_Cells.MaxX; ++x)
+            m_Cells[MakeCellKey(x, y)].push_back(&entry);
+}
 
-    // Highlight selected objects
+void ed::SpatialIndex::RemoveFromCells(Entry& entry)
+{
+    auto removeFrom = [&entry](vector<Entry*>& entries)
     {
-        auto selectedObjects = &m_SelectedObjects;
-        if (auto selectAction = m_CurrentAction ? m_CurrentAction->AsSelect() : nullptr)
-            selectedObjects = &selectAction->m_CandidateObjects;
+        auto entryIt = std::find(entries.begin(), entries.end(), &entry);
+        if (entryIt != entries.end())
+        {
+            *entryIt = entries.back();
+            entries.pop_back();
+        }
+    };
 
-        for (auto selectedObject : *selectedObjects)
-            if (selectedObject->IsVisible())
-                selectedObject->Draw(drawList, Object::Selected);
+    if (entry.m_IsLarge)
+    {
+        removeFrom(m_LargeEntries);
+        return;
     }
 
-    if (!isSelecting)
+    for (int y = entry.m_Cells.MinY; y <= entry.m_Cells.MaxY; ++y)
     {
-        auto hoveredObject = control.HotObject;
-        if (auto dragAction = m_CurrentAction ? m_CurrentAction->AsDrag() : nullptr)
-            hoveredObject = dragAction->m_DraggedObject;
-        if (auto sizeAction = m_CurrentAction ? m_CurrentAction->AsSize() : nullptr)
-            hoveredObject = sizeAction->m_SizedNode;
+        for (int x = entry.m_Cells.MinX; x <= entry.m_Cells.MaxX; ++x)
+        {
+            auto cellIt = m_Cells.find(MakeCellKey(x, y));
+            if (cellIt == m_Cells.end())
+                continue;
 
-        if (hoveredObject && !IsSelected(hoveredObject) && hoveredObject->IsVisible())
-            hoveredObject->Draw(drawList, Object::Hovered);
+            removeFrom(cellIt->second);
+            if (cellIt->second.empty())
+                m_Cells.erase(cellIt);
+        }
     }
+}
 
-    // Draw animations
-    for (auto controller : m_AnimationControllers)
-        controller->Draw(drawList);
+ImU64 ed::SpatialIndex::MakeCellKey(int x, int y)
+{
+    return (static_cast<ImU64>(static_cast<ImU32>(x)) << 32) | static_cast<ImU32>(y);
+}
 
-    if (m_CurrentAction && !m_CurrentAction->Process(control))
-        m_CurrentAction = nullptr;
+bool ed::SpatialIndex::Touches(const ImRect& a, const ImRect& b)
+{
+    // Inclusive test, degenerated rects (points) have to be found too.
+    return a.Min.x <= b.Max.x && a.Max.x >= b.Min.x
+        && a.Min.y <= b.Max.y && a.Max.y >= b.Min.y;
+}
 
-    if (m_NavigateAction.m_IsActive)
-        m_NavigateAction.Process(control);
-    else
-        m_NavigateAction.Accept(control);
 
-    if (nullptr == m_CurrentAction)
-    {
-        EditorAction* possibleAction   = nullptr;
 
-        auto accept = [&possibleAction, &control](EditorAction& action)
-        {
-            auto result = action.Accept(control);
 
-            if (result == EditorAction::True)
-                return true;
-            else if (/*!possibleAction &&*/ result == EditorAction::Possible)
-                possibleAction = &action;
-            else if (result == EditorAction::Possible)
-                action.Reject();
+//------------------------------------------------------------------------------
+//
+// Impostor Cache
+//
+//------------------------------------------------------------------------------
+ed::ImpostorCache::ImpostorCache()
+    : m_DrawList(nullptr)
+    , m_AtlasSize(0)
+    , m_NextShelfY(0.0f)
+{
+}
 
-            return false;
-        };
+void ed::ImpostorCache::SetAtlasSize(int size)
+{
+    if (m_AtlasSize == size)
+        return;
 
-        if (accept(m_ContextMenuAction))
-            m_CurrentAction = &m_ContextMenuAction;
-        else if (accept(m_ShortcutAction))
-            m_CurrentAction = &m_ShortcutAction;
-        else if (accept(m_SizeAction))
-            m_CurrentAction = &m_SizeAction;
-        else if (accept(m_DragAction))
-            m_CurrentAction = &m_DragAction;
-        else if (accept(m_SelectAction))
-            m_CurrentAction = &m_SelectAction;
-        else if (accept(m_CreateItemAction))
-            m_CurrentAction = &m_CreateItemAction;
-        else if (accept(m_DeleteItemsAction))
-            m_CurrentAction = &m_DeleteItemsAction;
+    Clear();
+    m_AtlasSize = size;
+}
 
-        if (possibleAction)
-            ImGui::SetMouseCursor(possibleAction->GetCursor());
+ed::ImpostorCache::Entry* ed::ImpostorCache::Find(Node* node)
+{
+    auto entryIt = m_Entries.find(node);
+    if (entryIt == m_Entries.end())
+        return nullptr;
 
-        if (m_CurrentAction && possibleAction)
-            possibleAction->Reject();
+    return &entryIt->second;
+}
+
+ed::ImpostorCache::Entry* ed::ImpostorCache::Allocate(Node* node, const ImVec2& pixelSize, int frame)
+{
+    Remove(node);
+
+    ImRect atlasRect;
+    while (!AllocateRect(pixelSize, atlasRect))
+    {
+        if (!Evict(frame))
+            return nullptr;
     }
 
-    if (m_CurrentAction)
-        ImGui::SetMouseCursor(m_CurrentAction->GetCursor());
+    auto& entry = m_Entries[node];
+    entry.m_AtlasRect     = ImRect(atlasRect.Min, atlasRect.Min + pixelSize);
+    entry.m_Slot          = atlasRect;
+    entry.m_LastUsedFrame = frame;
 
-    // Draw selection rectangle
-    m_SelectAction.Draw(drawList);
+    return &entry;
+}
 
-    bool sortGroups = false;
-    if (control.ActiveNode)
-    {
-        if (!IsGroup(control.ActiveNode))
-        {
-            // Bring active node to front
-            auto activeNodeIt = std::find(m_Nodes.begin(), m_Nodes.end(), control.ActiveNode);
-            std::rotate(activeNodeIt, activeNodeIt + 1, m_Nodes.end());
-        }
-        else if (!isDragging && m_CurrentAction && m_CurrentAction->AsDrag())
-        {
-            // Bring content of dragged group to front
-            std::vector<Node*> nodes;
-            control.ActiveNode->GetGroupedNodes(nodes);
+void ed::ImpostorCache::Remove(Node* node)
+{
+    auto entryIt = m_Entries.find(node);
+    if (entryIt == m_Entries.end())
+        return;
 
-            std::stable_partition(m_Nodes.begin(), m_Nodes.end(), [&nodes](Node* node)
-            {
-                return std::find(nodes.begin(), nodes.end(), node) == nodes.end();
-            });
+    m_FreeRects.push_back(entryIt->second.m_Slot);
+    m_Entries.erase(entryIt);
+
+    // Start over with empty atlas instead of leaving it fragmented.
+    if (m_Entries.empty())
+        Clear();
+}
+
+void ed::ImpostorCache::Clear()
+{
+    m_Entries.clear();
+    m_Shelves.resize(0);
+    m_FreeRects.resize(0);
+    m_NextShelfY = 0.0f;
+}
+
+size_t ed::ImpostorCache::GetMemoryUsage() const
+{
+    return HeapSize(m_Shelves) + HeapSize(m_FreeRects) + HeapSize(m_Entries) + ImDrawList_GetMemoryUsage(m_DrawList);
+}
 
-            sortGroups = true;
+bool ed::ImpostorCache::AllocateRect(const ImVec2& size, ImRect& result)
+{
+    // Best fitting rect of evicted entry.
+    int   bestFree = -1;
+    float bestArea = FLT_MAX;
+    for (int i = 0; i < static_cast<int>(m_FreeRects.size()); ++i)
+    {
+        const auto& rect = m_FreeRects[i];
+        if (rect.GetWidth() < size.x || rect.GetHeight() < size.y)
+            continue;
+
+        const auto area = rect.GetWidth() * rect.GetHeight();
+        if (area < bestArea && area <= size.x * size.y * 2.0f)
+        {
+            bestFree = i;
+            bestArea = area;
         }
     }
 
-    // Sort nodes if bounds of node changed
-    if (sortGroups || ((m_Settings.m_DirtyReason & (SaveReasonFlags::Position | SaveReasonFlags::Size)) != SaveReasonFlags::None))
+    if (bestFree >= 0)
     {
-        // Bring all groups before regular nodes
-        auto groupsItEnd = std::stable_partition(m_Nodes.begin(), m_Nodes.end(), IsGroup);
+        result = m_FreeRects[bestFree];
+        m_FreeRects[bestFree] = m_FreeRects.back();
+        m_FreeRects.pop_back();
+        return true;
+    }
 
-        // Sort groups by area
-        std::sort(m_Nodes.begin(), groupsItEnd, [this](Node* lhs, Node* rhs)
-        {
-            const auto& lhsSize = lhs == m_SizeAction.m_SizedNode ? m_SizeAction.GetStartGroupBounds().GetSize() : lhs->m_GroupBounds.GetSize();
-            const auto& rhsSize = rhs == m_SizeAction.m_SizedNode ? m_SizeAction.GetStartGroupBounds().GetSize() : rhs->m_GroupBounds.GetSize();
+    const auto atlasSize = static_cast<float>(m_AtlasSize);
 
-            const auto lhsArea = lhsSize.x * lhsSize.y;
-            const auto rhsArea = rhsSize.x * rhsSize.y;
+    // Lowest shelf rect fits in, tall shelves are not wasted for short rects.
+    Shelf* bestShelf = nullptr;
+    for (auto& shelf : m_Shelves)
+    {
+        if (shelf.m_Height < size.y || shelf.m_Height > size.y * 1.5f || shelf.m_X + size.x > atlasSize)
+            continue;
 
-            return lhsArea > rhsArea;
-        });
+        if (!bestShelf || shelf.m_Height < bestShelf->m_Height)
+            bestShelf = &shelf;
     }
 
-# if 1
-    // Every node has few channels assigned. Grow channel list
-    // to hold twice as much of channels and place them in
-    // node drawing order.
+    if (!bestShelf && m_NextShelfY + size.y <= atlasSize && size.x <= atlasSize)
     {
-        // Copy group nodes
-        auto liveNodeCount = static_cast<int>(std::count_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return node->m_IsLive; }));
-
-        // Reserve two additional channels for sorted list of channels
-        auto nodeChannelCount = drawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(drawList, drawList->_Splitter._Count + c_ChannelsPerNode * liveNodeCount + c_LinkChannelCount);
+        m_Shelves.push_back(Shelf{ m_NextShelfY, size.y, 0.0f });
+        m_NextShelfY += size.y;
+        bestShelf = &m_Shelves.back();
+    }
 
-        int targetChannel = nodeChannelCount;
+    if (!bestShelf)
+        return false;
 
-        auto copyNode = [&targetChannel, drawList](Node* node)
-        {
-            if (!node->m_IsLive)
-                return;
+    result = ImRect(ImVec2(bestShelf->m_X, bestShelf->m_Y), ImVec2(bestShelf->m_X + size.x, bestShelf->m_Y + bestShelf->m_Height));
+    bestShelf->m_X += size.x;
 
-            for (int i = 0; i < c_ChannelsPerNode; ++i)
-                ImDrawList_SwapChannels(drawList, node->m_Channel + i, targetChannel + i);
+    return true;
+}
 
-            node->m_Channel = targetChannel;
-            targetChannel += c_ChannelsPerNode;
-        };
+bool ed::ImpostorCache::Evict(int frame)
+{
+    // Entries used by current frame are still needed.
+    auto oldestIt = m_Entries.end();
+    for (auto entryIt = m_Entries.begin(), entryEnd = m_Entries.end(); entryIt != entryEnd; ++entryIt)
+    {
+        if (entryIt->second.m_LastUsedFrame >= frame)
+            continue;
 
-        auto groupsItEnd = std::find_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return !IsGroup(node); });
+        if (oldestIt == m_Entries.end() || entryIt->second.m_LastUsedFrame < oldestIt->second.m_LastUsedFrame)
+            oldestIt = entryIt;
+    }
 
-        // Copy group nodes
-        std::for_each(m_Nodes.begin(), groupsItEnd, copyNode);
+    if (oldestIt == m_Entries.end())
+        return false;
 
-        // Copy links
-        for (int i = 0; i < c_LinkChannelCount; ++i, ++targetChannel)
-            ImDrawList_SwapChannels(drawList, c_LinkStartChannel + i, targetChannel);
+    Remove(oldestIt->first);
 
-        // Copy normal nodes
-        std::for_each(groupsItEnd, m_Nodes.end(), copyNode);
-    }
-# endif
+    return true;
+}
 
-    // ImGui::PopClipRect();
 
-    // Draw grid
-# if 1 // #FIXME
-    {
-        //auto& style = ImGui::GetStyle();
 
-        drawList->ChannelsSetCurrent(c_UserChannel_Grid);
 
-        ImVec2 offset    = m_Canvas.ViewOrigin() * (1.0f / m_Canvas.ViewScale());
-        ImU32 GRID_COLOR = GetColor(StyleColor_Grid, ImClamp(m_Canvas.ViewScale() * m_Canvas.ViewScale(), 0.0f, 1.0f));
-        float GRID_SX    = 32.0f;// * m_Canvas.ViewScale();
-        float GRID_SY    = 32.0f;// * m_Canvas.ViewScale();
-        ImVec2 VIEW_POS  = m_Canvas.ViewRect().Min;
-        ImVec2 VIEW_SIZE = m_Canvas.ViewRect().GetSize();
+//------------------------------------------------------------------------------
+//
+// Frame Profiler
+//
+//------------------------------------------------------------------------------
+# if IMGUI_NODE_EDITOR_PROFILER()
+static const char* const c_FramePhaseNames[] =
+{
+    "Frame",
+    "BuildControl",
+    "DrawNodes",
+    "DrawLinks",
+    "ReorderChannels",
+    "MergeChannels",
+    "LeaveLocalSpace",
+    "SaveSettings"
+};
 
-        drawList->AddRectFilled(VIEW_POS, VIEW_POS + VIEW_SIZE, GetColor(StyleColor_Bg));
+static_assert(IM_ARRAYSIZE(c_FramePhaseNames) == static_cast<int>(ed::FramePhase::Count), "Every frame phase needs a name.");
 
-        for (float x = fmodf(offset.x, GRID_SX); x < VIEW_SIZE.x; x += GRID_SX)
-            drawList->AddLine(ImVec2(x, 0.0f) + VIEW_POS, ImVec2(x, VIEW_SIZE.y) + VIEW_POS, GRID_COLOR);
-        for (float y = fmodf(offset.y, GRID_SY); y < VIEW_SIZE.y; y += GRID_SY)
-            drawList->AddLine(ImVec2(0.0f, y) + VIEW_POS, ImVec2(VIEW_SIZE.x, y) + VIEW_POS, GRID_COLOR);
-    }
-# endif
+ed::FrameProfiler::FrameProfiler():
+    m_Samples(),
+    m_Current(),
+    m_SampleCount(0),
+    m_NextSample(0),
+    m_FrameStart()
+{
+}
 
-# if 0
-    {
-        auto userChannel = drawList->_Splitter._Count;
-        auto channelsToCopy = c_UserLayersCount;
-        ImDrawList_ChannelsGrow(drawList, userChannel + channelsToCopy);
-        for (int i = 0; i < channelsToCopy; ++i)
-            ImDrawList_SwapChannels(drawList, userChannel + i, c_UserLayerChannelStart + i);
-    }
-# endif
+void ed::FrameProfiler::BeginFrame()
+{
+    for (auto& current : m_Current)
+        current = 0.0f;
 
-# if 0
-    {
-        auto preOffset  = ImVec2(0, 0);
-        auto postOffset = m_OldCanvas.WindowScreenPos + m_OldCanvas.ClientOrigin;
-        auto scale      = m_OldCanvas.Zoom;
+    m_FrameStart = Now();
+}
 
-        ImDrawList_TransformChannels(drawList,                        0,                            1, preOffset, scale, postOffset);
-        ImDrawList_TransformChannels(drawList, c_BackgroundChannelStart, drawList->_ChannelsCount - 1, preOffset, scale, postOffset);
+void ed::FrameProfiler::EndFrame()
+{
+    Add(FramePhase::Frame, Elapsed(m_FrameStart));
 
-        auto clipTranslation = m_OldCanvas.WindowScreenPos - m_OldCanvas.FromScreen(m_OldCanvas.WindowScreenPos);
-        ImGui::PushClipRect(m_OldCanvas.WindowScreenPos + ImVec2(1, 1), m_OldCanvas.WindowScreenPos + m_OldCanvas.WindowScreenSize - ImVec2(1, 1), false);
-        ImDrawList_TranslateAndClampClipRects(drawList,                        0,                            1, clipTranslation);
-        ImDrawList_TranslateAndClampClipRects(drawList, c_BackgroundChannelStart, drawList->_ChannelsCount - 1, clipTranslation);
-        ImGui::PopClipRect();
+    for (int i = 0; i < c_PhaseCount; ++i)
+        m_Samples[i][m_NextSample] = m_Current[i];
 
-        // #debug: Static grid in local space
-        //for (float x = 0; x < Canvas.WindowScreenSize.x; x += 100)
-        //    drawList->AddLine(ImVec2(x, 0.0f) + Canvas.WindowScreenPos, ImVec2(x, Canvas.WindowScreenSize.y) + Canvas.WindowScreenPos, IM_COL32(255, 0, 0, 128));
-        //for (float y = 0; y < Canvas.WindowScreenSize.y; y += 100)
-        //    drawList->AddLine(ImVec2(0.0f, y) + Canvas.WindowScreenPos, ImVec2(Canvas.WindowScreenSize.x, y) + Canvas.WindowScreenPos, IM_COL32(255, 0, 0, 128));
-    }
-# endif
+    m_NextSample = (m_NextSample + 1) % FrameStats::SampleCount;
+    if (m_SampleCount < FrameStats::SampleCount)
+        ++m_SampleCount;
+}
 
-# if 1
-    // Move user and hint channels to top
-    {
-        // Clip plane is transformed to global space.
-        // These channels already have clip planes in global space, so
-        // we move them to clip plane. Batch transformation in canvas
-        // will bring them back to global space.
-        auto preTransformClipRect = [this, drawList](int channelIndex)
-        {
-            ImDrawChannel& channel = drawList->_Splitter._Channels[channelIndex];
-            for (ImDrawCmd& cmd : channel._CmdBuffer)
-            {
-                auto a = ToCanvas(ImVec2(cmd.ClipRect.x, cmd.ClipRect.y));
-                auto b = ToCanvas(ImVec2(cmd.ClipRect.z, cmd.ClipRect.w));
-                cmd.ClipRect = ImVec4(a.x, a.y, b.x, b.y);
-            }
-        };
+ed::FramePhaseTiming ed::FrameProfiler::GetTiming(FramePhase phase) const
+{
+    FramePhaseTiming timing = {};
+    if (m_SampleCount == 0)
+        return timing;
 
-        drawList->ChannelsSetCurrent(0);
+    const auto& samples = m_Samples[static_cast<int>(phase)];
 
-        auto channelCount = drawList->_Splitter._Count;
-        ImDrawList_ChannelsGrow(drawList, channelCount + 3);
-        ImDrawList_SwapChannels(drawList, c_UserChannel_HintsBackground, channelCount + 0);
-        ImDrawList_SwapChannels(drawList, c_UserChannel_Hints,           channelCount + 1);
-        ImDrawList_SwapChannels(drawList, c_UserChannel_Content,         channelCount + 2);
+    const auto last = (m_NextSample + FrameStats::SampleCount - 1) % FrameStats::SampleCount;
+    timing.Last = samples[last];
+    timing.Min  = samples[last];
+    timing.Max  = samples[last];
 
-        preTransformClipRect(channelCount + 0);
-        preTransformClipRect(channelCount + 1);
-        preTransformClipRect(channelCount + 2);
+    auto sum = 0.0f;
+    for (int i = 0; i < m_SampleCount; ++i)
+    {
+        timing.Min = ImMin(timing.Min, samples[i]);
+        timing.Max = ImMax(timing.Max, samples[i]);
+        sum += samples[i];
     }
+    timing.Average = sum / m_SampleCount;
+
+    return timing;
+}
+# else
+ed::FramePhaseTiming ed::FrameProfiler::GetTiming(FramePhase phase) const
+{
+    IM_UNUSED(phase);
+
+    return FramePhaseTiming{};
+}
 # endif
 
-    UpdateAnimations();
 
-    drawList->ChannelsMerge();
 
-    // #debug
-    // drawList->AddRectFilled(ImVec2(-10.0f, -10.0f), ImVec2(10.0f, 10.0f), IM_COL32(255, 0, 255, 255));
 
-    // ImGui::EndChild();
-    // ImGui::PopStyleColor();
-    if (m_IsCanvasVisible)
-        m_Canvas.End();
+//------------------------------------------------------------------------------
+//
+// Quality Governor
+//
+//------------------------------------------------------------------------------
+static const ed::QualityLevel c_QualityLevels[] =
+{
+    // tessellation, flow stride, hover interval, reduced zoom, overview zoom
+    { 1.0f, 1, 1, 0.0f,  0.0f  },
+    { 2.0f, 1, 2, 0.3f,  0.0f  },
+    { 4.0f, 2, 4, 0.45f, 0.15f },
+    { 8.0f, 4, 8, 0.6f,  0.25f },
+};
 
-    ImDrawList_SwapSplitter(drawList, m_Splitter);
+static const int   c_QualityLevelCount         = IM_ARRAYSIZE(c_QualityLevels);
+static const int   c_FlowMarkerPeriod          = 4;     // multiple of every flow stride, offset wraps after that many markers
+static const int   c_QualityStepDownFrames     = 15;    // frames over budget before quality is lowered
+static const int   c_QualityStepUpFrames       = 120;   // frames under headroom before quality is raised
+static const float c_QualityHeadroom           = 0.5f;  // fraction of budget frame has to fit in to raise quality
+static const float c_QualityFrameTimeSmoothing = 0.1f;  // weight of the last frame in smoothed time
 
-    // Draw border
+ed::QualityGovernor::QualityGovernor()
+    : m_Level(0)
+    , m_FrameTime(0.0f)
+    , m_OverBudgetFrames(0)
+    , m_UnderBudgetFrames(0)
+    , m_FrameStart()
+{
+}
+
+void ed::QualityGovernor::EndFrame(float budget)
+{
+    const auto elapsed = std::chrono::duration<float, std::milli>(Clock::now() - m_FrameStart).count();
+    m_FrameTime = m_FrameTime > 0.0f ? ImLerp(m_FrameTime, elapsed, c_QualityFrameTimeSmoothing) : elapsed;
+
+    if (budget <= 0.0f)
     {
-        auto& style = ImGui::GetStyle();
-        auto borderShadoColor = style.Colors[ImGuiCol_BorderShadow];
-        auto borderColor = style.Colors[ImGuiCol_Border];
-        drawList->AddRect(m_Canvas.Rect().Min + ImVec2(1, 1), m_Canvas.Rect().Max - ImVec2(1, 1), ImColor(borderShadoColor));
-        drawList->AddRect(m_Canvas.Rect().Min, m_Canvas.Rect().Max, ImColor(borderColor));
+        m_Level             = 0;
+        m_OverBudgetFrames  = 0;
+        m_UnderBudgetFrames = 0;
+        return;
     }
 
-    // ShowMetrics(control);
+    if (m_FrameTime > budget)
+    {
+        m_UnderBudgetFrames = 0;
+        if (++m_OverBudgetFrames >= c_QualityStepDownFrames && m_Level < c_QualityLevelCount - 1)
+        {
+            ++m_Level;
+            m_OverBudgetFrames = 0;
+        }
+    }
+    else if (m_FrameTime < budget * c_QualityHeadroom)
+    {
+        m_OverBudgetFrames = 0;
+        if (++m_UnderBudgetFrames >= c_QualityStepUpFrames && m_Level > 0)
+        {
+            --m_Level;
+            m_UnderBudgetFrames = 0;
+        }
+    }
+    else
+    {
+        m_OverBudgetFrames  = 0;
+        m_UnderBudgetFrames = 0;
+    }
+}
 
-    ImGui::PopID();
+const ed::QualityLevel& ed::QualityGovernor::GetQuality() const
+{
+    return c_QualityLevels[m_Level];
+}
 
-    if (!m_CurrentAction && m_IsFirstFrame && !m_Settings.m_Selection.empty())
+
+
+
+//------------------------------------------------------------------------------
+//
+// Auto Layout
+//
+//------------------------------------------------------------------------------
+// Layered layout in the spirit of Sugiyama: links closing cycles are reversed,
+// nodes are put in column of longest path leading to them and ordered inside
+// columns by barycenters of their neighbors. Links spanning several columns
+// are not split into dummy nodes, their neighbors are weighted by relative
+// position in own column instead.
+static void LayoutLayered(ed::LayoutGraph& graph, const ax::NodeEditor::LayoutConfig& config, const std::atomic<bool>& cancel)
+{
+    const auto nodeCount = static_cast<int>(graph.m_Nodes.size());
+
+    // Adjacency in compressed rows, outgoing first then incoming.
+    auto buildRows = [nodeCount](const ed::vector<std::pair<int, int>>& edges, bool outgoing, ed::vector<int>& start, ed::vector<int>& list)
+    {
+        start.assign(nodeCount + 1, 0);
+        for (auto& edge : edges)
+            ++start[(outgoing ? edge.first : edge.second) + 1];
+        for (int i = 0; i < nodeCount; ++i)
+            start[i + 1] += start[i];
+
+        list.resize(edges.size());
+        auto fill = start;
+        for (auto& edge : edges)
+        {
+            const auto from = outgoing ? edge.first : edge.second;
+            list[fill[from]++] = outgoing ? edge.second : edge.first;
+        }
+    };
+
+    ed::vector<int> outStart, outList;
+    buildRows(graph.m_Edges, true, outStart, outList);
+
+    // Iterative depth first search, edges to nodes still on stack close cycles.
+    ed::vector<std::pair<int, int>> edges;
+    edges.reserve(graph.m_Edges.size());
     {
-        ClearSelection();
-        for (auto id : m_Settings.m_Selection)
-            if (auto object = FindObject(id))
-                SelectObject(object);
+        ed::vector<uint8_t> state(nodeCount, 0); // 0 - new, 1 - on stack, 2 - done
+        ed::vector<std::pair<int, int>> stack;   // node, next outgoing edge
+        for (int root = 0; root < nodeCount; ++root)
+        {
+            if (state[root] != 0)
+                continue;
+
+            state[root] = 1;
+            stack.emplace_back(root, outStart[root]);
+            while (!stack.empty())
+            {
+                auto& top = stack.back();
+                if (top.second == outStart[top.first + 1])
+                {
+                    state[top.first] = 2;
+                    stack.pop_back();
+                    continue;
+                }
+
+                const auto from = top.first;
+                const auto to   = outList[top.second++];
+                if (from == to)
+                    continue;
+
+                if (state[to] == 1)
+                    edges.emplace_back(to, from);
+                else
+                {
+                    edges.emplace_back(from, to);
+                    if (state[to] == 0)
+                    {
+                        state[to] = 1;
+                        stack.emplace_back(to, outStart[to]);
+                    }
+                }
+            }
+        }
     }
 
-    if (HasSelectionChanged())
-        MakeDirty(SaveReasonFlags::Selection);
+    if (cancel)
+        return;
 
-    if (m_Settings.m_IsDirty && !m_CurrentAction)
-        SaveSettings();
+    ed::vector<int> inStart, inList;
+    buildRows(edges, true, outStart, outList);
+    buildRows(edges, false, inStart, inList);
 
-    m_IsFirstFrame = false;
-}
+    // Longest path layering in topological order.
+    ed::vector<int> layer(nodeCount, 0);
+    {
+        ed::vector<int> pending(nodeCount);
+        ed::vector<int> ready;
+        ready.reserve(nodeCount);
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            pending[i] = inStart[i + 1] - inStart[i];
+            if (pending[i] == 0)
+                ready.push_back(i);
+        }
 
-bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness)
-{
-    //auto& editorStyle = GetStyle();
+        for (size_t i = 0; i < ready.size(); ++i)
+        {
+            const auto node = ready[i];
+            for (int e = outStart[node]; e < outStart[node + 1]; ++e)
+            {
+                const auto next = outList[e];
+                layer[next] = ImMax(layer[next], layer[node] + 1);
+                if (--pending[next] == 0)
+                    ready.push_back(next);
+            }
+        }
+    }
 
-    auto startPin = FindPin(startPinId);
-    auto endPin   = FindPin(endPinId);
+    const auto layerCount = nodeCount > 0 ? *std::max_element(layer.begin(), layer.end()) + 1 : 0;
 
-    if (!startPin || !startPin->m_IsLive || !endPin || !endPin->m_IsLive)
-        return false;
+    // Columns start in order of current vertical position.
+    ed::vector<int> order(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) { return graph.m_Positions[lhs].y < graph.m_Positions[rhs].y; });
 
-    startPin->m_HasConnection = true;
-      endPin->m_HasConnection = true;
+    ed::vector<ed::vector<int>> layers(layerCount);
+    for (auto node : order)
+        layers[layer[node]].push_back(node);
 
-    auto link           = GetLink(id);
-    link->m_StartPin      = startPin;
-    link->m_EndPin        = endPin;
-    link->m_Color         = color;
-    link->m_Thickness     = thickness;
-    link->m_IsLive        = true;
+    // Relative position of node in its column, 0 to 1.
+    ed::vector<float> rank(nodeCount, 0.0f);
+    auto updateRanks = [&](const ed::vector<int>& nodes)
+    {
+        const auto scale = 1.0f / ImMax(1, static_cast<int>(nodes.size()) - 1);
+        for (size_t i = 0; i < nodes.size(); ++i)
+            rank[nodes[i]] = i * scale;
+    };
+    for (auto& nodes : layers)
+        updateRanks(nodes);
 
-    link->UpdateEndpoints();
+    ed::vector<float> barycenter(nodeCount, 0.0f);
+    auto sweep = [&](int layerIndex, const ed::vector<int>& start, const ed::vector<int>& list)
+    {
+        auto& nodes = layers[layerIndex];
+        for (auto node : nodes)
+        {
+            const auto begin = start[node], end = start[node + 1];
+            if (begin == end)
+            {
+                barycenter[node] = rank[node];
+                continue;
+            }
 
-    return true;
-}
+            auto sum = 0.0f;
+            for (int e = begin; e < end; ++e)
+                sum += rank[list[e]];
+            barycenter[node] = sum / (end - begin);
+        }
 
-void ed::EditorContext::SetNodePosition(NodeId nodeId, const ImVec2& position)
-{
-    auto node = FindNode(nodeId);
-    if (!node)
+        std::stable_sort(nodes.begin(), nodes.end(), [&](int lhs, int rhs) { return barycenter[lhs] < barycenter[rhs]; });
+        updateRanks(nodes);
+    };
+
+    for (int pass = 0; pass < 4 && !cancel; ++pass)
     {
-        node = CreateNode(nodeId);
-        node->m_IsLive = false;
+        for (int i = 1; i < layerCount; ++i)
+            sweep(i, inStart, inList);
+        for (int i = layerCount - 2; i >= 0; --i)
+            sweep(i, outStart, outList);
     }
 
-    if (node->m_Bounds.Min != position)
+    if (cancel)
+        return;
+
+    // Columns are as wide as their widest node, nodes are centered vertically.
+    auto x = 0.0f;
+    for (auto& nodes : layers)
     {
-        node->m_Bounds.Translate(position - node->m_Bounds.Min);
-        node->m_Bounds.Floor();
-        MakeDirty(NodeEditor::SaveReasonFlags::Position, node);
+        auto width  = 0.0f;
+        auto height = 0.0f;
+        for (auto node : nodes)
+        {
+            width   = ImMax(width, graph.m_Sizes[node].x);
+            height += graph.m_Sizes[node].y;
+        }
+        height += config.Spacing.y * ImMax(0, static_cast<int>(nodes.size()) - 1);
+
+        auto y = -0.5f * height;
+        for (auto node : nodes)
+        {
+            graph.m_Positions[node] = ImVec2(x, y);
+            y += graph.m_Sizes[node].y + config.Spacing.y;
+        }
+
+        x += width + config.Spacing.x;
     }
 }
 
-ImVec2 ed::EditorContext::GetNodePosition(NodeId nodeId)
+// Fruchterman-Reingold with repulsion limited to nodes in neighboring grid
+// cells, which keeps iteration close to linear in number of nodes.
+static void LayoutForceDirected(ed::LayoutGraph& graph, const ax::NodeEditor::LayoutConfig& config, const std::atomic<bool>& cancel)
 {
-    auto node = FindNode(nodeId);
-    if (!node)
-        return ImVec2(FLT_MAX, FLT_MAX);
+    const auto nodeCount = static_cast<int>(graph.m_Nodes.size());
+    if (nodeCount == 0)
+        return;
 
-    return node->m_Bounds.Min;
-}
+    auto averageSize = ImVec2(0, 0);
+    for (auto& size : graph.m_Sizes)
+        averageSize += size;
+    averageSize = averageSize * (1.0f / nodeCount);
 
-ImVec2 ed::EditorContext::GetNodeSize(NodeId nodeId)
-{
-    auto node = FindNode(nodeId);
-    if (!node)
-        return ImVec2(0, 0);
+    const auto length = ImMax(1.0f, config.Spacing.x + ImMax(averageSize.x, averageSize.y));
+    const auto range  = 2.0f * length;
 
-    return node->m_Bounds.GetSize();
-}
+    ed::vector<ImVec2> center(nodeCount);
+    ImRect extent(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        center[i] = graph.m_Positions[i] + graph.m_Sizes[i] * 0.5f;
+        extent.Add(center[i]);
+    }
 
-void ed::EditorContext::MarkNodeToRestoreState(Node* node)
-{
-    node->m_RestoreState = true;
-}
+    // Graphs without positions start from a spiral, coinciding nodes would
+    // never be pushed apart.
+    if (extent.GetWidth() < length && extent.GetHeight() < length)
+    {
+        const auto goldenAngle = 2.39996323f;
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            const auto radius = length * 0.5f * ImSqrt(static_cast<float>(i));
+            center[i] = ImVec2(radius * ImCos(i * goldenAngle), radius * ImSin(i * goldenAngle));
+        }
+    }
 
-void ed::EditorContext::RestoreNodeState(Node* node)
-{
-    auto settings = m_Settings.FindNode(node->m_ID);
-    if (!settings)
-        return;
+    ed::vector<ImVec2> displacement(nodeCount);
+    ed::vector<std::pair<uint64_t, int>> cells(nodeCount);
 
-    // Load state from config (if possible)
-    if (!NodeSettings::Parse(m_Config.LoadNode(node->m_ID), *settings))
-        return;
+    auto cellKey = [](int x, int y)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    };
 
-    node->m_Bounds.Min      = settings->m_Location;
-    node->m_Bounds.Max      = node->m_Bounds.Min + settings->m_Size;
-    node->m_Bounds.Floor();
-    node->m_GroupBounds.Min = settings->m_Location;
-    node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings->m_GroupSize;
-    node->m_GroupBounds.Floor();
-}
+    const auto iterations = ImMax(1, config.Iterations);
+    for (int iteration = 0; iteration < iterations && !cancel; ++iteration)
+    {
+        const auto temperature = length * 0.1f * ImSqrt(static_cast<float>(nodeCount)) * (1.0f - static_cast<float>(iteration) / iterations);
 
-void ed::EditorContext::ClearSelection()
-{
-    m_SelectedObjects.clear();
-}
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            const auto cx = static_cast<int>(ImFloor(center[i].x / range));
+            const auto cy = static_cast<int>(ImFloor(center[i].y / range));
+            cells[i] = std::make_pair(cellKey(cx, cy), i);
+        }
+        std::sort(cells.begin(), cells.end());
 
-void ed::EditorContext::SelectObject(Object* object)
-{
-    m_SelectedObjects.push_back(object);
-}
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            auto force = ImVec2(0, 0);
 
-void ed::EditorContext::DeselectObject(Object* object)
-{
-    auto objectIt = std::find(m_SelectedObjects.begin(), m_SelectedObjects.end(), object);
-    if (objectIt != m_SelectedObjects.end())
-        m_SelectedObjects.erase(objectIt);
-}
+            const auto cx = static_cast<int>(ImFloor(center[i].x / range));
+            const auto cy = static_cast<int>(ImFloor(center[i].y / range));
+            for (int y = cy - 1; y <= cy + 1; ++y)
+            {
+                for (int x = cx - 1; x <= cx + 1; ++x)
+                {
+                    const auto key = std::make_pair(cellKey(x, y), 0);
+                    for (auto it = std::lower_bound(cells.begin(), cells.end(), key); it != cells.end() && it->first == key.first; ++it)
+                    {
+                        if (it->second == i)
+                            continue;
+
+                        auto delta = center[i] - center[it->second];
+                        auto distanceSq = ImLengthSqr(delta);
+                        if (distanceSq >= range * range)
+                            continue;
+                        if (distanceSq < 0.01f)
+                        {
+                            // Push coinciding nodes apart in direction depending on their order.
+                            delta = ImVec2(i < it->second ? -0.1f : 0.1f, 0.0f);
+                            distanceSq = 0.01f;
+                        }
+
+                        force += delta * (length * length / distanceSq);
+                    }
+                }
+            }
 
-void ed::EditorContext::SetSelectedObject(Object* object)
-{
-    ClearSelection();
-    SelectObject(object);
-}
+            displacement[i] = force;
+        }
 
-void ed::EditorContext::ToggleObjectSelection(Object* object)
-{
-    if (IsSelected(object))
-        DeselectObject(object);
-    else
-        SelectObject(object);
+        for (auto& edge : graph.m_Edges)
+        {
+            const auto delta    = center[edge.second] - center[edge.first];
+            const auto distance = ImSqrt(ImLengthSqr(delta));
+            const auto pull     = delta * (distance / length);
+            displacement[edge.first]  += pull;
+            displacement[edge.second] -= pull;
+        }
+
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            const auto distance = ImSqrt(ImLengthSqr(displacement[i]));
+            if (distance > 0.0f)
+                center[i] += displacement[i] * (ImMin(distance, temperature) / distance);
+        }
+    }
+
+    for (int i = 0; i < nodeCount; ++i)
+        graph.m_Positions[i] = center[i] - graph.m_Sizes[i] * 0.5f;
 }
 
-bool ed::EditorContext::IsSelected(Object* object)
+// Computes layout on its own thread. Result is read by editor once done.
+struct ed::LayoutJob
 {
-    return std::find(m_SelectedObjects.begin(), m_SelectedObjects.end(), object) != m_SelectedObjects.end();
-}
+    LayoutJob(LayoutGraph graph, const LayoutConfig& config)
+        : m_Graph(std::move(graph))
+        , m_Config(config)
+        , m_IsDone(false)
+        , m_Cancel(false)
+    {
+        m_Thread = std::thread([this]() { Run(); });
+    }
 
-const ed::vector<ed::Object*>& ed::EditorContext::GetSelectedObjects()
+    ~LayoutJob()
+    {
+        m_Cancel = true;
+        m_Thread.join();
+    }
+
+    bool IsDone() const { return m_IsDone; }
+
+    // Valid when done.
+    LayoutGraph& GetResult() { return m_Graph; }
+
+private:
+    void Run()
+    {
+        // Graph keeps top left corner it had.
+        ImVec2 origin(FLT_MAX, FLT_MAX);
+        for (auto& position : m_Graph.m_Positions)
+            origin = ImMin(origin, position);
+
+        if (m_Config.Algorithm == LayoutAlgorithm::ForceDirected)
+            LayoutForceDirected(m_Graph, m_Config, m_Cancel);
+        else
+            LayoutLayered(m_Graph, m_Config, m_Cancel);
+
+        ImVec2 min(FLT_MAX, FLT_MAX);
+        for (auto& position : m_Graph.m_Positions)
+            min = ImMin(min, position);
+
+        const auto offset = origin - min;
+        for (auto& position : m_Graph.m_Positions)
+            position = ImFloor(position + offset);
+
+        m_IsDone = true;
+    }
+
+    LayoutGraph       m_Graph;
+    LayoutConfig      m_Config;
+    std::atomic<bool> m_IsDone;
+    std::atomic<bool> m_Cancel;
+    std::thread       m_Thread;
+};
+
+ed::LayoutEngine::LayoutEngine()
+    : m_NextNode(0)
 {
-    return m_SelectedObjects;
 }
 
-bool ed::EditorContext::IsAnyNodeSelected()
+ed::LayoutEngine::~LayoutEngine()
 {
-    for (auto object : m_SelectedObjects)
-        if (object->AsNode())
-            return true;
-
-    return false;
 }
 
-bool ed::EditorContext::IsAnyLinkSelected()
+void ed::LayoutEngine::Start(LayoutGraph graph, const LayoutConfig& config)
 {
-    for (auto object : m_SelectedObjects)
-        if (object->AsLink())
-            return true;
+    Cancel();
 
-    return false;
+    m_Config = config;
+    m_Job.reset(new LayoutJob(std::move(graph), config));
 }
 
-bool ed::EditorContext::HasSelectionChanged()
+void ed::LayoutEngine::Cancel()
 {
-    return m_LastSelectedObjects != m_SelectedObjects;
+    m_Job.reset();
+    m_Result = LayoutGraph();
+    m_NextNode = 0;
+    m_Moves.resize(0);
 }
 
-ed::Node* ed::EditorContext::FindNodeAt(const ImVec2& p)
+void ed::LayoutEngine::Update(EditorContext* editor)
 {
-    for (auto node : m_Nodes)
-        if (node->TestHit(p))
-            return node;
-
-    return nullptr;
-}
+    if (m_Job)
+    {
+        if (!m_Job->IsDone())
+            return;
 
-void ed::EditorContext::FindNodesInRect(const ImRect& r, vector<Node*>& result, bool append, bool includeIntersecting)
-{
-    if (!append)
-        result.resize(0);
+        m_Result = std::move(m_Job->GetResult());
+        m_Job.reset();
+        m_NextNode = 0;
+    }
 
-    if (ImRect_IsEmpty(r))
-        return;
+    m_BatchNodes.resize(0);
+    m_BatchPositions.resize(0);
 
-    for (auto node : m_Nodes)
-        if (node->TestHit(r, includeIntersecting))
-            result.push_back(node);
-}
+    // Every moved node costs its links full update, nodes still animating
+    // count against the batch.
+    const auto duration  = m_Config.AnimationDuration;
+    const auto nodeCount = static_cast<int>(m_Result.m_Nodes.size());
+    const auto batchEnd  = m_Config.NodesPerFrame > 0
+        ? ImMin(nodeCount, m_NextNode + ImMax(0, m_Config.NodesPerFrame - static_cast<int>(m_Moves.size())))
+        : nodeCount;
 
-void ed::EditorContext::FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append)
+    // Nodes deleted since layout started are skipped.
+    for (; m_NextNode < batchEnd; ++m_NextNode)
+    {
+        const auto id   = m_Result.m_Nodes[m_NextNode];
+        const auto node = editor->FindNode(id);
+        if (!node || !node->IsLive())
+            continue;
+
+        const auto target = m_Result.m_Positions[m_NextNode];
+        if (duration > 0.0f)
+        {
+            Move move;
+            move.m_ID   = id;
+            move.m_From = node->m_Bounds.Min;
+            move.m_To   = target;
+            move.m_Time = 0.0f;
+            m_Moves.push_back(move);
+        }
+        else
+        {
+            m_BatchNodes.push_back(id);
+            m_BatchPositions.push_back(target);
+        }
+    }
+
+    if (m_NextNode >= nodeCount)
+        m_Result = LayoutGraph();
+
+    // Every batch eases from the frame it started in, like NavigateAnimation.
+    const auto deltaTime = ImMax(0.0f, ImGui::GetIO().DeltaTime);
+    for (size_t i = 0; i < m_Moves.size(); )
+    {
+        auto& move = m_Moves[i];
+        move.m_Time += deltaTime;
+
+        const auto progress = ImMin(1.0f, move.m_Time / duration);
+        m_BatchNodes.push_back(move.m_ID);
+        m_BatchPositions.push_back(ImFloor(ImEasing::EaseOutQuad(move.m_From, move.m_To - move.m_From, progress)));
+
+        if (progress >= 1.0f)
+        {
+            move = m_Moves.back();
+            m_Moves.pop_back();
+        }
+        else
+            ++i;
+    }
+
+    if (m_BatchNodes.empty())
+        return;
+
+    // Layout is not replayed, nodes are moved by recorded positions instead.
+    if (auto recorder = editor->GetTraceRecorder())
+        for (size_t i = 0; i < m_BatchNodes.size(); ++i)
+            recorder->SetNodePosition(m_BatchNodes[i], m_BatchPositions[i]);
+
+    editor->SetNodePositions(m_BatchNodes.data(), m_BatchPositions.data(), static_cast<int>(m_BatchNodes.size()));
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Editor Context
+//
+//------------------------------------------------------------------------------
+ed::EditorContext::EditorContext(const ax::NodeEditor::Config* config)
+    : m_IsFirstFrame(true)
+    , m_IsWindowActive(false)
+    , m_IsHibernated(false)
+    , m_ShortcutsEnabled(true)
+    , m_Style()
+    , m_StyleColors()
+    , m_StyleColorsGeneration(-1)
+    , m_Nodes()
+    , m_Pins()
+    , m_Links()
+    , m_NodeMap()
+    , m_PinMap()
+    , m_LinkMap()
+    , m_IsPinOrderDirty(false)
+    , m_IsLinkOrderDirty(false)
+    , m_NodeIndex()
+    , m_LinkIndex()
+    , m_QueryResult()
+    , m_IsNodeOrderDirty(true)
+    , m_IsNodeStateOrderDirty(false)
+    , m_IsNodeLayerDirty(false)
+    , m_Groups()
+    , m_GroupedStamp(0)
+    , m_DraggedNodes()
+    , m_ContentBounds()
+    , m_IsContentBoundsValid(false)
+    , m_ContentBoundsFrame(0)
+    , m_SelectionBounds()
+    , m_IsSelectionBoundsValid(false)
+    , m_SelectionBoundsFrame(0)
+    , m_SelectionBoundsGeneration(0)
+    , m_SelectionChangeCount(0)
+    , m_SelectionId(1)
+    , m_LastActiveLink(nullptr)
+    , m_LastActiveObject(nullptr)
+    , m_LastActiveRegion(NodeRegion::None)
+    , m_GeometryGeneration(0)
+    , m_SubmitHash(0)
+    , m_LastSubmitHash(0)
+    , m_LastViewRect()
+    , m_HoverCache()
+    , m_Minimap()
+    , m_Profiler()
+    , m_FrameFirstVertex(0)
+    , m_FrameFirstIndex(0)
+    , m_FrameFirstCommand(0)
+    , m_FrameStats()
+    , m_NeedsRedraw(true)
+    , m_LastFrameGeneration(0)
+    , m_LastHotObject(nullptr)
+    , m_Canvas()
+    , m_IsCanvasVisible(false)
+    , m_LOD(LevelOfDetail::Full)
+    , m_Impostors()
+    , m_UseImpostors(false)
+    , m_RenderImpostors(false)
+    , m_LastZoom(0.0f)
+    , m_FrameIndex(0)
+    , m_NodeBuilder(this)
+    , m_HintBuilder(this)
+    , m_CurrentAction(nullptr)
+    , m_NavigateAction(this, m_Canvas)
+    , m_SizeAction(this)
+    , m_DragAction(this)
+    , m_SelectAction(this)
+    , m_ContextMenuAction(this)
+    , m_ShortcutAction(this)
+    , m_CreateItemAction(this)
+    , m_DeleteItemsAction(this)
+    , m_AnimationControllers{ &m_FlowAnimationController }
+    , m_FlowAnimationController(this)
+    , m_DoubleClickedNode(0)
+    , m_DoubleClickedPin(0)
+    , m_DoubleClickedLink(0)
+    , m_BackgroundClicked(false)
+    , m_BackgroundDoubleClicked(false)
+    , m_IsInitialized(false)
+    , m_Settings()
+    , m_Config(config)
+    , m_ExternalChannel(0)
 {
-    if (!append)
-        result.resize(0);
+}
 
-    if (ImRect_IsEmpty(r))
+ed::EditorContext::~EditorContext()
+{
+    if (m_IsInitialized)
+        SaveSettings();
+
+    m_Config.Flush();
+
+    m_LinkPool.Clear();
+    m_PinPool.Clear();
+    m_NodePool.Clear();
+
+    m_Splitter.ClearFreeMemory();
+}
+
+void ed::EditorContext::Hibernate()
+{
+    if (m_IsHibernated)
         return;
 
+    TrimMemory();
+
+    // On top of trimming, caches of live objects go too.
     for (auto link : m_Links)
-        if (link->TestHit(r))
-            result.push_back(link);
+        link->ClearGeometry();
+
+    m_Impostors.m_DrawList.ClearFreeMemory();
+
+    m_Minimap.m_HasKey = false;
+    vector<ImRect>().swap(m_Minimap.m_Bounds);
+    vector<ImDrawVert>().swap(m_Minimap.m_Vertices);
+
+    m_IsHibernated = true;
 }
 
-void ed::EditorContext::FindLinksForNode(NodeId nodeId, vector<Link*>& result, bool add)
+void ed::EditorContext::TrimMemory()
 {
-    if (!add)
-        result.clear();
+    // Nothing pending is left behind.
+    if (m_Settings.m_IsDirty && !m_CurrentAction)
+        SaveSettings();
+
+    // Channels, including ones of every node, are split again by Begin().
+    m_Splitter.ClearFreeMemory();
+    m_NodeBuilder.ClearFreeMemory();
+    m_Canvas.ClearFreeMemory();
+
+    vector<Object*>().swap(m_QueryResult);
+    vector<Link*>().swap(m_QueryLinks);
+    vector<ImCubicBezierPoints>().swap(m_QueryCurves);
+    vector<ImProjectResult>().swap(m_QueryProjections);
+    vector<Link*>().swap(m_StaleLinks);
+    vector<LinkGeometryChunk>().swap(m_LinkGeometryChunks);
+    vector<LinkGeometryRange>().swap(m_LinkGeometryRanges);
+    vector<int>().swap(m_DrawOrder);
+
+    m_SelectAction.ClearFreeMemory();
+    m_DeleteItemsAction.ClearFreeMemory();
+    m_FlowAnimationController.ClearFreeMemory();
+
+    for (auto link : m_Links)
+        if (!link->IsLive())
+            link->ClearGeometry();
+
+    // Records of deleted nodes are useless, unless they wait to be saved.
+    // Node which comes back gets new one.
+    m_Settings.RemoveNodes([this](const NodeSettings& settings)
+    {
+        auto node = FindNode(settings.m_ID);
+        return node && node->m_IsForgotten && !node->IsLive() && !settings.m_IsDirty;
+    });
+
+    // Objects stay, so editor keeps its state. Object pools are not
+    // trimmed, only lookup tables and lists are shrunk.
+    m_NodeMap.Compact();
+    m_PinMap.Compact();
+    m_LinkMap.Compact();
+    m_Nodes.shrink_to_fit();
+    m_Pins.shrink_to_fit();
+    m_Links.shrink_to_fit();
+    m_NodeStates.ShrinkToFit();
+    m_PinStates.ShrinkToFit();
+    m_LinkStates.ShrinkToFit();
+}
+
+ed::MemoryStats ed::EditorContext::GetMemoryStats() const
+{
+    MemoryStats stats;
+
+    stats.Objects = m_NodePool.GetMemoryUsage()
+        + m_PinPool.GetMemoryUsage()
+        + m_LinkPool.GetMemoryUsage()
+        + m_NodeMap.GetMemoryUsage()
+        + m_PinMap.GetMemoryUsage()
+        + m_LinkMap.GetMemoryUsage()
+        + m_NodeStates.GetMemoryUsage()
+        + m_PinStates.GetMemoryUsage()
+        + m_LinkStates.GetMemoryUsage()
+        + HeapSize(m_Nodes)
+        + HeapSize(m_Pins)
+        + HeapSize(m_Links)
+        + HeapSize(m_Groups)
+        + HeapSize(m_SelectedObjects)
+        + HeapSize(m_SelectionChangedObjects);
+
+    stats.Channels = ImDrawListSplitter_GetMemoryUsage(m_Splitter)
+        + m_NodeBuilder.GetMemoryUsage()
+        + HeapSize(m_DrawOrder);
+
+    stats.Settings = m_Settings.GetMemoryUsage();
+
+    stats.Animations = m_FlowAnimationController.GetMemoryUsage()
+        + HeapSize(m_LiveAnimations)
+        + HeapSize(m_LastLiveAnimations);
+
+    stats.Caches = m_NodeIndex.GetMemoryUsage()
+        + m_LinkIndex.GetMemoryUsage()
+        + m_Impostors.GetMemoryUsage()
+        + m_SelectAction.GetMemoryUsage()
+        + m_DeleteItemsAction.GetMemoryUsage()
+        + HeapSize(m_QueryResult)
+        + HeapSize(m_QueryLinks)
+        + HeapSize(m_QueryCurves)
+        + HeapSize(m_QueryProjections)
+        + HeapSize(m_StaleLinks)
+        + HeapSize(m_Minimap.m_Bounds)
+        + HeapSize(m_Minimap.m_Vertices)
+        + HeapSize(m_LinkGeometryChunks)
+        + HeapSize(m_LinkGeometryRanges);
+    for (auto& link : m_Links)
+        stats.Caches += link->GetGeometryMemoryUsage();
+    for (auto& chunk : m_LinkGeometryChunks)
+        stats.Caches += HeapSize(chunk.m_Vertices) + HeapSize(chunk.m_Indices)
+            + (chunk.m_Scratch ? sizeof(ImDrawList) + ImDrawList_GetMemoryUsage(*chunk.m_Scratch) : 0);
+
+    stats.Total = stats.Objects + stats.Channels + stats.Settings + stats.Animations + stats.Caches;
+
+    return stats;
+}
+
+void ed::EditorContext::Begin(const char* id, const ImVec2& size)
+{
+    m_Profiler.BeginFrame();
+
+    m_IsHibernated = false;
+
+    // Style may be changed directly between frames.
+    m_Style.Invalidate();
+
+    if (!m_IsInitialized)
+    {
+        LoadSettings();
+        m_IsInitialized = true;
+    }
+
+    // Layout batches are applied while nodes from last frame are still live.
+    m_Layout.Update(this);
+
+    //ImGui::LogToClipboard();
+    //Log("---- begin ----");
+
+    // Impostors are used only when zoom is stable, images rendered at
+    // different scale would look blurry.
+    const auto zoom = m_NavigateAction.m_Zoom;
+    const auto usedImpostors = m_UseImpostors;
+    m_Impostors.SetAtlasSize(m_Config.NodeImpostorAtlasSize);
+    m_UseImpostors    = m_Config.RenderNodeImpostor && m_Config.NodeImpostorAtlasSize > 0 && zoom < m_Config.NodeImpostorZoom && zoom >= GetLodOverviewZoom();
+    m_RenderImpostors = m_UseImpostors && zoom == m_LastZoom;
+    m_LastZoom        = zoom;
+
+    ++m_FrameIndex;
+
+    // Nodes are marked as drawn from impostor only while impostors are used.
+    const auto frame = ImGui::GetFrameCount();
+    if (m_UseImpostors || usedImpostors)
+    {
+        for (auto node : m_Nodes)
+        {
+            node->m_HasImpostor = false;
+            if (!m_UseImpostors || !node->IsLive() || IsGroup(node))
+                continue;
+
+            auto entry = m_Impostors.Find(node);
+            if (entry && entry->m_Scale == zoom && entry->m_NodeSize == node->m_Bounds.GetSize())
+            {
+                entry->m_LastUsedFrame = frame;
+                node->m_HasImpostor = true;
+            }
+        }
+    }
+
+    if (m_Config.RetainNodes)
+    {
+        // Keep nodes and their pins live until they're submitted again.
+        for (auto node : m_Nodes)
+        {
+            node->m_IsRetained = node->IsLive() && !node->m_IsForgotten;
+            node->SetLive(node->m_IsRetained);
+        }
+    }
+    else
+        m_NodeStates.ResetLive();
+
+    if (m_Config.RetainNodes || m_UseImpostors)
+    {
+        // Pins of retained nodes and of nodes drawn as impostors may not
+        // be submitted again.
+        for (auto pin : m_Pins)
+        {
+            pin->m_IsRetained = pin->IsLive() && pin->m_Node && (pin->m_Node->m_IsRetained || pin->m_Node->m_HasImpostor);
+            pin->SetLive(pin->m_IsRetained);
+        }
+    }
+    else
+        m_PinStates.ResetLive();
+
+    m_LinkStates.ResetLive();
+
+    auto drawList = ImGui::GetWindowDrawList();
+
+    m_FrameFirstVertex  = drawList->VtxBuffer.Size;
+    m_FrameFirstIndex   = drawList->IdxBuffer.Size;
+    m_FrameFirstCommand = drawList->CmdBuffer.Size;
+
+    ImDrawList_SwapSplitter(drawList, m_Splitter);
+    m_ExternalChannel = drawList->_Splitter._Current;
+
+    ImGui::PushID(id);
+
+    auto availableContentSize = ImGui::GetContentRegionAvail();
+    ImVec2 canvasSize = ImFloor(size);
+    if (canvasSize.x <= 0.0f)
+        canvasSize.x = ImMax(4.0f, availableContentSize.x);
+    if (canvasSize.y <= 0.0f)
+        canvasSize.y = ImMax(4.0f, availableContentSize.y);
+
+    m_IsCanvasVisible = m_Canvas.Begin(id, canvasSize);
+
+    //ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0, 0, 0, 0));
+    //ImGui::BeginChild(id, size, false,
+    //    ImGuiWindowFlags_NoMove |
+    //    ImGuiWindowFlags_NoScrollbar |
+    //    ImGuiWindowFlags_NoScrollWithMouse);
+
+    //ImGui::CaptureKeyboardFromApp();
+
+    m_IsWindowActive = ImGui::IsWindowFocused();
+
+    //
+	m_NavigateAction.SetWindow(m_Canvas.ViewRect().Min, m_Canvas.ViewRect().GetSize());
+
+    if (m_CurrentAction && m_CurrentAction->IsDragging() && m_NavigateAction.MoveOverEdge())
+    {
+        auto& io = ImGui::GetIO();
+        auto offset = m_NavigateAction.GetMoveOffset();
+        for (int i = 0; i < 5; ++i)
+            io.MouseClickedPos[i] = io.MouseClickedPos[i] - offset;
+    }
+    else
+        m_NavigateAction.StopMoveOverEdge();
+
+    m_Canvas.SetView(m_NavigateAction.GetView());
+
+    if (m_Canvas.ViewRect().Min != m_LastViewRect.Min || m_Canvas.ViewRect().Max != m_LastViewRect.Max)
+    {
+        m_LastViewRect = m_Canvas.ViewRect();
+        NotifyGeometryChanged();
+    }
+
+    m_SubmitHash = 0;
+
+    m_Minimap.m_IsShown   = false;
+    m_Minimap.m_IsHovered = false;
+
+    const auto viewScale = m_Canvas.ViewScale();
+    if (viewScale < GetLodOverviewZoom())
+        m_LOD = LevelOfDetail::Overview;
+    else if (viewScale < GetLodReducedZoom())
+        m_LOD = LevelOfDetail::Reduced;
+    else
+        m_LOD = LevelOfDetail::Full;
+
+    // #debug #clip
+    //ImGui::Text("CLIP = { x=%g y=%g w=%g h=%g r=%g b=%g }",
+    //    clipMin.x, clipMin.y, clipMax.x - clipMin.x, clipMax.y - clipMin.y, clipMax.x, clipMax.y);
+
+    // Reserve channels for background and links
+    ImDrawList_ChannelsGrow(drawList, c_NodeStartChannel);
+
+    if (HasSelectionChanged())
+        ++m_SelectionId;
+
+    CommitSelectionChanges();
+}
+
+void ed::EditorContext::End()
+{
+    m_Governor.BeginFrame();
+
+    SortObjects();
+    UpdateNodeStateOrder();
+
+    // Pins not submitted again by their node are gone.
+    if (m_Config.RetainNodes || m_UseImpostors)
+    {
+        for (auto pin : m_Pins)
+        {
+            auto node = pin->m_Node;
+            if (pin->m_IsRetained && !node->m_IsRetained && !(node->m_HasImpostor && node->IsLive()))
+            {
+                pin->SetLive(false);
+                pin->m_ConnectionFrame = -1;
+            }
+        }
+    }
+
+    // Set of submitted objects changed.
+    if (m_SubmitHash != m_LastSubmitHash)
+    {
+        m_LastSubmitHash = m_SubmitHash;
+        m_IsContentBoundsValid = false;
+        NotifyGeometryChanged();
+    }
+
+    if (m_ContentBoundsFrame == m_FrameIndex)
+        m_IsContentBoundsValid = false;
+    if (m_SelectionBoundsFrame == m_FrameIndex)
+        m_IsSelectionBoundsValid = false;
+
+    //auto& io          = ImGui::GetIO();
+    auto  control     = BuildControl(m_CurrentAction && m_CurrentAction->IsDragging()); // NavigateAction.IsMovingOverEdge()
+    auto  drawList    = ImGui::GetWindowDrawList();
+
+    const auto hadInput = HadInput();
+    //auto& editorStyle = GetStyle();
+
+    m_DoubleClickedNode       = control.DoubleClickedNode ? control.DoubleClickedNode->m_ID : 0;
+    m_DoubleClickedPin        = control.DoubleClickedPin  ? control.DoubleClickedPin->m_ID  : 0;
+    m_DoubleClickedLink       = control.DoubleClickedLink ? control.DoubleClickedLink->m_ID : 0;
+    m_BackgroundClicked       = control.BackgroundClicked;
+    m_BackgroundDoubleClicked = control.BackgroundDoubleClicked;
+
+    //if (DoubleClickedNode) LOG_TRACE(0, "DOUBLE CLICK NODE: %d", DoubleClickedNode);
+    //if (DoubleClickedPin)  LOG_TRACE(0, "DOUBLE CLICK PIN:  %d", DoubleClickedPin);
+    //if (DoubleClickedLink) LOG_TRACE(0, "DOUBLE CLICK LINK: %d", DoubleClickedLink);
+    //if (BackgroundDoubleClicked) LOG_TRACE(0, "DOUBLE CLICK BACKGROUND", DoubleClickedLink);
+
+    const bool isSelecting = m_CurrentAction && m_CurrentAction->AsSelect() != nullptr;
+    const bool isDragging  = m_CurrentAction && m_CurrentAction->AsDrag()   != nullptr;
+    //const bool isSizing    = CurrentAction && CurrentAction->AsSize()   != nullptr;
+
+    auto hasPendingImpostors = m_UseImpostors;
+    {
+        // Curves keep about the same error on screen as zoom goes down, at and
+        // above 100% they are tessellated as before. Tolerance is a squared
+        // distance, so it grows with square of inverse zoom. Zoom is rounded
+        // down to power of two, cached link geometry keys on tolerance and
+        // would be rebuilt on every zoom step otherwise. Fringe is dropped far
+        // zoomed out.
+        const auto viewScale     = m_Canvas.ViewScale();
+        const auto distanceScale = ImPow(2.0f, ImFloor(log2f(1.0f / ImMin(viewScale, 1.0f))));
+        DrawQualityScope drawQuality(GetQuality().TessellationScale * distanceScale * distanceScale, viewScale >= m_Style.LodAntiAliasZoom);
+
+        // Draw nodes
+        {
+            FrameProfiler::Scope profile(m_Profiler, FramePhase::DrawNodes);
+
+            // States are parallel to m_Nodes, only visible nodes are touched.
+            m_NodeStates.Cull(ImGui::GetCurrentWindowRead()->ClipRect);
+            for (size_t i = 0; i < m_Nodes.size(); ++i)
+                if (m_NodeStates.m_IsVisible[i])
+                    m_Nodes[i]->Draw(drawList);
+
+            if (m_RenderImpostors)
+                hasPendingImpostors = RenderImpostors(drawList);
+        }
+
+        // Draw links
+        {
+            FrameProfiler::Scope profile(m_Profiler, FramePhase::DrawLinks);
+
+            m_LinkStates.Cull(ImGui::GetCurrentWindowRead()->ClipRect);
+            if (m_Config.ParallelFor)
+                BuildLinkGeometry(drawList);
+            for (size_t i = 0; i < m_Links.size(); ++i)
+                if (m_LinkStates.m_IsVisible[i])
+                    m_Links[i]->Draw(drawList);
+        }
+
+        // Highlight selected objects
+        {
+            auto selectedObjects = &m_SelectedObjects;
+            if (auto selectAction = m_CurrentAction ? m_CurrentAction->AsSelect() : nullptr)
+                selectedObjects = &selectAction->m_CandidateObjects;
+
+            for (auto selectedObject : *selectedObjects)
+                if (selectedObject->IsVisible())
+                    selectedObject->Draw(drawList, Object::Selected);
+        }
+
+        if (!isSelecting)
+        {
+            auto hoveredObject = control.HotObject;
+            if (auto dragAction = m_CurrentAction ? m_CurrentAction->AsDrag() : nullptr)
+                hoveredObject = dragAction->m_DraggedObject;
+            if (auto sizeAction = m_CurrentAction ? m_CurrentAction->AsSize() : nullptr)
+                hoveredObject = sizeAction->m_SizedNode;
+
+            if (hoveredObject && !IsSelected(hoveredObject) && hoveredObject->IsVisible())
+                hoveredObject->Draw(drawList, Object::Hovered);
+        }
+
+        // Draw animations
+        for (auto controller : m_AnimationControllers)
+            controller->Draw(drawList);
+    }
+
+    if (m_CurrentAction && !m_CurrentAction->Process(control))
+        m_CurrentAction = nullptr;
+
+    if (m_NavigateAction.m_IsActive)
+        m_NavigateAction.Process(control);
+    else
+        m_NavigateAction.Accept(control);
+
+    if (nullptr == m_CurrentAction)
+    {
+        EditorAction* possibleAction   = nullptr;
+
+        auto accept = [&possibleAction, &control](EditorAction& action)
+        {
+            auto result = action.Accept(control);
+
+            if (result == EditorAction::True)
+                return true;
+            else if (/*!possibleAction &&*/ result == EditorAction::Possible)
+                possibleAction = &action;
+            else if (result == EditorAction::Possible)
+                action.Reject();
+
+            return false;
+        };
+
+        if (accept(m_ContextMenuAction))
+            m_CurrentAction = &m_ContextMenuAction;
+        else if (accept(m_ShortcutAction))
+            m_CurrentAction = &m_ShortcutAction;
+        else if (accept(m_SizeAction))
+            m_CurrentAction = &m_SizeAction;
+        else if (accept(m_DragAction))
+            m_CurrentAction = &m_DragAction;
+        else if (accept(m_SelectAction))
+            m_CurrentAction = &m_SelectAction;
+        else if (accept(m_CreateItemAction))
+            m_CurrentAction = &m_CreateItemAction;
+        else if (accept(m_DeleteItemsAction))
+            m_CurrentAction = &m_DeleteItemsAction;
+
+        if (possibleAction)
+            ImGui::SetMouseCursor(possibleAction->GetCursor());
+
+        if (m_CurrentAction && possibleAction)
+            possibleAction->Reject();
+    }
+
+    if (m_CurrentAction)
+        ImGui::SetMouseCursor(m_CurrentAction->GetCursor());
+
+    // Draw selection rectangle
+    m_SelectAction.Draw(drawList);
+
+    if (control.ActiveNode)
+    {
+        if (!IsGroup(control.ActiveNode))
+        {
+            // Bring active node to front, it stays there for rest of the interaction.
+            if (m_Nodes.back() != control.ActiveNode)
+            {
+                auto activeNodeIt = std::find(m_Nodes.begin(), m_Nodes.end(), control.ActiveNode);
+                std::rotate(activeNodeIt, activeNodeIt + 1, m_Nodes.end());
+                NotifyNodeOrderChanged();
+            }
+        }
+        else if (!isDragging && m_CurrentAction && m_CurrentAction->AsDrag())
+        {
+            // Bring content of dragged group to front
+            std::vector<Node*> nodes;
+            control.ActiveNode->GetGroupedNodes(nodes);
+            std::sort(nodes.begin(), nodes.end());
+
+            std::stable_partition(m_Nodes.begin(), m_Nodes.end(), [&nodes](Node* node)
+            {
+                return !std::binary_search(nodes.begin(), nodes.end(), node);
+            });
+
+            NotifyNodeOrderChanged();
+
+            // Nested groups were moved too.
+            m_IsNodeLayerDirty = true;
+        }
+    }
+
+    // Groups are kept before regular nodes and sorted by area. Order changes
+    // only when node becomes group or back, or when area of a group changes.
+    {
+        FrameProfiler::Scope profile(m_Profiler, FramePhase::ReorderChannels);
+
+        auto groupArea = [this](const Node* node)
+        {
+            const auto& size = node == m_SizeAction.m_SizedNode ? m_SizeAction.GetStartGroupBounds().GetSize() : node->m_GroupBounds.GetSize();
+            return size.x * size.y;
+        };
+
+        auto sortGroups = m_IsNodeLayerDirty;
+
+        auto groupsItEnd = m_Nodes.begin();
+        if (m_IsNodeLayerDirty)
+        {
+            groupsItEnd = std::stable_partition(m_Nodes.begin(), m_Nodes.end(), IsGroup);
+            m_IsNodeLayerDirty = false;
+        }
+        else
+            groupsItEnd = std::find_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return !IsGroup(node); });
+
+        for (auto groupIt = m_Nodes.begin(); groupIt != groupsItEnd && !sortGroups; ++groupIt)
+            sortGroups = (*groupIt)->m_GroupSortArea != groupArea(*groupIt);
+
+        if (sortGroups)
+        {
+            for (auto groupIt = m_Nodes.begin(); groupIt != groupsItEnd; ++groupIt)
+                (*groupIt)->m_GroupSortArea = groupArea(*groupIt);
+
+            std::stable_sort(m_Nodes.begin(), groupsItEnd, [](const Node* lhs, const Node* rhs)
+            {
+                return lhs->m_GroupSortArea > rhs->m_GroupSortArea;
+            });
+
+            NotifyNodeOrderChanged();
+        }
+    }
+
+# if 1
+    // Every node has few channels assigned. Instead of moving
+    // channels around, build list of channels in drawing order
+    // used to merge them.
+    {
+        FrameProfiler::Scope profile(m_Profiler, FramePhase::ReorderChannels);
+
+        UpdateNodeStateOrder();
+
+        m_DrawOrder.resize(0);
+        m_DrawOrder.push_back(c_UserChannel_Grid);
+        m_DrawOrder.push_back(c_BackgroundChannelStart);
+
+        auto addNodes = [this](size_t begin, size_t end)
+        {
+            for (auto index = begin; index < end; ++index)
+            {
+                if (!m_NodeStates.m_IsLive[index])
+                    continue;
+
+                auto node = m_Nodes[index].m_Object;
+                if (node->m_IsRetained)
+                    continue;
+
+                for (int i = 0; i < c_ChannelsPerNode; ++i)
+                    m_DrawOrder.push_back(node->m_Channel + i);
+            }
+        };
+
+        auto groupsItEnd = std::find_if(m_Nodes.begin(), m_Nodes.end(), [](Node* node) { return !IsGroup(node); });
+        auto groupCount  = static_cast<size_t>(groupsItEnd - m_Nodes.begin());
+
+        // Group nodes
+        addNodes(0, groupCount);
+
+        // Links
+        for (int i = 0; i < c_LinkChannelCount; ++i)
+            m_DrawOrder.push_back(c_LinkStartChannel + i);
+
+        // Normal nodes
+        addNodes(groupCount, m_Nodes.size());
+    }
+# endif
+
+    // ImGui::PopClipRect();
+
+    // Draw grid
+# if 1 // #FIXME
+    {
+        //auto& style = ImGui::GetStyle();
+
+        ImDrawList_ChannelsSetCurrent(drawList, c_UserChannel_Grid);
+
+        ImVec2 offset    = m_Canvas.ViewOrigin() * (1.0f / m_Canvas.ViewScale());
+        ImU32 GRID_COLOR = GetColor(StyleColor_Grid, ImClamp(m_Canvas.ViewScale() * m_Canvas.ViewScale(), 0.0f, 1.0f));
+        float GRID_SX    = 32.0f;// * m_Canvas.ViewScale();
+        float GRID_SY    = 32.0f;// * m_Canvas.ViewScale();
+        ImVec2 VIEW_POS  = m_Canvas.ViewRect().Min;
+        ImVec2 VIEW_SIZE = m_Canvas.ViewRect().GetSize();
+
+        drawList->AddRectFilled(VIEW_POS, VIEW_POS + VIEW_SIZE, GetColor(StyleColor_Bg));
+
+        if (m_Config.GridTexture)
+        {
+            // Single quad regardless of zoom, texture wraps every grid cell.
+            // Coordinates stay in first tile to not lose precision far from origin.
+            ImVec2 uvMin = ImVec2(-fmodf(offset.x, GRID_SX) / GRID_SX, -fmodf(offset.y, GRID_SY) / GRID_SY);
+            ImVec2 uvMax = uvMin + ImVec2(VIEW_SIZE.x / GRID_SX, VIEW_SIZE.y / GRID_SY);
+            drawList->AddImage(m_Config.GridTexture, VIEW_POS, VIEW_POS + VIEW_SIZE, uvMin, uvMax, GRID_COLOR);
+        }
+        else
+        {
+            for (float x = fmodf(offset.x, GRID_SX); x < VIEW_SIZE.x; x += GRID_SX)
+                drawList->AddLine(ImVec2(x, 0.0f) + VIEW_POS, ImVec2(x, VIEW_SIZE.y) + VIEW_POS, GRID_COLOR);
+            for (float y = fmodf(offset.y, GRID_SY); y < VIEW_SIZE.y; y += GRID_SY)
+                drawList->AddLine(ImVec2(0.0f, y) + VIEW_POS, ImVec2(VIEW_SIZE.x, y) + VIEW_POS, GRID_COLOR);
+        }
+    }
+# endif
+
+# if 0
+    {
+        auto userChannel = drawList->_Splitter._Count;
+        auto channelsToCopy = c_UserLayersCount;
+        ImDrawList_ChannelsGrow(drawList, userChannel + channelsToCopy);
+        for (int i = 0; i < channelsToCopy; ++i)
+            ImDrawList_SwapChannels(drawList, userChannel + i, c_UserLayerChannelStart + i);
+    }
+# endif
+
+# if 0
+    {
+        auto preOffset  = ImVec2(0, 0);
+        auto postOffset = m_OldCanvas.WindowScreenPos + m_OldCanvas.ClientOrigin;
+        auto scale      = m_OldCanvas.Zoom;
+
+        ImDrawList_TransformChannels(drawList,                        0,                            1, preOffset, scale, postOffset);
+        ImDrawList_TransformChannels(drawList, c_BackgroundChannelStart, drawList->_ChannelsCount - 1, preOffset, scale, postOffset);
+
+        auto clipTranslation = m_OldCanvas.WindowScreenPos - m_OldCanvas.FromScreen(m_OldCanvas.WindowScreenPos);
+        ImGui::PushClipRect(m_OldCanvas.WindowScreenPos + ImVec2(1, 1), m_OldCanvas.WindowScreenPos + m_OldCanvas.WindowScreenSize - ImVec2(1, 1), false);
+        ImDrawList_TranslateAndClampClipRects(drawList,                        0,                            1, clipTranslation);
+        ImDrawList_TranslateAndClampClipRects(drawList, c_BackgroundChannelStart, drawList->_ChannelsCount - 1, clipTranslation);
+        ImGui::PopClipRect();
+
+        // #debug: Static grid in local space
+        //for (float x = 0; x < Canvas.WindowScreenSize.x; x += 100)
+        //    drawList->AddLine(ImVec2(x, 0.0f) + Canvas.WindowScreenPos, ImVec2(x, Canvas.WindowScreenSize.y) + Canvas.WindowScreenPos, IM_COL32(255, 0, 0, 128));
+        //for (float y = 0; y < Canvas.WindowScreenSize.y; y += 100)
+        //    drawList->AddLine(ImVec2(0.0f, y) + Canvas.WindowScreenPos, ImVec2(Canvas.WindowScreenSize.x, y) + Canvas.WindowScreenPos, IM_COL32(255, 0, 0, 128));
+    }
+# endif
+
+# if 1
+    // Move user and hint channels to top
+    {
+        // Clip plane is transformed to global space.
+        // These channels already have clip planes in global space, so
+        // we move them to clip plane. Batch transformation in canvas
+        // will bring them back to global space.
+        auto preTransformClipRect = [this, drawList](int channelIndex)
+        {
+            ImDrawChannel& channel = drawList->_Splitter._Channels[channelIndex];
+            for (ImDrawCmd& cmd : channel._CmdBuffer)
+            {
+                auto a = ToCanvas(ImVec2(cmd.ClipRect.x, cmd.ClipRect.y));
+                auto b = ToCanvas(ImVec2(cmd.ClipRect.z, cmd.ClipRect.w));
+                cmd.ClipRect = ImVec4(a.x, a.y, b.x, b.y);
+            }
+        };
+
+        ImDrawList_ChannelsSetCurrent(drawList, 0);
+
+        m_DrawOrder.push_back(c_UserChannel_HintsBackground);
+        m_DrawOrder.push_back(c_UserChannel_Hints);
+        m_DrawOrder.push_back(c_UserChannel_Content);
+
+        preTransformClipRect(c_UserChannel_HintsBackground);
+        preTransformClipRect(c_UserChannel_Hints);
+        preTransformClipRect(c_UserChannel_Content);
+    }
+# endif
+
+    UpdateAnimations();
+
+    m_FrameStats.ChannelCount = drawList->_Splitter._Count;
+
+    {
+        FrameProfiler::Scope profile(m_Profiler, FramePhase::MergeChannels);
+
+        ImDrawList_ChannelsMerge(drawList, m_DrawOrder);
+    }
+
+    // #debug
+    // drawList->AddRectFilled(ImVec2(-10.0f, -10.0f), ImVec2(10.0f, 10.0f), IM_COL32(255, 0, 255, 255));
+
+    // ImGui::EndChild();
+    // ImGui::PopStyleColor();
+    if (m_IsCanvasVisible)
+    {
+        FrameProfiler::Scope profile(m_Profiler, FramePhase::LeaveLocalSpace);
+
+        m_Canvas.End();
+    }
+
+    ImDrawList_SwapSplitter(drawList, m_Splitter);
+
+    if (m_Minimap.m_IsShown && m_IsCanvasVisible)
+        DrawMinimap(drawList);
+
+    // Draw border
+    {
+        auto& style = ImGui::GetStyle();
+        auto borderShadoColor = style.Colors[ImGuiCol_BorderShadow];
+        auto borderColor = style.Colors[ImGuiCol_Border];
+        drawList->AddRect(m_Canvas.Rect().Min + ImVec2(1, 1), m_Canvas.Rect().Max - ImVec2(1, 1), ImColor(borderShadoColor));
+        drawList->AddRect(m_Canvas.Rect().Min, m_Canvas.Rect().Max, ImColor(borderColor));
+    }
+
+    // ShowMetrics(control);
+
+    ImGui::PopID();
+
+    if (!m_CurrentAction && m_IsFirstFrame && !m_Settings.m_Selection.empty())
+    {
+        ClearSelection();
+        for (auto id : m_Settings.m_Selection)
+            if (auto object = FindObject(id))
+                SelectObject(object);
+    }
+
+    if (HasSelectionChanged())
+        MakeDirty(SaveReasonFlags::Selection);
+
+    // Settings written on background thread failed to reach disk, they are
+    // written again like ones failed to save right away.
+    const auto failedSaveReason = m_Config.TakeSaveFailure();
+    if (failedSaveReason != SaveReasonFlags::None)
+        MakeDirty(failedSaveReason);
+
+    if (m_Settings.m_IsDirty && !m_CurrentAction)
+        SaveSettings();
+
+    // Geometry changed during this frame may move dependent objects
+    // in the next one, e.g. links follow nodes which size settled.
+    const auto isSettling = m_GeometryGeneration != m_LastFrameGeneration;
+    m_LastFrameGeneration = m_GeometryGeneration;
+
+    const auto hotChanged = control.HotObject != m_LastHotObject;
+    m_LastHotObject = control.HotObject;
+
+    m_NeedsRedraw =
+           m_IsFirstFrame
+        || !m_LiveAnimations.empty()
+        || m_NavigateAction.IsNavigating()
+        || m_NavigateAction.m_IsActive
+        || m_CurrentAction != nullptr
+        || m_Layout.IsRunning()
+        || hasPendingImpostors
+        || isSettling
+        || hotChanged
+        || hadInput;
+
+    m_FrameStats.VertexCount      = drawList->VtxBuffer.Size - m_FrameFirstVertex;
+    m_FrameStats.IndexCount       = drawList->IdxBuffer.Size - m_FrameFirstIndex;
+    m_FrameStats.DrawCommandCount = drawList->CmdBuffer.Size - m_FrameFirstCommand;
+
+    m_Governor.EndFrame(m_Config.FrameBudget);
+    m_FrameStats.EndTime      = m_Governor.GetFrameTime();
+    m_FrameStats.QualityLevel = m_Governor.GetLevel();
+
+    m_Profiler.EndFrame();
+
+    m_IsFirstFrame = false;
+}
+
+float ed::EditorContext::GetNextWakeupTime() const
+{
+    // Animations, navigation and actions change editor every frame.
+    if (m_NeedsRedraw)
+        return 0.0f;
+
+    // Failed background write is retried by End(), which has to run to
+    // notice it.
+    if (m_Config.IsSaving())
+        return c_SettingsWritePollInterval;
+
+    return FLT_MAX;
+}
+
+bool ed::EditorContext::HadInput() const
+{
+    auto& io = ImGui::GetIO();
+
+    const auto isHovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem)
+        && m_Canvas.ViewRect().Contains(ImGui::GetMousePos());
+
+    if (isHovered)
+    {
+        if (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f)
+            return true;
+
+        for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); ++i)
+            if (io.MouseDown[i] || ImGui::IsMouseReleased(i))
+                return true;
+    }
+
+    if (m_IsWindowActive)
+    {
+        if (io.InputQueueCharacters.Size > 0)
+            return true;
+
+        for (int i = 0; i < IM_ARRAYSIZE(io.KeysDown); ++i)
+            if (io.KeysDown[i] || ImGui::IsKeyReleased(i))
+                return true;
+    }
+
+    return false;
+}
+
+ImRect ed::EditorContext::GetSelectionBounds()
+{
+    if (!m_IsSelectionBoundsValid || m_SelectionBoundsGeneration != m_GeometryGeneration)
+    {
+        m_SelectionBounds            = GetBounds(m_SelectedObjects);
+        m_IsSelectionBoundsValid     = true;
+        m_SelectionBoundsFrame       = m_FrameIndex;
+        m_SelectionBoundsGeneration  = m_GeometryGeneration;
+    }
+
+    return m_SelectionBounds;
+}
+
+ImRect ed::EditorContext::GetContentBounds()
+{
+    if (!m_IsContentBoundsValid)
+    {
+        // Node states are contiguous, no need to touch nodes.
+        ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (int i = 0; i < m_NodeStates.Size(); ++i)
+            if (m_NodeStates.m_IsLive[i])
+                bounds.Add(m_NodeStates.m_Bounds[i]);
+
+        m_ContentBounds        = bounds;
+        m_IsContentBoundsValid = true;
+        m_ContentBoundsFrame   = m_FrameIndex;
+    }
+
+    if (ImRect_IsEmpty(m_ContentBounds))
+        return ImRect();
+
+    return m_ContentBounds;
+}
+
+bool ed::EditorContext::DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness)
+{
+    auto startPin = FindPin(startPinId);
+    auto endPin   = FindPin(endPinId);
+
+    // Link is not created until it can be drawn.
+    if (!startPin || !startPin->IsLive() || !endPin || !endPin->IsLive())
+        return false;
+
+    return DoLink(GetLink(id), startPin, endPin, color, thickness);
+}
+
+bool ed::EditorContext::DoLink(Link* link, Pin* startPin, Pin* endPin, ImU32 color, float thickness)
+{
+    //auto& editorStyle = GetStyle();
+
+    if (!startPin || !startPin->IsLive() || !endPin || !endPin->IsLive())
+        return false;
+
+    startPin->m_ConnectionFrame = m_FrameIndex;
+      endPin->m_ConnectionFrame = m_FrameIndex;
+
+    if (link->m_Thickness != thickness)
+        NotifyGeometryChanged();
+    NotifyObjectSubmitted(link->m_ID);
+
+    // Keep adjacency lists of pins in sync with link endpoints. Link is
+    // listed once by pin, even if it starts and ends at the same one.
+    if (link->m_StartPin != startPin || link->m_EndPin != endPin)
+    {
+        auto detach = [link](Pin* pin)
+        {
+            auto linkIt = pin ? std::find(pin->m_Links.begin(), pin->m_Links.end(), link) : vector<Link*>::iterator();
+            if (pin && linkIt != pin->m_Links.end())
+                pin->m_Links.erase(linkIt);
+        };
+
+        auto attach = [link](Pin* pin)
+        {
+            if (std::find(pin->m_Links.begin(), pin->m_Links.end(), link) == pin->m_Links.end())
+                pin->m_Links.push_back(link);
+        };
+
+        detach(link->m_StartPin);
+        detach(link->m_EndPin);
+        attach(startPin);
+        attach(endPin);
+
+        link->InvalidateEndpoints();
+    }
+
+    link->m_StartPin      = startPin;
+    link->m_EndPin        = endPin;
+    link->m_Color         = color;
+    link->m_Thickness     = thickness;
+    link->SetLive(true);
+
+    link->UpdateEndpoints();
+
+    m_LinkIndex.Update(link, link->m_Bounds);
+
+    return true;
+}
+
+void ed::EditorContext::SetNodePosition(NodeId nodeId, const ImVec2& position)
+{
+    auto node = FindNode(nodeId);
+    if (!node)
+    {
+        node = CreateNode(nodeId);
+        node->SetLive(false);
+    }
+
+    if (node->m_Bounds.Min != position)
+    {
+        node->m_Bounds.Translate(position - node->m_Bounds.Min);
+        node->m_Bounds.Floor();
+        NotifyNodeBoundsChanged(node);
+        MakeDirty(NodeEditor::SaveReasonFlags::Position, node);
+    }
+}
+
+void ed::EditorContext::SetNodePositions(const NodeId* nodeIds, const ImVec2* positions, int count)
+{
+    auto anyMoved = false;
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto node = FindNode(nodeIds[i]);
+        if (!node)
+        {
+            node = CreateNode(nodeIds[i]);
+            node->SetLive(false);
+        }
+
+        if (node->m_Bounds.Min == positions[i])
+            continue;
+
+        const auto lastBounds = node->m_Bounds;
+        node->m_Bounds.Translate(positions[i] - node->m_Bounds.Min);
+        node->m_Bounds.Floor();
+        if (!node->m_IsDragged)
+            m_NodeIndex.Update(node, node->m_Bounds);
+        m_NodeStates.m_Bounds[node->m_StateIndex] = node->m_Bounds;
+        NotifyContentBoundsChanged(node, &lastBounds);
+        m_Settings.MakeDirty(NodeEditor::SaveReasonFlags::Position, node);
+        anyMoved = true;
+    }
+
+    if (!anyMoved)
+        return;
+
+    // Unlike NotifyNodeBoundsChanged() groups are not tested against every
+    // moved node, all are updated on next use instead.
+    for (auto group : m_Groups)
+        group->m_IsGroupedNodesDirty = true;
+
+    NotifyGeometryChanged();
+}
+
+void ed::EditorContext::AutoLayout(const LayoutConfig& config)
+{
+    // Only geometry and connectivity are copied, worker never touches
+    // editor state. Groups stay where they are.
+    LayoutGraph graph;
+    std::unordered_map<Node*, int> indices;
+    for (auto node : m_Nodes)
+    {
+        if (!node->IsLive() || IsGroup(node))
+            continue;
+
+        indices[node] = static_cast<int>(graph.m_Nodes.size());
+        graph.m_Nodes.push_back(node->m_ID);
+        graph.m_Positions.push_back(node->m_Bounds.Min);
+        graph.m_Sizes.push_back(node->m_Bounds.GetSize());
+    }
+
+    for (auto link : m_Links)
+    {
+        if (!link->IsLive() || !link->m_StartPin || !link->m_EndPin)
+            continue;
+
+        auto start = indices.find(link->m_StartPin->m_Node);
+        auto end   = indices.find(link->m_EndPin->m_Node);
+        if (start == indices.end() || end == indices.end() || start->second == end->second)
+            continue;
+
+        graph.m_Edges.emplace_back(start->second, end->second);
+    }
+
+    m_Layout.Start(std::move(graph), config);
+}
+
+void ed::EditorContext::GetNodeBounds(const NodeId* nodeIds, ImVec2* positions, ImVec2* sizes, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        auto node = FindNode(nodeIds[i]);
+
+        if (positions)
+            positions[i] = node ? node->m_Bounds.Min : ImVec2(FLT_MAX, FLT_MAX);
+        if (sizes)
+            sizes[i] = node ? node->m_Bounds.GetSize() : ImVec2(0, 0);
+    }
+}
+
+ImVec2 ed::EditorContext::GetNodePosition(NodeId nodeId)
+{
+    auto node = FindNode(nodeId);
+    if (!node)
+        return ImVec2(FLT_MAX, FLT_MAX);
+
+    return node->m_Bounds.Min;
+}
+
+ImVec2 ed::EditorContext::GetNodeSize(NodeId nodeId)
+{
+    auto node = FindNode(nodeId);
+    if (!node)
+        return ImVec2(0, 0);
+
+    return node->m_Bounds.GetSize();
+}
+
+void ed::EditorContext::MarkNodeToRestoreState(Node* node)
+{
+    node->m_RestoreState = true;
+}
+
+void ed::EditorContext::RestoreNodeState(Node* node)
+{
+    auto settings = m_Settings.FindNode(node->m_ID);
+    if (!settings)
+        return;
+
+    // Load state from config (if possible)
+    if (!NodeSettings::Parse(m_Config.LoadNode(node->m_ID), *settings))
+        return;
+
+    ApplyNodeSettings(node, *settings);
+}
+
+void ed::EditorContext::ApplyNodeSettings(Node* node, const NodeSettings& settings)
+{
+    node->m_Bounds.Min      = settings.m_Location;
+    node->m_Bounds.Max      = node->m_Bounds.Min + settings.m_Size;
+    node->m_Bounds.Floor();
+    node->m_GroupBounds.Min = settings.m_Location;
+    node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings.m_GroupSize;
+    node->m_GroupBounds.Floor();
+
+    NotifyNodeBoundsChanged(node);
+}
+
+bool ed::EditorContext::IsNodeVisible(NodeId nodeId)
+{
+    // Unknown nodes have to be submitted at least once to be measured.
+    auto node = FindNode(nodeId);
+    if (!node || !node->IsLive())
+        return true;
+
+    const auto bounds = node->GetBounds();
+
+    return ImRect_IsEmpty(bounds) || GetViewRect().Overlaps(bounds);
+}
+
+void ed::EditorContext::ForgetNode(Node* node)
+{
+    // Node submitted this frame stays until next one, retained is dropped
+    // right away. Its pins are dropped by End().
+    if (node->m_IsRetained)
+    {
+        node->SetLive(false);
+        m_IsContentBoundsValid = false;
+    }
+
+    node->m_IsRetained  = false;
+    node->m_IsForgotten = true;
+
+    ++node->m_Generation;
+    for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+        ++pin->m_Generation;
+
+    m_Impostors.Remove(node);
+
+    NotifyGeometryChanged();
+}
+
+bool ed::EditorContext::DrawNodeImpostor(ImDrawList* drawList, Node* node)
+{
+    auto entry = m_Impostors.Find(node);
+    if (!entry)
+        return false;
+
+    // Content was already submitted by the user, drop it.
+    for (int i = 0; i < c_ChannelsPerNode; ++i)
+    {
+        if (i == c_NodeBackgroundChannel)
+            continue;
+
+        auto& channel = drawList->_Splitter._Channels[node->m_Channel + i];
+        if (channel._CmdBuffer.Size > 0)
+        {
+            channel._CmdBuffer.resize(1);
+            channel._CmdBuffer[0].ElemCount    = 0;
+            channel._CmdBuffer[0].UserCallback = nullptr;
+        }
+        channel._IdxBuffer.resize(0);
+    }
+
+    const auto atlasSize = static_cast<float>(m_Impostors.GetAtlasSize());
+    const auto min = node->m_Bounds.Min + entry->m_Offset;
+
+    drawList->AddImage(m_Config.NodeImpostorAtlas, min, min + entry->m_Size,
+        entry->m_AtlasRect.Min / atlasSize, entry->m_AtlasRect.Max / atlasSize);
+
+    return true;
+}
+
+void ed::EditorContext::BuildLinkGeometry(ImDrawList* drawList)
+{
+    // Few links are cheaper to tessellate in place.
+    const int c_MinParallelLinks = 64;
+
+    m_StaleLinks.resize(0);
+    for (size_t i = 0; i < m_Links.size(); ++i)
+        if (m_LinkStates.m_IsVisible[i] && !m_Links[i]->HasGeometry(drawList))
+            m_StaleLinks.push_back(m_Links[i]);
+
+    if (static_cast<int>(m_StaleLinks.size()) < c_MinParallelLinks)
+        return;
+
+    // Links are split into chunks of at least c_MinParallelLinks, each chunk
+    // gets its own scratch list. Lists are allocated and reserved here, so
+    // workers never allocate through ImGui (allocation counters are not
+    // thread safe).
+    const int c_MaxChunks = 16;
+
+    const int linkCount  = static_cast<int>(m_StaleLinks.size());
+    const int chunkCount = ImMin(linkCount / c_MinParallelLinks, c_MaxChunks);
+
+    if (static_cast<int>(m_LinkGeometryChunks.size()) < chunkCount)
+        m_LinkGeometryChunks.resize(chunkCount);
+
+    for (int i = 0; i < chunkCount; ++i)
+    {
+        auto& chunk = m_LinkGeometryChunks[i];
+        if (!chunk.m_Scratch)
+            chunk.m_Scratch.reset(new ImDrawList(drawList->_Data));
+
+        auto scratch = chunk.m_Scratch.get();
+        scratch->_Data = drawList->_Data;
+        scratch->CmdBuffer.reserve(4);
+        scratch->VtxBuffer.reserve(c_MaxLinkVertices);
+        scratch->IdxBuffer.reserve(c_MaxLinkIndices);
+        scratch->_Path.reserve(c_MaxLinkPathPoints);
+
+        chunk.m_Vertices.resize(0);
+        chunk.m_Indices.resize(0);
+    }
+
+    m_LinkGeometryRanges.resize(linkCount);
+
+    struct JobData
+    {
+        Link**             m_Links;
+        LinkGeometryChunk* m_Chunks;
+        LinkGeometryRange* m_Ranges;
+        const ImDrawList*  m_DrawList;
+        int                m_LinkCount;
+        int                m_ChunkCount;
+    };
+
+    JobData jobData = { m_StaleLinks.data(), m_LinkGeometryChunks.data(), m_LinkGeometryRanges.data(), drawList, linkCount, chunkCount };
+
+    auto job = [](int begin, int end, void* data)
+    {
+        auto& jobData = *reinterpret_cast<JobData*>(data);
+
+        for (int chunkIndex = begin; chunkIndex < end; ++chunkIndex)
+        {
+            auto& chunk   = jobData.m_Chunks[chunkIndex];
+            auto  scratch = chunk.m_Scratch.get();
+
+            const int first = static_cast<int>(static_cast<long long>(jobData.m_LinkCount) *  chunkIndex      / jobData.m_ChunkCount);
+            const int last  = static_cast<int>(static_cast<long long>(jobData.m_LinkCount) * (chunkIndex + 1) / jobData.m_ChunkCount);
+
+            for (int i = first; i < last; ++i)
+            {
+                auto& range = jobData.m_Ranges[i];
+                range.m_Chunk       = chunkIndex;
+                range.m_FirstVertex = static_cast<int>(chunk.m_Vertices.size());
+                range.m_FirstIndex  = static_cast<int>(chunk.m_Indices.size());
+                range.m_VertexCount = -1;
+                range.m_IndexCount  = 0;
+
+                if (!jobData.m_Links[i]->TessellateGeometry(scratch, jobData.m_DrawList))
+                    continue;
+
+                // Output uses std allocator, growing it here is safe.
+                chunk.m_Vertices.insert(chunk.m_Vertices.end(), scratch->VtxBuffer.begin(), scratch->VtxBuffer.end());
+                chunk.m_Indices.insert(chunk.m_Indices.end(), scratch->IdxBuffer.begin(), scratch->IdxBuffer.end());
+
+                range.m_VertexCount = scratch->VtxBuffer.Size;
+                range.m_IndexCount  = scratch->IdxBuffer.Size;
+            }
+        }
+    };
+
+    m_Config.ParallelFor(chunkCount, job, &jobData, m_Config.UserPointer);
+
+    // Link buffers are ImVector, they are filled on this thread.
+    for (int i = 0; i < linkCount; ++i)
+    {
+        const auto& range = m_LinkGeometryRanges[i];
+        if (range.m_VertexCount < 0)
+            continue;
+
+        const auto& chunk = m_LinkGeometryChunks[range.m_Chunk];
+        m_StaleLinks[i]->SetGeometry(drawList,
+            chunk.m_Vertices.data() + range.m_FirstVertex, range.m_VertexCount,
+            chunk.m_Indices.data()  + range.m_FirstIndex,  range.m_IndexCount);
+    }
+}
+
+void ed::EditorContext::ShowMinimap(const ImVec2& size, MinimapLocation location)
+{
+    const float c_Margin = 10.0f;
+
+    const auto& canvasRect = m_Canvas.Rect();
+    const auto  minimapSize = ImFloor(ImMin(size, canvasRect.GetSize() - ImVec2(c_Margin * 2.0f, c_Margin * 2.0f)));
+    if (!m_IsCanvasVisible || minimapSize.x <= 0.0f || minimapSize.y <= 0.0f)
+        return;
+
+    const auto isLeft = location == MinimapLocation::TopLeft || location == MinimapLocation::BottomLeft;
+    const auto isTop  = location == MinimapLocation::TopLeft || location == MinimapLocation::TopRight;
+
+    ImVec2 position;
+    position.x = isLeft ? canvasRect.Min.x + c_Margin : canvasRect.Max.x - c_Margin - minimapSize.x;
+    position.y = isTop  ? canvasRect.Min.y + c_Margin : canvasRect.Max.y - c_Margin - minimapSize.y;
+
+    m_Minimap.m_IsShown = true;
+    m_Minimap.m_Rect    = ImRect(position, position + minimapSize);
+
+    // Button is emitted before any node content, so it wins hover over
+    // widgets below minimap. Mouse is in canvas space, so is the button.
+    const auto buttonMin = ToCanvas(m_Minimap.m_Rect.Min);
+    const auto buttonMax = ToCanvas(m_Minimap.m_Rect.Max);
+
+    const auto cursorPos = ImGui::GetCursorScreenPos();
+    ImGui::SetCursorScreenPos(buttonMin);
+    ImGui::InvisibleButton("##minimap", buttonMax - buttonMin);
+    ImGui::SetCursorScreenPos(cursorPos);
+
+    m_Minimap.m_IsHovered = ImGui::IsItemHovered() || ImGui::IsItemActive();
+
+    // Content is mapped as it was drawn last frame.
+    if (ImGui::IsItemActive() && m_Minimap.m_HasKey && m_Minimap.m_Scale > 0.0f)
+    {
+        const auto minimapPoint = ToScreen(ImGui::GetMousePos()) - m_Minimap.m_Rect.Min - m_Minimap.m_Offset;
+        m_NavigateAction.CenterView(m_Minimap.m_Key.m_Content.Min + minimapPoint * (1.0f / m_Minimap.m_Scale));
+    }
+}
+
+void ed::EditorContext::DrawMinimap(ImDrawList* drawList)
+{
+    const float c_Padding = 4.0f;
+
+    auto& minimap = m_Minimap;
+    const auto& rect = minimap.m_Rect;
+
+    MinimapCache::Key key = {};
+    key.m_Content         = GetContentBounds();
+    key.m_Size            = rect.GetSize();
+    key.m_NodeColor       = GetColor(StyleColor_MinimapNode);
+    key.m_GroupColor      = GetColor(StyleColor_MinimapNode, 0.35f);
+    key.m_TexUvWhitePixel = drawList->_Data->TexUvWhitePixel;
+
+    if (!minimap.m_HasKey || memcmp(&key, &minimap.m_Key, sizeof(key)) != 0)
+    {
+        const auto contentSize = key.m_Content.GetSize();
+        const auto available   = key.m_Size - ImVec2(c_Padding * 2.0f, c_Padding * 2.0f);
+
+        minimap.m_Key    = key;
+        minimap.m_HasKey = true;
+        minimap.m_Scale  = 0.0f;
+        if (contentSize.x > 0.0f && contentSize.y > 0.0f && available.x > 0.0f && available.y > 0.0f)
+            minimap.m_Scale = ImMin(available.x / contentSize.x, available.y / contentSize.y);
+        minimap.m_Offset = (key.m_Size - contentSize * minimap.m_Scale) * 0.5f;
+
+        // Every rect is rewritten.
+        minimap.m_Bounds.resize(0);
+    }
+
+    const auto nodeCount = m_NodeStates.Size();
+    if (minimap.m_IsDirty || minimap.m_Generation != m_GeometryGeneration || static_cast<int>(minimap.m_Bounds.size()) != nodeCount)
+    {
+        minimap.m_IsDirty    = false;
+        minimap.m_Generation = m_GeometryGeneration;
+
+        minimap.m_Bounds.resize(nodeCount, ImRect(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX));
+        minimap.m_Vertices.resize(nodeCount * 4);
+
+        for (int i = 0; i < nodeCount; ++i)
+        {
+            // Gone nodes collapse to a point.
+            const auto  bounds = m_NodeStates.m_IsLive[i] ? m_NodeStates.m_Bounds[i] : ImRect();
+            const auto  color  = IsGroup(m_Nodes[i].m_Object) ? key.m_GroupColor : key.m_NodeColor;
+            auto&       cached = minimap.m_Bounds[i];
+            auto        vertex = &minimap.m_Vertices[i * 4];
+            if (bounds.Min == cached.Min && bounds.Max == cached.Max && vertex->col == color)
+                continue;
+
+            cached = bounds;
+
+            // Every node stays visible, even if smaller than a pixel.
+            auto a = minimap.m_Offset + (bounds.Min - key.m_Content.Min) * minimap.m_Scale;
+            auto b = minimap.m_Offset + (bounds.Max - key.m_Content.Min) * minimap.m_Scale;
+            if (!ImRect_IsEmpty(bounds))
+                b = ImMax(b, a + ImVec2(1.0f, 1.0f));
+            else
+                b = a;
+
+            const ImVec2 corners[4] = { a, ImVec2(b.x, a.y), b, ImVec2(a.x, b.y) };
+            for (auto& corner : corners)
+            {
+                vertex->pos = corner;
+                vertex->uv  = key.m_TexUvWhitePixel;
+                vertex->col = color;
+                ++vertex;
+            }
+        }
+    }
+
+    drawList->AddRectFilled(rect.Min, rect.Max, GetColor(StyleColor_MinimapBg));
+
+    drawList->PushClipRect(rect.Min, rect.Max, true);
+
+    // Quads are emitted in batches small enough to be addressed by 16-bit indices.
+    const int c_BatchQuads = 16384;
+    for (int first = 0; first < nodeCount; first += c_BatchQuads)
+    {
+        const auto quadCount = ImMin(c_BatchQuads, nodeCount - first);
+
+        drawList->PrimReserve(quadCount * 6, quadCount * 4);
+
+        const auto baseIndex = drawList->_VtxCurrentIdx;
+        const auto source    = &minimap.m_Vertices[first * 4];
+        for (int i = 0; i < quadCount * 4; ++i)
+        {
+            drawList->_VtxWritePtr[i]      = source[i];
+            drawList->_VtxWritePtr[i].pos += rect.Min;
+        }
+
+        for (int i = 0; i < quadCount; ++i)
+        {
+            const auto index = static_cast<ImDrawIdx>(baseIndex + i * 4);
+            auto       write = drawList->_IdxWritePtr + i * 6;
+            write[0] = index;     write[1] = static_cast<ImDrawIdx>(index + 1); write[2] = static_cast<ImDrawIdx>(index + 2);
+            write[3] = index;     write[4] = static_cast<ImDrawIdx>(index + 2); write[5] = static_cast<ImDrawIdx>(index + 3);
+        }
+
+        drawList->_VtxWritePtr   += quadCount * 4;
+        drawList->_IdxWritePtr   += quadCount * 6;
+        drawList->_VtxCurrentIdx += quadCount * 4;
+    }
+
+    // Visible part of the canvas.
+    if (minimap.m_Scale > 0.0f)
+    {
+        const auto& viewRect = m_Canvas.ViewRect();
+        const auto  a = rect.Min + minimap.m_Offset + (viewRect.Min - key.m_Content.Min) * minimap.m_Scale;
+        const auto  b = rect.Min + minimap.m_Offset + (viewRect.Max - key.m_Content.Min) * minimap.m_Scale;
+        drawList->AddRect(a, b, GetColor(StyleColor_MinimapView), 0.0f, ImDrawCornerFlags_All, 1.5f);
+    }
+
+    drawList->PopClipRect();
+
+    drawList->AddRect(rect.Min, rect.Max, ImColor(ImGui::GetStyle().Colors[ImGuiCol_Border]));
+}
+
+bool ed::EditorContext::RenderImpostors(ImDrawList* drawList)
+{
+    // Rasterizing is expensive, spread it across frames.
+    const int c_MaxImpostorsPerFrame = 16;
+
+    const auto currentChannel = drawList->_Splitter._Current;
+
+    int budget = c_MaxImpostorsPerFrame;
+    for (auto node : m_Nodes)
+    {
+        if (!node->IsLive() || node->m_IsRetained || node->m_HasImpostor || IsGroup(node) || !node->IsVisible())
+            continue;
+
+        // Some nodes are left for next frame.
+        if (budget <= 0)
+        {
+            ImDrawList_ChannelsSetCurrent(drawList, currentChannel);
+            return true;
+        }
+
+        ImDrawList_ChannelsSetCurrent(drawList, c_UserChannel_Content);
+        if (RenderImpostor(drawList, node))
+            --budget;
+    }
+
+    ImDrawList_ChannelsSetCurrent(drawList, currentChannel);
+
+    return false;
+}
+
+bool ed::EditorContext::RenderImpostor(ImDrawList* drawList, Node* node)
+{
+    if (ImRect_IsEmpty(node->m_Bounds))
+        return false;
+
+    const auto scale  = m_NavigateAction.m_Zoom;
+    const auto margin = node->m_BorderWidth + 2.0f / scale;
+
+    auto canvasRect = node->m_Bounds;
+    canvasRect.Expand(margin);
+
+    const auto pixelSize = ImVec2(ImCeil(canvasRect.GetWidth() * scale), ImCeil(canvasRect.GetHeight() * scale));
+    const auto atlasSize = static_cast<float>(m_Impostors.GetAtlasSize());
+    if (pixelSize.x > atlasSize * 0.5f || pixelSize.y > atlasSize * 0.5f)
+        return false;
+
+    // Match canvas rect to pixel grid exactly, otherwise image will be stretched.
+    canvasRect.Max = canvasRect.Min + pixelSize / scale;
+
+    // Gather geometry of node channels. Vertices are shared by all channels,
+    // copy used range and rebase indices.
+    auto& target = m_Impostors.m_DrawList;
+    target._Data = drawList->_Data;
+    target.Clear();
+
+    for (int i = 0; i < c_ChannelsPerNode; ++i)
+    {
+        auto& channel = drawList->_Splitter._Channels[node->m_Channel + i];
+
+        const ImDrawIdx* indices = channel._IdxBuffer.Data;
+        for (auto& cmd : channel._CmdBuffer)
+        {
+            if (cmd.UserCallback)
+                return false;
+
+            if (cmd.ElemCount == 0)
+                continue;
+
+            const ImDrawIdx* cmdIndices = indices + cmd.IdxOffset;
+
+            unsigned int minIndex = UINT_MAX, maxIndex = 0;
+            for (unsigned int j = 0; j < cmd.ElemCount; ++j)
+            {
+                minIndex = ImMin<unsigned int>(minIndex, cmdIndices[j]);
+                maxIndex = ImMax<unsigned int>(maxIndex, cmdIndices[j]);
+            }
+
+            const auto vertexBase  = static_cast<unsigned int>(target.VtxBuffer.Size);
+            const auto vertexCount = maxIndex - minIndex + 1;
+            if (sizeof(ImDrawIdx) == 2 && vertexBase + vertexCount > 0xFFFF)
+                return false;
+
+            const auto indexBase = target.IdxBuffer.Size;
+
+            target.VtxBuffer.resize(target.VtxBuffer.Size + static_cast<int>(vertexCount));
+            memcpy(target.VtxBuffer.Data + vertexBase, drawList->VtxBuffer.Data + cmd.VtxOffset + minIndex, vertexCount * sizeof(ImDrawVert));
+
+            target.IdxBuffer.resize(target.IdxBuffer.Size + static_cast<int>(cmd.ElemCount));
+            for (unsigned int j = 0; j < cmd.ElemCount; ++j)
+                target.IdxBuffer[indexBase + j] = static_cast<ImDrawIdx>(cmdIndices[j] - minIndex + vertexBase);
+
+            ImDrawCmd targetCmd = cmd;
+            targetCmd.VtxOffset = 0;
+            targetCmd.IdxOffset = static_cast<unsigned int>(indexBase);
+            target.CmdBuffer.push_back(targetCmd);
+        }
+    }
+
+    if (target.CmdBuffer.empty())
+        return false;
+
+    auto entry = m_Impostors.Allocate(node, pixelSize, ImGui::GetFrameCount());
+    if (!entry)
+        return false;
+
+    if (!m_Config.RenderNodeImpostor(&target, canvasRect.Min, canvasRect.Max, entry->m_AtlasRect.Min, entry->m_AtlasRect.Max, m_Config.UserPointer))
+    {
+        m_Impostors.Remove(node);
+        return false;
+    }
+
+    entry->m_Offset   = canvasRect.Min - node->m_Bounds.Min;
+    entry->m_Size     = canvasRect.GetSize();
+    entry->m_NodeSize = node->m_Bounds.GetSize();
+    entry->m_Scale    = scale;
+
+    return true;
+}
+
+void ed::EditorContext::SetObjectSelected(Object* object, bool selected)
+{
+    IM_ASSERT(object->m_IsSelected != selected);
+
+    object->m_IsSelected = selected;
+    m_IsSelectionBoundsValid = false;
+
+    // Count objects which state differ from the one at the start of the frame,
+    // selection changed if there is any.
+    if (object->m_IsSelected != object->m_WasSelected)
+    {
+        ++m_SelectionChangeCount;
+        m_SelectionChangedObjects.push_back(object);
+    }
+    else
+        --m_SelectionChangeCount;
+}
+
+void ed::EditorContext::CommitSelectionChanges()
+{
+    for (auto object : m_SelectionChangedObjects)
+        object->m_WasSelected = object->m_IsSelected;
+
+    m_SelectionChangedObjects.resize(0);
+    m_SelectionChangeCount = 0;
+}
+
+void ed::EditorContext::ClearSelection()
+{
+    for (auto object : m_SelectedObjects)
+        SetObjectSelected(object, false);
+
+    m_SelectedObjects.clear();
+}
+
+void ed::EditorContext::SelectObject(Object* object)
+{
+    if (object->m_IsSelected)
+        return;
+
+    SetObjectSelected(object, true);
+
+    m_SelectedObjects.push_back(object);
+}
+
+void ed::EditorContext::DeselectObject(Object* object)
+{
+    if (!object->m_IsSelected)
+        return;
+
+    SetObjectSelected(object, false);
+
+    auto objectIt = std::find(m_SelectedObjects.begin(), m_SelectedObjects.end(), object);
+    if (objectIt != m_SelectedObjects.end())
+        m_SelectedObjects.erase(objectIt);
+}
+
+void ed::EditorContext::DeselectObjects(const vector<Object*>& objects)
+{
+    auto anyDeselected = false;
+    for (auto object : objects)
+    {
+        if (!object->m_IsSelected)
+            continue;
+
+        SetObjectSelected(object, false);
+        anyDeselected = true;
+    }
+
+    if (anyDeselected)
+    {
+        auto endIt = std::remove_if(m_SelectedObjects.begin(), m_SelectedObjects.end(), [](Object* object) { return !object->m_IsSelected; });
+        m_SelectedObjects.erase(endIt, m_SelectedObjects.end());
+    }
+}
+
+void ed::EditorContext::SetSelectedObject(Object* object)
+{
+    ClearSelection();
+    SelectObject(object);
+}
+
+void ed::EditorContext::ToggleObjectSelection(Object* object)
+{
+    if (IsSelected(object))
+        DeselectObject(object);
+    else
+        SelectObject(object);
+}
+
+bool ed::EditorContext::IsSelected(Object* object)
+{
+    return object->m_IsSelected;
+}
+
+const ed::vector<ed::Object*>& ed::EditorContext::GetSelectedObjects()
+{
+    return m_SelectedObjects;
+}
+
+bool ed::EditorContext::IsAnyNodeSelected()
+{
+    for (auto object : m_SelectedObjects)
+        if (object->AsNode())
+            return true;
+
+    return false;
+}
+
+bool ed::EditorContext::IsAnyLinkSelected()
+{
+    for (auto object : m_SelectedObjects)
+        if (object->AsLink())
+            return true;
+
+    return false;
+}
+
+bool ed::EditorContext::HasSelectionChanged()
+{
+    return m_SelectionChangeCount != 0;
+}
+
+ed::Node* ed::EditorContext::FindNodeAt(const ImVec2& p)
+{
+    UpdateNodeOrder();
+
+    QueryNodes(ImRect(p, p));
+
+    // Report node which comes first in m_Nodes, like linear search does.
+    Node* result = nullptr;
+    for (auto object : m_QueryResult)
+    {
+        auto node = object->AsNode();
+        if ((!result || node->m_ZPosition < result->m_ZPosition) && node->TestHit(p))
+            result = node;
+    }
+
+    return result;
+}
+
+void ed::EditorContext::FindNodesInRect(const ImRect& r, vector<Node*>& result, bool append, bool includeIntersecting)
+{
+    if (!append)
+        result.resize(0);
+
+    if (ImRect_IsEmpty(r))
+        return;
+
+    UpdateNodeOrder();
+
+    QueryNodes(r);
+
+    const auto first = result.size();
+
+    for (auto object : m_QueryResult)
+    {
+        auto node = object->AsNode();
+        if (node->TestHit(r, includeIntersecting))
+            result.push_back(node);
+    }
+
+    std::sort(result.begin() + first, result.end(), [](const Node* lhs, const Node* rhs)
+    {
+        return lhs->m_ZPosition < rhs->m_ZPosition;
+    });
+}
+
+void ed::EditorContext::FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append)
+{
+    if (!append)
+        result.resize(0);
+
+    if (ImRect_IsEmpty(r))
+        return;
+
+    m_QueryResult.resize(0);
+    m_LinkIndex.Query(r, m_QueryResult);
+
+    const auto first = result.size();
+
+    for (auto object : m_QueryResult)
+    {
+        auto link = object->AsLink();
+        if (link->TestHit(r))
+            result.push_back(link);
+    }
+
+    std::sort(result.begin() + first, result.end(), [](const Link* lhs, const Link* rhs)
+    {
+        return lhs->m_ID.AsPointer() < rhs->m_ID.AsPointer();
+    });
+}
+
+void ed::EditorContext::FindLinksForNode(NodeId nodeId, vector<Link*>& result, bool add)
+{
+    if (!add)
+        result.clear();
+
+    auto node = FindNode(nodeId);
+    if (!node)
+        return;
+
+    // Live links have live endpoints, these are all chained in their node.
+    for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
+    {
+        if (!pin->IsLive() || pin->m_Node != node)
+            continue;
+
+        for (auto link : pin->m_Links)
+        {
+            if (!link->IsLive())
+                continue;
+
+            // Link between pins of the same node is reported by start pin.
+            if (link->m_StartPin == pin || link->m_StartPin->m_Node != node)
+                result.push_back(link);
+        }
+    }
+}
+
+void ed::EditorContext::FindLinksForPin(PinId pinId, vector<Link*>& result, bool add)
+{
+    if (!add)
+        result.clear();
+
+    auto pin = FindPin(pinId);
+    if (!pin)
+        return;
+
+    for (auto link : pin->m_Links)
+        if (link->IsLive())
+            result.push_back(link);
+}
+
+bool ed::EditorContext::PinHadAnyLinks(PinId pinId)
+{
+    auto pin = FindPin(pinId);
+    if (!pin || !pin->IsLive())
+        return false;
+
+    // Linked in this or previous frame.
+    return pin->m_ConnectionFrame >= m_FrameIndex - 1;
+}
+
+void ed::EditorContext::NotifyLinkDeleted(Link* link)
+{
+    ++link->m_Generation;
+
+    if (m_LastActiveLink == link)
+        m_LastActiveLink = nullptr;
+}
+
+void ed::EditorContext::NotifyNodeBoundsChanged(Node* node)
+{
+    // Index and groups are updated once node is dropped, see EndNodeDrags().
+    if (node->m_IsDragged)
+    {
+        auto& bounds = m_NodeStates.m_Bounds[node->m_StateIndex];
+        const auto lastBounds = bounds;
+        bounds = node->m_Bounds;
+        NotifyContentBoundsChanged(node, &lastBounds);
+        NotifyGeometryChanged();
+        return;
+    }
+
+    ImRect lastBounds;
+    const auto wasIndexed = m_NodeIndex.GetBounds(node, lastBounds);
+
+    m_NodeIndex.Update(node, node->m_Bounds);
+    m_NodeStates.m_Bounds[node->m_StateIndex] = node->m_Bounds;
+    NotifyContentBoundsChanged(node, wasIndexed ? &lastBounds : nullptr);
+
+    // Node may leave or enter groups it touched before or touches now.
+    for (auto group : m_Groups)
+    {
+        if (group == node || group->m_GroupBounds.Overlaps(node->m_Bounds) || (wasIndexed && group->m_GroupBounds.Overlaps(lastBounds)))
+            group->m_IsGroupedNodesDirty = true;
+    }
+
+    NotifyGeometryChanged();
+}
+
+float ed::EditorContext::GetVisibleRounding(float rounding) const
+{
+    return rounding * m_Canvas.ViewScale() < c_MinVisibleRounding ? 0.0f : rounding;
+}
+
+void ed::EditorContext::BeginNodeDrag(Node* node)
+{
+    if (node->m_IsDragged)
+        return;
+
+    node->m_IsDragged = true;
+    m_NodeIndex.Remove(node);
+    m_DraggedNodes.push_back(node);
+}
+
+void ed::EditorContext::EndNodeDrags()
+{
+    if (m_DraggedNodes.empty())
+        return;
+
+    for (auto node : m_DraggedNodes)
+    {
+        node->m_IsDragged = false;
+        m_NodeIndex.Update(node, node->m_Bounds);
+    }
+
+    m_DraggedNodes.resize(0);
+
+    // Same as in SetNodePositions(), nodes may have left or entered any group.
+    for (auto group : m_Groups)
+        group->m_IsGroupedNodesDirty = true;
+
+    NotifyGeometryChanged();
+}
+
+void ed::EditorContext::NotifyContentBoundsChanged(const Node* node, const ImRect* lastBounds)
+{
+    if (!m_IsContentBoundsValid)
+        return;
+
+    // Node which touched the edge and no longer covers its last bounds may
+    // shrink content, find the new edge on next query.
+    if (lastBounds && !node->m_Bounds.Contains(*lastBounds))
+    {
+        const auto& last    = *lastBounds;
+        const auto& content = m_ContentBounds;
+        if (last.Min.x <= content.Min.x || last.Min.y <= content.Min.y || last.Max.x >= content.Max.x || last.Max.y >= content.Max.y)
+        {
+            m_IsContentBoundsValid = false;
+            return;
+        }
+    }
+
+    if (node->IsLive())
+        m_ContentBounds.Add(node->m_Bounds);
+}
+
+void ed::EditorContext::NotifyNodeTypeChanged(Node* node)
+{
+    m_IsNodeLayerDirty = true;
+
+    auto groupIt = std::find(m_Groups.begin(), m_Groups.end(), node);
+    if (IsGroup(node) && groupIt == m_Groups.end())
+        m_Groups.push_back(node);
+    else if (!IsGroup(node) && groupIt != m_Groups.end())
+        m_Groups.erase(groupIt);
+
+    // Groups may be nested in this one now, or not anymore.
+    for (auto group : m_Groups)
+        group->m_IsGroupedNodesDirty = true;
+}
+
+void ed::EditorContext::GetGroupedNodes(Node* group, vector<Node*>& result)
+{
+    auto updateGroupedNodes = [this](Node* group)
+    {
+        if (!group->m_IsGroupedNodesDirty)
+            return;
+
+        QueryNodes(group->m_GroupBounds);
+
+        group->m_GroupedNodes.resize(0);
+        for (auto object : m_QueryResult)
+        {
+            auto node = object->AsNode();
+            if (node != group && !ImRect_IsEmpty(node->m_Bounds) && group->m_GroupBounds.Contains(node->m_Bounds))
+                group->m_GroupedNodes.push_back(node);
+        }
+
+        group->m_IsGroupedNodesDirty = false;
+    };
+
+    UpdateNodeOrder();
+
+    // Stamp marks nodes already reported.
+    const auto stamp = ++m_GroupedStamp;
+    group->m_GroupedStamp = stamp;
+
+    const auto firstNodeIndex = result.size();
+
+    updateGroupedNodes(group);
+    for (auto node : group->m_GroupedNodes)
+    {
+        if (node->IsLive() && node->m_GroupedStamp != stamp)
+        {
+            node->m_GroupedStamp = stamp;
+            result.push_back(node);
+        }
+    }
+
+    for (auto index = firstNodeIndex; index < result.size(); ++index)
+    {
+        auto node = result[index];
+        if (!IsGroup(node))
+            continue;
+
+        updateGroupedNodes(node);
+        for (auto child : node->m_GroupedNodes)
+        {
+            if (child->IsLive() && child->m_GroupedStamp != stamp)
+            {
+                child->m_GroupedStamp = stamp;
+                result.push_back(child);
+            }
+        }
+    }
+
+    std::sort(result.begin() + firstNodeIndex, result.end(), [](const Node* lhs, const Node* rhs)
+    {
+        return lhs->m_ZPosition < rhs->m_ZPosition;
+    });
+}
+
+void ed::EditorContext::Suspend(SuspendFlags flags)
+{
+    auto drawList = ImGui::GetWindowDrawList();
+    auto lastChannel = drawList->_Splitter._Current;
+    ImDrawList_ChannelsSetCurrent(drawList, m_ExternalChannel);
+    m_Canvas.Suspend();
+    ImDrawList_ChannelsSetCurrent(drawList, lastChannel);
+    if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
+        ImDrawList_SwapSplitter(drawList, m_Splitter);
+}
+
+void ed::EditorContext::Resume(SuspendFlags flags)
+{
+    auto drawList = ImGui::GetWindowDrawList();
+    if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
+        ImDrawList_SwapSplitter(drawList, m_Splitter);
+    auto lastChannel = drawList->_Splitter._Current;
+    ImDrawList_ChannelsSetCurrent(drawList, m_ExternalChannel);
+    m_Canvas.Resume();
+    ImDrawList_ChannelsSetCurrent(drawList, lastChannel);
+}
+
+bool ed::EditorContext::IsSuspended()
+{
+	return m_Canvas.IsSuspended();
+}
+
+bool ed::EditorContext::IsActive()
+{
+    return m_IsWindowActive;
+}
+
+ed::Pin* ed::EditorContext::CreatePin(PinId id, PinKind kind)
+{
+    IM_ASSERT(nullptr == FindObject(id));
+    auto pin = m_PinPool.Create(this, id, kind);
+    m_Pins.push_back({id, pin});
+    m_PinStates.Add(pin, true);
+    m_PinMap.Insert(id, pin);
+    m_IsPinOrderDirty = true;
+    return pin;
+}
+
+ed::Node* ed::EditorContext::CreateNode(NodeId id)
+{
+    IM_ASSERT(nullptr == FindObject(id));
+    auto node = m_NodePool.Create(this, id);
+    m_Nodes.push_back({id, node});
+    m_NodeStates.Add(node, false);
+    m_NodeMap.Insert(id, node);
+
+    auto settings = m_Settings.FindNode(id);
+    if (!settings)
+        settings = m_Settings.AddNode(id);
+
+    if (!settings->m_WasUsed)
+    {
+        settings->m_WasUsed = true;
+        RestoreNodeState(node);
+    }
+
+    node->m_Bounds.Min  = settings->m_Location;
+    node->m_Bounds.Max  = node->m_Bounds.Min;
+    node->m_Bounds.Floor();
+
+    NotifyNodeBoundsChanged(node);
+    NotifyNodeOrderChanged();
+
+    if (settings->m_GroupSize.x > 0 || settings->m_GroupSize.y > 0)
+    {
+        node->m_Type            = NodeType::Group;
+        node->m_GroupBounds.Min = settings->m_Location;
+        node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings->m_GroupSize;
+        node->m_GroupBounds.Floor();
+        NotifyNodeTypeChanged(node);
+    }
+
+    node->SetLive(false);
+
+    return node;
+}
+
+ed::Link* ed::EditorContext::CreateLink(LinkId id)
+{
+    IM_ASSERT(nullptr == FindObject(id));
+    auto link = m_LinkPool.Create(this, id);
+    m_Links.push_back({id, link});
+    m_LinkStates.Add(link, true);
+    m_LinkMap.Insert(id, link);
+    m_IsLinkOrderDirty = true;
+
+    return link;
+}
+
+ed::Node* ed::EditorContext::FindNode(NodeId id)
+{
+    return m_NodeMap.Find(id);
+}
+
+ed::Pin* ed::EditorContext::FindPin(PinId id)
+{
+    return m_PinMap.Find(id);
+}
+
+ed::Link* ed::EditorContext::FindLink(LinkId id)
+{
+    return m_LinkMap.Find(id);
+}
+
+ed::Object* ed::EditorContext::FindObject(ObjectId id)
+{
+    if (id.IsNodeId())
+        return FindNode(id.AsNodeId());
+    else if (id.IsLinkId())
+        return FindLink(id.AsLinkId());
+    else if (id.IsPinId())
+        return FindPin(id.AsPinId());
+    else
+        return nullptr;
+}
+
+ed::Node* ed::EditorContext::GetNode(NodeId id)
+{
+    auto node = FindNode(id);
+    if (!node)
+        node = CreateNode(id);
+    return node;
+}
+
+ed::Pin* ed::EditorContext::GetPin(PinId id, PinKind kind)
+{
+    if (auto pin = FindPin(id))
+    {
+        pin->m_Kind = kind;
+        return pin;
+    }
+    else
+        return CreatePin(id, kind);
+}
+
+ed::Link* ed::EditorContext::GetLink(LinkId id)
+{
+    if (auto link = FindLink(id))
+        return link;
+    else
+        return CreateLink(id);
+}
+
+template <typename T>
+static ed::ObjectHandle<decltype(T::m_ID)> MakeHandle(T* object)
+{
+    ed::ObjectHandle<decltype(T::m_ID)> handle;
+    handle.ID         = object->m_ID;
+    handle.Object     = object;
+    handle.Generation = object->m_Generation;
+    return handle;
+}
+
+ed::NodeHandle ed::EditorContext::AcquireNode(NodeId id)
+{
+    return MakeHandle(GetNode(id));
+}
+
+ed::PinHandle ed::EditorContext::AcquirePin(PinId id)
+{
+    auto pin = FindPin(id);
+    if (!pin)
+    {
+        // Kind is set by BeginPin().
+        pin = CreatePin(id, PinKind::Input);
+        pin->SetLive(false);
+    }
+
+    return MakeHandle(pin);
+}
+
+ed::LinkHandle ed::EditorContext::AcquireLink(LinkId id)
+{
+    auto link = FindLink(id);
+    if (!link)
+    {
+        link = CreateLink(id);
+        link->SetLive(false);
+    }
+
+    return MakeHandle(link);
+}
+
+void ed::EditorContext::LoadSettings()
+{
+    ed::Settings::Parse(m_Config.Load(), m_Settings, m_Config.LazyLoadNodeSettings);
+
+    m_NavigateAction.m_Scroll = m_Settings.m_ViewScroll;
+    m_NavigateAction.m_Zoom   = m_Settings.m_ViewZoom;
+}
+
+void ed::EditorContext::SaveSettings()
+{
+    FrameProfiler::Scope profile(m_Profiler, FramePhase::SaveSettings);
+
+    m_Config.BeginSave();
+
+    // Only nodes made dirty since last save can differ from their settings.
+    vector<size_t> dirtyNodes;
+    dirtyNodes.swap(m_Settings.m_DirtyNodes);
+
+    vector<std::string>        nodeData;
+    vector<NodeSettingsChange> nodeChanges;
+    if (m_Config.SaveNodeSettingsBatch)
+    {
+        nodeData.reserve(dirtyNodes.size());
+        nodeChanges.reserve(dirtyNodes.size());
+    }
+
+    for (auto index : dirtyNodes)
+    {
+        auto& settings = m_Settings.m_Nodes[index];
+        if (!settings.m_IsDirty)
+            continue;
+
+        auto node = FindNode(settings.m_ID);
+        if (!node)
+            continue;
+
+        settings.m_Location = node->m_Bounds.Min;
+        settings.m_Size     = node->m_Bounds.GetSize();
+        if (IsGroup(node))
+            settings.m_GroupSize = node->m_GroupBounds.GetSize();
+
+        if (node->m_RestoreState)
+            continue;
+
+        if (m_Config.SaveNodeSettingsBatch)
+        {
+            nodeData.push_back(settings.Serialize(m_Config.SaveFormat));
+
+            NodeSettingsChange change;
+            change.Id     = settings.m_ID;
+            change.Data   = nodeData.back().c_str();
+            change.Size   = nodeData.back().size();
+            change.Reason = settings.m_DirtyReason;
+            nodeChanges.push_back(change);
+        }
+        else if (m_Config.SaveNodeSettings)
+        {
+            if (m_Config.SaveNode(node->m_ID, settings.Serialize(m_Config.SaveFormat), settings.m_DirtyReason))
+                settings.ClearDirty();
+        }
+    }
+
+    auto nodesSaved = false;
+    if (!nodeChanges.empty() && m_Config.SaveNodes(nodeChanges))
+    {
+        for (auto& change : nodeChanges)
+            m_Settings.FindNode(change.Id)->ClearDirty();
+
+        nodesSaved = true;
+    }
+
+    // Keep nodes which were not saved for next attempt.
+    for (auto index : dirtyNodes)
+        if (m_Settings.m_Nodes[index].m_IsDirty)
+            m_Settings.m_DirtyNodes.push_back(index);
+
+    m_Settings.m_Selection.resize(0);
+    for (auto& object : m_SelectedObjects)
+        m_Settings.m_Selection.push_back(object->ID());
+
+    m_Settings.m_ViewScroll = m_NavigateAction.m_Scroll;
+    m_Settings.m_ViewZoom   = m_NavigateAction.m_Zoom;
+
+    // Nodes saved in batch do not require whole settings to be rewritten.
+    const auto globalReasons = SaveReasonFlags::Navigation | SaveReasonFlags::Selection;
+    const auto needFullSave  = !m_Config.SaveNodeSettingsBatch
+        || (m_Settings.m_DirtyReason & globalReasons) != SaveReasonFlags::None
+        || (!nodesSaved && !nodeChanges.empty());
+
+    if (!needFullSave || m_Config.Save(m_Settings, m_Settings.m_DirtyReason))
+        m_Settings.ClearDirty();
+
+    m_Config.EndSave();
+}
+
+void ed::EditorContext::MakeDirty(SaveReasonFlags reason)
+{
+    m_Settings.MakeDirty(reason);
+}
+
+void ed::EditorContext::MakeDirty(SaveReasonFlags reason, Node* node)
+{
+    m_Settings.MakeDirty(reason, node);
+}
+
+void ed::EditorContext::QueryNodes(const ImRect& rect)
+{
+    m_QueryResult.resize(0);
+    m_NodeIndex.Query(rect, m_QueryResult);
+
+    for (auto node : m_DraggedNodes)
+    {
+        const auto& bounds = node->m_Bounds;
+        if (bounds.Min.x <= rect.Max.x && rect.Min.x <= bounds.Max.x && bounds.Min.y <= rect.Max.y && rect.Min.y <= bounds.Max.y)
+            m_QueryResult.push_back(node);
+    }
+}
+
+ed::Link* ed::EditorContext::FindLinkAt(const ImVec2& p)
+{
+    auto area = ImRect(p, p);
+    area.Expand(c_LinkSelectThickness);
+
+    m_QueryResult.resize(0);
+    m_LinkIndex.Query(area, m_QueryResult);
+
+    // Test candidates in m_Links order, first hit wins like in linear search.
+    std::sort(m_QueryResult.begin(), m_QueryResult.end(), [](Object* lhs, Object* rhs)
+    {
+        return lhs->AsLink()->m_ID.AsPointer() < rhs->AsLink()->m_ID.AsPointer();
+    });
+
+    // Same test as Link::TestHit(), curves passing bounds check are
+    // projected in batch.
+    m_QueryLinks.resize(0);
+    m_QueryCurves.resize(0);
+    for (auto object : m_QueryResult)
+    {
+        auto link = object->AsLink();
+
+        auto bounds = link->GetBounds();
+        bounds.Expand(c_LinkSelectThickness);
+        if (!link->IsLive() || !bounds.Contains(p))
+            continue;
+
+        if (!link->TestSegmentBounds(p, link->m_Thickness + c_LinkSelectThickness))
+            continue;
+
+        m_QueryLinks.push_back(link);
+        m_QueryCurves.push_back(link->GetCurve());
+    }
+
+    m_QueryProjections.resize(m_QueryCurves.size());
+    ImProjectOnCubicBezierBatch(p, m_QueryCurves.data(), static_cast<int>(m_QueryCurves.size()), m_QueryProjections.data(), 50);
+
+    for (size_t i = 0; i < m_QueryLinks.size(); ++i)
+    {
+        auto link = m_QueryLinks[i];
+        if (m_QueryProjections[i].Distance <= link->m_Thickness + c_LinkSelectThickness)
+            return link;
+    }
+
+    return nullptr;
+}
+
+ImU32 ed::EditorContext::GetColor(StyleColor colorIndex) const
+{
+    // Colors are the same for most of objects drawn in a frame, they are
+    // packed once and again only after style is pushed or popped.
+    if (m_StyleColorsGeneration != m_Style.GetGeneration())
+    {
+        for (int i = 0; i < StyleColor_Count; ++i)
+            m_StyleColors[i] = ImColor(m_Style.Colors[i]);
+        m_StyleColorsGeneration = m_Style.GetGeneration();
+    }
+
+    return m_StyleColors[colorIndex];
+}
+
+ImU32 ed::EditorContext::GetColor(StyleColor colorIndex, float alpha) const
+{
+    if (alpha == 1.0f)
+        return GetColor(colorIndex);
+
+    auto color = m_Style.Colors[colorIndex];
+    return ImColor(color.x, color.y, color.z, color.w * alpha);
+}
+
+void ed::EditorContext::RegisterAnimation(Animation* animation)
+{
+    if (animation->m_LiveIndex >= 0)
+        return;
+
+    animation->m_LiveIndex = static_cast<int>(m_LiveAnimations.size());
+    m_LiveAnimations.push_back(animation);
+}
+
+void ed::EditorContext::UnregisterAnimation(Animation* animation)
+{
+    const auto index = animation->m_LiveIndex;
+    if (index < 0)
+        return;
+
+    // Order of live animations does not matter, fill the gap with last one.
+    auto last = m_LiveAnimations.back();
+    m_LiveAnimations[index] = last;
+    last->m_LiveIndex = index;
+    m_LiveAnimations.pop_back();
+
+    animation->m_LiveIndex = -1;
+}
+
+void ed::EditorContext::SortObjects()
+{
+    // Objects created during frame are appended, containers are sorted
+    // once here instead of on every insertion.
+    if (m_IsPinOrderDirty)
+    {
+        std::sort(m_Pins.begin(), m_Pins.end());
+        m_PinStates.Reorder(m_Pins);
+        m_IsPinOrderDirty = false;
+    }
+
+    if (m_IsLinkOrderDirty)
+    {
+        std::sort(m_Links.begin(), m_Links.end());
+        m_LinkStates.Reorder(m_Links);
+        m_IsLinkOrderDirty = false;
+    }
+}
+
+void ed::EditorContext::UpdateNodeStateOrder()
+{
+    if (!m_IsNodeStateOrderDirty)
+        return;
+
+    m_NodeStates.Reorder(m_Nodes);
+    m_IsNodeStateOrderDirty = false;
+    m_Minimap.m_IsDirty = true;
+}
+
+void ed::EditorContext::UpdateNodeOrder()
+{
+    if (!m_IsNodeOrderDirty)
+        return;
+
+    bool changed = false;
+
+    int position = 0;
+    for (auto node : m_Nodes)
+    {
+        changed |= node->m_ZPosition != position;
+        node->m_ZPosition = position++;
+    }
+
+    if (changed)
+        NotifyGeometryChanged();
+
+    m_IsNodeOrderDirty = false;
+}
+
+void ed::EditorContext::UpdateAnimations()
+{
+    m_LastLiveAnimations = m_LiveAnimations;
+
+    // Animations may stop each other while updating, skip ones which did.
+    for (auto animation : m_LastLiveAnimations)
+    {
+        if (animation->m_LiveIndex >= 0)
+            animation->Update();
+    }
+}
+
+void ed::EditorContext::Flow(Link* link)
+{
+    m_FlowAnimationController.Flow(link);
+}
+
+void ed::EditorContext::SetUserContext(bool globalSpace)
+{
+    const auto mousePos = ImGui::GetMousePos();
+
+    // Move drawing cursor to mouse location and prepare layer for
+    // content added by user.
+    if (globalSpace)
+        ImGui::SetCursorScreenPos(m_Canvas.FromLocal(mousePos));
+    else
+        ImGui::SetCursorScreenPos(m_Canvas.FromLocal(mousePos));
+        //ImGui::SetCursorScreenPos(ImFloor(mousePos));
+        //ImGui::SetCursorScreenPos(ImVec2(floorf(mousePos.x), floorf(mousePos.y)));
+
+    if (!IsSuspended())
+    {
+        auto drawList = ImGui::GetWindowDrawList();
+        ImDrawList_ChannelsSetCurrent(drawList, c_UserChannel_Content);
+    }
+
+    // #debug
+    // drawList->AddCircleFilled(ImGui::GetMousePos(), 4, IM_COL32(0, 255, 0, 255));
+}
+
+void ed::EditorContext::EnableShortcuts(bool enable)
+{
+    m_ShortcutsEnabled = enable;
+}
+
+bool ed::EditorContext::AreShortcutsEnabled()
+{
+    return m_ShortcutsEnabled;
+}
+
+ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
+{
+    FrameProfiler::Scope profile(m_Profiler, FramePhase::BuildControl);
+
+    if (!allowOffscreen && (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) || m_Minimap.m_IsHovered))
+        return Control(nullptr, nullptr, nullptr, nullptr, false, false, false, false);
+
+    const auto mousePos = ImGui::GetMousePos();
+
+    // Expand clip rectangle to always contain cursor
+    auto editorRect = m_Canvas.ViewRect();
+    auto isMouseOffscreen = allowOffscreen && !editorRect.Contains(mousePos);
+    if (isMouseOffscreen)
+    {
+        // Extend clip rect to capture off-screen mouse cursor
+        editorRect.Add(ImFloor(mousePos));
+        editorRect.Add(ImVec2(ImCeil(mousePos.x), ImCeil(mousePos.y)));
+
+        ImGui::PushClipRect(editorRect.Min, editorRect.Max, false);
+    }
+
+    Object* hotObject           = nullptr;
+    Object* activeObject        = nullptr;
+    Object* clickedObject       = nullptr;
+    Object* doubleClickedObject = nullptr;
+
+    // Emits invisible button and returns true if it is clicked.
+    auto emitInteractiveArea = [](ObjectId id, const ImRect& rect)
+    {
+        char idString[33] = { 0 }; // itoa can output 33 bytes maximum
+        snprintf(idString, 32, "%p", id.AsPointer());
+        ImGui::SetCursorScreenPos(rect.Min);
+
+        // debug
+        //if (id < 0) return ImGui::Button(idString, to_imvec(rect.size));
+
+        auto result = ImGui::InvisibleButton(idString, rect.GetSize());
+
+        // #debug
+        //ImGui::GetWindowDrawList()->AddRectFilled(ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), IM_COL32(0, 255, 0, 64));
+
+        return result;
+    };
+
+    // Check input interactions over area.
+    auto checkInteractionsInArea = [&emitInteractiveArea, &hotObject, &activeObject, &clickedObject, &doubleClickedObject](ObjectId id, const ImRect& rect, Object* object)
+    {
+        if (emitInteractiveArea(id, rect))
+            clickedObject = object;
+        if (!doubleClickedObject && ImGui::IsMouseDoubleClicked(0) && ImGui::IsItemHovered())
+            doubleClickedObject = object;
+
+        if (!hotObject && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
+            hotObject = object;
+
+        return ImGui::IsItemActive();
+    };
+
+    // Check input interactions over object. Groups are interactive only
+    // over their regions, each emitted with own id.
+    auto checkInteractionsWithObject = [&checkInteractionsInArea](Object* object, NodeRegion region)
+    {
+        if (auto pin = object->AsPin())
+            return checkInteractionsInArea(pin->m_ID, pin->m_Bounds, pin);
+
+        auto node = object->AsNode();
+        if (node->m_Type != NodeType::Group)
+            return checkInteractionsInArea(node->m_ID, node->m_Bounds, node);
+
+        ImGui::PushID(node->m_ID.AsPointer());
+        auto result = checkInteractionsInArea(NodeId(static_cast<int>(region)), node->GetRegionBounds(region), node);
+        ImGui::PopID();
+
+        return result;
+    };
+
+    UpdateNodeOrder();
+
+    // Mouse and geometry did not move since last frame, object under
+    // cursor is the same one.
+    // Under frame budget pressure result is kept for few frames while only
+    // the mouse moves. Buttons always get fresh hit-test.
+    const auto hoverInterval = GetQuality().HoverInterval;
+    const auto reuseHover    = hoverInterval > 1
+        && m_HoverCache.m_IsValid
+        && m_HoverCache.m_Generation == m_GeometryGeneration
+        && m_FrameIndex - m_HoverCache.m_FrameIndex < hoverInterval
+        && !ImGui::IsAnyMouseDown()
+        && !ImGui::IsMouseReleased(0) && !ImGui::IsMouseReleased(1) && !ImGui::IsMouseReleased(2);
+
+    if (!reuseHover && (!m_HoverCache.m_IsValid || m_HoverCache.m_Generation != m_GeometryGeneration || m_HoverCache.m_MousePos != mousePos))
+    {
+        m_HoverCache.m_IsValid    = false;
+        m_HoverCache.m_Generation = m_GeometryGeneration;
+        m_HoverCache.m_MousePos   = mousePos;
+        m_HoverCache.m_HasHotLink = false;
+        m_HoverCache.m_HotLink    = nullptr;
+    }
+
+    // Find object under mouse cursor. Nodes are tested from top to bottom,
+    // pins of the node before node itself. Pins does not overlap each other
+    // and all are within node bounds.
+    Object*    hitObject = m_HoverCache.m_HitObject;
+    NodeRegion hitRegion = m_HoverCache.m_HitRegion;
+    if (!m_HoverCache.m_IsValid)
+    {
+        hitObject = nullptr;
+        hitRegion = NodeRegion::None;
+
+        static const NodeRegion c_Regions[] =
+        {
+            NodeRegion::TopLeft,
+            NodeRegion::TopRight,
+            NodeRegion::BottomLeft,
+            NodeRegion::BottomRight,
+            NodeRegion::Top,
+            NodeRegion::Bottom,
+            NodeRegion::Left,
+            NodeRegion::Right,
+            NodeRegion::Header,
+        };
+
+        // Small groups have regions expanded beyond node bounds.
+        const auto queryMargin = ImMax(GetView().InvScale, 1.0f) * c_GroupSelectThickness * 2.5f;
+
+        QueryNodes(ImRect(mousePos - ImVec2(queryMargin, queryMargin), mousePos + ImVec2(queryMargin, queryMargin)));
+
+        std::sort(m_QueryResult.begin(), m_QueryResult.end(), [](Object* lhs, Object* rhs)
+        {
+            return lhs->AsNode()->m_ZPosition > rhs->AsNode()->m_ZPosition;
+        });
+
+        for (auto object : m_QueryResult)
+        {
+            auto node = object->AsNode();
+            if (!node->IsLive())
+                continue;
+
+            for (auto pin = node->m_LastPin; pin && !hitObject; pin = pin->m_PreviousPin)
+            {
+                if (pin->IsLive() && pin->m_Bounds.Contains(mousePos))
+                    hitObject = pin;
+            }
+
+            if (!hitObject && node->m_Type == NodeType::Group)
+            {
+                for (auto region : c_Regions)
+                {
+                    if (node->GetRegionBounds(region).Contains(mousePos))
+                    {
+                        hitObject = node;
+                        hitRegion = region;
+                        break;
+                    }
+                }
+            }
+            else if (!hitObject && node->m_Bounds.Contains(mousePos))
+                hitObject = node;
+
+            if (hitObject)
+                break;
+        }
+
+        m_HoverCache.m_IsValid    = true;
+        m_HoverCache.m_HitObject  = hitObject;
+        m_HoverCache.m_HitRegion  = hitRegion;
+        m_HoverCache.m_FrameIndex = m_FrameIndex;
+    }
+
+    // Only object under cursor and object which was active are submitted
+    // to ImGui. Active one must be submitted every frame to remain active.
+    auto lastActiveObject = m_LastActiveObject;
+    auto lastActiveRegion = m_LastActiveRegion;
+    m_LastActiveObject = nullptr;
+    m_LastActiveRegion = NodeRegion::None;
+
+    if (hitObject && checkInteractionsWithObject(hitObject, hitRegion))
+    {
+        activeObject       = hitObject;
+        m_LastActiveObject = hitObject;
+        m_LastActiveRegion = hitRegion;
+    }
+
+    if (lastActiveObject && lastActiveObject->IsLive() && (lastActiveObject != hitObject || lastActiveRegion != hitRegion))
+    {
+        if (checkInteractionsWithObject(lastActiveObject, lastActiveRegion))
+        {
+            activeObject       = lastActiveObject;
+            m_LastActiveObject = lastActiveObject;
+            m_LastActiveRegion = lastActiveRegion;
+        }
+    }
+
+    // Links are not regular widgets and must be done manually since
+    // ImGui does not support interactive elements with custom hit maps.
+    //
+    // Links can steal input from background.
+
+    // Links are just over background. So if anything else
+    // is hovered we can skip them.
+    if (nullptr == hotObject)
+    {
+        if (!m_HoverCache.m_HasHotLink)
+        {
+            m_HoverCache.m_HasHotLink = true;
+            m_HoverCache.m_HotLink    = FindLinkAt(mousePos);
+        }
+
+        hotObject = m_HoverCache.m_HotLink;
+    }
+
+    // Check for interaction with background.
+    auto backgroundClicked       = emitInteractiveArea(NodeId(0), editorRect);
+    auto backgroundDoubleClicked = !doubleClickedObject && ImGui::IsItemHovered() ? ImGui::IsMouseDoubleClicked(0) : false;
+    auto isBackgroundActive      = ImGui::IsItemActive();
+    auto isBackgroundHot         = !hotObject;
+    auto isDragging              = ImGui::IsMouseDragging(0, 1) || ImGui::IsMouseDragging(1, 1) || ImGui::IsMouseDragging(2, 1);
+
+    if (backgroundDoubleClicked)
+        backgroundClicked = false;
+
+    if (isMouseOffscreen)
+        ImGui::PopClipRect();
+
+    // Process link input using background interactions.
+    auto hotLink = hotObject ? hotObject->AsLink() : nullptr;
+
+    // ImGui take care of tracking active items. With link
+    // we must do this ourself.
+    if (!isDragging && isBackgroundActive && hotLink && !m_LastActiveLink)
+        m_LastActiveLink = hotLink;
+    if (isBackgroundActive && m_LastActiveLink)
+    {
+        activeObject       = m_LastActiveLink;
+        isBackgroundActive = false;
+    }
+    else if (!isBackgroundActive && m_LastActiveLink)
+        m_LastActiveLink = nullptr;
+
+    // Steal click from backgrounds if link is hovered.
+    if (!isDragging && backgroundClicked && hotLink)
+    {
+        clickedObject     = hotLink;
+        backgroundClicked = false;
+    }
+
+    // Steal double-click from backgrounds if link is hovered.
+    if (!isDragging && backgroundDoubleClicked && hotLink)
+    {
+        doubleClickedObject = hotLink;
+        backgroundDoubleClicked = false;
+    }
+
+    return Control(hotObject, activeObject, clickedObject, doubleClickedObject,
+        isBackgroundHot, isBackgroundActive, backgroundClicked, backgroundDoubleClicked);
+}
+
+ed::FrameStats ed::EditorContext::GetFrameStats() const
+{
+    auto stats = m_FrameStats;
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i)
+        stats.Phases[i] = m_Profiler.GetTiming(static_cast<FramePhase>(i));
+    return stats;
+}
+
+void ed::EditorContext::ShowMetrics(const Control& control)
+{
+    auto& io = ImGui::GetIO();
+
+    auto getObjectName = [](Object* object)
+    {
+        if (!object) return "";
+        else if (object->AsNode())  return "Node";
+        else if (object->AsPin())   return "Pin";
+        else if (object->AsLink())  return "Link";
+        else return "";
+    };
+
+    auto getHotObjectName = [&control, &getObjectName]()
+    {
+        if (control.HotObject)
+            return getObjectName(control.HotObject);
+        else if (control.BackgroundHot)
+            return "Background";
+        else
+            return "<unknown>";
+    };
+
+    auto getActiveObjectName = [&control, &getObjectName]()
+    {
+        if (control.ActiveObject)
+            return getObjectName(control.ActiveObject);
+        else if (control.BackgroundActive)
+            return "Background";
+        else
+            return "<unknown>";
+    };
+
+    auto liveNodeCount  = (int)std::count(m_NodeStates.m_IsLive.begin(), m_NodeStates.m_IsLive.end(), 1);
+    auto livePinCount   = (int)std::count(m_PinStates.m_IsLive.begin(),  m_PinStates.m_IsLive.end(),  1);
+    auto liveLinkCount  = (int)std::count(m_LinkStates.m_IsLive.begin(), m_LinkStates.m_IsLive.end(), 1);
+
+    auto canvasRect     = m_Canvas.Rect();
+    auto viewRect       = m_Canvas.ViewRect();
+    auto localMousePos  = m_Canvas.ToLocal(io.MousePos);
+    auto globalMousePos = io.MousePos;
+
+    ImGui::SetCursorScreenPos(canvasRect.Min + ImVec2(5, 5));
+    ImGui::BeginGroup();
+    ImGui::Text("Is Editor Active: %s", ImGui::IsWindowHovered() ? "true" : "false");
+    ImGui::Text("View Position: { x=%g y=%g }", viewRect.Min.x, viewRect.Min.y);
+    ImGui::Text("View Size: { w=%g h=%g }", viewRect.GetWidth(), viewRect.GetHeight());
+    ImGui::Text("Canvas Size: { w=%g h=%g }", canvasRect.GetWidth(), canvasRect.GetHeight());
+    ImGui::Text("Mouse: { x=%.0f y=%.0f } global: { x=%g y=%g }", localMousePos.x, localMousePos.y, globalMousePos.x, globalMousePos.y);
+    ImGui::Text("Live Nodes: %d", liveNodeCount);
+    ImGui::Text("Live Pins: %d", livePinCount);
+    ImGui::Text("Live Links: %d", liveLinkCount);
+    ImGui::Text("Vertices: %d Indices: %d Draw Commands: %d Channels: %d",
+        m_FrameStats.VertexCount, m_FrameStats.IndexCount, m_FrameStats.DrawCommandCount, m_FrameStats.ChannelCount);
+    ImGui::Text("End: %.3f ms Budget: %.3f ms Quality Level: %d", m_FrameStats.EndTime, m_Config.FrameBudget, m_FrameStats.QualityLevel);
+# if IMGUI_NODE_EDITOR_PROFILER()
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i)
+    {
+        const auto timing = m_Profiler.GetTiming(static_cast<FramePhase>(i));
+        ImGui::Text("%-16s %7.3f ms (min %.3f avg %.3f max %.3f)", c_FramePhaseNames[i], timing.Last, timing.Min, timing.Average, timing.Max);
+    }
+# endif
+    ImGui::Text("Hot Object: %s (%p)", getHotObjectName(), control.HotObject ? control.HotObject->ID().AsPointer() : nullptr);
+    if (auto node = control.HotObject ? control.HotObject->AsNode() : nullptr)
+    {
+        ImGui::SameLine();
+        ImGui::Text("{ x=%g y=%g w=%g h=%g }", node->m_Bounds.Min.x, node->m_Bounds.Min.y, node->m_Bounds.GetWidth(), node->m_Bounds.GetHeight());
+    }
+    ImGui::Text("Active Object: %s (%p)", getActiveObjectName(), control.ActiveObject ? control.ActiveObject->ID().AsPointer() : nullptr);
+    if (auto node = control.ActiveObject ? control.ActiveObject->AsNode() : nullptr)
+    {
+        ImGui::SameLine();
+        ImGui::Text("{ x=%g y=%g w=%g h=%g }", node->m_Bounds.Min.x, node->m_Bounds.Min.y, node->m_Bounds.GetWidth(), node->m_Bounds.GetHeight());
+    }
+    ImGui::Text("Action: %s", m_CurrentAction ? m_CurrentAction->GetName() : "<none>");
+    ImGui::Text("Action Is Dragging: %s", m_CurrentAction && m_CurrentAction->IsDragging() ? "Yes" : "No");
+    m_NavigateAction.ShowMetrics();
+    m_SizeAction.ShowMetrics();
+    m_DragAction.ShowMetrics();
+    m_SelectAction.ShowMetrics();
+    m_ContextMenuAction.ShowMetrics();
+    m_CreateItemAction.ShowMetrics();
+    m_DeleteItemsAction.ShowMetrics();
+    ImGui::EndGroup();
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Node Settings
+//
+//------------------------------------------------------------------------------
+// Binary settings layout, all values are little-endian:
+//   header:    char[4] magic, uint32 version
+//   settings:  "NESB" header, float scroll x, y, float zoom,
+//              uint32 node count, node count x { uint64 id, node record },
+//              uint32 selection count, selection count x { uint8 type, uint64 id }
+//   node:      "NESN" header, node record
+//   record:    float location x, y, size x, y, group size x, y
+static const char     c_BinarySettingsMagic[4]     = { 'N', 'E', 'S', 'B' };
+static const char     c_BinaryNodeSettingsMagic[4] = { 'N', 'E', 'S', 'N' };
+static const uint32_t c_BinarySettingsVersion      = 1;
+
+struct BinarySettingsWriter
+{
+    std::string m_Data;
+
+    void Bytes(const char* data, size_t size) { m_Data.append(data, size); }
+
+    void U8(uint8_t value) { m_Data.push_back(static_cast<char>(value)); }
+
+    void U32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            U8(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    void U64(uint64_t value)
+    {
+        U32(static_cast<uint32_t>(value));
+        U32(static_cast<uint32_t>(value >> 32));
+    }
+
+    void Float(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        U32(bits);
+    }
+
+    void Vec2(const ImVec2& value) { Float(value.x); Float(value.y); }
+
+    void Header(const char (&magic)[4]) { Bytes(magic, 4); U32(c_BinarySettingsVersion); }
+};
+
+struct BinarySettingsReader
+{
+    const uint8_t* m_Cursor;
+    const uint8_t* m_End;
+    bool           m_IsValid;
+
+    BinarySettingsReader(const std::string& data)
+        : m_Cursor(reinterpret_cast<const uint8_t*>(data.data()))
+        , m_End(reinterpret_cast<const uint8_t*>(data.data()) + data.size())
+        , m_IsValid(true)
+    {
+    }
+
+    static bool HasHeader(const std::string& data, const char (&magic)[4])
+    {
+        return data.size() >= 8 && memcmp(data.data(), magic, 4) == 0;
+    }
+
+    bool Require(size_t size)
+    {
+        if (static_cast<size_t>(m_End - m_Cursor) < size)
+            m_IsValid = false;
+        return m_IsValid;
+    }
+
+    uint8_t U8()
+    {
+        if (!Require(1))
+            return 0;
+        return *m_Cursor++;
+    }
+
+    uint32_t U32()
+    {
+        if (!Require(4))
+            return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(*m_Cursor++) << (i * 8);
+        return value;
+    }
+
+    uint64_t U64()
+    {
+        const uint64_t lo = U32();
+        const uint64_t hi = U32();
+        return lo | (hi << 32);
+    }
+
+    float Float()
+    {
+        const auto bits = U32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    ImVec2 Vec2() { auto x = Float(); auto y = Float(); return ImVec2(x, y); }
+
+    bool Header(const char (&magic)[4])
+    {
+        if (!Require(4) || memcmp(m_Cursor, magic, 4) != 0)
+            return m_IsValid = false;
+        m_Cursor += 4;
+        if (U32() != c_BinarySettingsVersion)
+            m_IsValid = false;
+        return m_IsValid;
+    }
+};
+
+static void WriteNodeRecord(BinarySettingsWriter& writer, const ed::NodeSettings& settings)
+{
+    writer.Vec2(settings.m_Location);
+    writer.Vec2(settings.m_Size);
+    writer.Vec2(settings.m_GroupSize);
+}
+
+static bool ReadNodeRecord(BinarySettingsReader& reader, ed::NodeSettings& settings)
+{
+    const auto location  = reader.Vec2();
+    const auto size      = reader.Vec2();
+    const auto groupSize = reader.Vec2();
+    if (!reader.m_IsValid)
+        return false;
+
+    settings.m_Location  = location;
+    settings.m_Size      = size;
+    settings.m_GroupSize = groupSize;
+    return true;
+}
+
+void ed::NodeSettings::ClearDirty()
+{
+    m_IsDirty     = false;
+    m_DirtyReason = SaveReasonFlags::None;
+}
+
+void ed::NodeSettings::MakeDirty(SaveReasonFlags reason)
+{
+    m_IsDirty     = true;
+    m_DirtyReason = m_DirtyReason | reason;
+}
+
+ed::json::value ed::NodeSettings::Serialize()
+{
+    json::value result;
+    result["location"]["x"] = m_Location.x;
+    result["location"]["y"] = m_Location.y;
+
+    if (m_GroupSize.x > 0 || m_GroupSize.y > 0)
+    {
+        result["group_size"]["x"] = m_GroupSize.x;
+        result["group_size"]["y"] = m_GroupSize.y;
+    }
+
+    return result;
+}
+
+std::string ed::NodeSettings::Serialize(SettingsFormat format)
+{
+    if (format == SettingsFormat::Binary)
+    {
+        BinarySettingsWriter writer;
+        writer.Header(c_BinaryNodeSettingsMagic);
+        WriteNodeRecord(writer, *this);
+        return std::move(writer.m_Data);
+    }
+
+    return Serialize().dump();
+}
+
+bool ed::NodeSettings::Parse(const std::string& string, NodeSettings& settings)
+{
+    if (BinarySettingsReader::HasHeader(string, c_BinaryNodeSettingsMagic))
+    {
+        BinarySettingsReader reader(string);
+        return reader.Header(c_BinaryNodeSettingsMagic) && ReadNodeRecord(reader, settings);
+    }
+
+    auto settingsValue = json::value::parse(string);
+    if (settingsValue.is_discarded())
+        return false;
+
+    return Parse(settingsValue, settings);
+}
+
+bool ed::NodeSettings::Parse(const json::value& data, NodeSettings& result)
+{
+    if (!data.is_object())
+        return false;
+
+    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    {
+        if (v.is_object())
+        {
+            auto xValue = v["x"];
+            auto yValue = v["y"];
+
+            if (xValue.is_number() && yValue.is_number())
+            {
+                result.x = static_cast<float>(xValue.get<double>());
+                result.y = static_cast<float>(yValue.get<double>());
+
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    if (!tryParseVector(data["location"], result.m_Location))
+        return false;
+
+    if (data.contains("group_size") && !tryParseVector(data["group_size"], result.m_GroupSize))
+        return false;
+
+    return true;
+}
+
+
+
+
+//------------------------------------------------------------------------------
+//
+// Settings
+//
+//------------------------------------------------------------------------------
+ed::NodeSettings* ed::Settings::AddNode(NodeId id)
+{
+    IM_ASSERT(nullptr == FindNode(id));
+    m_NodeIndices[id.Get()] = m_Nodes.size();
+    m_Nodes.push_back(NodeSettings(id));
+    return &m_Nodes.back();
+}
+
+ed::NodeSettings* ed::Settings::FindNode(NodeId id)
+{
+    auto indexIt = m_NodeIndices.find(id.Get());
+    if (indexIt != m_NodeIndices.end())
+        return &m_Nodes[indexIt->second];
+
+    auto pendingIt = m_PendingNodes.find(id.Get());
+    if (pendingIt == m_PendingNodes.end())
+        return nullptr;
+
+    auto range = pendingIt->second;
+    m_PendingNodes.erase(pendingIt);
+
+    auto settings = AddNode(id);
+    NodeSettings::Parse(m_PendingData.substr(range.first, range.second), *settings);
+
+    if (m_PendingNodes.empty())
+        std::string().swap(m_PendingData);
+
+    return settings;
+}
+
+void ed::Settings::ClearDirty(Node* node)
+{
+    if (node)
+    {
+        // Record may be already dropped by TrimMemory().
+        if (auto settings = FindNode(node->m_ID))
+            settings->ClearDirty();
+    }
+    else
+    {
+        m_IsDirty     = false;
+        m_DirtyReason = SaveReasonFlags::None;
+
+        for (auto index : m_DirtyNodes)
+            m_Nodes[index].ClearDirty();
+
+        m_DirtyNodes.resize(0);
+    }
+}
+
+void ed::Settings::MakeDirty(SaveReasonFlags reason, Node* node)
+{
+    m_IsDirty     = true;
+    m_DirtyReason = m_DirtyReason | reason;
+
+    if (node)
+    {
+        // Record of forgotten node dropped by TrimMemory() is created again
+        // when node comes back.
+        auto indexIt = m_NodeIndices.find(node->m_ID.Get());
+        if (indexIt == m_NodeIndices.end())
+        {
+            AddNode(node->m_ID)->m_WasUsed = true;
+            indexIt = m_NodeIndices.find(node->m_ID.Get());
+        }
+
+        auto& settings = m_Nodes[indexIt->second];
+        if (!settings.m_IsDirty)
+            m_DirtyNodes.push_back(indexIt->second);
+
+        settings.MakeDirty(reason);
+    }
+}
+
+size_t ed::Settings::GetMemoryUsage() const
+{
+    return HeapSize(m_Nodes)
+        + HeapSize(m_Selection)
+        + HeapSize(m_NodeIndices)
+        + HeapSize(m_DirtyNodes)
+        + HeapSize(m_PendingData)
+        + HeapSize(m_PendingNodes);
+}
+
+ed::SettingsOutput::SettingsOutput(ConfigWriteSettings write, SaveReasonFlags reason, void* userPointer)
+    : m_Write(write)
+    , m_Reason(reason)
+    , m_UserPointer(userPointer)
+    , m_IsValid(true)
+{
+    if (m_Write)
+        m_Buffer.reserve(c_ChunkSize + 256);
+}
+
+void ed::SettingsOutput::Append(const char* data, size_t size)
+{
+    m_Buffer.append(data, size);
+
+    if (m_Write && m_Buffer.size() >= c_ChunkSize)
+        Flush();
+}
+
+void ed::SettingsOutput::Append(std::string&& data)
+{
+    // Whole document serialized at once is taken over without copying.
+    if (m_Buffer.empty() && !m_Write)
+        m_Buffer.swap(data);
+    else
+        Append(data.data(), data.size());
+}
+
+void ed::SettingsOutput::Flush()
+{
+    if (m_IsValid && !m_Buffer.empty())
+        m_IsValid = m_Write(m_Buffer.data(), m_Buffer.size(), m_Reason, m_UserPointer);
+
+    m_Buffer.resize(0);
+}
+
+bool ed::SettingsOutput::Finish()
+{
+    if (!m_Write)
+        return true;
+
+    Flush();
+
+    // End of stream is signaled even if writing failed.
+    const auto finished = m_Write(nullptr, 0, m_Reason, m_UserPointer);
+
+    return m_IsValid && finished;
+}
+
+std::string ed::Settings::Serialize(SettingsFormat format)
+{
+    SettingsOutput output;
+    Serialize(format, output);
+    return std::move(output.m_Buffer);
+}
+
+void ed::Settings::Serialize(SettingsFormat format, SettingsOutput& output)
+{
+    if (format == SettingsFormat::Binary)
+        SerializeBinary(output);
+    else
+        SerializeJson(output);
+}
+
+void ed::Settings::SerializeJson(SettingsOutput& output)
+{
+    // Written straight to output in layout json::value::dump() produces for
+    // equivalent document, except nodes follow order of m_Nodes instead of
+    // being sorted by key. Empty containers are null like there.
+    char buffer[64];
+
+    auto writeNumber = [&](float value)
+    {
+        const auto size = ImFormatString(buffer, sizeof(buffer), "%.*g", std::numeric_limits<double>::max_digits10 + 1, static_cast<double>(value));
+        output.Append(buffer, static_cast<size_t>(size));
+    };
+
+    auto writeVector = [&](const ImVec2& value)
+    {
+        output.Append("{\"x\":");
+        writeNumber(value.x);
+        output.Append(",\"y\":");
+        writeNumber(value.y);
+        output.Append("}");
+    };
+
+    auto writeObjectId = [&](ObjectId id)
+    {
+        const char* prefix = "";
+        switch (id.Type())
+        {
+            default:
+            case NodeEditor::Detail::ObjectType::None: break;
+            case NodeEditor::Detail::ObjectType::Node: prefix = "node:"; break;
+            case NodeEditor::Detail::ObjectType::Link: prefix = "link:"; break;
+            case NodeEditor::Detail::ObjectType::Pin:  prefix = "pin:";  break;
+        }
+
+        const auto size = ImFormatString(buffer, sizeof(buffer), "\"%s%llu\"", prefix, static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(id.AsPointer())));
+        output.Append(buffer, static_cast<size_t>(size));
+    };
+
+    output.Append("{\"nodes\":");
+    auto first = true;
+    for (auto& node : m_Nodes)
+    {
+        if (!node.m_WasUsed)
+            continue;
+
+        output.Append(first ? "{" : ",");
+        first = false;
+
+        writeObjectId(node.m_ID);
+        output.Append(":{");
+        if (node.m_GroupSize.x > 0 || node.m_GroupSize.y > 0)
+        {
+            output.Append("\"group_size\":");
+            writeVector(node.m_GroupSize);
+            output.Append(",");
+        }
+        output.Append("\"location\":");
+        writeVector(node.m_Location);
+        output.Append("}");
+    }
+    output.Append(first ? "null" : "}");
+
+    output.Append(",\"selection\":");
+    first = true;
+    for (auto& id : m_Selection)
+    {
+        output.Append(first ? "[" : ",");
+        first = false;
+
+        writeObjectId(id);
+    }
+    output.Append(first ? "null" : "]");
+
+    output.Append(",\"view\":{\"scroll\":");
+    writeVector(m_ViewScroll);
+    output.Append(",\"zoom\":");
+    writeNumber(m_ViewZoom);
+    output.Append("}}");
+}
+
+void ed::Settings::SerializeBinary(SettingsOutput& output)
+{
+    BinarySettingsWriter writer;
+    writer.Header(c_BinarySettingsMagic);
+    writer.Vec2(m_ViewScroll);
+    writer.Float(m_ViewZoom);
+
+    const auto usedNodeCount = std::count_if(m_Nodes.begin(), m_Nodes.end(), [](const NodeSettings& node) { return node.m_WasUsed; });
+
+    const auto size = 8 + usedNodeCount * 32 + m_Selection.size() * 9;
+    writer.m_Data.reserve(writer.m_Data.size() + (output.m_Write ? ImMin(size, SettingsOutput::c_ChunkSize) : size));
 
-    for (auto link : m_Links)
+    writer.U32(static_cast<uint32_t>(usedNodeCount));
+    for (auto& node : m_Nodes)
     {
-        if (!link->m_IsLive)
+        if (!node.m_WasUsed)
             continue;
 
-        if (link->m_StartPin->m_Node->m_ID == nodeId || link->m_EndPin->m_Node->m_ID == nodeId)
-            result.push_back(link);
+        writer.U64(node.m_ID.Get());
+        WriteNodeRecord(writer, node);
+
+        if (output.m_Write && writer.m_Data.size() >= SettingsOutput::c_ChunkSize)
+        {
+            output.Append(writer.m_Data.data(), writer.m_Data.size());
+            writer.m_Data.resize(0);
+        }
+    }
+
+    writer.U32(static_cast<uint32_t>(m_Selection.size()));
+    for (auto& id : m_Selection)
+    {
+        writer.U8(static_cast<uint8_t>(id.Type()));
+        writer.U64(id.Get());
     }
+
+    output.Append(std::move(writer.m_Data));
 }
 
-bool ed::EditorContext::PinHadAnyLinks(PinId pinId)
+bool ed::Settings::ParseBinary(const std::string& string, Settings& settings)
 {
-    auto pin = FindPin(pinId);
-    if (!pin || !pin->m_IsLive)
+    Settings result = settings;
+
+    BinarySettingsReader reader(string);
+    if (!reader.Header(c_BinarySettingsMagic))
         return false;
 
-    return pin->m_HasConnection || pin->m_HadConnection;
-}
+    result.m_ViewScroll = reader.Vec2();
+    result.m_ViewZoom   = reader.Float();
 
-void ed::EditorContext::NotifyLinkDeleted(Link* link)
-{
-    if (m_LastActiveLink == link)
-        m_LastActiveLink = nullptr;
-}
+    const auto nodeCount = reader.U32();
+    if (!reader.Require(static_cast<size_t>(nodeCount) * 32))
+        return false;
 
-void ed::EditorContext::Suspend(SuspendFlags flags)
-{
-    auto drawList = ImGui::GetWindowDrawList();
-    auto lastChannel = drawList->_Splitter._Current;
-    drawList->ChannelsSetCurrent(m_ExternalChannel);
-    m_Canvas.Suspend();
-    drawList->ChannelsSetCurrent(lastChannel);
-    if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
-        ImDrawList_SwapSplitter(drawList, m_Splitter);
-}
+    result.m_Nodes.reserve(result.m_Nodes.size() + nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        const auto id = NodeId(static_cast<uintptr_t>(reader.U64()));
 
-void ed::EditorContext::Resume(SuspendFlags flags)
-{
-    auto drawList = ImGui::GetWindowDrawList();
-    if ((flags & SuspendFlags::KeepSplitter) != SuspendFlags::KeepSplitter)
-        ImDrawList_SwapSplitter(drawList, m_Splitter);
-    auto lastChannel = drawList->_Splitter._Current;
-    drawList->ChannelsSetCurrent(m_ExternalChannel);
-    m_Canvas.Resume();
-    drawList->ChannelsSetCurrent(lastChannel);
-}
+        auto nodeSettings = result.FindNode(id);
+        if (!nodeSettings)
+            nodeSettings = result.AddNode(id);
 
-bool ed::EditorContext::IsSuspended()
-{
-	return m_Canvas.IsSuspended();
-}
+        if (!ReadNodeRecord(reader, *nodeSettings))
+            return false;
+    }
 
-bool ed::EditorContext::IsActive()
-{
-    return m_IsWindowActive;
-}
+    const auto selectionCount = reader.U32();
+    if (!reader.Require(static_cast<size_t>(selectionCount) * 9))
+        return false;
 
-ed::Pin* ed::EditorContext::CreatePin(PinId id, PinKind kind)
-{
-    IM_ASSERT(nullptr == FindObject(id));
-    auto pin = new Pin(this, id, kind);
-    m_Pins.push_back({id, pin});
-    std::sort(m_Pins.begin(), m_Pins.end());
-    return pin;
+    result.m_Selection.resize(0);
+    result.m_Selection.reserve(selectionCount);
+    for (uint32_t i = 0; i < selectionCount; ++i)
+    {
+        const auto type = static_cast<ObjectType>(reader.U8());
+        const auto id   = static_cast<uintptr_t>(reader.U64());
+        switch (type)
+        {
+            case ObjectType::Node: result.m_Selection.push_back(NodeId(id)); break;
+            case ObjectType::Link: result.m_Selection.push_back(LinkId(id)); break;
+            case ObjectType::Pin:  result.m_Selection.push_back(PinId(id));  break;
+            default: break;
+        }
+    }
+
+    if (!reader.m_IsValid)
+        return false;
+
+    settings = std::move(result);
+
+    return true;
 }
 
-ed::Node* ed::EditorContext::CreateNode(NodeId id)
+// Reads settings straight from parser events, so no intermediate json::value
+// tree is built. Same rules apply as for NodeSettings::Parse().
+struct SettingsParser final: ed::json::event_handler
 {
-    IM_ASSERT(nullptr == FindObject(id));
-    auto node = new Node(this, id);
-    m_Nodes.push_back({id, node});
-    //std::sort(Nodes.begin(), Nodes.end());
+    SettingsParser(ed::Settings& result, const char* deferredData = nullptr)
+        : m_Result(result)
+        , m_DeferredData(deferredData)
+    {
+    }
 
-    auto settings = m_Settings.FindNode(id);
-    if (!settings)
-        settings = m_Settings.AddNode(id);
+    bool on_null() override        { return AcceptValue(); }
+    bool on_boolean(bool) override { return AcceptValue(); }
 
-    if (!settings->m_WasUsed)
+    bool on_string(const char* data, size_t size) override
     {
-        settings->m_WasUsed = true;
-        RestoreNodeState(node);
-    }
+        if (Top() == Context::Selection)
+            m_Result.m_Selection.push_back(DeserializeObjectId(data, size));
 
-    node->m_Bounds.Min  = settings->m_Location;
-    node->m_Bounds.Max  = node->m_Bounds.Min;
-    node->m_Bounds.Floor();
+        return AcceptValue();
+    }
 
-    if (settings->m_GroupSize.x > 0 || settings->m_GroupSize.y > 0)
+    bool on_number(double value) override
     {
-        node->m_Type            = NodeType::Group;
-        node->m_GroupBounds.Min = settings->m_Location;
-        node->m_GroupBounds.Max = node->m_GroupBounds.Min + settings->m_GroupSize;
-        node->m_GroupBounds.Floor();
+        switch (Top())
+        {
+            case Context::Vector:
+                if (m_Key == "x")      { m_Vector.x = static_cast<float>(value); m_HasX = true; }
+                else if (m_Key == "y") { m_Vector.y = static_cast<float>(value); m_HasY = true; }
+                break;
+
+            case Context::View:
+                if (m_Key == "zoom")
+                    m_ViewZoom = static_cast<float>(value);
+                break;
+
+            default:
+                break;
+        }
+
+        return AcceptValue();
     }
 
-    node->m_IsLive = false;
+    bool on_object_begin() override
+    {
+        auto context = Context::Unknown;
+        switch (Top())
+        {
+            case Context::None:
+                context = Context::Root;
+                break;
+
+            case Context::Root:
+                if (m_Key == "nodes")
+                    context = Context::Nodes;
+                else if (m_Key == "view")
+                {
+                    context      = Context::View;
+                    m_Target     = &m_ViewScroll;
+                    m_ViewScroll = ImVec2(0, 0);
+                    m_ViewZoom   = 1.0f;
+                }
+                break;
 
-    return node;
-}
+            case Context::Nodes:
+                context = Context::Node;
+                break;
 
-ed::Link* ed::EditorContext::CreateLink(LinkId id)
-{
-    IM_ASSERT(nullptr == FindObject(id));
-    auto link = new Link(this, id);
-    m_Links.push_back({id, link});
-    std::sort(m_Links.begin(), m_Links.end());
+            case Context::Node:
+                if (m_Key == "location")
+                    m_Target = &m_Node->m_Location;
+                else if (m_Key == "group_size")
+                    m_Target = &m_Node->m_GroupSize;
+                else
+                    break;
+                context = Context::Vector;
+                break;
 
-    return link;
-}
+            case Context::View:
+                if (m_Key == "scroll")
+                    context = Context::Vector;
+                break;
 
-template <typename C, typename Id>
-static inline auto FindItemInLinear(C& container, Id id)
-{
-# if defined(_DEBUG)
-    auto start = container.data();
-    auto end   = container.data() + container.size();
-    for (auto it = start; it < end; ++it)
-        if ((*it).m_ID == id)
-            return it->m_Object;
-# else
-    for (auto item : container)
-        if (item.m_ID == id)
-            return item.m_Object;
-# endif
+            default:
+                break;
+        }
 
-   return static_cast<decltype(container[0].m_Object)>(nullptr);
-}
-
-template <typename C, typename Id>
-static inline auto FindItemIn(C& container, Id id)
-{
-//# if defined(_DEBUG)
-//    auto start = container.data();
-//    auto end   = container.data() + container.size();
-//    for (auto it = start; it < end; ++it)
-//        if ((*it)->ID == id)
-//            return *it;
-//# else
-//    for (auto item : container)
-//        if (item->ID == id)
-//            return item;
-//# endif
-    auto key = typename C::value_type{ id, nullptr };
-    auto first = container.cbegin();
-    auto last  = container.cend();
-    auto it    = std::lower_bound(first, last, key);
-    if (it != last && (key.m_ID == it->m_ID))
-        return it->m_Object;
-    else
-        return static_cast<decltype(it->m_Object)>(nullptr);
-}
+        if (context == Context::Vector)
+        {
+            m_Vector = ImVec2(0, 0);
+            m_HasX   = false;
+            m_HasY   = false;
+        }
 
-ed::Node* ed::EditorContext::FindNode(NodeId id)
-{
-    return FindItemInLinear(m_Nodes, id);
-}
+        m_Stack.push_back(context);
+        return true;
+    }
 
-ed::Pin* ed::EditorContext::FindPin(PinId id)
-{
-    return FindItemIn(m_Pins, id);
-}
+    bool on_key(const char* data, size_t size) override
+    {
+        m_Key.assign(data, size);
 
-ed::Link* ed::EditorContext::FindLink(LinkId id)
-{
-    return FindItemIn(m_Links, id);
-}
+        if (Top() == Context::Nodes)
+        {
+            m_NodeId = DeserializeObjectId(data, size).AsNodeId();
 
-ed::Object* ed::EditorContext::FindObject(ObjectId id)
-{
-    if (id.IsNodeId())
-        return FindNode(id.AsNodeId());
-    else if (id.IsLinkId())
-        return FindLink(id.AsLinkId());
-    else if (id.IsPinId())
-        return FindPin(id.AsPinId());
-    else
-        return nullptr;
-}
+            if (!IsDeferred())
+            {
+                m_Node = m_Result.FindNode(m_NodeId);
+                if (!m_Node)
+                    m_Node = m_Result.AddNode(m_NodeId);
+            }
+        }
 
-ed::Node* ed::EditorContext::GetNode(NodeId id)
-{
-    auto node = FindNode(id);
-    if (!node)
-        node = CreateNode(id);
-    return node;
-}
+        return true;
+    }
 
-ed::Pin* ed::EditorContext::GetPin(PinId id, PinKind kind)
-{
-    if (auto pin = FindPin(id))
+    bool want_raw_value() override
     {
-        pin->m_Kind = kind;
-        return pin;
+        return IsDeferred();
     }
-    else
-        return CreatePin(id, kind);
-}
 
-ed::Link* ed::EditorContext::GetLink(LinkId id)
-{
-    if (auto link = FindLink(id))
-        return link;
-    else
-        return CreateLink(id);
-}
+    bool on_raw_value(const char* data, size_t size) override
+    {
+        auto offset = static_cast<size_t>(data - m_DeferredData);
+        m_Result.m_PendingNodes[m_NodeId.Get()] = std::make_pair(offset, size);
+        return true;
+    }
 
-void ed::EditorContext::LoadSettings()
-{
-    ed::Settings::Parse(m_Config.Load(), m_Settings);
+    bool on_object_end() override
+    {
+        auto context = Top();
+        m_Stack.pop_back();
 
-    m_NavigateAction.m_Scroll = m_Settings.m_ViewScroll;
-    m_NavigateAction.m_Zoom   = m_Settings.m_ViewZoom;
-}
+        if (context == Context::Vector && m_HasX && m_HasY)
+            *m_Target = m_Vector;
+        else if (context == Context::View)
+        {
+            m_Result.m_ViewScroll = m_ViewScroll;
+            m_Result.m_ViewZoom   = m_ViewZoom;
+        }
 
-void ed::EditorContext::SaveSettings()
-{
-    m_Config.BeginSave();
+        return true;
+    }
 
-    for (auto& node : m_Nodes)
+    bool on_array_begin() override
     {
-        auto settings = m_Settings.FindNode(node->m_ID);
-        settings->m_Location = node->m_Bounds.Min;
-        settings->m_Size     = node->m_Bounds.GetSize();
-        if (IsGroup(node))
-            settings->m_GroupSize = node->m_GroupBounds.GetSize();
-
-        if (!node->m_RestoreState && settings->m_IsDirty && m_Config.SaveNodeSettings)
+        auto context = Context::Unknown;
+        switch (Top())
         {
-            if (m_Config.SaveNode(node->m_ID, settings->Serialize().dump(), settings->m_DirtyReason))
-                settings->ClearDirty();
+            case Context::None:
+                return false;
+
+            case Context::Root:
+                if (m_Key == "selection")
+                {
+                    context = Context::Selection;
+                    m_Result.m_Selection.resize(0);
+                }
+                break;
+
+            default:
+                break;
         }
+
+        m_Stack.push_back(context);
+        return true;
     }
 
-    m_Settings.m_Selection.resize(0);
-    for (auto& object : m_SelectedObjects)
-        m_Settings.m_Selection.push_back(object->ID());
+    bool on_array_end() override
+    {
+        m_Stack.pop_back();
+        return true;
+    }
 
-    m_Settings.m_ViewScroll = m_NavigateAction.m_Scroll;
-    m_Settings.m_ViewZoom   = m_NavigateAction.m_Zoom;
+private:
+    enum class Context { None, Unknown, Root, Nodes, Node, Vector, View, Selection };
 
-    if (m_Config.Save(m_Settings.Serialize(), m_Settings.m_DirtyReason))
-        m_Settings.ClearDirty();
+    Context Top() const
+    {
+        return m_Stack.empty() ? Context::None : m_Stack.back();
+    }
 
-    m_Config.EndSave();
-}
+    // Node records are kept as text when parsing is deferred.
+    bool IsDeferred() const
+    {
+        return m_DeferredData && Top() == Context::Nodes;
+    }
 
-void ed::EditorContext::MakeDirty(SaveReasonFlags reason)
-{
-    m_Settings.MakeDirty(reason);
-}
+    // Top level value has to be an object.
+    bool AcceptValue() const
+    {
+        return !m_Stack.empty();
+    }
 
-void ed::EditorContext::MakeDirty(SaveReasonFlags reason, Node* node)
-{
-    m_Settings.MakeDirty(reason, node);
-}
+    static ed::ObjectId DeserializeObjectId(const char* data, size_t size)
+    {
+        auto str       = std::string(data, size);
+        auto separator = str.find_first_of(':');
+        auto idStart   = str.c_str() + ((separator != std::string::npos) ? separator + 1 : 0);
+        auto id        = reinterpret_cast<void*>(strtoull(idStart, nullptr, 10));
+        if (str.compare(0, separator, "node") == 0)
+            return ed::ObjectId(ed::NodeId(id));
+        else if (str.compare(0, separator, "link") == 0)
+            return ed::ObjectId(ed::LinkId(id));
+        else if (str.compare(0, separator, "pin") == 0)
+            return ed::ObjectId(ed::PinId(id));
+        else
+            // fallback to old format
+            return ed::ObjectId(ed::NodeId(id)); //return ObjectId();
+    }
+
+    ed::Settings&         m_Result;
+    const char*           m_DeferredData;
+    ed::vector<Context>   m_Stack;
+    std::string           m_Key;
+    ed::NodeId            m_NodeId;
+    ed::NodeSettings*     m_Node   = nullptr;
+    ImVec2*               m_Target = nullptr;
+    ImVec2                m_Vector;
+    bool                  m_HasX   = false;
+    bool                  m_HasY   = false;
+    ImVec2                m_ViewScroll;
+    float                 m_ViewZoom = 1.0f;
+};
 
-ed::Link* ed::EditorContext::FindLinkAt(const ImVec2& p)
+bool ed::Settings::Parse(const std::string& string, Settings& settings, bool deferNodes)
 {
-    for (auto& link : m_Links)
-        if (link->TestHit(p, c_LinkSelectThickness))
-            return link;
+    // Binary node records are read without text conversion, deferring gains nothing.
+    if (BinarySettingsReader::HasHeader(string, c_BinarySettingsMagic))
+        return ParseBinary(string, settings);
 
-    return nullptr;
+    Settings result = settings;
+
+    if (deferNodes)
+    {
+        result.m_PendingData = string;
+
+        SettingsParser parser(result, result.m_PendingData.data());
+        if (!json::value::parse(result.m_PendingData.data(), result.m_PendingData.size(), parser))
+            return false;
+
+        // Records of already known nodes are applied right away.
+        for (auto& node : result.m_Nodes)
+        {
+            auto pendingIt = result.m_PendingNodes.find(node.m_ID.Get());
+            if (pendingIt == result.m_PendingNodes.end())
+                continue;
+
+            NodeSettings::Parse(result.m_PendingData.substr(pendingIt->second.first, pendingIt->second.second), node);
+            result.m_PendingNodes.erase(pendingIt);
+        }
+    }
+    else
+    {
+        SettingsParser parser(result);
+        if (!json::value::parse(string.data(), string.size(), parser))
+            return false;
+    }
+
+    settings = std::move(result);
+
+    return true;
 }
 
-ImU32 ed::EditorContext::GetColor(StyleColor colorIndex) const
+
+
+
+//------------------------------------------------------------------------------
+//
+// State Snapshot
+//
+//------------------------------------------------------------------------------
+// Snapshot layout, encoded like binary settings:
+//   "NESS" header, uint8 is delta, float scroll x, y, float zoom,
+//   uint32 node count, node count x { uint64 id, node record },
+//   uint32 selection count, selection count x { uint8 type, uint64 id }
+// Node records are sorted by id. Delta lists only nodes changed since base,
+// view and selection are always complete.
+static const char c_StateSnapshotMagic[4]    = { 'N', 'E', 'S', 'S' };
+static const int  c_StateSnapshotMaxDepth    = 16; // deeper snapshot is stored in full
+
+struct StateSnapshotContent
+{
+    ImVec2                       m_ViewScroll;
+    float                        m_ViewZoom;
+    ed::vector<ed::NodeSettings> m_Nodes; // sorted by id
+    ed::vector<ed::ObjectId>     m_Selection;
+};
+
+static bool NodeSettingsLess(const ed::NodeSettings& lhs, const ed::NodeSettings& rhs)
 {
-    return ImColor(m_Style.Colors[colorIndex]);
+    return lhs.m_ID.Get() < rhs.m_ID.Get();
 }
 
-ImU32 ed::EditorContext::GetColor(StyleColor colorIndex, float alpha) const
+static bool IsSameNodeRecord(const ed::NodeSettings& lhs, const ed::NodeSettings& rhs)
 {
-    auto color = m_Style.Colors[colorIndex];
-    return ImColor(color.x, color.y, color.z, color.w * alpha);
+    return lhs.m_Location == rhs.m_Location && lhs.m_Size == rhs.m_Size && lhs.m_GroupSize == rhs.m_GroupSize;
 }
 
-void ed::EditorContext::RegisterAnimation(Animation* animation)
+// Reads snapshot on top of content restored by its base.
+static bool ReadStateSnapshot(const std::string& data, StateSnapshotContent& content)
 {
-    m_LiveAnimations.push_back(animation);
-}
+    BinarySettingsReader reader(data);
+    if (!reader.Header(c_StateSnapshotMagic))
+        return false;
 
-void ed::EditorContext::UnregisterAnimation(Animation* animation)
-{
-    auto it = std::find(m_LiveAnimations.begin(), m_LiveAnimations.end(), animation);
-    if (it != m_LiveAnimations.end())
-        m_LiveAnimations.erase(it);
-}
+    const auto isDelta = reader.U8() != 0;
+    content.m_ViewScroll = reader.Vec2();
+    content.m_ViewZoom   = reader.Float();
 
-void ed::EditorContext::UpdateAnimations()
-{
-    m_LastLiveAnimations = m_LiveAnimations;
+    const auto nodeCount = reader.U32();
+    if (!reader.Require(static_cast<size_t>(nodeCount) * 32))
+        return false;
 
-    for (auto animation : m_LastLiveAnimations)
+    ed::vector<ed::NodeSettings> nodes;
+    nodes.reserve(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
     {
-        const bool isLive = (std::find(m_LiveAnimations.begin(), m_LiveAnimations.end(), animation) != m_LiveAnimations.end());
-
-        if (isLive)
-            animation->Update();
+        nodes.emplace_back(ed::NodeId(static_cast<uintptr_t>(reader.U64())));
+        if (!ReadNodeRecord(reader, nodes.back()))
+            return false;
     }
-}
 
-void ed::EditorContext::Flow(Link* link)
-{
-    m_FlowAnimationController.Flow(link);
-}
+    if (isDelta)
+    {
+        // Changed records replace ones of base, new are merged in.
+        ed::vector<ed::NodeSettings> merged;
+        merged.reserve(content.m_Nodes.size() + nodes.size());
 
-void ed::EditorContext::SetUserContext(bool globalSpace)
-{
-    const auto mousePos = ImGui::GetMousePos();
+        auto baseIt = content.m_Nodes.begin(), baseEnd = content.m_Nodes.end();
+        for (auto& node : nodes)
+        {
+            while (baseIt != baseEnd && NodeSettingsLess(*baseIt, node))
+                merged.push_back(*baseIt++);
+            if (baseIt != baseEnd && baseIt->m_ID == node.m_ID)
+                ++baseIt;
+            merged.push_back(node);
+        }
+        merged.insert(merged.end(), baseIt, baseEnd);
 
-    // Move drawing cursor to mouse location and prepare layer for
-    // content added by user.
-    if (globalSpace)
-        ImGui::SetCursorScreenPos(m_Canvas.FromLocal(mousePos));
+        content.m_Nodes.swap(merged);
+    }
     else
-        ImGui::SetCursorScreenPos(m_Canvas.FromLocal(mousePos));
-        //ImGui::SetCursorScreenPos(ImFloor(mousePos));
-        //ImGui::SetCursorScreenPos(ImVec2(floorf(mousePos.x), floorf(mousePos.y)));
+        content.m_Nodes.swap(nodes);
 
-    if (!IsSuspended())
+    const auto selectionCount = reader.U32();
+    if (!reader.Require(static_cast<size_t>(selectionCount) * 9))
+        return false;
+
+    content.m_Selection.resize(0);
+    content.m_Selection.reserve(selectionCount);
+    for (uint32_t i = 0; i < selectionCount; ++i)
     {
-        auto drawList = ImGui::GetWindowDrawList();
-        drawList->ChannelsSetCurrent(c_UserChannel_Content);
+        const auto type = static_cast<ed::ObjectType>(reader.U8());
+        const auto id   = static_cast<uintptr_t>(reader.U64());
+        switch (type)
+        {
+            case ed::ObjectType::Node: content.m_Selection.push_back(ed::NodeId(id)); break;
+            case ed::ObjectType::Link: content.m_Selection.push_back(ed::LinkId(id)); break;
+            case ed::ObjectType::Pin:  content.m_Selection.push_back(ed::PinId(id));  break;
+            default: break;
+        }
     }
 
-    // #debug
-    // drawList->AddCircleFilled(ImGui::GetMousePos(), 4, IM_COL32(0, 255, 0, 255));
+    return reader.m_IsValid;
 }
 
-void ed::EditorContext::EnableShortcuts(bool enable)
+static bool ReadStateSnapshot(const ed::StateSnapshot* snapshot, StateSnapshotContent& content)
 {
-    m_ShortcutsEnabled = enable;
+    ed::vector<const ed::StateSnapshot*> chain;
+    for (; snapshot; snapshot = snapshot->m_Base)
+        chain.push_back(snapshot);
+
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        if (!ReadStateSnapshot((*it)->m_Data, content))
+            return false;
+
+    return true;
 }
 
-bool ed::EditorContext::AreShortcutsEnabled()
+ed::StateSnapshot::StateSnapshot(const StateSnapshot* base)
+    : m_Base(base)
+    , m_Depth(base ? base->m_Depth + 1 : 0)
+    , m_RefCount(1)
 {
-    return m_ShortcutsEnabled;
+    if (m_Base)
+        ++m_Base->m_RefCount;
 }
 
-ed::Control ed::EditorContext::BuildControl(bool allowOffscreen)
+ed::StateSnapshot::~StateSnapshot()
 {
-    if (!allowOffscreen && !ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
-        return Control(nullptr, nullptr, nullptr, nullptr, false, false, false, false);
-
-    const auto mousePos = ImGui::GetMousePos();
+    IM_ASSERT(m_RefCount == 0);
+}
 
-    // Expand clip rectangle to always contain cursor
-    auto editorRect = m_Canvas.ViewRect();
-    auto isMouseOffscreen = allowOffscreen && !editorRect.Contains(mousePos);
-    if (isMouseOffscreen)
+void ed::StateSnapshot::Release(const StateSnapshot* snapshot)
+{
+    // Chain is walked instead of recursion, undo stacks can be long.
+    while (snapshot && --snapshot->m_RefCount == 0)
     {
-        // Extend clip rect to capture off-screen mouse cursor
-        editorRect.Add(ImFloor(mousePos));
-        editorRect.Add(ImVec2(ImCeil(mousePos.x), ImCeil(mousePos.y)));
-
-        ImGui::PushClipRect(editorRect.Min, editorRect.Max, false);
+        auto base = snapshot->m_Base;
+        delete snapshot;
+        snapshot = base;
     }
+}
 
-    Object* hotObject           = nullptr;
-    Object* activeObject        = nullptr;
-    Object* clickedObject       = nullptr;
-    Object* doubleClickedObject = nullptr;
+ed::StateSnapshot* ed::EditorContext::SaveStateSnapshot(const StateSnapshot* base)
+{
+    StateSnapshotContent baseContent;
+    if (base && (base->m_Depth + 1 >= c_StateSnapshotMaxDepth || !ReadStateSnapshot(base, baseContent)))
+        base = nullptr;
 
-    // Emits invisible button and returns true if it is clicked.
-    auto emitInteractiveArea = [](ObjectId id, const ImRect& rect)
+    vector<NodeSettings> nodes;
+    nodes.reserve(m_Nodes.size());
+    for (auto node : m_Nodes)
     {
-        char idString[33] = { 0 }; // itoa can output 33 bytes maximum
-        snprintf(idString, 32, "%p", id.AsPointer());
-        ImGui::SetCursorScreenPos(rect.Min);
+        if (!node->IsLive())
+            continue;
 
-        // debug
-        //if (id < 0) return ImGui::Button(idString, to_imvec(rect.size));
+        nodes.emplace_back(node->m_ID);
+        auto& record = nodes.back();
+        record.m_Location = node->m_Bounds.Min;
+        record.m_Size     = node->m_Bounds.GetSize();
+        if (IsGroup(node))
+            record.m_GroupSize = node->m_GroupBounds.GetSize();
+    }
+    std::sort(nodes.begin(), nodes.end(), NodeSettingsLess);
 
-        auto result = ImGui::InvisibleButton(idString, rect.GetSize());
+    // Unchanged records are dropped, list stays sorted.
+    if (base)
+    {
+        auto baseIt = baseContent.m_Nodes.begin(), baseEnd = baseContent.m_Nodes.end();
+        auto endIt = std::remove_if(nodes.begin(), nodes.end(), [&](const NodeSettings& node)
+        {
+            while (baseIt != baseEnd && NodeSettingsLess(*baseIt, node))
+                ++baseIt;
+            return baseIt != baseEnd && baseIt->m_ID == node.m_ID && IsSameNodeRecord(*baseIt, node);
+        });
+        nodes.erase(endIt, nodes.end());
+    }
 
-        // #debug
-        //ImGui::GetWindowDrawList()->AddRectFilled(ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), IM_COL32(0, 255, 0, 64));
+    auto snapshot = new StateSnapshot(base);
 
-        return result;
-    };
+    BinarySettingsWriter writer;
+    writer.m_Data.reserve(32 + nodes.size() * 32 + m_SelectedObjects.size() * 9);
+    writer.Header(c_StateSnapshotMagic);
+    writer.U8(base ? 1 : 0);
+    writer.Vec2(m_NavigateAction.m_Scroll);
+    writer.Float(m_NavigateAction.m_Zoom);
 
-    // Check input interactions over area.
-    auto checkInteractionsInArea = [&emitInteractiveArea, &hotObject, &activeObject, &clickedObject, &doubleClickedObject](ObjectId id, const ImRect& rect, Object* object)
+    writer.U32(static_cast<uint32_t>(nodes.size()));
+    for (auto& node : nodes)
     {
-        if (emitInteractiveArea(id, rect))
-            clickedObject = object;
-        if (!doubleClickedObject && ImGui::IsMouseDoubleClicked(0) && ImGui::IsItemHovered())
-            doubleClickedObject = object;
+        writer.U64(node.m_ID.Get());
+        WriteNodeRecord(writer, node);
+    }
 
-        if (!hotObject && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem))
-            hotObject = object;
+    writer.U32(static_cast<uint32_t>(m_SelectedObjects.size()));
+    for (auto object : m_SelectedObjects)
+    {
+        const auto id = object->ID();
+        writer.U8(static_cast<uint8_t>(id.Type()));
+        writer.U64(id.Get());
+    }
 
-        if (ImGui::IsItemActive())
-            activeObject = object;
-    };
+    snapshot->m_Data = std::move(writer.m_Data);
+    snapshot->m_Data.shrink_to_fit();
 
-    // Process live nodes and pins.
-    for (auto nodeIt = m_Nodes.rbegin(), nodeItEnd = m_Nodes.rend(); nodeIt != nodeItEnd; ++nodeIt)
-    {
-        auto node = *nodeIt;
+    return snapshot;
+}
 
-        if (!node->m_IsLive) continue;
+void ed::EditorContext::RestoreStateSnapshot(const StateSnapshot* snapshot)
+{
+    StateSnapshotContent content;
+    if (!snapshot || !ReadStateSnapshot(snapshot, content))
+        return;
 
-        // Check for interactions with live pins in node before
-        // processing node itself. Pins does not overlap each other
-        // and all are within node bounds.
-        for (auto pin = node->m_LastPin; pin; pin = pin->m_PreviousPin)
-        {
-            if (!pin->m_IsLive) continue;
+    // Nodes unknown to editor or not listed in snapshot are left alone.
+    for (auto& record : content.m_Nodes)
+    {
+        auto node = FindNode(record.m_ID);
+        if (!node)
+            continue;
 
-            checkInteractionsInArea(pin->m_ID, pin->m_Bounds, pin);
-        }
+        const auto groupSize = IsGroup(node) ? node->m_GroupBounds.GetSize() : ImVec2(0, 0);
+        if (node->m_Bounds.Min == record.m_Location && node->m_Bounds.GetSize() == record.m_Size && groupSize == record.m_GroupSize)
+            continue;
 
-        // Check for interactions with node.
-        if (node->m_Type == NodeType::Group)
-        {
-            // Node with a hole
-            ImGui::PushID(node->m_ID.AsPointer());
+        auto settings = record;
+        if (!IsGroup(node))
+            settings.m_GroupSize = node->m_GroupBounds.GetSize();
 
-            static const NodeRegion c_Regions[] =
-            {
-                NodeRegion::TopLeft,
-                NodeRegion::TopRight,
-                NodeRegion::BottomLeft,
-                NodeRegion::BottomRight,
-                NodeRegion::Top,
-                NodeRegion::Bottom,
-                NodeRegion::Left,
-                NodeRegion::Right,
-                NodeRegion::Header,
-            };
+        ApplyNodeSettings(node, settings);
+        MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::Size, node);
+    }
 
-            for (auto region : c_Regions)
-            {
-                auto bounds = node->GetRegionBounds(region);
-                if (ImRect_IsEmpty(bounds))
-                    continue;
-                checkInteractionsInArea(NodeId(static_cast<int>(region)), bounds, node);
-            }
+    ClearSelection();
+    for (auto id : content.m_Selection)
+        if (auto object = FindObject(id))
+            SelectObject(object);
 
-            ImGui::PopID();
-        }
-        else
-            checkInteractionsInArea(node->m_ID, node->m_Bounds, node);
+    if (m_NavigateAction.m_Scroll != content.m_ViewScroll || m_NavigateAction.m_Zoom != content.m_ViewZoom)
+    {
+        m_NavigateAction.StopNavigation();
+        m_NavigateAction.m_Scroll = content.m_ViewScroll;
+        m_NavigateAction.m_Zoom   = content.m_ViewZoom;
+        MakeDirty(SaveReasonFlags::Navigation);
     }
+}
 
-    // Links are not regular widgets and must be done manually since
-    // ImGui does not support interactive elements with custom hit maps.
-    //
-    // Links can steal input from background.
 
-    // Links are just over background. So if anything else
-    // is hovered we can skip them.
-    if (nullptr == hotObject)
-        hotObject = FindLinkAt(mousePos);
 
-    // Check for interaction with background.
-    auto backgroundClicked       = emitInteractiveArea(NodeId(0), editorRect);
-    auto backgroundDoubleClicked = !doubleClickedObject && ImGui::IsItemHovered() ? ImGui::IsMouseDoubleClicked(0) : false;
-    auto isBackgroundActive      = ImGui::IsItemActive();
-    auto isBackgroundHot         = !hotObject;
-    auto isDragging              = ImGui::IsMouseDragging(0, 1) || ImGui::IsMouseDragging(1, 1) || ImGui::IsMouseDragging(2, 1);
 
-    if (backgroundDoubleClicked)
-        backgroundClicked = false;
+//------------------------------------------------------------------------------
+//
+// Trace
+//
+//------------------------------------------------------------------------------
+// Trace layout, encoded like binary settings:
+//   "NETR" header, records until the end of data
+//   record:    uint8 op, payload
+//   Begin:     uint32 id length, id with terminating zero, float size x, y,
+//              float display size x, y, float delta time, float mouse x, y,
+//              uint8 mouse buttons, float wheel, float horizontal wheel,
+//              uint8 modifiers, uint32 key count, key count x uint32 key index
+//   BeginNode: uint64 node id
+//   EndNode:   float node size x, y
+//   Pin:       uint64 pin id, uint8 kind, float bounds x, y, x, y, float pivot x, y, x, y
+//   Group:     float bounds x, y, x, y
+//   Link:      uint64 link id, uint64 start pin id, uint64 end pin id, uint32 color, float thickness
+//   Flow:      uint64 link id
+//   SetNodePosition:     uint64 node id, float x, y
+//   SelectNode/Link:     uint64 id, uint8 append
+//   DeselectNode/Link:   uint64 id
+//   NavigateToContent:   float duration
+//   NavigateToSelection: uint8 zoom in, float duration
+//   ShowMinimap:         float size x, y, uint8 location
+//   Repeat:              none, stands for body of last frame stored in full
+// Pin and group bounds are relative to top left corner of their node. Graphs
+// are mostly submitted the same way every frame, so frames usually come down
+// to Begin, Repeat and End.
+static const char c_TraceMagic[4]   = { 'N', 'E', 'T', 'R' };
+static const int  c_TraceHeaderSize = 8;
+static const int  c_TraceMaxKeys    = IM_ARRAYSIZE(ImGuiIO::KeysDown);
+
+struct TraceInput
+{
+    ImVec2   m_DisplaySize;
+    float    m_DeltaTime;
+    ImVec2   m_MousePos;
+    uint8_t  m_MouseDown;
+    float    m_MouseWheel;
+    float    m_MouseWheelH;
+    uint8_t  m_Modifiers;
+    int      m_KeyCount;
+    uint16_t m_Keys[c_TraceMaxKeys];
+};
 
-    if (isMouseOffscreen)
-        ImGui::PopClipRect();
+// Every record decoded into one shape, unused fields are left alone.
+struct TraceRecord
+{
+    ed::TraceOp m_Op;
+    uint64_t    m_Ids[3];
+    const char* m_Name;
+    ImRect      m_Rects[2];
+    ImVec2      m_Vec;
+    float       m_Value;
+    uint32_t    m_Color;
+    uint8_t     m_Flags;
+    TraceInput  m_Input;
+};
 
-    // Process link input using background interactions.
-    auto hotLink = hotObject ? hotObject->AsLink() : nullptr;
+static ImRect ReadTraceRect(BinarySettingsReader& reader)
+{
+    const auto min = reader.Vec2();
+    const auto max = reader.Vec2();
+    return ImRect(min, max);
+}
 
-    // ImGui take care of tracking active items. With link
-    // we must do this ourself.
-    if (!isDragging && isBackgroundActive && hotLink && !m_LastActiveLink)
-        m_LastActiveLink = hotLink;
-    if (isBackgroundActive && m_LastActiveLink)
-    {
-        activeObject       = m_LastActiveLink;
-        isBackgroundActive = false;
-    }
-    else if (!isBackgroundActive && m_LastActiveLink)
-        m_LastActiveLink = nullptr;
+static bool ReadTraceRecord(BinarySettingsReader& reader, TraceRecord& record)
+{
+    const auto op = reader.U8();
+    if (!reader.m_IsValid || op >= static_cast<uint8_t>(ed::TraceOp::Count))
+        return false;
 
-    // Steal click from backgrounds if link is hovered.
-    if (!isDragging && backgroundClicked && hotLink)
+    record.m_Op = static_cast<ed::TraceOp>(op);
+    switch (record.m_Op)
     {
-        clickedObject     = hotLink;
-        backgroundClicked = false;
-    }
+        case ed::TraceOp::Begin:
+        {
+            const auto length = reader.U32();
+            if (length == 0 || !reader.Require(length) || reader.m_Cursor[length - 1] != 0)
+                return false;
+            record.m_Name = reinterpret_cast<const char*>(reader.m_Cursor);
+            reader.m_Cursor += length;
+
+            auto& input = record.m_Input;
+            record.m_Vec        = reader.Vec2();
+            input.m_DisplaySize = reader.Vec2();
+            input.m_DeltaTime   = reader.Float();
+            input.m_MousePos    = reader.Vec2();
+            input.m_MouseDown   = reader.U8();
+            input.m_MouseWheel  = reader.Float();
+            input.m_MouseWheelH = reader.Float();
+            input.m_Modifiers   = reader.U8();
+
+            const auto keyCount = reader.U32();
+            if (keyCount > static_cast<uint32_t>(c_TraceMaxKeys))
+                return false;
+            input.m_KeyCount = static_cast<int>(keyCount);
+            for (int i = 0; i < input.m_KeyCount; ++i)
+                input.m_Keys[i] = static_cast<uint16_t>(ImMin(reader.U32(), static_cast<uint32_t>(c_TraceMaxKeys - 1)));
+            break;
+        }
 
-    // Steal double-click from backgrounds if link is hovered.
-    if (!isDragging && backgroundDoubleClicked && hotLink)
-    {
-        doubleClickedObject = hotLink;
-        backgroundDoubleClicked = false;
+        case ed::TraceOp::End:
+        case ed::TraceOp::ClearSelection:
+        case ed::TraceOp::Repeat:
+            break;
+
+        case ed::TraceOp::BeginNode:
+        case ed::TraceOp::Flow:
+        case ed::TraceOp::DeselectNode:
+        case ed::TraceOp::DeselectLink:
+            record.m_Ids[0] = reader.U64();
+            break;
+
+        case ed::TraceOp::EndNode:
+            record.m_Vec = reader.Vec2();
+            break;
+
+        case ed::TraceOp::Pin:
+            record.m_Ids[0]   = reader.U64();
+            record.m_Flags    = reader.U8();
+            record.m_Rects[0] = ReadTraceRect(reader);
+            record.m_Rects[1] = ReadTraceRect(reader);
+            break;
+
+        case ed::TraceOp::Group:
+            record.m_Rects[0] = ReadTraceRect(reader);
+            break;
+
+        case ed::TraceOp::Link:
+            record.m_Ids[0] = reader.U64();
+            record.m_Ids[1] = reader.U64();
+            record.m_Ids[2] = reader.U64();
+            record.m_Color  = reader.U32();
+            record.m_Value  = reader.Float();
+            break;
+
+        case ed::TraceOp::SetNodePosition:
+            record.m_Ids[0] = reader.U64();
+            record.m_Vec    = reader.Vec2();
+            break;
+
+        case ed::TraceOp::SelectNode:
+        case ed::TraceOp::SelectLink:
+            record.m_Ids[0] = reader.U64();
+            record.m_Flags  = reader.U8();
+            break;
+
+        case ed::TraceOp::NavigateToContent:
+            record.m_Value = reader.Float();
+            break;
+
+        case ed::TraceOp::NavigateToSelection:
+            record.m_Flags = reader.U8();
+            record.m_Value = reader.Float();
+            break;
+
+        case ed::TraceOp::ShowMinimap:
+            record.m_Vec   = reader.Vec2();
+            record.m_Flags = reader.U8();
+            break;
+
+        default:
+            return false;
     }
 
-    return Control(hotObject, activeObject, clickedObject, doubleClickedObject,
-        isBackgroundHot, isBackgroundActive, backgroundClicked, backgroundDoubleClicked);
+    return reader.m_IsValid;
 }
 
-void ed::EditorContext::ShowMetrics(const Control& control)
+// Reader limited to records in range of trace data.
+static BinarySettingsReader MakeTraceReader(const ed::Trace& trace, uint32_t begin, uint32_t end)
 {
-    auto& io = ImGui::GetIO();
+    BinarySettingsReader reader(trace.m_Data);
+    reader.m_End    = reader.m_Cursor + end;
+    reader.m_Cursor = reader.m_Cursor + begin;
+    return reader;
+}
 
-    auto getObjectName = [](Object* object)
-    {
-        if (!object) return "";
-        else if (object->AsNode())  return "Node";
-        else if (object->AsPin())   return "Pin";
-        else if (object->AsLink())  return "Link";
-        else return "";
-    };
+bool ed::Trace::Index()
+{
+    m_Frames.resize(0);
 
-    auto getHotObjectName = [&control, &getObjectName]()
-    {
-        if (control.HotObject)
-            return getObjectName(control.HotObject);
-        else if (control.BackgroundHot)
-            return "Background";
-        else
-            return "<unknown>";
-    };
+    BinarySettingsReader reader(m_Data);
+    if (!reader.Header(c_TraceMagic))
+        return false;
 
-    auto getActiveObjectName = [&control, &getObjectName]()
-    {
-        if (control.ActiveObject)
-            return getObjectName(control.ActiveObject);
-        else if (control.BackgroundActive)
-            return "Background";
-        else
-            return "<unknown>";
-    };
+    const auto data = reinterpret_cast<const uint8_t*>(m_Data.data());
+    auto offset = [&]() { return static_cast<uint32_t>(reader.m_Cursor - data); };
 
-    auto liveNodeCount  = (int)std::count_if(m_Nodes.begin(),  m_Nodes.end(),  [](Node*  node)  { return  node->m_IsLive; });
-    auto livePinCount   = (int)std::count_if(m_Pins.begin(),   m_Pins.end(),   [](Pin*   pin)   { return   pin->m_IsLive; });
-    auto liveLinkCount  = (int)std::count_if(m_Links.begin(),  m_Links.end(),  [](Link*  link)  { return  link->m_IsLive; });
+    Frame frame     = {};
+    Frame lastFrame = {};
+    auto  hasBegin  = false;
+    auto  hasRepeat = false;
 
-    auto canvasRect     = m_Canvas.Rect();
-    auto viewRect       = m_Canvas.ViewRect();
-    auto localMousePos  = m_Canvas.ToLocal(io.MousePos);
-    auto globalMousePos = io.MousePos;
+    frame.m_Begin = offset();
 
-    ImGui::SetCursorScreenPos(canvasRect.Min + ImVec2(5, 5));
-    ImGui::BeginGroup();
-    ImGui::Text("Is Editor Active: %s", ImGui::IsWindowHovered() ? "true" : "false");
-    ImGui::Text("View Position: { x=%g y=%g }", viewRect.Min.x, viewRect.Min.y);
-    ImGui::Text("View Size: { w=%g h=%g }", viewRect.GetWidth(), viewRect.GetHeight());
-    ImGui::Text("Canvas Size: { w=%g h=%g }", canvasRect.GetWidth(), canvasRect.GetHeight());
-    ImGui::Text("Mouse: { x=%.0f y=%.0f } global: { x=%g y=%g }", localMousePos.x, localMousePos.y, globalMousePos.x, globalMousePos.y);
-    ImGui::Text("Live Nodes: %d", liveNodeCount);
-    ImGui::Text("Live Pins: %d", livePinCount);
-    ImGui::Text("Live Links: %d", liveLinkCount);
-    ImGui::Text("Hot Object: %s (%p)", getHotObjectName(), control.HotObject ? control.HotObject->ID().AsPointer() : nullptr);
-    if (auto node = control.HotObject ? control.HotObject->AsNode() : nullptr)
-    {
-        ImGui::SameLine();
-        ImGui::Text("{ x=%g y=%g w=%g h=%g }", node->m_Bounds.Min.x, node->m_Bounds.Min.y, node->m_Bounds.GetWidth(), node->m_Bounds.GetHeight());
-    }
-    ImGui::Text("Active Object: %s (%p)", getActiveObjectName(), control.ActiveObject ? control.ActiveObject->ID().AsPointer() : nullptr);
-    if (auto node = control.ActiveObject ? control.ActiveObject->AsNode() : nullptr)
+    TraceRecord record;
+    while (reader.m_Cursor < reader.m_End)
     {
-        ImGui::SameLine();
-        ImGui::Text("{ x=%g y=%g w=%g h=%g }", node->m_Bounds.Min.x, node->m_Bounds.Min.y, node->m_Bounds.GetWidth(), node->m_Bounds.GetHeight());
-    }
-    ImGui::Text("Action: %s", m_CurrentAction ? m_CurrentAction->GetName() : "<none>");
-    ImGui::Text("Action Is Dragging: %s", m_CurrentAction && m_CurrentAction->IsDragging() ? "Yes" : "No");
-    m_NavigateAction.ShowMetrics();
-    m_SizeAction.ShowMetrics();
-    m_DragAction.ShowMetrics();
-    m_SelectAction.ShowMetrics();
-    m_ContextMenuAction.ShowMetrics();
-    m_CreateItemAction.ShowMetrics();
-    m_DeleteItemsAction.ShowMetrics();
-    ImGui::EndGroup();
-}
+        const auto recordBegin = offset();
+
+        if (!ReadTraceRecord(reader, record))
+        {
+            m_Frames.resize(0);
+            return false;
+        }
 
+        switch (record.m_Op)
+        {
+            case TraceOp::Begin:
+                frame.m_BodyBegin = offset();
+                hasBegin = true;
+                break;
+
+            // Only frame stored in full can be repeated.
+            case TraceOp::Repeat:
+                if (!hasBegin || m_Frames.empty())
+                {
+                    m_Frames.resize(0);
+                    return false;
+                }
+                hasRepeat = true;
+                break;
 
+            case TraceOp::End:
+                if (!hasBegin)
+                {
+                    m_Frames.resize(0);
+                    return false;
+                }
 
+                frame.m_End = offset();
+                if (hasRepeat)
+                {
+                    frame.m_BodyBegin = lastFrame.m_BodyBegin;
+                    frame.m_BodyEnd   = lastFrame.m_BodyEnd;
+                }
+                else
+                {
+                    frame.m_BodyEnd = recordBegin;
+                    lastFrame = frame;
+                }
+                m_Frames.push_back(frame);
 
-//------------------------------------------------------------------------------
-//
-// Node Settings
-//
-//------------------------------------------------------------------------------
-void ed::NodeSettings::ClearDirty()
-{
-    m_IsDirty     = false;
-    m_DirtyReason = SaveReasonFlags::None;
-}
+                frame = Frame();
+                frame.m_Begin = offset();
+                hasBegin  = false;
+                hasRepeat = false;
+                break;
 
-void ed::NodeSettings::MakeDirty(SaveReasonFlags reason)
-{
-    m_IsDirty     = true;
-    m_DirtyReason = m_DirtyReason | reason;
+            default:
+                break;
+        }
+    }
+
+    return true;
 }
 
-ed::json::value ed::NodeSettings::Serialize()
+void ed::Trace::ApplyInput(int frame, ImGuiIO& io) const
 {
-    json::value result;
-    result["location"]["x"] = m_Location.x;
-    result["location"]["y"] = m_Location.y;
+    if (frame < 0 || frame >= GetFrameCount())
+        return;
 
-    if (m_GroupSize.x > 0 || m_GroupSize.y > 0)
+    auto reader = MakeTraceReader(*this, m_Frames[frame].m_Begin, m_Frames[frame].m_End);
+
+    TraceRecord record;
+    while (reader.m_Cursor < reader.m_End && ReadTraceRecord(reader, record))
     {
-        result["group_size"]["x"] = m_GroupSize.x;
-        result["group_size"]["y"] = m_GroupSize.y;
-    }
+        if (record.m_Op != TraceOp::Begin)
+            continue;
 
-    return result;
+        auto& input = record.m_Input;
+        io.DisplaySize = input.m_DisplaySize;
+        io.DeltaTime   = input.m_DeltaTime;
+        io.MousePos    = input.m_MousePos;
+        for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); ++i)
+            io.MouseDown[i] = (input.m_MouseDown & (1 << i)) != 0;
+        io.MouseWheel  = input.m_MouseWheel;
+        io.MouseWheelH = input.m_MouseWheelH;
+        io.KeyCtrl     = (input.m_Modifiers & 1) != 0;
+        io.KeyShift    = (input.m_Modifiers & 2) != 0;
+        io.KeyAlt      = (input.m_Modifiers & 4) != 0;
+        io.KeySuper    = (input.m_Modifiers & 8) != 0;
+
+        memset(io.KeysDown, 0, sizeof(io.KeysDown));
+        for (int i = 0; i < input.m_KeyCount; ++i)
+            io.KeysDown[input.m_Keys[i]] = true;
+        break;
+    }
 }
 
-bool ed::NodeSettings::Parse(const std::string& string, NodeSettings& settings)
+template <typename F>
+static void AppendTraceRecord(ed::Trace& trace, ed::TraceOp op, F&& write)
 {
-    auto settingsValue = json::value::parse(string);
-    if (settingsValue.is_discarded())
-        return false;
+    BinarySettingsWriter writer;
+    writer.m_Data.swap(trace.m_Data);
+    writer.U8(static_cast<uint8_t>(op));
+    write(writer);
+    writer.m_Data.swap(trace.m_Data);
+}
 
-    return Parse(settingsValue, settings);
+static void WriteTraceRect(BinarySettingsWriter& writer, const ImRect& rect)
+{
+    writer.Vec2(rect.Min);
+    writer.Vec2(rect.Max);
 }
 
-bool ed::NodeSettings::Parse(const json::value& data, NodeSettings& result)
+ed::TraceRecorder::TraceRecorder()
+    : m_BodyBegin(0)
+    , m_LastBodyBegin(0)
+    , m_LastBodyEnd(0)
 {
-    if (!data.is_object())
-        return false;
+    BinarySettingsWriter writer;
+    writer.Header(c_TraceMagic);
+    m_Trace.m_Data = std::move(writer.m_Data);
+}
 
-    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+void ed::TraceRecorder::Begin(const char* id, const ImVec2& size, const ImGuiIO& io)
+{
+    AppendTraceRecord(m_Trace, TraceOp::Begin, [&](BinarySettingsWriter& writer)
     {
-        if (v.is_object())
-        {
-            auto xValue = v["x"];
-            auto yValue = v["y"];
-
-            if (xValue.is_number() && yValue.is_number())
-            {
-                result.x = static_cast<float>(xValue.get<double>());
-                result.y = static_cast<float>(yValue.get<double>());
+        const auto length = strlen(id) + 1;
+        writer.U32(static_cast<uint32_t>(length));
+        writer.Bytes(id, length);
+        writer.Vec2(size);
 
-                return true;
-            }
-        }
+        uint8_t mouseDown = 0;
+        for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); ++i)
+            if (io.MouseDown[i])
+                mouseDown |= static_cast<uint8_t>(1 << i);
 
-        return false;
-    };
+        uint8_t modifiers = 0;
+        if (io.KeyCtrl)  modifiers |= 1;
+        if (io.KeyShift) modifiers |= 2;
+        if (io.KeyAlt)   modifiers |= 4;
+        if (io.KeySuper) modifiers |= 8;
 
-    if (!tryParseVector(data["location"], result.m_Location))
-        return false;
+        writer.Vec2(io.DisplaySize);
+        writer.Float(io.DeltaTime);
+        writer.Vec2(io.MousePos);
+        writer.U8(mouseDown);
+        writer.Float(io.MouseWheel);
+        writer.Float(io.MouseWheelH);
+        writer.U8(modifiers);
 
-    if (data.contains("group_size") && !tryParseVector(data["group_size"], result.m_GroupSize))
-        return false;
+        const auto keyCount = std::count(std::begin(io.KeysDown), std::end(io.KeysDown), true);
+        writer.U32(static_cast<uint32_t>(keyCount));
+        for (int i = 0; i < c_TraceMaxKeys; ++i)
+            if (io.KeysDown[i])
+                writer.U32(static_cast<uint32_t>(i));
+    });
 
-    return true;
+    m_BodyBegin = static_cast<uint32_t>(m_Trace.m_Data.size());
 }
 
+void ed::TraceRecorder::End()
+{
+    auto& data = m_Trace.m_Data;
+
+    const auto bodyEnd  = static_cast<uint32_t>(data.size());
+    const auto bodySize = bodyEnd - m_BodyBegin;
 
+    if (bodySize > 0 && bodySize == m_LastBodyEnd - m_LastBodyBegin &&
+        memcmp(data.data() + m_BodyBegin, data.data() + m_LastBodyBegin, bodySize) == 0)
+    {
+        data.resize(m_BodyBegin);
+        AppendTraceRecord(m_Trace, TraceOp::Repeat, [](BinarySettingsWriter&) {});
+    }
+    else
+    {
+        m_LastBodyBegin = m_BodyBegin;
+        m_LastBodyEnd   = bodyEnd;
+    }
 
+    AppendTraceRecord(m_Trace, TraceOp::End, [](BinarySettingsWriter&) {});
+}
 
-//------------------------------------------------------------------------------
-//
-// Settings
-//
-//------------------------------------------------------------------------------
-ed::NodeSettings* ed::Settings::AddNode(NodeId id)
+void ed::TraceRecorder::BeginNode(NodeId id)
 {
-    m_Nodes.push_back(NodeSettings(id));
-    return &m_Nodes.back();
+    AppendTraceRecord(m_Trace, TraceOp::BeginNode, [&](BinarySettingsWriter& writer)
+    {
+        writer.U64(id.Get());
+    });
 }
 
-ed::NodeSettings* ed::Settings::FindNode(NodeId id)
+void ed::TraceRecorder::EndNode(const Node* node)
 {
-    for (auto& settings : m_Nodes)
-        if (settings.m_ID == id)
-            return &settings;
+    AppendTraceRecord(m_Trace, TraceOp::EndNode, [&](BinarySettingsWriter& writer)
+    {
+        writer.Vec2(node->m_Bounds.GetSize());
+    });
+}
 
-    return nullptr;
+void ed::TraceRecorder::EndPin(const ed::Pin* pin)
+{
+    const auto origin = pin->m_Node->m_Bounds.Min;
+
+    AppendTraceRecord(m_Trace, TraceOp::Pin, [&](BinarySettingsWriter& writer)
+    {
+        writer.U64(pin->m_ID.Get());
+        writer.U8(static_cast<uint8_t>(pin->m_Kind));
+        WriteTraceRect(writer, ImRect(pin->m_Bounds.Min - origin, pin->m_Bounds.Max - origin));
+        WriteTraceRect(writer, ImRect(pin->m_Pivot.Min - origin, pin->m_Pivot.Max - origin));
+    });
 }
 
-void ed::Settings::ClearDirty(Node* node)
+void ed::TraceRecorder::Group(const Node* node, const ImRect& bounds)
 {
-    if (node)
+    const auto origin = node->m_Bounds.Min;
+
+    AppendTraceRecord(m_Trace, TraceOp::Group, [&](BinarySettingsWriter& writer)
     {
-        auto settings = FindNode(node->m_ID);
-        IM_ASSERT(settings);
-        settings->ClearDirty();
-    }
-    else
+        WriteTraceRect(writer, ImRect(bounds.Min - origin, bounds.Max - origin));
+    });
+}
+
+void ed::TraceRecorder::Link(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness)
+{
+    AppendTraceRecord(m_Trace, TraceOp::Link, [&](BinarySettingsWriter& writer)
     {
-        m_IsDirty     = false;
-        m_DirtyReason = SaveReasonFlags::None;
+        writer.U64(id.Get());
+        writer.U64(startPinId.Get());
+        writer.U64(endPinId.Get());
+        writer.U32(color);
+        writer.Float(thickness);
+    });
+}
 
-        for (auto& knownNode : m_Nodes)
-            knownNode.ClearDirty();
-    }
+void ed::TraceRecorder::Flow(LinkId id)
+{
+    AppendTraceRecord(m_Trace, TraceOp::Flow, [&](BinarySettingsWriter& writer)
+    {
+        writer.U64(id.Get());
+    });
 }
 
-void ed::Settings::MakeDirty(SaveReasonFlags reason, Node* node)
+void ed::TraceRecorder::SetNodePosition(NodeId id, const ImVec2& position)
 {
-    m_IsDirty     = true;
-    m_DirtyReason = m_DirtyReason | reason;
+    AppendTraceRecord(m_Trace, TraceOp::SetNodePosition, [&](BinarySettingsWriter& writer)
+    {
+        writer.U64(id.Get());
+        writer.Vec2(position);
+    });
+}
 
-    if (node)
+void ed::TraceRecorder::Select(TraceOp op, ObjectId id, bool append)
+{
+    AppendTraceRecord(m_Trace, op, [&](BinarySettingsWriter& writer)
     {
-        auto settings = FindNode(node->m_ID);
-        IM_ASSERT(settings);
+        if (op == TraceOp::ClearSelection)
+            return;
 
-        settings->MakeDirty(reason);
-    }
+        writer.U64(id.Get());
+        if (op == TraceOp::SelectNode || op == TraceOp::SelectLink)
+            writer.U8(append ? 1 : 0);
+    });
 }
 
-std::string ed::Settings::Serialize()
+void ed::TraceRecorder::Navigate(TraceOp op, bool zoomIn, float duration)
 {
-    json::value result;
+    AppendTraceRecord(m_Trace, op, [&](BinarySettingsWriter& writer)
+    {
+        if (op == TraceOp::NavigateToSelection)
+            writer.U8(zoomIn ? 1 : 0);
+        writer.Float(duration);
+    });
+}
 
-    auto serializeObjectId = [](ObjectId id)
+void ed::TraceRecorder::ShowMinimap(const ImVec2& size, MinimapLocation location)
+{
+    AppendTraceRecord(m_Trace, TraceOp::ShowMinimap, [&](BinarySettingsWriter& writer)
     {
-        auto value = std::to_string(reinterpret_cast<uintptr_t>(id.AsPointer()));
-        switch (id.Type())
-        {
-            default:
-            case NodeEditor::Detail::ObjectType::None: return value;
-            case NodeEditor::Detail::ObjectType::Node: return "node:" + value;
-            case NodeEditor::Detail::ObjectType::Link: return "link:" + value;
-            case NodeEditor::Detail::ObjectType::Pin:  return "pin:"  + value;
-        }
-    };
+        writer.Vec2(size);
+        writer.U8(static_cast<uint8_t>(location));
+    });
+}
 
-    auto& nodes = result["nodes"];
-    for (auto& node : m_Nodes)
+ed::Trace* ed::TraceRecorder::Finish()
+{
+    auto trace = new Trace();
+    trace->m_Data.swap(m_Trace.m_Data);
+    if (!trace->Index())
     {
-        if (node.m_WasUsed)
-            nodes[serializeObjectId(node.m_ID)] = node.Serialize();
+        delete trace;
+        return nullptr;
     }
 
-    auto& selection = result["selection"];
-    for (auto& id : m_Selection)
-        selection.push_back(serializeObjectId(id));
+    trace->m_Data.resize(trace->m_Frames.empty() ? c_TraceHeaderSize : trace->m_Frames.back().m_End);
+    trace->m_Data.shrink_to_fit();
 
-    auto& view = result["view"];
-    view["scroll"]["x"] = m_ViewScroll.x;
-    view["scroll"]["y"] = m_ViewScroll.y;
-    view["zoom"]   = m_ViewZoom;
+    return trace;
+}
 
-    return result.dump();
+void ed::EditorContext::BeginTraceRecording()
+{
+    m_TraceRecorder.reset(new TraceRecorder());
 }
 
-bool ed::Settings::Parse(const std::string& string, Settings& settings)
+ed::Trace* ed::EditorContext::EndTraceRecording()
 {
-    Settings result = settings;
+    if (!m_TraceRecorder)
+        return nullptr;
 
-    auto settingsValue = json::value::parse(string);
-    if (settingsValue.is_discarded())
-        return false;
+    auto trace = m_TraceRecorder->Finish();
+    m_TraceRecorder.reset();
+    return trace;
+}
 
-    if (!settingsValue.is_object())
-        return false;
+void ed::EditorContext::ReplayTrace(const Trace& trace, int frame)
+{
+    if (frame < 0 || frame >= trace.GetFrameCount())
+        return;
 
-    auto tryParseVector = [](const json::value& v, ImVec2& result) -> bool
+    const auto& frameRange = trace.m_Frames[frame];
+
+    auto reader = MakeTraceReader(trace, frameRange.m_Begin, frameRange.m_End);
+    auto outer  = reader; // resumed after repeated body
+    auto inBody = false;
+
+    // Node content is not recorded. Pins and groups are placed where they
+    // were, dummy item of recorded size gives node its bounds.
+    Node*  node = nullptr;
+    ImVec2 contentStart;
+
+    TraceRecord record;
+    for (;;)
     {
-        if (v.is_object() && v.contains("x") && v.contains("y"))
+        if (reader.m_Cursor >= reader.m_End)
         {
-            auto xValue = v["x"];
-            auto yValue = v["y"];
+            if (!inBody)
+                break;
+            reader = outer;
+            inBody = false;
+            continue;
+        }
 
-            if (xValue.is_number() && yValue.is_number())
+        if (!ReadTraceRecord(reader, record))
+            break;
+
+        switch (record.m_Op)
+        {
+            case TraceOp::Repeat:
+                if (inBody)
+                    break;
+                outer  = reader;
+                reader = MakeTraceReader(trace, frameRange.m_BodyBegin, frameRange.m_BodyEnd);
+                inBody = true;
+                break;
+
+            case TraceOp::Begin:
+                Begin(record.m_Name, record.m_Vec);
+                break;
+
+            case TraceOp::End:
+                End();
+                break;
+
+            case TraceOp::BeginNode:
+                node = GetNode(NodeId(static_cast<uintptr_t>(record.m_Ids[0])));
+                m_NodeBuilder.Begin(node);
+                contentStart = ImGui::GetCursorScreenPos();
+                break;
+
+            case TraceOp::EndNode:
             {
-                result.x = static_cast<float>(xValue.get<double>());
-                result.y = static_cast<float>(yValue.get<double>());
+                if (!node)
+                    break;
+
+                const auto& padding = m_Style.NodePadding;
+                ImGui::SetCursorScreenPos(contentStart);
+                ImGui::Dummy(ImMax(record.m_Vec - ImVec2(padding.x + padding.z, padding.y + padding.w), ImVec2(0, 0)));
+                m_NodeBuilder.End();
+                node = nullptr;
+                break;
+            }
 
-                return true;
+            case TraceOp::Pin:
+            {
+                if (!node)
+                    break;
+
+                const auto origin = node->m_Bounds.Min;
+                const auto kind   = static_cast<PinKind>(record.m_Flags);
+                const auto& bounds = record.m_Rects[0];
+                const auto& pivot  = record.m_Rects[1];
+
+                ImGui::SetCursorScreenPos(origin + bounds.Min);
+                m_NodeBuilder.BeginPin(GetPin(PinId(static_cast<uintptr_t>(record.m_Ids[0])), kind), kind);
+                m_NodeBuilder.PinRect(origin + bounds.Min, origin + bounds.Max);
+                m_NodeBuilder.PinPivotRect(origin + pivot.Min, origin + pivot.Max);
+                m_NodeBuilder.EndPin();
+                break;
             }
-        }
 
-        return false;
-    };
+            case TraceOp::Group:
+                if (!node)
+                    break;
 
-    auto deserializeObjectId = [](const std::string& str)
-    {
-        auto separator = str.find_first_of(':');
-        auto idStart   = str.c_str() + ((separator != std::string::npos) ? separator + 1 : 0);
-        auto id        = reinterpret_cast<void*>(strtoull(idStart, nullptr, 10));
-        if (str.compare(0, separator, "node") == 0)
-            return ObjectId(NodeId(id));
-        else if (str.compare(0, separator, "link") == 0)
-            return ObjectId(LinkId(id));
-        else if (str.compare(0, separator, "pin") == 0)
-            return ObjectId(PinId(id));
-        else
-            // fallback to old format
-            return ObjectId(NodeId(id)); //return ObjectId();
-    };
+                ImGui::SetCursorScreenPos(node->m_Bounds.Min + record.m_Rects[0].Min);
+                m_NodeBuilder.Group(record.m_Rects[0].GetSize());
+                break;
 
-    //auto& settingsObject = settingsValue.get<json::object>();
+            case TraceOp::Link:
+                DoLink(LinkId(static_cast<uintptr_t>(record.m_Ids[0])),
+                    PinId(static_cast<uintptr_t>(record.m_Ids[1])), PinId(static_cast<uintptr_t>(record.m_Ids[2])),
+                    record.m_Color, record.m_Value);
+                break;
 
-    auto& nodesValue = settingsValue["nodes"];
-    if (nodesValue.is_object())
-    {
-        for (auto& node : nodesValue.get<json::object>())
-        {
-            auto id = deserializeObjectId(node.first.c_str()).AsNodeId();
+            case TraceOp::Flow:
+                if (auto link = FindLink(LinkId(static_cast<uintptr_t>(record.m_Ids[0]))))
+                    Flow(link);
+                break;
 
-            auto nodeSettings = result.FindNode(id);
-            if (!nodeSettings)
-                nodeSettings = result.AddNode(id);
+            case TraceOp::SetNodePosition:
+                SetNodePosition(NodeId(static_cast<uintptr_t>(record.m_Ids[0])), record.m_Vec);
+                break;
 
-            NodeSettings::Parse(node.second, *nodeSettings);
-        }
-    }
+            case TraceOp::ClearSelection:
+                ClearSelection();
+                break;
 
-    auto& selectionValue = settingsValue["selection"];
-    if (selectionValue.is_array())
-    {
-        const auto selectionArray = selectionValue.get<json::array>();
+            case TraceOp::SelectNode:
+            case TraceOp::SelectLink:
+            {
+                const auto id = static_cast<uintptr_t>(record.m_Ids[0]);
+                auto object = record.m_Op == TraceOp::SelectNode ? static_cast<Object*>(FindNode(NodeId(id))) : FindLink(LinkId(id));
+                if (!object)
+                    break;
 
-        result.m_Selection.reserve(selectionArray.size());
-        result.m_Selection.resize(0);
-        for (auto& selection : selectionArray)
-        {
-            if (selection.is_string())
-                result.m_Selection.push_back(deserializeObjectId(selection.get<json::string>()));
-        }
-    }
+                if (record.m_Flags)
+                    SelectObject(object);
+                else
+                    SetSelectedObject(object);
+                break;
+            }
 
-    auto& viewValue = settingsValue["view"];
-    if (viewValue.is_object())
-    {
-        auto& viewScrollValue = viewValue["scroll"];
-        auto& viewZoomValue   = viewValue["zoom"];
+            case TraceOp::DeselectNode:
+                if (auto object = FindNode(NodeId(static_cast<uintptr_t>(record.m_Ids[0]))))
+                    DeselectObject(object);
+                break;
 
-        if (!tryParseVector(viewScrollValue, result.m_ViewScroll))
-            result.m_ViewScroll = ImVec2(0, 0);
+            case TraceOp::DeselectLink:
+                if (auto object = FindLink(LinkId(static_cast<uintptr_t>(record.m_Ids[0]))))
+                    DeselectObject(object);
+                break;
 
-        result.m_ViewZoom = viewZoomValue.is_number() ? static_cast<float>(viewZoomValue.get<double>()) : 1.0f;
-    }
+            case TraceOp::NavigateToContent:
+                NavigateTo(GetContentBounds(), true, record.m_Value);
+                break;
 
-    settings = std::move(result);
+            case TraceOp::NavigateToSelection:
+                NavigateTo(GetSelectionBounds(), record.m_Flags != 0, record.m_Value);
+                break;
 
-    return true;
+            case TraceOp::ShowMinimap:
+                ShowMinimap(record.m_Vec, static_cast<MinimapLocation>(record.m_Flags));
+                break;
+
+            default:
+                break;
+        }
+    }
 }
 
 
 
+
 //------------------------------------------------------------------------------
 //
 // Animation
@@ -2493,7 +7010,8 @@ ed::Animation::Animation(EditorContext* editor):
     Editor(editor),
     m_State(Stopped),
     m_Time(0.0f),
-    m_Duration(0.0f)
+    m_Duration(0.0f),
+    m_LiveIndex(-1)
 {
 }
 
@@ -2628,8 +7146,10 @@ ed::FlowAnimation::FlowAnimation(FlowAnimationController* controller):
     Animation(controller->Editor),
     Controller(controller),
     m_Link(nullptr),
+    m_Speed(0.0f),
+    m_MarkerDistance(0.0f),
     m_Offset(0.0f),
-    m_PathLength(0.0f)
+    m_ListIndex(-1)
 {
 }
 
@@ -2661,7 +7181,8 @@ void ed::FlowAnimation::Draw(ImDrawList* drawList)
     if (!IsPathValid())
         UpdatePath();
 
-    m_Offset = fmodf(m_Offset, m_MarkerDistance);
+    // Wrapping by whole period keeps markers in place at any stride.
+    m_Offset = fmodf(m_Offset, m_MarkerDistance * c_FlowMarkerPeriod);
 
     const auto progress    = GetProgress();
 
@@ -2670,28 +7191,88 @@ void ed::FlowAnimation::Draw(ImDrawList* drawList)
     //const auto flowPath  = Link->GetCurve();
 
     m_Link->Draw(drawList, flowColor, 2.0f);
+}
+
+void ed::FlowAnimation::DrawMarkers(ImDrawList* drawList, FlowMarkerGeometry& geometry)
+{
+    if (!IsPlaying() || !IsLinkValid() || !m_Link->IsVisible() || !IsPathValid())
+        return;
+
+    const auto progress = GetProgress();
+
+    const auto markerAlpha  = powf(1.0f - progress, 0.35f);
+    const auto markerRadius = 4.0f * (1.0f - progress) + 2.0f;
+    const auto markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
+
+    // Skipped markers are ones in between, remaining ones do not jump.
+    const auto markerStride = Editor->GetQuality().FlowMarkerStride;
+    IM_ASSERT(c_FlowMarkerPeriod % markerStride == 0);
+    const auto markerStep   = m_MarkerDistance * markerStride;
+    const auto markerOffset = fmodf(m_Offset, markerStep);
+
+    const auto pathLength = m_Path.GetLength();
+    if (markerOffset >= pathLength)
+        return;
+
+    // Markers go in order along the path, resume search from last one.
+    int cursor = 0;
+    const auto origin = m_Path.Sample(markerOffset, cursor);
 
-    if (IsPathValid())
+    // All markers of a flow look the same. First one is drawn by ImGui and
+    // captured, the rest are copies moved into place.
+    const auto firstVertex = drawList->VtxBuffer.Size;
+    const auto firstIndex  = drawList->IdxBuffer.Size;
+
+    drawList->AddCircleFilled(origin, markerRadius, markerColor);
+
+    const auto vertexCount = drawList->VtxBuffer.Size - firstVertex;
+    const auto indexCount  = drawList->IdxBuffer.Size - firstIndex;
+    if (vertexCount == 0)
+        return;
+
+    // Counted from the end, vertex offset may have been reset by the call.
+    const auto markerBaseIndex = drawList->_VtxCurrentIdx - vertexCount;
+
+    geometry.Vertices.resize(vertexCount);
+    memcpy(geometry.Vertices.Data, drawList->VtxBuffer.Data + firstVertex, vertexCount * sizeof(ImDrawVert));
+
+    geometry.Indices.resize(indexCount);
+    for (int i = 0; i < indexCount; ++i)
+        geometry.Indices.Data[i] = static_cast<ImDrawIdx>(drawList->IdxBuffer.Data[firstIndex + i] - markerBaseIndex);
+
+    for (float d = markerOffset + markerStep; d < pathLength; d += markerStep)
     {
-        //Offset = 0;
+        const auto delta = m_Path.Sample(d, cursor) - origin;
+
+        drawList->PrimReserve(indexCount, vertexCount);
 
-        const auto markerAlpha  = powf(1.0f - progress, 0.35f);
-        const auto markerRadius = 4.0f * (1.0f - progress) + 2.0f;
-        const auto markerColor  = Editor->GetColor(StyleColor_FlowMarker, markerAlpha);
+        auto vertex = drawList->_VtxWritePtr;
+        for (auto& source : geometry.Vertices)
+        {
+            *vertex = source;
+            vertex->pos.x += delta.x;
+            vertex->pos.y += delta.y;
+            ++vertex;
+        }
 
-        for (float d = m_Offset; d < m_PathLength; d += m_MarkerDistance)
-            drawList->AddCircleFilled(SamplePath(d), markerRadius, markerColor);
+        const auto markerIndex = drawList->_VtxCurrentIdx;
+        for (int i = 0; i < indexCount; ++i)
+            drawList->_IdxWritePtr[i] = static_cast<ImDrawIdx>(markerIndex + geometry.Indices.Data[i]);
+
+        drawList->_VtxWritePtr   += vertexCount;
+        drawList->_IdxWritePtr   += indexCount;
+        drawList->_VtxCurrentIdx += vertexCount;
     }
 }
 
 bool ed::FlowAnimation::IsLinkValid() const
 {
-    return m_Link && m_Link->m_IsLive;
+    return m_Link && m_Link->IsLive();
 }
 
 bool ed::FlowAnimation::IsPathValid() const
 {
-    return m_Path.size() > 1 && m_PathLength > 0.0f && m_Link->m_Start == m_LastStart && m_Link->m_End == m_LastEnd;
+    return !m_Path.IsEmpty() && m_Path.GetLength() > 0.0f && m_Link->m_Start == m_LastStart && m_Link->m_End == m_LastEnd;
 }
 
 void ed::FlowAnimation::UpdatePath()
@@ -2706,40 +7287,17 @@ void ed::FlowAnimation::UpdatePath()
 
     m_LastStart  = m_Link->m_Start;
     m_LastEnd    = m_Link->m_End;
-    m_PathLength = ImCubicBezierLength(curve.P0, curve.P1, curve.P2, curve.P3);
-
-    auto collectPointsCallback = [this](ImCubicBezierFixedStepSample& result)
-    {
-        m_Path.push_back(CurvePoint{ result.Length, result.Point });
-    };
 
-    const auto step = ImMax(m_MarkerDistance * 0.5f, 15.0f);
+    const auto step     = ImMax(m_MarkerDistance * 0.5f, 15.0f);
+    const auto length   = ImCubicBezierLength(curve.P0, curve.P1, curve.P2, curve.P3);
+    const auto segments = ImClamp(static_cast<int>(ceilf(length / step)), 8, 256);
 
-    m_Path.resize(0);
-    ImCubicBezierFixedStep(collectPointsCallback, curve, step, false, 0.5f, 0.001f);
+    m_Path.Build(curve, segments);
 }
 
 void ed::FlowAnimation::ClearPath()
 {
-    vector<CurvePoint>().swap(m_Path);
-    m_PathLength = 0.0f;
-}
-
-ImVec2 ed::FlowAnimation::SamplePath(float distance)
-{
-    //distance = ImMax(0.0f, std::min(distance, PathLength));
-
-    auto endPointIt = std::find_if(m_Path.begin(), m_Path.end(), [distance](const CurvePoint& p) { return distance < p.Distance; });
-    if (endPointIt == m_Path.end())
-        endPointIt = m_Path.end() - 1;
-    else if (endPointIt == m_Path.begin())
-        endPointIt = m_Path.begin() + 1;
-
-    const auto& start = endPointIt[-1];
-    const auto& end   = *endPointIt;
-    const auto  t     = (distance - start.Distance) / (end.Distance - start.Distance);
-
-    return start.Point + (end.Point - start.Point) * t;
+    m_Path.Clear();
 }
 
 void ed::FlowAnimation::OnUpdate(float progress)
@@ -2749,6 +7307,11 @@ void ed::FlowAnimation::OnUpdate(float progress)
     m_Offset += m_Speed * ImGui::GetIO().DeltaTime;
 }
 
+void ed::FlowAnimation::OnPlay()
+{
+    Controller->Activate(this);
+}
+
 void ed::FlowAnimation::OnStop()
 {
     Controller->Release(this);
@@ -2769,13 +7332,14 @@ ed::FlowAnimationController::FlowAnimationController(EditorContext* editor):
 
 ed::FlowAnimationController::~FlowAnimationController()
 {
-    for (auto animation : m_Animations)
-        delete animation;
+    // Playing animations release themselves when destroyed, lists have
+    // to be still around.
+    m_Pool.clear();
 }
 
 void ed::FlowAnimationController::Flow(Link* link)
 {
-    if (!link || !link->m_IsLive)
+    if (!link || !link->IsLive())
         return;
 
     auto& editorStyle = GetStyle();
@@ -2787,42 +7351,121 @@ void ed::FlowAnimationController::Flow(Link* link)
 
 void ed::FlowAnimationController::Draw(ImDrawList* drawList)
 {
-    if (m_Animations.empty())
+    if (m_LiveFlows.empty())
         return;
 
-    drawList->ChannelsSetCurrent(c_LinkChannel_Flow);
+    ImDrawList_ChannelsSetCurrent(drawList, c_LinkChannel_Flow);
+
+    // Highlighted links first, then markers of all flows on top of them.
+    for (auto animation : m_LiveFlows)
+        animation->Draw(drawList);
+
+    for (auto animation : m_LiveFlows)
+        animation->DrawMarkers(drawList, m_MarkerGeometry);
+}
+
+void ed::FlowAnimationController::Activate(FlowAnimation* animation)
+{
+    if (animation->m_ListIndex >= 0)
+        RemoveFromList(m_FreeFlows, animation);
+
+    AddToList(m_LiveFlows, animation);
+}
+
+void ed::FlowAnimationController::Release(FlowAnimation* animation)
+{
+    if (animation->m_ListIndex >= 0)
+        RemoveFromList(m_LiveFlows, animation);
+
+    AddToList(m_FreeFlows, animation);
+}
+
+void ed::FlowAnimationController::ClearFreeMemory()
+{
+    // Stopped animations keep their slots, links refer to them. Path is
+    // rebuilt when animation is played again.
+    for (auto animation : m_FreeFlows)
+        animation->ClearPath();
+
+    // Slots at the end of the pool can be given back. Deque keeps remaining
+    // animations in place, so pointers held by links stay valid.
+    while (!m_Pool.empty() && !m_Pool.back().IsPlaying())
+    {
+        auto animation = &m_Pool.back();
+        if (animation->m_ListIndex >= 0)
+            RemoveFromList(m_FreeFlows, animation);
+
+        if (animation->m_Link && animation->m_Link->m_FlowAnimation == animation)
+            animation->m_Link->m_FlowAnimation = nullptr;
+
+        m_Pool.pop_back();
+    }
+
+    m_Pool.shrink_to_fit();
+    m_FreeFlows.shrink_to_fit();
+
+    m_MarkerGeometry.Vertices.clear();
+    m_MarkerGeometry.Indices.clear();
+}
+
+size_t ed::FlowAnimationController::GetMemoryUsage() const
+{
+    size_t size = m_Pool.size() * sizeof(FlowAnimation);
+    for (auto& animation : m_Pool)
+        size += animation.GetPathMemoryUsage();
 
-    for (auto animation : m_Animations)
-        animation->Draw(drawList);
+    return size
+        + HeapSize(m_LiveFlows)
+        + HeapSize(m_FreeFlows)
+        + HeapSize(m_MarkerGeometry.Vertices)
+        + HeapSize(m_MarkerGeometry.Indices);
 }
 
 ed::FlowAnimation* ed::FlowAnimationController::GetOrCreate(Link* link)
 {
-    // Return live animation which match target link
-    {
-        auto animationIt = std::find_if(m_Animations.begin(), m_Animations.end(), [link](FlowAnimation* animation) { return animation->m_Link == link; });
-        if (animationIt != m_Animations.end())
-            return *animationIt;
-    }
+    // Link remembers its animation, it is either still playing or was not
+    // taken over by other link yet
+    if (link->m_FlowAnimation)
+        return link->m_FlowAnimation;
 
-    // There are no live animations for target link, try to reuse inactive old one
-    if (!m_FreePool.empty())
+    // Reuse stopped animation of other link
+    if (!m_FreeFlows.empty())
     {
-        auto animation = m_FreePool.back();
-        m_FreePool.pop_back();
+        auto animation = m_FreeFlows.back();
+        RemoveFromList(m_FreeFlows, animation);
+
+        if (animation->m_Link && animation->m_Link->m_FlowAnimation == animation)
+            animation->m_Link->m_FlowAnimation = nullptr;
+
+        link->m_FlowAnimation = animation;
         return animation;
     }
 
-    // Cache miss, allocate new one
-    auto animation = new FlowAnimation(this);
-    m_Animations.push_back(animation);
+    // Pool is empty, allocate new one
+    m_Pool.emplace_back(this);
 
+    auto animation = &m_Pool.back();
+    link->m_FlowAnimation = animation;
     return animation;
 }
 
-void ed::FlowAnimationController::Release(FlowAnimation* animation)
+void ed::FlowAnimationController::AddToList(vector<FlowAnimation*>& list, FlowAnimation* animation)
+{
+    animation->m_ListIndex = static_cast<int>(list.size());
+    list.push_back(animation);
+}
+
+void ed::FlowAnimationController::RemoveFromList(vector<FlowAnimation*>& list, FlowAnimation* animation)
 {
-    IM_UNUSED(animation);
+    const auto index = animation->m_ListIndex;
+    IM_ASSERT(index >= 0 && index < static_cast<int>(list.size()) && list[index] == animation);
+
+    auto last = list.back();
+    list[index] = last;
+    last->m_ListIndex = index;
+    list.pop_back();
+
+    animation->m_ListIndex = -1;
 }
 
 
@@ -3139,6 +7782,19 @@ ImRect ed::NavigateAction::GetViewRect() const
     return m_Canvas.CalcViewRect(GetView());
 }
 
+void ed::NavigateAction::CenterView(const ImVec2& canvasPoint)
+{
+    StopNavigation();
+
+    auto view = m_Canvas.CalcCenterView(canvasPoint);
+    if (m_Scroll == -view.Origin)
+        return;
+
+    m_Scroll = -view.Origin;
+
+    Editor->MakeDirty(SaveReasonFlags::Navigation);
+}
+
 float ed::NavigateAction::MatchZoom(int steps, float fallbackZoom)
 {
     auto currentZoomIndex = MatchZoomIndex(steps);
@@ -3297,6 +7953,8 @@ bool ed::SizeAction::Process(const Control& control)
         m_SizedNode->m_GroupBounds.Min.y -= m_StartBounds.Min.y - m_StartGroupBounds.Min.y;
         m_SizedNode->m_GroupBounds.Max.x -= m_StartBounds.Max.x - m_StartGroupBounds.Max.x;
         m_SizedNode->m_GroupBounds.Max.y -= m_StartBounds.Max.y - m_StartGroupBounds.Max.y;
+
+        Editor->NotifyNodeBoundsChanged(m_SizedNode);
     }
     else if (!control.ActiveNode)
     {
@@ -3425,6 +8083,10 @@ ed::EditorAction::AcceptResult ed::DragAction::Accept(const Control& control)
                     m_Objects.push_back(candidate);
         }
 
+        for (auto object : m_Objects)
+            if (auto node = object->AsNode())
+                Editor->BeginNodeDrag(node);
+
         m_IsActive = true;
     }
     else if (control.HotNode && IsGroup(control.HotNode) && control.HotNode->GetRegion(ImGui::GetMousePos()) == NodeRegion::Header)
@@ -3447,6 +8109,8 @@ bool ed::DragAction::Process(const Control& control)
                 Editor->MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::User, object->AsNode());
         }
 
+        Editor->EndNodeDrags();
+
         m_Objects.resize(0);
 
         m_DraggedObject = nullptr;
@@ -3547,6 +8211,7 @@ ed::SelectAction::SelectAction(EditorContext* editor):
     m_SelectLinkMode(false),
     m_CommitSelection(false),
     m_StartPoint(),
+    m_CandidateGeneration(0),
     m_Animation(editor)
 {
 }
@@ -3578,7 +8243,12 @@ ed::EditorAction::AcceptResult ed::SelectAction::Accept(const Control& control)
         }
 
         if (io.KeyCtrl)
+        {
             m_SelectedObjectsAtStart = Editor->GetSelectedObjects();
+            std::sort(m_SelectedObjectsAtStart.begin(), m_SelectedObjectsAtStart.end());
+        }
+
+        ResetCandidates();
     }
     else if (control.BackgroundClicked)
     {
@@ -3620,6 +8290,8 @@ bool ed::SelectAction::Process(const Control& control)
         for (auto object : m_CandidateObjects)
             Editor->SelectObject(object);
 
+        for (auto object : m_CandidateObjects)
+            object->m_IsSelectCandidate = false;
         m_CandidateObjects.clear();
 
         m_CommitSelection = false;
@@ -3640,34 +8312,7 @@ bool ed::SelectAction::Process(const Control& control)
         if (rect.GetHeight() <= 0)
             rect.Max.y = rect.Min.y + 1;
 
-        vector<Node*> nodes;
-        vector<Link*> links;
-
-        if (m_SelectLinkMode)
-        {
-            Editor->FindLinksInRect(rect, links);
-            m_CandidateObjects.assign(links.begin(), links.end());
-        }
-        else
-        {
-            Editor->FindNodesInRect(rect, nodes);
-            m_CandidateObjects.assign(nodes.begin(), nodes.end());
-
-            if (m_SelectGroups)
-            {
-                auto endIt = std::remove_if(m_CandidateObjects.begin(), m_CandidateObjects.end(), [](Object* object) { return !IsGroup(object->AsNode()); });
-                m_CandidateObjects.erase(endIt, m_CandidateObjects.end());
-            }
-            else
-            {
-                auto endIt = std::remove_if(m_CandidateObjects.begin(), m_CandidateObjects.end(), [](Object* object) { return IsGroup(object->AsNode()); });
-                m_CandidateObjects.erase(endIt, m_CandidateObjects.end());
-            }
-        }
-
-        m_CandidateObjects.insert(m_CandidateObjects.end(), m_SelectedObjectsAtStart.begin(), m_SelectedObjectsAtStart.end());
-        std::sort(m_CandidateObjects.begin(), m_CandidateObjects.end());
-        m_CandidateObjects.erase(std::unique(m_CandidateObjects.begin(), m_CandidateObjects.end()), m_CandidateObjects.end());
+        UpdateCandidates(rect);
     }
     else
     {
@@ -3683,6 +8328,100 @@ bool ed::SelectAction::Process(const Control& control)
     return m_IsActive;
 }
 
+void ed::SelectAction::ResetCandidates()
+{
+    for (auto object : m_CandidateObjects)
+        object->m_IsSelectCandidate = false;
+
+    m_CandidateObjects.resize(0);
+
+    for (auto object : m_SelectedObjectsAtStart)
+    {
+        object->m_IsSelectCandidate = true;
+        m_CandidateObjects.push_back(object);
+    }
+
+    m_CandidateRect       = ImRect();
+    m_CandidateGeneration = Editor->GetGeometryGeneration();
+}
+
+void ed::SelectAction::UpdateCandidates(const ImRect& rect)
+{
+    if (Editor->GetGeometryGeneration() != m_CandidateGeneration)
+        ResetCandidates();
+
+    const auto& last = m_CandidateRect;
+    if (rect.Min == last.Min && rect.Max == last.Max)
+        return;
+
+    // Objects fully inside of both rects keep their state, only these
+    // touching region between them need to be evaluated again. That region
+    // is covered by strips around intersection of both rects.
+    auto common = last;
+    common.ClipWithFull(rect);
+
+    ImRect strips[4];
+    auto   stripCount = 0;
+
+    if (ImRect_IsEmpty(last) || common.Min.x >= common.Max.x || common.Min.y >= common.Max.y)
+    {
+        ResetCandidates();
+        strips[stripCount++] = rect;
+    }
+    else
+    {
+        auto outer = last;
+        outer.Add(rect);
+
+        strips[stripCount++] = ImRect(outer.Min.x, outer.Min.y,  outer.Max.x,  common.Min.y);
+        strips[stripCount++] = ImRect(outer.Min.x, common.Max.y, outer.Max.x,  outer.Max.y);
+        strips[stripCount++] = ImRect(outer.Min.x, common.Min.y, common.Min.x, common.Max.y);
+        strips[stripCount++] = ImRect(common.Max.x, common.Min.y, outer.Max.x, common.Max.y);
+    }
+
+    m_CandidateRect = rect;
+
+    auto hasDroppedCandidates = false;
+
+    for (auto i = 0; i < stripCount; ++i)
+    {
+        if (m_SelectLinkMode)
+        {
+            Editor->FindLinksInRect(strips[i], m_QueryLinks);
+            for (auto link : m_QueryLinks)
+                hasDroppedCandidates |= !UpdateCandidate(link, rect);
+        }
+        else
+        {
+            Editor->FindNodesInRect(strips[i], m_QueryNodes);
+            for (auto node : m_QueryNodes)
+                if (IsGroup(node) == m_SelectGroups)
+                    hasDroppedCandidates |= !UpdateCandidate(node, rect);
+        }
+    }
+
+    // Drop objects which left the rect, order of remaining ones is kept.
+    if (hasDroppedCandidates)
+    {
+        auto endIt = std::remove_if(m_CandidateObjects.begin(), m_CandidateObjects.end(), [](Object* object) { return !object->m_IsSelectCandidate; });
+        m_CandidateObjects.erase(endIt, m_CandidateObjects.end());
+    }
+}
+
+bool ed::SelectAction::UpdateCandidate(Object* object, const ImRect& rect)
+{
+    const auto isCandidate = object->TestHit(rect) || std::binary_search(m_SelectedObjectsAtStart.begin(), m_SelectedObjectsAtStart.end(), object);
+    if (isCandidate == object->m_IsSelectCandidate)
+        return true;
+
+    object->m_IsSelectCandidate = isCandidate;
+
+    if (isCandidate)
+        m_CandidateObjects.push_back(object);
+
+    return isCandidate;
+}
+
 void ed::SelectAction::ShowMetrics()
 {
     EditorAction::ShowMetrics();
@@ -3701,7 +8440,7 @@ void ed::SelectAction::Draw(ImDrawList* drawList)
     const auto fillColor    = Editor->GetColor(m_SelectLinkMode ? StyleColor_LinkSelRect       : StyleColor_NodeSelRect, alpha);
     const auto outlineColor = Editor->GetColor(m_SelectLinkMode ? StyleColor_LinkSelRectBorder : StyleColor_NodeSelRectBorder, alpha);
 
-    drawList->ChannelsSetCurrent(c_BackgroundChannel_SelectionRect);
+    ImDrawList_ChannelsSetCurrent(drawList, c_BackgroundChannel_SelectionRect);
 
     auto min  = ImVec2(std::min(m_StartPoint.x, m_EndPoint.x), std::min(m_StartPoint.y, m_EndPoint.y));
     auto max  = ImVec2(ImMax(m_StartPoint.x, m_EndPoint.x), ImMax(m_StartPoint.y, m_EndPoint.y));
@@ -3711,6 +8450,22 @@ void ed::SelectAction::Draw(ImDrawList* drawList)
     drawList->AddRect(min, max, outlineColor);
 }
 
+void ed::SelectAction::ClearFreeMemory()
+{
+    if (m_IsActive || m_CommitSelection)
+        return;
+
+    m_CandidateObjects.shrink_to_fit();
+    vector<Object*>().swap(m_SelectedObjectsAtStart);
+    vector<Node*>().swap(m_QueryNodes);
+    vector<Link*>().swap(m_QueryLinks);
+}
+
+size_t ed::SelectAction::GetMemoryUsage() const
+{
+    return HeapSize(m_CandidateObjects) + HeapSize(m_SelectedObjectsAtStart) + HeapSize(m_QueryNodes) + HeapSize(m_QueryLinks);
+}
+
 
 
 
@@ -4152,7 +8907,7 @@ bool ed::CreateItemAction::Process(const Control& control)
             DropNothing();
 
         auto drawList = ImGui::GetWindowDrawList();
-        drawList->ChannelsSetCurrent(c_LinkChannel_NewLink);
+        ImDrawList_ChannelsSetCurrent(drawList, c_LinkChannel_NewLink);
 
         candidate.UpdateEndpoints();
         candidate.Draw(drawList, m_LinkColor, m_LinkThickness);
@@ -4250,7 +9005,7 @@ void ed::CreateItemAction::End()
 
         auto currentChannel = ImGui::GetWindowDrawList()->_Splitter._Current;
         if (currentChannel != m_LastChannel)
-            ImGui::GetWindowDrawList()->ChannelsSetCurrent(m_LastChannel);
+            ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), m_LastChannel);
 
         m_IsInGlobalSpace = false;
     }
@@ -4526,6 +9281,8 @@ void ed::DeleteItemsAction::End()
 
     IM_ASSERT(m_InInteraction);
     m_InInteraction = false;
+
+    CompactItems();
 }
 
 bool ed::DeleteItemsAction::QueryLink(LinkId* linkId, PinId* startId, PinId* endId)
@@ -4585,21 +9342,24 @@ bool ed::DeleteItemsAction::QueryItem(ObjectId* itemId, IteratorType itemType)
     auto itemCount = (int)m_CandidateObjects.size();
     while (m_CandidateItemIndex < itemCount)
     {
-        auto item = m_CandidateObjects[m_CandidateItemIndex];
-        if (itemType == Node)
+        // Skip items already accepted or rejected.
+        if (auto item = m_CandidateObjects[m_CandidateItemIndex])
         {
-            if (auto node = item->AsNode())
+            if (itemType == Node)
             {
-                *itemId = node->m_ID;
-                return true;
+                if (auto node = item->AsNode())
+                {
+                    *itemId = node->m_ID;
+                    return true;
+                }
             }
-        }
-        else if (itemType == Link)
-        {
-            if (auto link = item->AsLink())
+            else if (itemType == Link)
             {
-                *itemId = link->m_ID;
-                return true;
+                if (auto link = item->AsLink())
+                {
+                    *itemId = link->m_ID;
+                    return true;
+                }
             }
         }
 
@@ -4614,35 +9374,103 @@ bool ed::DeleteItemsAction::QueryItem(ObjectId* itemId, IteratorType itemType)
 
 bool ed::DeleteItemsAction::AcceptItem()
 {
-    if (!m_InInteraction)
+    if (!m_InInteraction || m_CurrentItemType == Unknown || !m_CandidateObjects[m_CandidateItemIndex])
         return false;
 
     m_UserAction = Accepted;
 
-    RemoveItem();
+    if (auto node = m_CandidateObjects[m_CandidateItemIndex]->AsNode())
+        Editor->ForgetNode(node);
+
+    RemoveItem(m_CandidateItemIndex);
 
     return true;
 }
 
 void ed::DeleteItemsAction::RejectItem()
 {
-    if (!m_InInteraction)
+    if (!m_InInteraction || m_CurrentItemType == Unknown || !m_CandidateObjects[m_CandidateItemIndex])
         return;
 
     m_UserAction = Rejected;
 
-    RemoveItem();
+    RemoveItem(m_CandidateItemIndex);
+}
+
+void ed::DeleteItemsAction::AcceptItems()
+{
+    if (!m_InInteraction)
+        return;
+
+    for (int i = 0, count = static_cast<int>(m_CandidateObjects.size()); i < count; ++i)
+    {
+        if (!m_CandidateObjects[i])
+            continue;
+
+        if (auto node = m_CandidateObjects[i]->AsNode())
+            Editor->ForgetNode(node);
+
+        RemoveItem(i);
+    }
+
+    m_CurrentItemType = Unknown;
+    m_UserAction      = Undetermined;
+}
+
+void ed::DeleteItemsAction::RejectItems()
+{
+    if (!m_InInteraction)
+        return;
+
+    for (int i = 0, count = static_cast<int>(m_CandidateObjects.size()); i < count; ++i)
+        if (m_CandidateObjects[i])
+            RemoveItem(i);
+
+    m_CurrentItemType = Unknown;
+    m_UserAction      = Undetermined;
+}
+
+void ed::DeleteItemsAction::RemoveItem(int index)
+{
+    // Items are only marked here, list is compacted and removed items
+    // deselected in batch at the end of interaction.
+    auto item = m_CandidateObjects[index];
+    m_CandidateObjects[index] = nullptr;
+
+    m_RemovedObjects.push_back(item);
+
+    // Deleted node is not kept alive by RetainNodes and its settings
+    // can be dropped by TrimMemory().
+    if (auto link = item->AsLink())
+        Editor->NotifyLinkDeleted(link);
+    else if (auto node = item->AsNode())
+        Editor->ForgetNode(node);
+}
+
+void ed::DeleteItemsAction::CompactItems()
+{
+    auto endIt = std::remove(m_CandidateObjects.begin(), m_CandidateObjects.end(), nullptr);
+    m_CandidateObjects.erase(endIt, m_CandidateObjects.end());
+
+    Editor->DeselectObjects(m_RemovedObjects);
+    m_RemovedObjects.resize(0);
 }
 
-void ed::DeleteItemsAction::RemoveItem()
+void ed::DeleteItemsAction::ClearFreeMemory()
 {
-    auto item = m_CandidateObjects[m_CandidateItemIndex];
-    m_CandidateObjects.erase(m_CandidateObjects.begin() + m_CandidateItemIndex);
+    // Objects queued by Add() wait for next interaction, only spare
+    // capacity is released.
+    if (m_IsActive)
+        return;
 
-    Editor->DeselectObject(item);
+    m_ManuallyDeletedObjects.shrink_to_fit();
+    m_CandidateObjects.shrink_to_fit();
+    m_RemovedObjects.shrink_to_fit();
+}
 
-    if (m_CurrentItemType == Link)
-        Editor->NotifyLinkDeleted(item->AsLink());
+size_t ed::DeleteItemsAction::GetMemoryUsage() const
+{
+    return HeapSize(m_ManuallyDeletedObjects) + HeapSize(m_CandidateObjects) + HeapSize(m_RemovedObjects);
 }
 
 
@@ -4656,21 +9484,39 @@ void ed::DeleteItemsAction::RemoveItem()
 ed::NodeBuilder::NodeBuilder(EditorContext* editor):
     Editor(editor),
     m_CurrentNode(nullptr),
-    m_CurrentPin(nullptr)
+    m_CurrentPin(nullptr),
+    m_ImpostorLastPin(nullptr)
 {
 }
 
 ed::NodeBuilder::~NodeBuilder()
 {
+    ClearFreeMemory();
+}
+
+void ed::NodeBuilder::ClearFreeMemory()
+{
+    IM_ASSERT(nullptr == m_CurrentNode);
+
     m_Splitter.ClearFreeMemory();
     m_PinSplitter.ClearFreeMemory();
 }
 
+size_t ed::NodeBuilder::GetMemoryUsage() const
+{
+    return ImDrawListSplitter_GetMemoryUsage(m_Splitter) + ImDrawListSplitter_GetMemoryUsage(m_PinSplitter);
+}
+
 void ed::NodeBuilder::Begin(NodeId nodeId)
+{
+    Begin(Editor->GetNode(nodeId));
+}
+
+void ed::NodeBuilder::Begin(Node* node)
 {
     IM_ASSERT(nullptr == m_CurrentNode);
 
-    m_CurrentNode = Editor->GetNode(nodeId);
+    m_CurrentNode = node;
 
     if (m_CurrentNode->m_RestoreState)
     {
@@ -4695,6 +9541,7 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
                 {
                     node->m_Bounds.Translate(ImFloor(offset));
                     node->m_GroupBounds.Translate(ImFloor(offset));
+                    Editor->NotifyNodeBoundsChanged(node);
                     Editor->MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::User, node);
                 }
             }
@@ -4702,6 +9549,7 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
             {
                 m_CurrentNode->m_Bounds.Translate(ImFloor(offset));
                 m_CurrentNode->m_GroupBounds.Translate(ImFloor(offset));
+                Editor->NotifyNodeBoundsChanged(m_CurrentNode);
                 Editor->MakeDirty(SaveReasonFlags::Position | SaveReasonFlags::User, m_CurrentNode);
             }
         }
@@ -4716,7 +9564,11 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
 
     const auto alpha = ImGui::GetStyle().Alpha;
 
-    m_CurrentNode->m_IsLive           = true;
+    m_CurrentNode->SetLive(true);
+    m_CurrentNode->m_IsRetained       = false;
+    m_CurrentNode->m_IsForgotten      = false;
+    m_ImpostorLastPin                 = m_CurrentNode->m_LastPin;
+    Editor->NotifyObjectSubmitted(m_CurrentNode->m_ID);
     m_CurrentNode->m_LastPin          = nullptr;
     m_CurrentNode->m_Color            = Editor->GetColor(StyleColor_NodeBg, alpha);
     m_CurrentNode->m_BorderColor      = Editor->GetColor(StyleColor_NodeBorder, alpha);
@@ -4734,7 +9586,7 @@ void ed::NodeBuilder::Begin(NodeId nodeId)
     {
         m_CurrentNode->m_Channel = drawList->_Splitter._Count;
         ImDrawList_ChannelsGrow(drawList, drawList->_Splitter._Count + c_ChannelsPerNode);
-        drawList->ChannelsSetCurrent(m_CurrentNode->m_Channel + c_NodeContentChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, m_CurrentNode->m_Channel + c_NodeContentChannel);
 
         m_Splitter.Clear();
         ImDrawList_SwapSplitter(drawList, m_Splitter);
@@ -4778,29 +9630,55 @@ void ed::NodeBuilder::End()
     m_NodeRect = ImGui_GetItemRect();
     m_NodeRect.Floor();
 
+    // Content may be skipped in overview or when node is drawn as impostor,
+    // keep size node had in higher detail.
+    const auto isContentOptional = Editor->GetLOD() == LevelOfDetail::Overview || m_CurrentNode->m_HasImpostor;
+    if (isContentOptional && !ImRect_IsEmpty(m_CurrentNode->m_Bounds))
+        m_NodeRect.Max = m_NodeRect.Min + m_CurrentNode->m_Bounds.GetSize();
+
+    // Pins skipped together with content are kept alive by the editor.
+    if (m_CurrentNode->m_HasImpostor && !m_CurrentNode->m_LastPin)
+        m_CurrentNode->m_LastPin = m_ImpostorLastPin;
+
     if (m_CurrentNode->m_Bounds.GetSize() != m_NodeRect.GetSize())
     {
         m_CurrentNode->m_Bounds.Max = m_CurrentNode->m_Bounds.Min + m_NodeRect.GetSize();
+        Editor->NotifyNodeBoundsChanged(m_CurrentNode);
         Editor->MakeDirty(SaveReasonFlags::Size, m_CurrentNode);
     }
 
+    const auto type = m_IsGroup ? NodeType::Group : NodeType::Node;
+    if (m_CurrentNode->m_Type != type)
+    {
+        m_CurrentNode->m_Type = type;
+        Editor->NotifyNodeTypeChanged(m_CurrentNode);
+    }
+
     if (m_IsGroup)
     {
         // Groups cannot have pins. Discard them.
         for (auto pin = m_CurrentNode->m_LastPin; pin; pin = pin->m_PreviousPin)
             pin->Reset();
 
-        m_CurrentNode->m_Type        = NodeType::Group;
+        if (m_CurrentNode->m_GroupBounds.GetSize() != m_GroupBounds.GetSize())
+            Editor->MakeDirty(SaveReasonFlags::Size, m_CurrentNode);
+
+        if (m_CurrentNode->m_GroupBounds.Min != m_GroupBounds.Min || m_CurrentNode->m_GroupBounds.Max != m_GroupBounds.Max)
+            Editor->NotifyGroupBoundsChanged(m_CurrentNode);
+
         m_CurrentNode->m_GroupBounds = m_GroupBounds;
         m_CurrentNode->m_LastPin     = nullptr;
     }
-    else
-        m_CurrentNode->m_Type        = NodeType::Node;
 
     m_CurrentNode = nullptr;
 }
 
 void ed::NodeBuilder::BeginPin(PinId pinId, PinKind kind)
+{
+    BeginPin(Editor->GetPin(pinId, kind), kind);
+}
+
+void ed::NodeBuilder::BeginPin(Pin* pin, PinKind kind)
 {
     IM_ASSERT(nullptr != m_CurrentNode);
     IM_ASSERT(nullptr == m_CurrentPin);
@@ -4808,10 +9686,14 @@ void ed::NodeBuilder::BeginPin(PinId pinId, PinKind kind)
 
     auto& editorStyle = Editor->GetStyle();
 
-    m_CurrentPin = Editor->GetPin(pinId, kind);
+    m_CurrentPin = pin;
+    m_CurrentPin->m_Kind = kind;
     m_CurrentPin->m_Node = m_CurrentNode;
 
-    m_CurrentPin->m_IsLive      = true;
+    m_LastPinGeometry = m_CurrentPin->MakeGeometryKey();
+
+    m_CurrentPin->SetLive(true);
+    m_CurrentPin->m_IsRetained  = false;
     m_CurrentPin->m_Color       = Editor->GetColor(StyleColor_PinRect);
     m_CurrentPin->m_BorderColor = Editor->GetColor(StyleColor_PinRectBorder);
     m_CurrentPin->m_BorderWidth = editorStyle.PinBorderWidth;
@@ -4826,6 +9708,9 @@ void ed::NodeBuilder::BeginPin(PinId pinId, PinKind kind)
     m_CurrentPin->m_PreviousPin = m_CurrentNode->m_LastPin;
     m_CurrentNode->m_LastPin    = m_CurrentPin;
 
+    m_LastPinBounds = m_CurrentPin->m_Bounds;
+    Editor->NotifyObjectSubmitted(m_CurrentPin->m_ID);
+
     m_PivotAlignment          = editorStyle.PivotAlignment;
     m_PivotSize               = editorStyle.PivotSize;
     m_PivotScale              = editorStyle.PivotScale;
@@ -4875,6 +9760,14 @@ void ed::NodeBuilder::EndPin()
     // #debug: Draw pin pivot rectangle
     //ImGui::GetWindowDrawList()->AddRect(m_CurrentPin->m_Pivot.Min, m_CurrentPin->m_Pivot.Max, IM_COL32(255, 0, 255, 255));
 
+    if (m_CurrentPin->m_Bounds.Min != m_LastPinBounds.Min || m_CurrentPin->m_Bounds.Max != m_LastPinBounds.Max)
+        Editor->NotifyGeometryChanged();
+
+    const auto geometry = m_CurrentPin->MakeGeometryKey();
+    if (memcmp(&geometry, &m_LastPinGeometry, sizeof(Pin::GeometryKey)) != 0)
+        if (++m_CurrentPin->m_GeometryVersion == 0)
+            m_CurrentPin->m_GeometryVersion = 1;
+
     m_CurrentPin = nullptr;
 }
 
@@ -4943,10 +9836,10 @@ ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList() const
 
 ImDrawList* ed::NodeBuilder::GetUserBackgroundDrawList(Node* node) const
 {
-    if (node && node->m_IsLive)
+    if (node && node->IsLive() && !node->m_IsRetained)
     {
         auto drawList = ImGui::GetWindowDrawList();
-        drawList->ChannelsSetCurrent(node->m_Channel + c_NodeUserBackgroundChannel);
+        ImDrawList_ChannelsSetCurrent(drawList, node->m_Channel + c_NodeUserBackgroundChannel);
         return drawList;
     }
     else
@@ -4993,10 +9886,10 @@ bool ed::HintBuilder::Begin(NodeId nodeId)
 
     const auto alpha = ImMax(0.0f, std::min(1.0f, (view.Scale - c_min_zoom) / (c_max_zoom - c_min_zoom)));
 
-    ImGui::GetWindowDrawList()->ChannelsSetCurrent(c_UserChannel_HintsBackground);
+    ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), c_UserChannel_HintsBackground);
     ImGui::PushClipRect(rect.Min + ImVec2(1, 1), rect.Max - ImVec2(1, 1), false);
 
-    ImGui::GetWindowDrawList()->ChannelsSetCurrent(c_UserChannel_Hints);
+    ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), c_UserChannel_Hints);
     ImGui::PushClipRect(rect.Min + ImVec2(1, 1), rect.Max - ImVec2(1, 1), false);
 
     ImGui::PushStyleVar(ImGuiStyleVar_Alpha, alpha);
@@ -5013,13 +9906,13 @@ void ed::HintBuilder::End()
 
     ImGui::PopStyleVar();
 
-    ImGui::GetWindowDrawList()->ChannelsSetCurrent(c_UserChannel_Hints);
+    ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), c_UserChannel_Hints);
     ImGui::PopClipRect();
 
-    ImGui::GetWindowDrawList()->ChannelsSetCurrent(c_UserChannel_HintsBackground);
+    ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), c_UserChannel_HintsBackground);
     ImGui::PopClipRect();
 
-    ImGui::GetWindowDrawList()->ChannelsSetCurrent(m_LastChannel);
+    ImDrawList_ChannelsSetCurrent(ImGui::GetWindowDrawList(), m_LastChannel);
 
     Editor->Resume(SuspendFlags::KeepSplitter);
 
@@ -5047,7 +9940,7 @@ ImDrawList* ed::HintBuilder::GetForegroundDrawList()
 
     auto drawList = ImGui::GetWindowDrawList();
 
-    drawList->ChannelsSetCurrent(c_UserChannel_Hints);
+    ImDrawList_ChannelsSetCurrent(drawList, c_UserChannel_Hints);
 
     return drawList;
 }
@@ -5058,7 +9951,7 @@ ImDrawList* ed::HintBuilder::GetBackgroundDrawList()
 
     auto drawList = ImGui::GetWindowDrawList();
 
-    drawList->ChannelsSetCurrent(c_UserChannel_HintsBackground);
+    ImDrawList_ChannelsSetCurrent(drawList, c_UserChannel_HintsBackground);
 
     return drawList;
 }
@@ -5078,6 +9971,7 @@ void ed::Style::PushColor(StyleColor colorIndex, const ImVec4& color)
     modifier.Value = Colors[colorIndex];
     m_ColorStack.push_back(modifier);
     Colors[colorIndex] = color;
+    Invalidate();
 }
 
 void ed::Style::PopColor(int count)
@@ -5089,6 +9983,7 @@ void ed::Style::PopColor(int count)
         m_ColorStack.pop_back();
         --count;
     }
+    Invalidate();
 }
 
 void ed::Style::PushVar(StyleVar varIndex, float value)
@@ -5100,6 +9995,7 @@ void ed::Style::PushVar(StyleVar varIndex, float value)
     modifier.Value = ImVec4(*var, 0, 0, 0);
     *var = value;
     m_VarStack.push_back(modifier);
+    Invalidate();
 }
 
 void ed::Style::PushVar(StyleVar varIndex, const ImVec2& value)
@@ -5111,6 +10007,7 @@ void ed::Style::PushVar(StyleVar varIndex, const ImVec2& value)
     modifier.Value = ImVec4(var->x, var->y, 0, 0);
     *var = value;
     m_VarStack.push_back(modifier);
+    Invalidate();
 }
 
 void ed::Style::PushVar(StyleVar varIndex, const ImVec4& value)
@@ -5122,6 +10019,7 @@ void ed::Style::PushVar(StyleVar varIndex, const ImVec4& value)
     modifier.Value = *var;
     *var = value;
     m_VarStack.push_back(modifier);
+    Invalidate();
 }
 
 void ed::Style::PopVar(int count)
@@ -5138,6 +10036,7 @@ void ed::Style::PopVar(int count)
         m_VarStack.pop_back();
         --count;
     }
+    Invalidate();
 }
 
 const char* ed::Style::GetColorName(StyleColor colorIndex) const
@@ -5162,6 +10061,9 @@ const char* ed::Style::GetColorName(StyleColor colorIndex) const
         case StyleColor_FlowMarker: return "FlowMarker";
         case StyleColor_GroupBg: return "GroupBg";
         case StyleColor_GroupBorder: return "GroupBorder";
+        case StyleColor_MinimapBg: return "MinimapBg";
+        case StyleColor_MinimapNode: return "MinimapNode";
+        case StyleColor_MinimapView: return "MinimapView";
         case StyleColor_Count: break;
     }
 
@@ -5190,6 +10092,9 @@ float* ed::Style::GetVarFloatAddr(StyleVar idx)
         case StyleVar_PinArrowWidth:            return &PinArrowWidth;
         case StyleVar_GroupRounding:            return &GroupRounding;
         case StyleVar_GroupBorderWidth:         return &GroupBorderWidth;
+        case StyleVar_LodReducedZoom:           return &LodReducedZoom;
+        case StyleVar_LodOverviewZoom:          return &LodOverviewZoom;
+        case StyleVar_LodAntiAliasZoom:         return &LodAntiAliasZoom;
         default:                                return nullptr;
     }
 }
@@ -5224,17 +10129,185 @@ ImVec4* ed::Style::GetVarVec4Addr(StyleVar idx)
 // Config
 //
 //------------------------------------------------------------------------------
+# if defined(_WIN32)
+extern "C" __declspec(dllimport) int __stdcall MoveFileExA(const char* existingFileName, const char* newFileName, unsigned long flags);
+# endif
+
+// Moves file over existing one, target is either old or new file at any time.
+static bool MoveFileOver(const std::string& source, const std::string& target)
+{
+# if defined(_WIN32)
+    // rename() does not replace existing files on Windows.
+    const unsigned long c_MoveFileReplaceExisting = 0x1; // MOVEFILE_REPLACE_EXISTING
+    const unsigned long c_MoveFileWriteThrough    = 0x8; // MOVEFILE_WRITE_THROUGH
+    if (MoveFileExA(source.c_str(), target.c_str(), c_MoveFileReplaceExisting | c_MoveFileWriteThrough))
+        return true;
+
+    // Last resort, not atomic. Target is missing until rename() is done.
+    std::remove(target.c_str());
+# endif
+
+    return std::rename(source.c_str(), target.c_str()) == 0;
+}
+
+// Writes settings file on background thread. Data posted while previous
+// write is in progress replace each other, only the latest one is written.
+// Reasons of failed writes are kept until taken by editor, later successful
+// write drops them since it carries newer data.
+struct ed::SettingsWriter
+{
+    SettingsWriter()
+        : m_PendingReason(SaveReasonFlags::None)
+        , m_FailedReason(SaveReasonFlags::None)
+        , m_HasPending(false)
+        , m_IsWriting(false)
+        , m_Quit(false)
+    {
+        m_Thread = std::thread([this]() { Run(); });
+    }
+
+    ~SettingsWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit = true;
+        }
+        m_Wake.notify_one();
+        m_Thread.join();
+    }
+
+    void Post(const char* path, std::string data, SaveReasonFlags reason)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_PendingPath = path;
+            m_PendingData.swap(data);
+            m_PendingReason = m_HasPending ? m_PendingReason | reason : reason;
+            m_HasPending    = true;
+        }
+        m_Wake.notify_one();
+    }
+
+    bool IsBusy()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_HasPending || m_IsWriting;
+    }
+
+    SaveReasonFlags TakeFailure()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto reason = m_FailedReason;
+        m_FailedReason = SaveReasonFlags::None;
+        return reason;
+    }
+
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Idle.wait(lock, [this]() { return !m_HasPending && !m_IsWriting; });
+    }
+
+private:
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (true)
+        {
+            m_Wake.wait(lock, [this]() { return m_HasPending || m_Quit; });
+
+            // Pending data is written before quitting.
+            if (!m_HasPending)
+                break;
+
+            std::string path, data;
+            path.swap(m_PendingPath);
+            data.swap(m_PendingData);
+            const auto reason = m_PendingReason;
+            m_HasPending = false;
+            m_IsWriting  = true;
+
+            lock.unlock();
+            const auto written = Write(path, data);
+            lock.lock();
+
+            m_FailedReason = written ? SaveReasonFlags::None : m_FailedReason | reason;
+            m_IsWriting    = false;
+            m_Idle.notify_all();
+        }
+    }
+
+    static bool Write(const std::string& path, const std::string& data)
+    {
+        // Write next to the target and swap files, so readers never
+        // see partially written settings.
+        const auto temporaryPath = path + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            file.close();
+            if (!file)
+            {
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+
+        if (!MoveFileOver(temporaryPath, path))
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    std::thread             m_Thread;
+    std::mutex              m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Idle;
+    std::string             m_PendingPath;
+    std::string             m_PendingData;
+    SaveReasonFlags         m_PendingReason;
+    SaveReasonFlags         m_FailedReason;
+    bool                    m_HasPending;
+    bool                    m_IsWriting;
+    bool                    m_Quit;
+};
+
 ed::Config::Config(const ax::NodeEditor::Config* config)
 {
     if (config)
         *static_cast<ax::NodeEditor::Config*>(this) = *config;
 }
 
+ed::Config::~Config()
+{
+    Flush();
+}
+
 std::string ed::Config::Load()
 {
     std::string data;
 
-    if (LoadSettings)
+    if (ReadSettings)
+    {
+        // Read until reader runs dry, size is not known up front.
+        while (true)
+        {
+            const auto offset = data.size();
+            data.resize(offset + SettingsOutput::c_ChunkSize);
+
+            const auto size = ReadSettings(&data[offset], SettingsOutput::c_ChunkSize, UserPointer);
+            data.resize(offset + ImMin(size, SettingsOutput::c_ChunkSize));
+            if (size == 0)
+                break;
+        }
+    }
+    else if (LoadSettings)
     {
         const auto size = LoadSettings(nullptr, UserPointer);
         if (size > 0)
@@ -5245,7 +10318,7 @@ std::string ed::Config::Load()
     }
     else if (SettingsFile)
     {
-        std::ifstream file(SettingsFile);
+        std::ifstream file(SettingsFile, std::ios::binary);
         if (file)
         {
             file.seekg(0, std::ios_base::end);
@@ -5283,19 +10356,50 @@ void ed::Config::BeginSave()
         BeginSaveSession(UserPointer);
 }
 
-bool ed::Config::Save(const std::string& data, SaveReasonFlags flags)
+static bool WriteSettingsFile(const char* data, size_t size, ed::SaveReasonFlags reason, void* userPointer)
+{
+    IM_UNUSED(reason);
+
+    auto& file = *reinterpret_cast<std::ofstream*>(userPointer);
+    if (data)
+        file.write(data, static_cast<std::streamsize>(size));
+
+    return !!file;
+}
+
+bool ed::Config::Save(Settings& settings, SaveReasonFlags flags)
 {
-    if (SaveSettings)
+    if (WriteSettings)
+    {
+        SettingsOutput output(WriteSettings, flags, UserPointer);
+        settings.Serialize(SaveFormat, output);
+        return output.Finish();
+    }
+    else if (SaveSettings)
     {
+        const auto data = settings.Serialize(SaveFormat);
         return SaveSettings(data.c_str(), data.size(), flags, UserPointer);
     }
+    else if (SettingsFile && SaveSettingsFileAsync)
+    {
+        if (!m_Writer)
+            m_Writer.reset(new SettingsWriter());
+
+        // Posted data counts as saved, failure is reported later by
+        // TakeSaveFailure().
+        m_Writer->Post(SettingsFile, settings.Serialize(SaveFormat), flags);
+
+        return true;
+    }
     else if (SettingsFile)
     {
-        std::ofstream settingsFile(SettingsFile);
-        if (settingsFile)
-            settingsFile << data;
+        std::ofstream settingsFile(SettingsFile, std::ios::binary);
+        if (!settingsFile)
+            return false;
 
-        return !!settingsFile;
+        SettingsOutput output(WriteSettingsFile, flags, &settingsFile);
+        settings.Serialize(SaveFormat, output);
+        return output.Finish();
     }
 
     return false;
@@ -5309,8 +10413,32 @@ bool ed::Config::SaveNode(NodeId nodeId, const std::string& data, SaveReasonFlag
     return false;
 }
 
+bool ed::Config::SaveNodes(const vector<NodeSettingsChange>& changes)
+{
+    if (SaveNodeSettingsBatch)
+        return SaveNodeSettingsBatch(changes.data(), static_cast<int>(changes.size()), UserPointer);
+
+    return false;
+}
+
 void ed::Config::EndSave()
 {
     if (EndSaveSession)
         EndSaveSession(UserPointer);
 }
+
+void ed::Config::Flush()
+{
+    if (m_Writer)
+        m_Writer->Flush();
+}
+
+ed::SaveReasonFlags ed::Config::TakeSaveFailure()
+{
+    return m_Writer ? m_Writer->TakeFailure() : SaveReasonFlags::None;
+}
+
+bool ed::Config::IsSaving() const
+{
+    return m_Writer && m_Writer->IsBusy();
+}
@@ -28,6 +28,13 @@ struct NodeId;
 struct LinkId;
 struct PinId;
 
+template <typename Id> struct ObjectHandle;
+using NodeHandle = ObjectHandle<NodeId>;
+using PinHandle  = ObjectHandle<PinId>;
+using LinkHandle = ObjectHandle<LinkId>;
+
+struct NodeSettingsChange;
+
 
 //------------------------------------------------------------------------------
 enum class SaveReasonFlags: uint32_t
@@ -43,24 +50,72 @@ enum class SaveReasonFlags: uint32_t
 inline SaveReasonFlags operator |(SaveReasonFlags lhs, SaveReasonFlags rhs) { return static_cast<SaveReasonFlags>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs)); }
 inline SaveReasonFlags operator &(SaveReasonFlags lhs, SaveReasonFlags rhs) { return static_cast<SaveReasonFlags>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs)); }
 
-using ConfigSaveSettings     = bool   (*)(const char* data, size_t size, SaveReasonFlags reason, void* userPointer);
-using ConfigLoadSettings     = size_t (*)(char* data, void* userPointer);
-
-using ConfigSaveNodeSettings = bool   (*)(NodeId nodeId, const char* data, size_t size, SaveReasonFlags reason, void* userPointer);
-using ConfigLoadNodeSettings = size_t (*)(NodeId nodeId, char* data, void* userPointer);
-
-using ConfigSession          = void   (*)(void* userPointer);
+using ConfigSaveSettings          = bool   (*)(const char* data, size_t size, SaveReasonFlags reason, void* userPointer);
+using ConfigLoadSettings          = size_t (*)(char* data, void* userPointer);
+
+// Chunked alternatives of SaveSettings and LoadSettings, whole document is not
+// held in memory. Writer receives consecutive pieces of settings as they are
+// serialized and is called once more with null data when all are written.
+// After it returns false remaining pieces are skipped and settings are saved
+// again later. Reader fills up to size bytes of data and returns number of
+// bytes written, 0 at the end.
+using ConfigWriteSettings         = bool   (*)(const char* data, size_t size, SaveReasonFlags reason, void* userPointer);
+using ConfigReadSettings          = size_t (*)(char* data, size_t size, void* userPointer);
+
+using ConfigSaveNodeSettings      = bool   (*)(NodeId nodeId, const char* data, size_t size, SaveReasonFlags reason, void* userPointer);
+using ConfigLoadNodeSettings      = size_t (*)(NodeId nodeId, char* data, void* userPointer);
+
+// Receives all dirty nodes at once. When set SaveNodeSettings is not used and
+// SaveSettings is called only if navigation or selection changed, so nodes
+// should be restored with LoadNodeSettings.
+using ConfigSaveNodeSettingsBatch = bool   (*)(const NodeSettingsChange* changes, int count, void* userPointer);
+
+using ConfigSession               = void   (*)(void* userPointer);
+
+// Renders drawList into atlasMin-atlasMax pixel rect of Config::NodeImpostorAtlas,
+// mapping canvasMin-canvasMax onto it. Vertices and clip rects are in canvas space.
+// Data has to be copied, image is used from next frame on and atlas has to be
+// updated before that frame is rendered.
+using ConfigRenderNodeImpostor    = bool   (*)(const ImDrawList* drawList, const ImVec2& canvasMin, const ImVec2& canvasMax, const ImVec2& atlasMin, const ImVec2& atlasMax, void* userPointer);
+
+// Calls job for consecutive ranges covering [0, count) and returns when all of
+// them are done. Ranges may run on any thread, jobs do not touch ImGui context
+// and do not allocate through ImGui.
+using ConfigParallelForJob        = void   (*)(int begin, int end, void* jobData);
+using ConfigParallelFor           = void   (*)(int count, ConfigParallelForJob job, void* jobData, void* userPointer);
+
+// Encoding of data passed to SaveSettings and SaveNodeSettings callbacks
+// (or written to SettingsFile). Loading accepts data in either format.
+enum class SettingsFormat: uint8_t
+{
+    Json,
+    Binary  // Versioned, compact. Ids and floats are stored without text conversion.
+};
 
 struct Config
 {
-    const char*             SettingsFile;
-    ConfigSession           BeginSaveSession;
-    ConfigSession           EndSaveSession;
-    ConfigSaveSettings      SaveSettings;
-    ConfigLoadSettings      LoadSettings;
-    ConfigSaveNodeSettings  SaveNodeSettings;
-    ConfigLoadNodeSettings  LoadNodeSettings;
-    void*                   UserPointer;
+    const char*                 SettingsFile;
+    ConfigSession               BeginSaveSession;
+    ConfigSession               EndSaveSession;
+    ConfigSaveSettings          SaveSettings;
+    ConfigLoadSettings          LoadSettings;
+    ConfigWriteSettings         WriteSettings;         // Used instead of SaveSettings when set.
+    ConfigReadSettings          ReadSettings;          // Used instead of LoadSettings when set.
+    ConfigSaveNodeSettings      SaveNodeSettings;
+    ConfigLoadNodeSettings      LoadNodeSettings;
+    ConfigSaveNodeSettingsBatch SaveNodeSettingsBatch;
+    bool                        SaveSettingsFileAsync; // Write SettingsFile on background thread, pending data is flushed by DestroyEditor(). Failed write is retried by next End().
+    SettingsFormat              SaveFormat;
+    bool                        LazyLoadNodeSettings;  // Parse saved node state when node is first submitted instead of in first Begin().
+    bool                        RetainNodes;           // Nodes not submitted in a frame keep last known bounds and pins, see IsNodeVisible().
+    ConfigRenderNodeImpostor    RenderNodeImpostor;    // Enables drawing static nodes as images when zoomed out, see IsNodeImpostor().
+    ImTextureID                 NodeImpostorAtlas;
+    int                         NodeImpostorAtlasSize; // Width and height of atlas in pixels.
+    float                       NodeImpostorZoom;      // Zoom below which impostors are used.
+    ImTextureID                 GridTexture;           // Replaces grid lines. One tile per grid cell with lines along top and left edge, sampled with wrap addressing.
+    ConfigParallelFor           ParallelFor;           // Used to tessellate links which geometry is not cached.
+    float                       FrameBudget;           // Milliseconds End() should take, drawing quality is lowered while exceeded. 0 disables, see FrameStats::QualityLevel.
+    void*                       UserPointer;
 
     Config()
         : SettingsFile("NodeEditor.json")
@@ -68,8 +123,22 @@ struct Config
         , EndSaveSession(nullptr)
         , SaveSettings(nullptr)
         , LoadSettings(nullptr)
+        , WriteSettings(nullptr)
+        , ReadSettings(nullptr)
         , SaveNodeSettings(nullptr)
         , LoadNodeSettings(nullptr)
+        , SaveNodeSettingsBatch(nullptr)
+        , SaveSettingsFileAsync(false)
+        , SaveFormat(SettingsFormat::Json)
+        , LazyLoadNodeSettings(false)
+        , RetainNodes(false)
+        , RenderNodeImpostor(nullptr)
+        , NodeImpostorAtlas(nullptr)
+        , NodeImpostorAtlasSize(0)
+        , NodeImpostorZoom(0.5f)
+        , GridTexture(nullptr)
+        , ParallelFor(nullptr)
+        , FrameBudget(0.0f)
         , UserPointer(nullptr)
     {
     }
@@ -105,6 +174,9 @@ enum StyleColor
     StyleColor_FlowMarker,
     StyleColor_GroupBg,
     StyleColor_GroupBorder,
+    StyleColor_MinimapBg,
+    StyleColor_MinimapNode,
+    StyleColor_MinimapView,
 
     StyleColor_Count
 };
@@ -134,10 +206,21 @@ enum StyleVar
     StyleVar_PinArrowWidth,
     StyleVar_GroupRounding,
     StyleVar_GroupBorderWidth,
+    StyleVar_LodReducedZoom,
+    StyleVar_LodOverviewZoom,
+    StyleVar_LodAntiAliasZoom,
 
     StyleVar_Count
 };
 
+// Detail level editor draws with, see Style::LodReducedZoom and Style::LodOverviewZoom.
+enum class LevelOfDetail
+{
+    Full,
+    Reduced,    // Pins and link arrows are not drawn, links are coarsely tessellated.
+    Overview    // Nodes are plain rects, links are straight lines. Node content is not readable.
+};
+
 struct Style
 {
     ImVec4  NodePadding;
@@ -163,6 +246,9 @@ struct Style
     float   PinArrowWidth;
     float   GroupRounding;
     float   GroupBorderWidth;
+    float   LodReducedZoom;     // Zoom below which LevelOfDetail::Reduced is used, 0 disables.
+    float   LodOverviewZoom;    // Zoom below which LevelOfDetail::Overview is used, 0 disables.
+    float   LodAntiAliasZoom;   // Zoom below which editor shapes are drawn without anti-aliasing, 0 disables.
     ImVec4  Colors[StyleColor_Count];
 
     Style()
@@ -190,6 +276,9 @@ struct Style
         PinArrowWidth           = 0.0f;
         GroupRounding           = 6.0f;
         GroupBorderWidth        = 1.0f;
+        LodReducedZoom          = 0.0f;
+        LodOverviewZoom         = 0.0f;
+        LodAntiAliasZoom        = 0.0f;
 
         Colors[StyleColor_Bg]                 = ImColor( 60,  60,  70, 200);
         Colors[StyleColor_Grid]               = ImColor(120, 120, 120,  40);
@@ -209,12 +298,101 @@ struct Style
         Colors[StyleColor_FlowMarker]         = ImColor(255, 128,  64, 255);
         Colors[StyleColor_GroupBg]            = ImColor(  0,   0,   0, 160);
         Colors[StyleColor_GroupBorder]        = ImColor(255, 255, 255,  32);
+        Colors[StyleColor_MinimapBg]          = ImColor( 20,  20,  24, 200);
+        Colors[StyleColor_MinimapNode]        = ImColor(200, 200, 200, 160);
+        Colors[StyleColor_MinimapView]        = ImColor(255, 176,  50, 200);
     }
 };
 
+// Corner of the canvas minimap is placed in, see ShowMinimap().
+enum class MinimapLocation
+{
+    TopLeft,
+    TopRight,
+    BottomLeft,
+    BottomRight
+};
+
+// Arrangement computed by AutoLayout().
+enum class LayoutAlgorithm
+{
+    Layered,      // Links flow left to right in columns, for data and control flows. Cycles are broken.
+    ForceDirected // Linked nodes pull together and all push apart, for graphs without direction.
+};
+
+struct LayoutConfig
+{
+    LayoutAlgorithm Algorithm;
+    ImVec2          Spacing;           // Gap between columns (x) and between nodes in column (y). Force-directed uses x as link length.
+    int             Iterations;        // Force-directed only.
+    int             NodesPerFrame;     // Most nodes moved in one frame, including animated ones. 0 moves all at once.
+    float           AnimationDuration; // Seconds node takes to move to its position, 0 to move at once.
+
+    LayoutConfig()
+        : Algorithm(LayoutAlgorithm::Layered)
+        , Spacing(ImVec2(80.0f, 30.0f))
+        , Iterations(100)
+        , NodesPerFrame(1000)
+        , AnimationDuration(0.35f)
+    {
+    }
+};
+
+// Parts of editor frame timed by profiler, see FrameStats.
+enum class FramePhase
+{
+    Frame,              // Begin() to End(), including user code submitting items.
+    BuildControl,       // Finding hovered, active and clicked items.
+    DrawNodes,
+    DrawLinks,
+    ReorderChannels,    // Sorting nodes and building channel draw order.
+    MergeChannels,
+    LeaveLocalSpace,    // Transforming canvas geometry to screen space.
+    SaveSettings,
+    Count
+};
+
+// Timings in milliseconds, over last FrameStats::SampleCount frames.
+struct FramePhaseTiming
+{
+    float Last;
+    float Min;
+    float Average;
+    float Max;
+};
+
+// Phase timings are collected only when editor is built with
+// '#define IMGUI_NODE_EDITOR_PROFILER() 1' in imconfig.h, otherwise they
+// stay zero. Counts are always reported and describe the last frame.
+struct FrameStats
+{
+    static const int SampleCount = 120;
+
+    FramePhaseTiming Phases[static_cast<int>(FramePhase::Count)];
+    int              VertexCount;       // Emitted by editor into window draw list.
+    int              IndexCount;
+    int              DrawCommandCount;
+    int              ChannelCount;      // Draw list channels used by editor.
+    float            EndTime;           // Milliseconds spent in End(), smoothed over recent frames.
+    int              QualityLevel;      // Chosen to meet Config::FrameBudget, 0 is full quality.
+};
+
+// Heap memory held by editor in bytes, estimated from container capacities.
+struct MemoryStats
+{
+    size_t Objects;     // Nodes, pins, links and their lookup tables.
+    size_t Channels;    // Draw list channels, including ones of nodes.
+    size_t Settings;
+    size_t Animations;
+    size_t Caches;      // Link geometry, spatial index, minimap, impostors and scratch buffers.
+    size_t Total;
+};
+
 
 //------------------------------------------------------------------------------
 struct EditorContext;
+struct StateSnapshot;
+struct Trace;
 
 
 //------------------------------------------------------------------------------
@@ -223,6 +401,16 @@ EditorContext* GetCurrentEditor();
 EditorContext* CreateEditor(const Config* config = nullptr);
 void DestroyEditor(EditorContext* ctx);
 
+// Releases render buffers and caches of an editor which is not drawn for
+// a while, e.g. one in a hidden tab. Node, pin and link objects are kept
+// (storage of deleted ones is released by DestroyEditor()). Graph, selection
+// and view are kept. Next Begin() wakes editor up, caches are rebuilt as
+// they are used. Must not be called between Begin() and End().
+void HibernateEditor(EditorContext* ctx);
+bool IsEditorHibernated(EditorContext* ctx);
+
+// Colors changed directly in returned style are picked up by next Begin(),
+// use PushStyleColor() to change them between Begin() and End().
 Style& GetStyle();
 const char* GetStyleColorName(StyleColor colorIndex);
 
@@ -248,6 +436,18 @@ void EndPin();
 void Group(const ImVec2& size);
 void EndNode();
 
+// Variants of calls above which skip id lookups, meant for large graphs
+// submitted every frame. See ObjectHandle.
+NodeHandle AcquireNode(NodeId id);
+PinHandle  AcquirePin(PinId id);
+LinkHandle AcquireLink(LinkId id);
+bool IsHandleValid(const NodeHandle& handle);
+bool IsHandleValid(const PinHandle& handle);
+bool IsHandleValid(const LinkHandle& handle);
+void BeginNode(const NodeHandle& node);
+void BeginPin(const PinHandle& pin, PinKind kind);
+bool Link(const LinkHandle& link, const PinHandle& startPin, const PinHandle& endPin, const ImVec4& color = ImVec4(1, 1, 1, 1), float thickness = 1.0f);
+
 bool BeginGroupHint(NodeId nodeId);
 ImVec2 GetGroupMin();
 ImVec2 GetGroupMax();
@@ -278,15 +478,48 @@ bool QueryDeletedLink(LinkId* linkId, PinId* startId = nullptr, PinId* endId = n
 bool QueryDeletedNode(NodeId* nodeId);
 bool AcceptDeletedItem();
 void RejectDeletedItem();
+// Bulk alternative to querying items one by one. Fills ids of pending items
+// and returns their count, pass nullptr to get count only.
+int  QueryDeletedNodes(NodeId* nodes, int size);
+int  QueryDeletedLinks(LinkId* links, int size);
+void AcceptDeletedItems(); // Accept all pending items.
+void RejectDeletedItems();
 void EndDelete();
 
 void SetNodePosition(NodeId nodeId, const ImVec2& editorPosition);
 ImVec2 GetNodePosition(NodeId nodeId);
 ImVec2 GetNodeSize(NodeId nodeId);
+// Batch versions of calls above, usable e.g. to apply auto-layout result. Unknown
+// nodes are reported like by GetNodePosition() and GetNodeSize(), either of
+// positions or sizes may be nullptr.
+void SetNodePositions(const NodeId* nodeIds, const ImVec2* positions, int count);
+void GetNodeBounds(const NodeId* nodeIds, ImVec2* positions, ImVec2* sizes, int count);
 void CenterNodeOnScreen(NodeId nodeId);
 
+// Arranges live nodes on a worker thread, graph is not blocked meanwhile. Node
+// sizes and links are copied when called, so nodes should be drawn at least
+// once before. New positions are applied by following Begin() calls in batches
+// of LayoutConfig::NodesPerFrame, top left corner of the graph stays in place.
+// Group nodes are left where they are. Starting new layout cancels running one.
+void AutoLayout(const LayoutConfig& config = LayoutConfig());
+bool IsAutoLayoutRunning(); // Until last node reaches its position.
+void CancelAutoLayout();    // Nodes stay where they are at the moment.
+
 void RestoreNodeState(NodeId nodeId);
 
+// With Config::RetainNodes set only visible nodes have to be submitted.
+// Unknown nodes are reported as visible, so they are measured at least once.
+bool IsNodeVisible(NodeId nodeId);
+int  GetVisibleNodes(NodeId* nodes, int size);
+void ForgetNode(NodeId nodeId); // Drop retained node, e.g. after it was removed by application.
+
+// True when node is drawn from its cached image this frame. Application may skip
+// node content then, node keeps its size and pins. Invalidate image when content
+// changes; changes of node size and zoom are detected by editor.
+bool IsNodeImpostor(NodeId nodeId);
+void InvalidateNodeImpostor(NodeId nodeId);
+void InvalidateNodeImpostors();
+
 void Suspend();
 void Resume();
 bool IsSuspended();
@@ -309,6 +542,11 @@ bool DeleteLink(LinkId linkId);
 void NavigateToContent(float duration = -1);
 void NavigateToSelection(bool zoomIn = false, float duration = -1);
 
+// Overview of the whole graph drawn over a corner of the canvas, size is in
+// pixels. Click or drag over it to move view there. Call right after Begin(),
+// before nodes, so minimap takes mouse input ahead of node content.
+void ShowMinimap(const ImVec2& size = ImVec2(200, 150), MinimapLocation location = MinimapLocation::BottomRight);
+
 bool ShowNodeContextMenu(NodeId* nodeId);
 bool ShowPinContextMenu(PinId* pinId);
 bool ShowLinkContextMenu(LinkId* linkId);
@@ -330,6 +568,20 @@ void EndShortcut();
 
 float GetCurrentZoom();
 
+// At LevelOfDetail::Overview application may skip drawing node content.
+// Size of node is kept from last frame in which it was drawn in higher detail.
+LevelOfDetail GetCurrentLOD();
+
+// Editor has pending work (animation, action in progress, input over the
+// canvas, hover change, settling layout). When false application may stop
+// rendering until new input arrives. Valid after End().
+bool NeedsRedraw();
+// Seconds after which editor wants to be drawn again, FLT_MAX when it can
+// sleep until next input. 0 while NeedsRedraw(), e.g. for whole duration of
+// animation or navigation. Short interval while settings are written on
+// background thread, so failed write is retried. Valid after End().
+float GetNextWakeupTime();
+
 NodeId GetDoubleClickedNode();
 PinId GetDoubleClickedPin();
 LinkId GetDoubleClickedLink();
@@ -338,10 +590,51 @@ bool IsBackgroundDoubleClicked();
 
 bool PinHadAnyLinks(PinId pinId);
 
+// Live links connected to node or pin. Links submitted in current frame are
+// known after Link() call for them, use after End() to get complete list.
+int GetNodeLinks(NodeId nodeId, LinkId* links, int size);
+int GetPinLinks(PinId pinId, LinkId* links, int size);
+
 ImVec2 GetScreenSize();
 ImVec2 ScreenToCanvas(const ImVec2& pos);
 ImVec2 CanvasToScreen(const ImVec2& pos);
 
+FrameStats GetFrameStats();
+
+// Returns buffers grown by past graphs to size needed by current one and
+// drops settings of deleted nodes. Must not be called between Begin() and End().
+void TrimMemory();
+MemoryStats GetMemoryStats();
+
+// Compact binary copy of node positions and sizes, selection and view, meant
+// for undo stacks. Snapshot saved with base stores only nodes changed since
+// base and keeps base alive, so snapshots can be destroyed in any order.
+// Restoring leaves nodes not present in snapshot where they are.
+StateSnapshot* SaveStateSnapshot(const StateSnapshot* base = nullptr);
+void RestoreStateSnapshot(const StateSnapshot* snapshot);
+void DestroyStateSnapshot(StateSnapshot* snapshot);
+size_t GetStateSnapshotSize(const StateSnapshot* snapshot); // in bytes, bases not included
+
+// Compact binary recording of ImGui input seen by Begin() and of calls building
+// the graph: nodes, pins and links with their rects, flows, selection, node
+// positions, navigation and minimap. Node content is not recorded. Replaying
+// trace in another application, like headless benchmark, gives the same editor
+// work frame by frame, which makes performance problems reproducible. Recording
+// must be started and ended outside of Begin() and End().
+void BeginTraceRecording();
+Trace* EndTraceRecording(); // Returns null when editor was not recording.
+bool IsRecordingTrace();
+Trace* LoadTrace(const void* data, size_t size); // Returns null when data is not a valid trace.
+void DestroyTrace(Trace* trace);
+const void* GetTraceData(const Trace* trace);
+size_t GetTraceSize(const Trace* trace);
+int GetTraceFrameCount(const Trace* trace);
+// Call ApplyTraceInput() before ImGui::NewFrame() and ReplayTraceFrame() in place
+// of whole Begin()...End() block, with the same ImGui window setup as recorded.
+// Keys are replayed by index, map them like recording application did.
+void ApplyTraceInput(const Trace* trace, int frame);
+void ReplayTraceFrame(const Trace* trace, int frame);
+
 
 
 
@@ -435,6 +728,39 @@ struct PinId final: Details::SafePointerType<PinId>
 };
 
 
+//------------------------------------------------------------------------------
+// Persistent reference to object of current editor, returned by AcquireNode(),
+// AcquirePin() and AcquireLink(). Handle becomes stale when object is deleted
+// or forgotten, stale handle still works but object is looked up by its id
+// again. Acquire handle anew when object is added back.
+template <typename Id>
+struct ObjectHandle
+{
+    Id       ID;
+    void*    Object;     // Internal, do not use.
+    uint32_t Generation;
+
+    ObjectHandle()
+        : ID()
+        , Object(nullptr)
+        , Generation(0)
+    {
+    }
+};
+
+
+//------------------------------------------------------------------------------
+// Settings of single node passed to Config::SaveNodeSettingsBatch.
+// Data is valid only for the duration of the call.
+struct NodeSettingsChange
+{
+    NodeId          Id;
+    const char*     Data;
+    size_t          Size;
+    SaveReasonFlags Reason;
+};
+
+
 //------------------------------------------------------------------------------
 } // namespace Editor
 } // namespace ax
@@ -58,6 +58,16 @@ void ax::NodeEditor::DestroyEditor(EditorContext* ctx)
     delete editor;
 }
 
+void ax::NodeEditor::HibernateEditor(EditorContext* ctx)
+{
+    reinterpret_cast<ax::NodeEditor::Detail::EditorContext*>(ctx)->Hibernate();
+}
+
+bool ax::NodeEditor::IsEditorHibernated(EditorContext* ctx)
+{
+    return reinterpret_cast<ax::NodeEditor::Detail::EditorContext*>(ctx)->IsHibernated();
+}
+
 void ax::NodeEditor::SetCurrentEditor(EditorContext* ctx)
 {
     s_Editor = reinterpret_cast<ax::NodeEditor::Detail::EditorContext*>(ctx);
@@ -110,16 +120,25 @@ void ax::NodeEditor::PopStyleVar(int count)
 
 void ax::NodeEditor::Begin(const char* id, const ImVec2& size)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Begin(id, size, ImGui::GetIO());
+
     s_Editor->Begin(id, size);
 }
 
 void ax::NodeEditor::End()
 {
     s_Editor->End();
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->End();
 }
 
 void ax::NodeEditor::BeginNode(NodeId id)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->BeginNode(id);
+
     s_Editor->GetNodeBuilder().Begin(id);
 }
 
@@ -128,6 +147,57 @@ void ax::NodeEditor::BeginPin(PinId id, PinKind kind)
     s_Editor->GetNodeBuilder().BeginPin(id, kind);
 }
 
+ax::NodeEditor::NodeHandle ax::NodeEditor::AcquireNode(NodeId id)
+{
+    return s_Editor->AcquireNode(id);
+}
+
+ax::NodeEditor::PinHandle ax::NodeEditor::AcquirePin(PinId id)
+{
+    return s_Editor->AcquirePin(id);
+}
+
+ax::NodeEditor::LinkHandle ax::NodeEditor::AcquireLink(LinkId id)
+{
+    return s_Editor->AcquireLink(id);
+}
+
+bool ax::NodeEditor::IsHandleValid(const NodeHandle& handle)
+{
+    return s_Editor->FromHandle<ax::NodeEditor::Detail::Node>(handle) != nullptr;
+}
+
+bool ax::NodeEditor::IsHandleValid(const PinHandle& handle)
+{
+    return s_Editor->FromHandle<ax::NodeEditor::Detail::Pin>(handle) != nullptr;
+}
+
+bool ax::NodeEditor::IsHandleValid(const LinkHandle& handle)
+{
+    return s_Editor->FromHandle<ax::NodeEditor::Detail::Link>(handle) != nullptr;
+}
+
+void ax::NodeEditor::BeginNode(const NodeHandle& node)
+{
+    auto object = s_Editor->FromHandle<ax::NodeEditor::Detail::Node>(node);
+    if (!object)
+        object = s_Editor->GetNode(node.ID);
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->BeginNode(object->m_ID);
+
+    s_Editor->GetNodeBuilder().Begin(object);
+}
+
+void ax::NodeEditor::BeginPin(const PinHandle& pin, PinKind kind)
+{
+    auto object = s_Editor->FromHandle<ax::NodeEditor::Detail::Pin>(pin);
+    if (!object)
+        object = s_Editor->GetPin(pin.ID, kind);
+
+    s_Editor->GetNodeBuilder().BeginPin(object, kind);
+}
+
 void ax::NodeEditor::PinRect(const ImVec2& a, const ImVec2& b)
 {
     s_Editor->GetNodeBuilder().PinRect(a, b);
@@ -155,17 +225,34 @@ void ax::NodeEditor::PinPivotAlignment(const ImVec2& alignment)
 
 void ax::NodeEditor::EndPin()
 {
-    s_Editor->GetNodeBuilder().EndPin();
+    auto& builder = s_Editor->GetNodeBuilder();
+    auto  pin     = builder.m_CurrentPin;
+
+    builder.EndPin();
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->EndPin(pin);
 }
 
 void ax::NodeEditor::Group(const ImVec2& size)
 {
-    s_Editor->GetNodeBuilder().Group(size);
+    auto& builder = s_Editor->GetNodeBuilder();
+
+    builder.Group(size);
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Group(builder.m_CurrentNode, builder.m_GroupBounds);
 }
 
 void ax::NodeEditor::EndNode()
 {
-    s_Editor->GetNodeBuilder().End();
+    auto& builder = s_Editor->GetNodeBuilder();
+    auto  node    = builder.m_CurrentNode;
+
+    builder.End();
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->EndNode(node);
 }
 
 bool ax::NodeEditor::BeginGroupHint(NodeId nodeId)
@@ -208,11 +295,32 @@ ImDrawList* ax::NodeEditor::GetNodeBackgroundDrawList(NodeId nodeId)
 
 bool ax::NodeEditor::Link(LinkId id, PinId startPinId, PinId endPinId, const ImVec4& color/* = ImVec4(1, 1, 1, 1)*/, float thickness/* = 1.0f*/)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Link(id, startPinId, endPinId, ImColor(color), thickness);
+
     return s_Editor->DoLink(id, startPinId, endPinId, ImColor(color), thickness);
 }
 
+bool ax::NodeEditor::Link(const LinkHandle& link, const PinHandle& startPin, const PinHandle& endPin, const ImVec4& color/* = ImVec4(1, 1, 1, 1)*/, float thickness/* = 1.0f*/)
+{
+    auto startObject = s_Editor->FromHandle<ax::NodeEditor::Detail::Pin>(startPin);
+    auto endObject   = s_Editor->FromHandle<ax::NodeEditor::Detail::Pin>(endPin);
+    auto linkObject  = s_Editor->FromHandle<ax::NodeEditor::Detail::Link>(link);
+
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Link(link.ID, startPin.ID, endPin.ID, ImColor(color), thickness);
+
+    if (!startObject || !endObject || !linkObject)
+        return s_Editor->DoLink(link.ID, startPin.ID, endPin.ID, ImColor(color), thickness);
+
+    return s_Editor->DoLink(linkObject, startObject, endObject, ImColor(color), thickness);
+}
+
 void ax::NodeEditor::Flow(LinkId linkId)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Flow(linkId);
+
     if (auto link = s_Editor->FindLink(linkId))
         s_Editor->Flow(link);
 }
@@ -355,6 +463,44 @@ void ax::NodeEditor::RejectDeletedItem()
     context.RejectItem();
 }
 
+int ax::NodeEditor::QueryDeletedNodes(NodeId* nodes, int size)
+{
+    auto& context = s_Editor->GetItemDeleter();
+    if (!context.IsInInteraction())
+        return 0;
+
+    return BuildIdList(context.GetPendingItems(), nodes, size, [](auto object)
+    {
+        return object && object->AsNode() != nullptr;
+    });
+}
+
+int ax::NodeEditor::QueryDeletedLinks(LinkId* links, int size)
+{
+    auto& context = s_Editor->GetItemDeleter();
+    if (!context.IsInInteraction())
+        return 0;
+
+    return BuildIdList(context.GetPendingItems(), links, size, [](auto object)
+    {
+        return object && object->AsLink() != nullptr;
+    });
+}
+
+void ax::NodeEditor::AcceptDeletedItems()
+{
+    auto& context = s_Editor->GetItemDeleter();
+
+    context.AcceptItems();
+}
+
+void ax::NodeEditor::RejectDeletedItems()
+{
+    auto& context = s_Editor->GetItemDeleter();
+
+    context.RejectItems();
+}
+
 void ax::NodeEditor::EndDelete()
 {
     auto& context = s_Editor->GetItemDeleter();
@@ -364,6 +510,9 @@ void ax::NodeEditor::EndDelete()
 
 void ax::NodeEditor::SetNodePosition(NodeId nodeId, const ImVec2& position)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->SetNodePosition(nodeId, position);
+
     s_Editor->SetNodePosition(nodeId, position);
 }
 
@@ -377,18 +526,86 @@ ImVec2 ax::NodeEditor::GetNodeSize(NodeId nodeId)
     return s_Editor->GetNodeSize(nodeId);
 }
 
+void ax::NodeEditor::SetNodePositions(const NodeId* nodeIds, const ImVec2* positions, int count)
+{
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        for (int i = 0; i < count; ++i)
+            recorder->SetNodePosition(nodeIds[i], positions[i]);
+
+    s_Editor->SetNodePositions(nodeIds, positions, count);
+}
+
+void ax::NodeEditor::GetNodeBounds(const NodeId* nodeIds, ImVec2* positions, ImVec2* sizes, int count)
+{
+    s_Editor->GetNodeBounds(nodeIds, positions, sizes, count);
+}
+
 void ax::NodeEditor::CenterNodeOnScreen(NodeId nodeId)
 {
     if (auto node = s_Editor->FindNode(nodeId))
         node->CenterOnScreenInNextFrame();
 }
 
+void ax::NodeEditor::AutoLayout(const LayoutConfig& config)
+{
+    s_Editor->AutoLayout(config);
+}
+
+bool ax::NodeEditor::IsAutoLayoutRunning()
+{
+    return s_Editor->IsAutoLayoutRunning();
+}
+
+void ax::NodeEditor::CancelAutoLayout()
+{
+    s_Editor->CancelAutoLayout();
+}
+
 void ax::NodeEditor::RestoreNodeState(NodeId nodeId)
 {
     if (auto node = s_Editor->FindNode(nodeId))
         s_Editor->MarkNodeToRestoreState(node);
 }
 
+bool ax::NodeEditor::IsNodeVisible(NodeId nodeId)
+{
+    return s_Editor->IsNodeVisible(nodeId);
+}
+
+int ax::NodeEditor::GetVisibleNodes(NodeId* nodes, int size)
+{
+    std::vector<Detail::Node*> visibleNodes;
+    s_Editor->FindNodesInRect(s_Editor->GetViewRect(), visibleNodes);
+
+    return BuildIdList(visibleNodes, nodes, size, [](auto)
+    {
+        return true;
+    });
+}
+
+void ax::NodeEditor::ForgetNode(NodeId nodeId)
+{
+    if (auto node = s_Editor->FindNode(nodeId))
+        s_Editor->ForgetNode(node);
+}
+
+bool ax::NodeEditor::IsNodeImpostor(NodeId nodeId)
+{
+    auto node = s_Editor->FindNode(nodeId);
+    return node && node->m_HasImpostor;
+}
+
+void ax::NodeEditor::InvalidateNodeImpostor(NodeId nodeId)
+{
+    if (auto node = s_Editor->FindNode(nodeId))
+        s_Editor->InvalidateNodeImpostor(node);
+}
+
+void ax::NodeEditor::InvalidateNodeImpostors()
+{
+    s_Editor->InvalidateNodeImpostors();
+}
+
 void ax::NodeEditor::Suspend()
 {
     s_Editor->Suspend();
@@ -437,11 +654,17 @@ int ax::NodeEditor::GetSelectedLinks(LinkId* links, int size)
 
 void ax::NodeEditor::ClearSelection()
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Select(ax::NodeEditor::Detail::TraceOp::ClearSelection);
+
     s_Editor->ClearSelection();
 }
 
 void ax::NodeEditor::SelectNode(NodeId nodeId, bool append)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Select(ax::NodeEditor::Detail::TraceOp::SelectNode, nodeId, append);
+
     if (auto node = s_Editor->FindNode(nodeId))
     {
         if (append)
@@ -453,6 +676,9 @@ void ax::NodeEditor::SelectNode(NodeId nodeId, bool append)
 
 void ax::NodeEditor::SelectLink(LinkId linkId, bool append)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Select(ax::NodeEditor::Detail::TraceOp::SelectLink, linkId, append);
+
     if (auto link = s_Editor->FindLink(linkId))
     {
         if (append)
@@ -464,12 +690,18 @@ void ax::NodeEditor::SelectLink(LinkId linkId, bool append)
 
 void ax::NodeEditor::DeselectNode(NodeId nodeId)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Select(ax::NodeEditor::Detail::TraceOp::DeselectNode, nodeId);
+
     if (auto node = s_Editor->FindNode(nodeId))
         s_Editor->DeselectObject(node);
 }
 
 void ax::NodeEditor::DeselectLink(LinkId linkId)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Select(ax::NodeEditor::Detail::TraceOp::DeselectLink, linkId);
+
     if (auto link = s_Editor->FindLink(linkId))
         s_Editor->DeselectObject(link);
 }
@@ -492,14 +724,28 @@ bool ax::NodeEditor::DeleteLink(LinkId linkId)
 
 void ax::NodeEditor::NavigateToContent(float duration)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Navigate(ax::NodeEditor::Detail::TraceOp::NavigateToContent, true, duration);
+
     s_Editor->NavigateTo(s_Editor->GetContentBounds(), true, duration);
 }
 
 void ax::NodeEditor::NavigateToSelection(bool zoomIn, float duration)
 {
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->Navigate(ax::NodeEditor::Detail::TraceOp::NavigateToSelection, zoomIn, duration);
+
     s_Editor->NavigateTo(s_Editor->GetSelectionBounds(), zoomIn, duration);
 }
 
+void ax::NodeEditor::ShowMinimap(const ImVec2& size, MinimapLocation location)
+{
+    if (auto recorder = s_Editor->GetTraceRecorder())
+        recorder->ShowMinimap(size, location);
+
+    s_Editor->ShowMinimap(size, location);
+}
+
 bool ax::NodeEditor::ShowNodeContextMenu(NodeId* nodeId)
 {
     return s_Editor->GetContextMenu().ShowNodeContextMenu(nodeId);
@@ -591,6 +837,21 @@ float ax::NodeEditor::GetCurrentZoom()
     return s_Editor->GetView().InvScale;
 }
 
+ax::NodeEditor::LevelOfDetail ax::NodeEditor::GetCurrentLOD()
+{
+    return s_Editor->GetLOD();
+}
+
+bool ax::NodeEditor::NeedsRedraw()
+{
+    return s_Editor->NeedsRedraw();
+}
+
+float ax::NodeEditor::GetNextWakeupTime()
+{
+    return s_Editor->GetNextWakeupTime();
+}
+
 ax::NodeEditor::NodeId ax::NodeEditor::GetDoubleClickedNode()
 {
     return s_Editor->GetDoubleClickedNode();
@@ -621,6 +882,28 @@ bool ax::NodeEditor::PinHadAnyLinks(PinId pinId)
     return s_Editor->PinHadAnyLinks(pinId);
 }
 
+int ax::NodeEditor::GetNodeLinks(NodeId nodeId, LinkId* links, int size)
+{
+    std::vector<ax::NodeEditor::Detail::Link*> nodeLinks;
+    s_Editor->FindLinksForNode(nodeId, nodeLinks);
+
+    return BuildIdList(nodeLinks, links, size, [](auto)
+    {
+        return true;
+    });
+}
+
+int ax::NodeEditor::GetPinLinks(PinId pinId, LinkId* links, int size)
+{
+    std::vector<ax::NodeEditor::Detail::Link*> pinLinks;
+    s_Editor->FindLinksForPin(pinId, pinLinks);
+
+    return BuildIdList(pinLinks, links, size, [](auto)
+    {
+        return true;
+    });
+}
+
 ImVec2 ax::NodeEditor::GetScreenSize()
 {
     return s_Editor->GetRect().GetSize();
@@ -635,3 +918,102 @@ ImVec2 ax::NodeEditor::CanvasToScreen(const ImVec2& pos)
 {
     return s_Editor->ToScreen(pos);
 }
+
+ax::NodeEditor::FrameStats ax::NodeEditor::GetFrameStats()
+{
+    return s_Editor->GetFrameStats();
+}
+
+void ax::NodeEditor::TrimMemory()
+{
+    s_Editor->TrimMemory();
+}
+
+ax::NodeEditor::MemoryStats ax::NodeEditor::GetMemoryStats()
+{
+    return s_Editor->GetMemoryStats();
+}
+
+ax::NodeEditor::StateSnapshot* ax::NodeEditor::SaveStateSnapshot(const StateSnapshot* base)
+{
+    auto snapshot = s_Editor->SaveStateSnapshot(reinterpret_cast<const ax::NodeEditor::Detail::StateSnapshot*>(base));
+    return reinterpret_cast<ax::NodeEditor::StateSnapshot*>(snapshot);
+}
+
+void ax::NodeEditor::RestoreStateSnapshot(const StateSnapshot* snapshot)
+{
+    s_Editor->RestoreStateSnapshot(reinterpret_cast<const ax::NodeEditor::Detail::StateSnapshot*>(snapshot));
+}
+
+void ax::NodeEditor::DestroyStateSnapshot(StateSnapshot* snapshot)
+{
+    ax::NodeEditor::Detail::StateSnapshot::Release(reinterpret_cast<ax::NodeEditor::Detail::StateSnapshot*>(snapshot));
+}
+
+size_t ax::NodeEditor::GetStateSnapshotSize(const StateSnapshot* snapshot)
+{
+    if (!snapshot)
+        return 0;
+
+    return reinterpret_cast<const ax::NodeEditor::Detail::StateSnapshot*>(snapshot)->m_Data.size();
+}
+
+void ax::NodeEditor::BeginTraceRecording()
+{
+    s_Editor->BeginTraceRecording();
+}
+
+ax::NodeEditor::Trace* ax::NodeEditor::EndTraceRecording()
+{
+    return reinterpret_cast<ax::NodeEditor::Trace*>(s_Editor->EndTraceRecording());
+}
+
+bool ax::NodeEditor::IsRecordingTrace()
+{
+    return s_Editor->GetTraceRecorder() != nullptr;
+}
+
+ax::NodeEditor::Trace* ax::NodeEditor::LoadTrace(const void* data, size_t size)
+{
+    auto trace = new ax::NodeEditor::Detail::Trace();
+    trace->m_Data.assign(static_cast<const char*>(data), size);
+    if (!trace->Index())
+    {
+        delete trace;
+        return nullptr;
+    }
+
+    return reinterpret_cast<ax::NodeEditor::Trace*>(trace);
+}
+
+void ax::NodeEditor::DestroyTrace(Trace* trace)
+{
+    delete reinterpret_cast<ax::NodeEditor::Detail::Trace*>(trace);
+}
+
+const void* ax::NodeEditor::GetTraceData(const Trace* trace)
+{
+    return trace ? reinterpret_cast<const ax::NodeEditor::Detail::Trace*>(trace)->m_Data.data() : nullptr;
+}
+
+size_t ax::NodeEditor::GetTraceSize(const Trace* trace)
+{
+    return trace ? reinterpret_cast<const ax::NodeEditor::Detail::Trace*>(trace)->m_Data.size() : 0;
+}
+
+int ax::NodeEditor::GetTraceFrameCount(const Trace* trace)
+{
+    return trace ? reinterpret_cast<const ax::NodeEditor::Detail::Trace*>(trace)->GetFrameCount() : 0;
+}
+
+void ax::NodeEditor::ApplyTraceInput(const Trace* trace, int frame)
+{
+    if (trace)
+        reinterpret_cast<const ax::NodeEditor::Detail::Trace*>(trace)->ApplyInput(frame, ImGui::GetIO());
+}
+
+void ax::NodeEditor::ReplayTraceFrame(const Trace* trace, int frame)
+{
+    if (trace)
+        s_Editor->ReplayTrace(*reinterpret_cast<const ax::NodeEditor::Detail::Trace*>(trace), frame);
+}
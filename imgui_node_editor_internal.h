@@ -27,7 +27,22 @@
 # include "crude_json.h"
 
 # include <vector>
+# include <algorithm>
+# include <deque>
 # include <string>
+# include <unordered_map>
+# include <memory>
+# include <new>
+# include <type_traits>
+# include <chrono>
+
+
+//------------------------------------------------------------------------------
+// Per-phase frame timings reported by GetFrameStats() and in metrics.
+// Enable with '#define IMGUI_NODE_EDITOR_PROFILER() 1' in imconfig.h.
+# ifndef IMGUI_NODE_EDITOR_PROFILER
+#     define IMGUI_NODE_EDITOR_PROFILER() 0
+# endif
 
 
 //------------------------------------------------------------------------------
@@ -50,6 +65,22 @@ using std::string;
 void Log(const char* fmt, ...);
 
 
+//------------------------------------------------------------------------------
+// Heap memory held by container, estimated from its capacity. Used by
+// GetMemoryStats().
+template <typename T>
+inline size_t HeapSize(const vector<T>& container) { return container.capacity() * sizeof(T); }
+template <typename T>
+inline size_t HeapSize(const ImVector<T>& container) { return static_cast<size_t>(container.Capacity) * sizeof(T); }
+template <typename K, typename V>
+inline size_t HeapSize(const std::unordered_map<K, V>& container)
+{
+    // Bucket array and a node with two pointers of overhead per element.
+    return container.bucket_count() * sizeof(void*) + container.size() * (sizeof(typename std::unordered_map<K, V>::value_type) + 2 * sizeof(void*));
+}
+inline size_t HeapSize(const std::string& string) { return string.capacity(); }
+
+
 //------------------------------------------------------------------------------
 //inline ImRect ToRect(const ax::rectf& rect);
 //inline ImRect ToRect(const ax::rect& rect);
@@ -125,6 +156,33 @@ private:
     float m_LastFringeScale;
 };
 
+// Scales curve tessellation tolerance and optionally turns off anti-aliasing
+// of shapes drawn into the window draw list. Cached link geometry keys on
+// both, so it is rebuilt when they change.
+struct DrawQualityScope
+{
+    DrawQualityScope(float tessellationScale, bool antiAliased)
+        : m_DrawList(ImGui::GetWindowDrawList())
+        , m_LastTessellationTol(ImGui::GetDrawListSharedData()->CurveTessellationTol)
+        , m_LastFlags(m_DrawList->Flags)
+    {
+        ImGui::GetDrawListSharedData()->CurveTessellationTol = m_LastTessellationTol * tessellationScale;
+        if (!antiAliased)
+            m_DrawList->Flags &= ~(ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill);
+    }
+
+    ~DrawQualityScope()
+    {
+        ImGui::GetDrawListSharedData()->CurveTessellationTol = m_LastTessellationTol;
+        m_DrawList->Flags = m_LastFlags;
+    }
+
+private:
+    ImDrawList*     m_DrawList;
+    float           m_LastTessellationTol;
+    ImDrawListFlags m_LastFlags;
+};
+
 
 //------------------------------------------------------------------------------
 enum class ObjectType
@@ -139,10 +197,18 @@ using ax::NodeEditor::PinKind;
 using ax::NodeEditor::StyleColor;
 using ax::NodeEditor::StyleVar;
 using ax::NodeEditor::SaveReasonFlags;
+using ax::NodeEditor::FramePhase;
+using ax::NodeEditor::FramePhaseTiming;
+using ax::NodeEditor::FrameStats;
+using ax::NodeEditor::MemoryStats;
 
 using ax::NodeEditor::NodeId;
 using ax::NodeEditor::PinId;
 using ax::NodeEditor::LinkId;
+using ax::NodeEditor::ObjectHandle;
+using ax::NodeEditor::NodeHandle;
+using ax::NodeEditor::PinHandle;
+using ax::NodeEditor::LinkHandle;
 
 struct ObjectId final: Details::SafePointerType<ObjectId>
 {
@@ -178,6 +244,8 @@ struct Node;
 struct Pin;
 struct Link;
 
+struct FlowAnimation;
+
 template <typename T, typename Id = typename T::IdType>
 struct ObjectWrapper
 {
@@ -196,6 +264,109 @@ struct ObjectWrapper
     }
 };
 
+// Open addressing hash map from object id to object. Lookup does not depend
+// on order of containers owning the objects, so these can be freely reordered.
+template <typename T, typename Id = typename T::IdType>
+struct ObjectMap
+{
+    ObjectMap()
+        : m_Count(0)
+    {
+    }
+
+    T*   Find(Id id) const;
+    void Insert(Id id, T* object);
+    bool Remove(Id id);
+    void Reserve(size_t count);
+    void Clear();
+    void Compact(); // Shrinks table to smallest capacity holding current objects.
+
+    size_t Size() const { return m_Count; }
+    size_t GetMemoryUsage() const { return HeapSize(m_Slots); }
+
+private:
+    // Slot is empty when m_Object is null.
+    struct Slot
+    {
+        uintptr_t m_Key;
+        T*        m_Object;
+    };
+
+    static size_t Hash(uintptr_t key);
+
+    void Rehash(size_t capacity);
+
+    vector<Slot> m_Slots;
+    size_t       m_Count;
+};
+
+// Allocates objects in blocks, so objects created one after another lie
+// close in memory and their addresses never change. Editor never destroys
+// single object (deleted ones are only forgotten), Clear() destroys all
+// objects and releases memory at once.
+template <typename T, int BlockSize = 128>
+struct ObjectPool
+{
+    ObjectPool()
+        : m_UsedInLastBlock(BlockSize)
+        , m_Count(0)
+    {
+    }
+
+    ~ObjectPool() { Clear(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T*   Create(Args&&... args);
+    void Clear();
+
+    size_t Size() const { return m_Count; }
+    size_t GetMemoryUsage() const { return m_Blocks.size() * BlockSize * sizeof(Slot) + HeapSize(m_Blocks); }
+
+private:
+    // Uninitialized storage of single object.
+    struct Slot
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_Storage;
+    };
+
+    vector<std::unique_ptr<Slot[]>> m_Blocks;
+    int                             m_UsedInLastBlock;
+    size_t                          m_Count;
+};
+
+struct Object;
+
+// Hot per-frame state of objects kept in arrays parallel to container owning
+// them (i.e. EditorContext::m_Nodes), at Object::m_StateIndex. Loops which
+// visit every object each frame go over arrays and touch only objects they
+// act on. Owner calls Reorder() whenever it reorders the container.
+struct ObjectStates
+{
+    vector<ImU8>   m_IsLive;
+    vector<ImU8>   m_IsVisible; // result of last Cull()
+    vector<ImRect> m_Bounds;    // set by owner when object bounds change
+
+    void Add(Object* object, bool isLive);
+
+    void ResetLive();
+
+    // Marks live objects which bounds overlap rect as visible. Same test
+    // as ImGui::IsRectVisible() does.
+    void Cull(const ImRect& rect);
+
+    template <typename T>
+    void Reorder(const vector<ObjectWrapper<T>>& objects);
+
+    int Size() const { return static_cast<int>(m_IsLive.size()); }
+
+    size_t GetMemoryUsage() const { return HeapSize(m_IsLive) + HeapSize(m_IsVisible) + HeapSize(m_Bounds); }
+
+    void ShrinkToFit();
+};
+
 struct Object
 {
     enum DrawFlags
@@ -212,11 +383,25 @@ struct Object
 
     EditorContext* const Editor;
 
-    bool    m_IsLive;
+    ObjectStates* m_States;
+    int           m_StateIndex;
+
+    bool    m_IsSelected;
+    bool    m_WasSelected;  // selection state at the start of the frame
+    bool    m_IsSelectCandidate;
+
+    // Advanced when object is deleted or forgotten, handles acquired before
+    // become stale. See ObjectHandle.
+    uint32_t m_Generation;
 
     Object(EditorContext* editor)
         : Editor(editor)
-        , m_IsLive(true)
+        , m_States(nullptr)
+        , m_StateIndex(-1)
+        , m_IsSelected(false)
+        , m_WasSelected(false)
+        , m_IsSelectCandidate(false)
+        , m_Generation(1)
     {
     }
 
@@ -224,9 +409,12 @@ struct Object
 
     virtual ObjectId ID() = 0;
 
+    bool IsLive() const { return m_States->m_IsLive[m_StateIndex] != 0; }
+    void SetLive(bool isLive) { m_States->m_IsLive[m_StateIndex] = isLive ? 1 : 0; }
+
     bool IsVisible() const
     {
-        if (!m_IsLive)
+        if (!IsLive())
             return false;
 
         const auto bounds = GetBounds();
@@ -234,7 +422,7 @@ struct Object
         return ImGui::IsRectVisible(bounds.Min, bounds.Max);
     }
 
-    virtual void Reset() { m_IsLive = false; }
+    virtual void Reset() { SetLive(false); }
 
     virtual void Draw(ImDrawList* drawList, DrawFlags flags = None) = 0;
 
@@ -248,7 +436,7 @@ struct Object
 
     virtual bool TestHit(const ImVec2& point, float extraThickness = 0.0f) const
     {
-        if (!m_IsLive)
+        if (!IsLive())
             return false;
 
         auto bounds = GetBounds();
@@ -260,7 +448,7 @@ struct Object
 
     virtual bool TestHit(const ImRect& rect, bool allowIntersect = true) const
     {
-        if (!m_IsLive)
+        if (!IsLive())
             return false;
 
         const auto bounds = GetBounds();
@@ -295,8 +483,25 @@ struct Pin final: Object
     float   m_Radius;
     float   m_ArrowSize;
     float   m_ArrowWidth;
-    bool    m_HasConnection;
-    bool    m_HadConnection;
+    int     m_ConnectionFrame; // EditorContext::m_FrameIndex of last link using pin
+    bool    m_IsRetained;
+
+    // Links which use pin as one of endpoints, live or not.
+    vector<Link*> m_Links;
+
+    // Everything link endpoints and curves depend on.
+    struct GeometryKey
+    {
+        ImRect m_Pivot;
+        ImVec2 m_Dir;
+        float  m_Strength;
+        float  m_Radius;
+        float  m_ArrowSize;
+    };
+
+    // Bumped every time GeometryKey changes, links compare it against value
+    // they were computed for. Never zero.
+    unsigned m_GeometryVersion;
 
     Pin(EditorContext* editor, PinId id, PinKind kind)
         : Object(editor)
@@ -315,8 +520,10 @@ struct Pin final: Object
         , m_Radius(0)
         , m_ArrowSize(0)
         , m_ArrowWidth(0)
-        , m_HasConnection(false)
-        , m_HadConnection(false)
+        , m_ConnectionFrame(-1)
+        , m_IsRetained(false)
+        , m_Links()
+        , m_GeometryVersion(1)
     {
     }
 
@@ -324,8 +531,7 @@ struct Pin final: Object
 
     virtual void Reset() override final
     {
-        m_HadConnection = m_HasConnection && m_IsLive;
-        m_HasConnection = false;
+        m_ConnectionFrame = -1;
 
         Object::Reset();
     }
@@ -335,6 +541,8 @@ struct Pin final: Object
     ImVec2 GetClosestPoint(const ImVec2& p) const;
     ImLine GetClosestLine(const Pin* pin) const;
 
+    GeometryKey MakeGeometryKey() const;
+
     virtual ImRect GetBounds() const override final { return m_Bounds; }
 
     virtual Pin* AsPin() override final { return this; }
@@ -390,6 +598,26 @@ struct Node final: Object
     bool     m_RestoreState;
     bool     m_CenterOnScreen;
 
+    // Node was not submitted this frame and is kept live with
+    // its last known bounds and pins (see Config::RetainNodes).
+    bool     m_IsRetained;
+    bool     m_IsForgotten;
+
+    // Node is moved by DragAction and is not in EditorContext::m_NodeIndex.
+    bool     m_IsDragged;
+
+    // Node is drawn from ImpostorCache this frame, see IsNodeImpostor().
+    bool     m_HasImpostor;
+
+    int      m_ZPosition;
+    float    m_GroupSortArea; // area group was last sorted by
+
+    // Nodes which bounds are within group bounds, live or not. Rebuilt
+    // on demand when marked dirty by EditorContext::NotifyNodeBoundsChanged().
+    vector<Node*> m_GroupedNodes;
+    bool     m_IsGroupedNodesDirty;
+    unsigned m_GroupedStamp;
+
     Node(EditorContext* editor, NodeId id)
         : Object(editor)
         , m_ID(id)
@@ -405,6 +633,15 @@ struct Node final: Object
         , m_GroupBounds()
         , m_RestoreState(false)
         , m_CenterOnScreen(false)
+        , m_IsRetained(false)
+        , m_IsForgotten(false)
+        , m_IsDragged(false)
+        , m_HasImpostor(false)
+        , m_ZPosition(0)
+        , m_GroupSortArea(0)
+        , m_GroupedNodes()
+        , m_IsGroupedNodesDirty(true)
+        , m_GroupedStamp(0)
     {
     }
 
@@ -443,6 +680,16 @@ struct Link final: Object
     float  m_Thickness;
     ImVec2 m_Start;
     ImVec2 m_End;
+    ImRect m_Bounds;
+    ImCubicBezierPoints m_Curve;
+
+    // Curve split into pieces of equal parameter span, bounds of their hulls.
+    static const int c_SegmentCount = 8;
+    ImRect m_SegmentBounds[c_SegmentCount];
+
+    // Last flow played on this link. May already be stopped, other link can
+    // take it over then.
+    FlowAnimation* m_FlowAnimation;
 
     Link(EditorContext* editor, LinkId id)
         : Object(editor)
@@ -451,6 +698,15 @@ struct Link final: Object
         , m_EndPin(nullptr)
         , m_Color(IM_COL32_WHITE)
         , m_Thickness(1.0f)
+        , m_Bounds()
+        , m_Curve()
+        , m_FlowAnimation(nullptr)
+        , m_CurveKey()
+        , m_HasCurve(false)
+        , m_StartPinVersion(0)
+        , m_EndPinVersion(0)
+        , m_GeometryKey()
+        , m_HasGeometry(false)
     {
     }
 
@@ -462,8 +718,26 @@ struct Link final: Object
     void Draw(ImDrawList* drawList, ImU32 color, float extraThickness = 0.0f) const;
 
     void UpdateEndpoints();
-
-    ImCubicBezierPoints GetCurve() const;
+    // Makes next UpdateEndpoints() look at pins again, call when they are replaced.
+    void InvalidateEndpoints() { m_StartPinVersion = 0; m_EndPinVersion = 0; }
+
+    // True when cached geometry matches what would be drawn into drawList.
+    bool HasGeometry(const ImDrawList* drawList) const;
+    // Tessellates link into scratch list as DrawCached() would into drawList.
+    // Returns false when result cannot be cached. Reads only, may run on worker
+    // thread when scratch has room for single link reserved.
+    bool TessellateGeometry(ImDrawList* scratch, const ImDrawList* drawList) const;
+    // Caches geometry tessellated for drawList.
+    void SetGeometry(const ImDrawList* drawList, const ImDrawVert* vertices, int vertexCount, const ImDrawIdx* indices, int indexCount);
+    // Drops cached geometry, link is tessellated again when drawn.
+    void ClearGeometry();
+    size_t GetGeometryMemoryUsage() const { return HeapSize(m_GeometryVertices) + HeapSize(m_GeometryIndices); }
+
+    const ImCubicBezierPoints& GetCurve() const { return m_Curve; }
+
+    // Returns false when point is farther than distance from the curve. Cheap
+    // and conservative, true does not mean point is that close.
+    bool TestSegmentBounds(const ImVec2& point, float distance) const;
 
     virtual bool TestHit(const ImVec2& point, float extraThickness = 0.0f) const override final;
     virtual bool TestHit(const ImRect& rect, bool allowIntersect = true) const override final;
@@ -471,6 +745,169 @@ struct Link final: Object
     virtual ImRect GetBounds() const override final;
 
     virtual Link* AsLink() override final { return this; }
+
+private:
+    // Everything m_Curve and m_Bounds depend on.
+    struct CurveKey
+    {
+        ImVec2 m_Start;
+        ImVec2 m_End;
+        ImVec2 m_StartDir;
+        ImVec2 m_EndDir;
+        float  m_StartStrength;
+        float  m_EndStrength;
+        float  m_StartArrowSize;
+        float  m_EndArrowSize;
+    };
+
+    CurveKey m_CurveKey;
+    bool     m_HasCurve;
+
+    // Pin::m_GeometryVersion of endpoints curve key was computed from, zero
+    // when pins changed since.
+    unsigned m_StartPinVersion;
+    unsigned m_EndPinVersion;
+
+    // Everything vertices emitted by Draw() depend on.
+    struct GeometryKey
+    {
+        ImCubicBezierPoints m_Curve;
+        float               m_Thickness;
+        float               m_StartArrowSize;
+        float               m_StartArrowWidth;
+        float               m_EndArrowSize;
+        float               m_EndArrowWidth;
+        ImU32               m_Color;
+        float               m_FringeScale;
+        float               m_TessellationTolerance;
+        ImVec2              m_TexUvWhitePixel;
+        ImDrawListFlags     m_Flags;
+        LevelOfDetail       m_LOD;
+    };
+
+    // Canvas space geometry of link in regular state. Indices are relative to
+    // the first vertex, so geometry can be appended to any draw list.
+    GeometryKey         m_GeometryKey;
+    bool                m_HasGeometry;
+    ImVector<ImDrawVert> m_GeometryVertices;
+    ImVector<ImDrawIdx>  m_GeometryIndices;
+
+    GeometryKey MakeGeometryKey(const ImDrawList* drawList) const;
+    void DrawCached(ImDrawList* drawList);
+
+    ImCubicBezierPoints CalculateCurve() const;
+    ImRect CalculateBounds() const;
+    void UpdateSegmentBounds();
+    // Moves curve, bounds and cached geometry without recomputing them.
+    void Translate(const ImVec2& offset);
+};
+
+// Uniform grid over canvas space. Objects are kept in every cell their bounds
+// touch and are moved between cells only when bounds leave the cells they
+// occupy, so queries visit only objects near the area of interest.
+struct SpatialIndex
+{
+    SpatialIndex(float cellSize = 256.0f);
+
+    void Update(Object* object, const ImRect& bounds);
+    void Remove(Object* object);
+    void Clear();
+
+    // Appends objects which indexed bounds touch the rect. Every object is
+    // reported once. Result is a superset, callers are expected to run
+    // precise hit-test on returned objects.
+    void Query(const ImRect& rect, vector<Object*>& result);
+
+    // Bounds object was indexed with.
+    bool GetBounds(Object* object, ImRect& result) const;
+
+    int GetObjectCount() const { return static_cast<int>(m_Entries.size()); }
+    int GetCellCount() const { return static_cast<int>(m_Cells.size()); }
+
+    size_t GetMemoryUsage() const;
+
+private:
+    struct CellRange
+    {
+        int MinX, MinY, MaxX, MaxY;
+
+        bool operator==(const CellRange& rhs) const { return MinX == rhs.MinX && MinY == rhs.MinY && MaxX == rhs.MaxX && MaxY == rhs.MaxY; }
+        bool operator!=(const CellRange& rhs) const { return !(*this == rhs); }
+    };
+
+    struct Entry
+    {
+        Object*    m_Object;
+        ImRect     m_Bounds;
+        CellRange  m_Cells;
+        bool       m_IsLarge;
+        unsigned   m_QueryStamp;
+    };
+
+    CellRange GetCellRange(const ImRect& rect) const;
+    bool IsLarge(const CellRange& range) const;
+    void AddToCells(Entry& entry);
+    void RemoveFromCells(Entry& entry);
+
+    static ImU64 MakeCellKey(int x, int y);
+    static bool Touches(const ImRect& a, const ImRect& b);
+
+    float                                       m_CellSize;
+    float                                       m_InvCellSize;
+    std::unordered_map<Object*, Entry>          m_Entries;
+    std::unordered_map<ImU64, vector<Entry*>>   m_Cells;
+    vector<Entry*>                              m_LargeEntries;
+    unsigned                                    m_QueryStamp;
+};
+
+// Images of nodes rendered by application into atlas texture (see
+// Config::RenderNodeImpostor). Atlas is packed in shelves, rects of evicted
+// entries are reused by nodes of similar size. Least recently used entries
+// are evicted when atlas is full.
+struct ImpostorCache
+{
+    struct Entry
+    {
+        ImVec2   m_Offset;         // canvas space, relative to node position
+        ImVec2   m_Size;           // canvas space
+        ImVec2   m_NodeSize;
+        float    m_Scale;
+        ImRect   m_AtlasRect;      // pixels
+        ImRect   m_Slot;           // pixels, part of atlas reserved for entry
+        int      m_LastUsedFrame;
+    };
+
+    ImpostorCache();
+
+    void SetAtlasSize(int size);
+    int  GetAtlasSize() const { return m_AtlasSize; }
+
+    Entry* Find(Node* node);
+    Entry* Allocate(Node* node, const ImVec2& pixelSize, int frame);
+    void   Remove(Node* node);
+    void   Clear();
+
+    size_t GetMemoryUsage() const;
+
+    // Scratch list node geometry is copied to before it is passed to application.
+    ImDrawList m_DrawList;
+
+private:
+    struct Shelf
+    {
+        float m_Y;
+        float m_Height;
+        float m_X;
+    };
+
+    bool AllocateRect(const ImVec2& size, ImRect& result);
+    bool Evict(int frame);
+
+    int                             m_AtlasSize;
+    float                           m_NextShelfY;
+    vector<Shelf>                   m_Shelves;
+    vector<ImRect>                  m_FreeRects;
+    std::unordered_map<Node*, Entry> m_Entries;
 };
 
 struct NodeSettings
@@ -501,11 +938,37 @@ struct NodeSettings
     void MakeDirty(SaveReasonFlags reason);
 
     json::value Serialize();
+    std::string Serialize(SettingsFormat format);
 
     static bool Parse(const std::string& string, NodeSettings& settings);
     static bool Parse(const json::value& data, NodeSettings& result);
 };
 
+// Destination of serialized settings. Data is collected in m_Buffer and, when
+// write callback is set, passed on in chunks as buffer fills up.
+struct SettingsOutput
+{
+    static const size_t c_ChunkSize = 64 * 1024;
+
+    std::string         m_Buffer;
+    ConfigWriteSettings m_Write;
+    SaveReasonFlags     m_Reason;
+    void*               m_UserPointer;
+    bool                m_IsValid;     // all chunks were accepted
+
+    SettingsOutput(ConfigWriteSettings write = nullptr, SaveReasonFlags reason = SaveReasonFlags::None, void* userPointer = nullptr);
+
+    void Append(const char* data, size_t size);
+    void Append(const char* text) { Append(text, strlen(text)); }
+    void Append(std::string&& data);
+
+    // Passes rest of the data and end of stream to callback.
+    bool Finish();
+
+private:
+    void Flush();
+};
+
 struct Settings
 {
     bool                 m_IsDirty;
@@ -516,6 +979,18 @@ struct Settings
     ImVec2               m_ViewScroll;
     float                m_ViewZoom;
 
+    // Maps node id to index in m_Nodes.
+    std::unordered_map<uintptr_t, size_t> m_NodeIndices;
+
+    // Indices of nodes made dirty since last save. Entries may be
+    // already clean when node was cleared individually.
+    vector<size_t>       m_DirtyNodes;
+
+    // Node records not parsed yet, as (offset, size) ranges
+    // of m_PendingData. FindNode() parses them on first use.
+    std::string          m_PendingData;
+    std::unordered_map<uintptr_t, std::pair<size_t, size_t>> m_PendingNodes;
+
     Settings()
         : m_IsDirty(false)
         , m_DirtyReason(SaveReasonFlags::None)
@@ -530,9 +1005,115 @@ struct Settings
     void ClearDirty(Node* node = nullptr);
     void MakeDirty(SaveReasonFlags reason, Node* node = nullptr);
 
-    std::string Serialize();
+    // Drops node records for which predicate returns true.
+    template <typename Predicate>
+    void RemoveNodes(Predicate predicate);
+
+    size_t GetMemoryUsage() const;
+
+    std::string Serialize(SettingsFormat format = SettingsFormat::Json);
+    void Serialize(SettingsFormat format, SettingsOutput& output);
 
-    static bool Parse(const std::string& string, Settings& settings);
+    static bool Parse(const std::string& string, Settings& settings, bool deferNodes = false);
+
+private:
+    void SerializeJson(SettingsOutput& output);
+    void SerializeBinary(SettingsOutput& output);
+    static bool ParseBinary(const std::string& string, Settings& settings);
+};
+
+// Node bounds, selection and view captured by SaveStateSnapshot(). Snapshot
+// with base stores only nodes which differ from state restored by base, base
+// is kept alive until all snapshots depending on it are released.
+struct StateSnapshot
+{
+    std::string          m_Data;
+    const StateSnapshot* m_Base;
+    int                  m_Depth;    // number of bases up to full snapshot
+    mutable int          m_RefCount; // owner and snapshots based on this one
+
+    StateSnapshot(const StateSnapshot* base);
+    ~StateSnapshot();
+
+    static void Release(const StateSnapshot* snapshot);
+};
+
+// Kinds of records in recorded trace, see BeginTraceRecording().
+enum class TraceOp: uint8_t
+{
+    Begin,
+    End,
+    BeginNode,
+    EndNode,
+    Pin,
+    Group,
+    Link,
+    Flow,
+    SetNodePosition,
+    ClearSelection,
+    SelectNode,
+    SelectLink,
+    DeselectNode,
+    DeselectLink,
+    NavigateToContent,
+    NavigateToSelection,
+    ShowMinimap,
+    Repeat,
+    Count
+};
+
+// Input and API calls recorded by TraceRecorder. Every frame is a run of
+// records ending with TraceOp::End, incomplete frame at the end is ignored.
+// Calls made between Begin() and End() form frame body, body same as one of
+// previous frame is stored as TraceOp::Repeat.
+struct Trace
+{
+    struct Frame
+    {
+        uint32_t m_Begin;     // offset of first record
+        uint32_t m_End;       // offset past TraceOp::End
+        uint32_t m_BodyBegin; // body replayed for TraceOp::Repeat
+        uint32_t m_BodyEnd;
+    };
+
+    std::string   m_Data;
+    vector<Frame> m_Frames;
+
+    // Builds frame list, false when data is not a valid trace.
+    bool Index();
+
+    int  GetFrameCount() const { return static_cast<int>(m_Frames.size()); }
+
+    // Sets ImGui input captured by Begin() of frame, use before ImGui::NewFrame().
+    void ApplyInput(int frame, ImGuiIO& io) const;
+};
+
+// Appends calls made through public API to trace. Pins and groups are stored
+// relative to their node, so graph can be rebuilt without node content.
+struct TraceRecorder
+{
+    Trace    m_Trace;
+    uint32_t m_BodyBegin;     // of frame being recorded
+    uint32_t m_LastBodyBegin; // of last frame stored in full
+    uint32_t m_LastBodyEnd;
+
+    TraceRecorder();
+
+    void Begin(const char* id, const ImVec2& size, const ImGuiIO& io);
+    void End();
+    void BeginNode(NodeId id);
+    void EndNode(const Node* node);
+    void EndPin(const Pin* pin);
+    void Group(const Node* node, const ImRect& bounds);
+    void Link(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness);
+    void Flow(LinkId id);
+    void SetNodePosition(NodeId id, const ImVec2& position);
+    void Select(TraceOp op, ObjectId id = ObjectId(), bool append = false);
+    void Navigate(TraceOp op, bool zoomIn, float duration);
+    void ShowMinimap(const ImVec2& size, MinimapLocation location);
+
+    // Completes recording, frame in progress is dropped.
+    Trace* Finish();
 };
 
 struct Control
@@ -638,6 +1219,7 @@ struct Animation
     State           m_State;
     float           m_Time;
     float           m_Duration;
+    int             m_LiveIndex; // Position in EditorContext::m_LiveAnimations, -1 when not registered
 
     Animation(EditorContext* editor);
     virtual ~Animation();
@@ -675,6 +1257,14 @@ private:
     void OnFinish() override final;
 };
 
+// Vertices and indices of a single flow marker, replayed for the rest of
+// markers of a flow. Indices are relative to the first vertex.
+struct FlowMarkerGeometry
+{
+    ImVector<ImDrawVert> Vertices;
+    ImVector<ImDrawIdx>  Indices;
+};
+
 struct FlowAnimation final: Animation
 {
     FlowAnimationController* Controller;
@@ -682,33 +1272,29 @@ struct FlowAnimation final: Animation
     float m_Speed;
     float m_MarkerDistance;
     float m_Offset;
+    int   m_ListIndex; // Position in live or free list of controller, -1 when in none
 
     FlowAnimation(FlowAnimationController* controller);
 
     void Flow(Link* link, float markerDistance, float speed, float duration);
 
     void Draw(ImDrawList* drawList);
+    void DrawMarkers(ImDrawList* drawList, FlowMarkerGeometry& geometry);
 
-private:
-    struct CurvePoint
-    {
-        float  Distance;
-        ImVec2 Point;
-    };
+    void ClearPath();
+    size_t GetPathMemoryUsage() const { return HeapSize(m_Path.Lengths); }
 
+private:
     ImVec2 m_LastStart;
     ImVec2 m_LastEnd;
-    float  m_PathLength;
-    vector<CurvePoint> m_Path;
+    ImCubicBezierArcLengthTable m_Path;
 
     bool IsLinkValid() const;
     bool IsPathValid() const;
     void UpdatePath();
-    void ClearPath();
-
-    ImVec2 SamplePath(float distance);
 
     void OnUpdate(float progress) override final;
+    void OnPlay() override final;
     void OnStop() override final;
 };
 
@@ -740,13 +1326,27 @@ struct FlowAnimationController final : AnimationController
 
     virtual void Draw(ImDrawList* drawList) override final;
 
+    void Activate(FlowAnimation* animation);
     void Release(FlowAnimation* animation);
 
+    // Releases paths of stopped animations and marker geometry. Stopped
+    // animations at the end of the pool are released too.
+    void ClearFreeMemory();
+    size_t GetMemoryUsage() const;
+
 private:
     FlowAnimation* GetOrCreate(Link* link);
 
-    vector<FlowAnimation*> m_Animations;
-    vector<FlowAnimation*> m_FreePool;
+    static void AddToList(vector<FlowAnimation*>& list, FlowAnimation* animation);
+    static void RemoveFromList(vector<FlowAnimation*>& list, FlowAnimation* animation);
+
+    // Animations are allocated in blocks and never move, links and lists
+    // refer to them by pointer. Every animation is either playing and is in
+    // live list, or is stopped and is in free list.
+    std::deque<FlowAnimation> m_Pool;
+    vector<FlowAnimation*>    m_LiveFlows;
+    vector<FlowAnimation*>    m_FreeFlows;
+    FlowMarkerGeometry        m_MarkerGeometry;
 };
 
 struct EditorAction
@@ -816,6 +1416,7 @@ struct NavigateAction final: EditorAction
     void NavigateTo(const ImRect& bounds, bool zoomIn, float duration = -1.0f, NavigationReason reason = NavigationReason::Unknown);
     void StopNavigation();
     void FinishNavigation();
+    bool IsNavigating() const { return m_Animation.IsPlaying(); }
 
     bool MoveOverEdge();
     void StopMoveOverEdge();
@@ -831,6 +1432,9 @@ struct NavigateAction final: EditorAction
     void SetViewRect(const ImRect& rect);
     ImRect GetViewRect() const;
 
+    // Moves view to be centered over point, zoom is kept.
+    void CenterView(const ImVec2& canvasPoint);
+
 private:
     ImGuiEx::Canvas&   m_Canvas;
     ImVec2 m_WindowScreenPos;
@@ -925,6 +1529,11 @@ struct SelectAction final: EditorAction
     vector<Object*> m_CandidateObjects;
     vector<Object*> m_SelectedObjectsAtStart;
 
+    ImRect          m_CandidateRect;        // rect candidates were evaluated against
+    uint64_t        m_CandidateGeneration;
+    vector<Node*>   m_QueryNodes;
+    vector<Link*>   m_QueryLinks;
+
     Animation       m_Animation;
 
     SelectAction(EditorContext* editor);
@@ -941,6 +1550,15 @@ struct SelectAction final: EditorAction
     virtual SelectAction* AsSelect() override final { return this; }
 
     void Draw(ImDrawList* drawList);
+
+    // Candidate lists are released only while selection is not in progress.
+    void ClearFreeMemory();
+    size_t GetMemoryUsage() const;
+
+private:
+    void ResetCandidates();
+    void UpdateCandidates(const ImRect& rect);
+    bool UpdateCandidate(Object* object, const ImRect& rect);
 };
 
 struct ContextMenuAction final: EditorAction
@@ -1110,12 +1728,23 @@ struct DeleteItemsAction final: EditorAction
     bool AcceptItem();
     void RejectItem();
 
+    // Items not accepted nor rejected yet, removed ones are null.
+    const vector<Object*>& GetPendingItems() const { return m_CandidateObjects; }
+    bool IsInInteraction() const { return m_InInteraction; }
+
+    void AcceptItems();
+    void RejectItems();
+
+    void ClearFreeMemory();
+    size_t GetMemoryUsage() const;
+
 private:
     enum IteratorType { Unknown, Link, Node };
     enum UserAction { Undetermined, Accepted, Rejected };
 
     bool QueryItem(ObjectId* itemId, IteratorType itemType);
-    void RemoveItem();
+    void RemoveItem(int index);
+    void CompactItems();
 
     vector<Object*> m_ManuallyDeletedObjects;
 
@@ -1123,6 +1752,7 @@ private:
     UserAction      m_UserAction;
     vector<Object*> m_CandidateObjects;
     int             m_CandidateItemIndex;
+    vector<Object*> m_RemovedObjects;
 };
 
 struct NodeBuilder
@@ -1144,16 +1774,25 @@ struct NodeBuilder
     ImRect m_GroupBounds;
     bool   m_IsGroup;
 
+    Pin*   m_ImpostorLastPin;
+    ImRect m_LastPinBounds;
+    Pin::GeometryKey m_LastPinGeometry;
+
     ImDrawListSplitter m_Splitter;
     ImDrawListSplitter m_PinSplitter;
 
     NodeBuilder(EditorContext* editor);
     ~NodeBuilder();
 
+    void ClearFreeMemory();
+    size_t GetMemoryUsage() const;
+
     void Begin(NodeId nodeId);
+    void Begin(Node* node);
     void End();
 
     void BeginPin(PinId pinId, PinKind kind);
+    void BeginPin(Pin* pin, PinKind kind);
     void EndPin();
 
     void PinRect(const ImVec2& a, const ImVec2& b);
@@ -1200,6 +1839,10 @@ struct Style: ax::NodeEditor::Style
 
     const char* GetColorName(StyleColor colorIndex) const;
 
+    // Changes on every push and pop, used to invalidate values derived from style.
+    int GetGeneration() const { return m_Generation; }
+    void Invalidate() { ++m_Generation; }
+
 private:
     struct ColorModifier
     {
@@ -1219,19 +1862,162 @@ private:
 
     vector<ColorModifier>   m_ColorStack;
     vector<VarModifier>     m_VarStack;
+    int                     m_Generation = 0;
 };
 
+struct SettingsWriter;
+
 struct Config: ax::NodeEditor::Config
 {
     Config(const ax::NodeEditor::Config* config);
+    ~Config();
 
     std::string Load();
     std::string LoadNode(NodeId nodeId);
 
     void BeginSave();
-    bool Save(const std::string& data, SaveReasonFlags flags);
+    bool Save(Settings& settings, SaveReasonFlags flags);
     bool SaveNode(NodeId nodeId, const std::string& data, SaveReasonFlags flags);
+    bool SaveNodes(const vector<NodeSettingsChange>& changes);
     void EndSave();
+
+    // Blocks until settings posted to background writer are on disk.
+    void Flush();
+
+    // Reasons of settings which background writer failed to write since last
+    // call, None when all writes succeeded.
+    SaveReasonFlags TakeSaveFailure();
+    bool IsSaving() const; // Background writer has data not written yet.
+
+private:
+    std::unique_ptr<SettingsWriter> m_Writer;
+};
+
+// Collects time spent in phases of a frame and keeps last FrameStats::SampleCount
+// frames of them. Compiles to nothing unless IMGUI_NODE_EDITOR_PROFILER() is set.
+struct FrameProfiler
+{
+# if IMGUI_NODE_EDITOR_PROFILER()
+    using Clock     = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+    static const int c_PhaseCount = static_cast<int>(FramePhase::Count);
+
+    float     m_Samples[c_PhaseCount][FrameStats::SampleCount];
+    float     m_Current[c_PhaseCount];
+    int       m_SampleCount;
+    int       m_NextSample;
+    TimePoint m_FrameStart;
+
+    FrameProfiler();
+
+    static TimePoint Now() { return Clock::now(); }
+    static float Elapsed(TimePoint start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); }
+
+    void BeginFrame();
+    void EndFrame();
+    void Add(FramePhase phase, float milliseconds) { m_Current[static_cast<int>(phase)] += milliseconds; }
+
+    struct Scope
+    {
+        Scope(FrameProfiler& profiler, FramePhase phase): m_Profiler(profiler), m_Phase(phase), m_Start(Now()) {}
+        ~Scope() { m_Profiler.Add(m_Phase, Elapsed(m_Start)); }
+
+        FrameProfiler& m_Profiler;
+        FramePhase     m_Phase;
+        TimePoint      m_Start;
+    };
+# else
+    void BeginFrame() {}
+    void EndFrame() {}
+
+    struct Scope
+    {
+        Scope(FrameProfiler&, FramePhase) {}
+    };
+# endif
+
+    FramePhaseTiming GetTiming(FramePhase phase) const;
+};
+
+// Drawing and interaction settings traded for frame time, one set per
+// QualityGovernor level.
+struct QualityLevel
+{
+    float TessellationScale;    // Multiplies curve tessellation tolerance.
+    int   FlowMarkerStride;     // Every n-th flow marker is drawn.
+    int   HoverInterval;        // Frames hover hit-test is reused while only mouse moves.
+    float LodReducedZoom;       // Raise Style thresholds, never lower them.
+    float LodOverviewZoom;
+};
+
+// Watches time spent in End() against Config::FrameBudget. Quality steps
+// down after End() stays over budget for a number of frames and steps back
+// up only after it stays well under, so it does not flip every frame.
+struct QualityGovernor
+{
+    using Clock = std::chrono::steady_clock;
+
+    QualityGovernor();
+
+    void BeginFrame() { m_FrameStart = Clock::now(); }
+    void EndFrame(float budget);
+
+    int   GetLevel() const { return m_Level; }
+    float GetFrameTime() const { return m_FrameTime; }
+    const QualityLevel& GetQuality() const;
+
+private:
+    int               m_Level;
+    float             m_FrameTime;
+    int               m_OverBudgetFrames;
+    int               m_UnderBudgetFrames;
+    Clock::time_point m_FrameStart;
+};
+
+// Nodes and their connections copied out of editor for layout worker, which
+// never touches editor itself. Edges refer to indices of nodes.
+struct LayoutGraph
+{
+    vector<NodeId>              m_Nodes;
+    vector<ImVec2>              m_Positions; // top left corners, current on input, computed on output
+    vector<ImVec2>              m_Sizes;
+    vector<std::pair<int, int>> m_Edges;     // from node of start pin to node of end pin
+};
+
+struct LayoutJob;
+
+// Runs layout on worker thread and moves nodes to computed positions over
+// following frames, see AutoLayout().
+struct LayoutEngine
+{
+    LayoutEngine();
+    ~LayoutEngine();
+
+    void Start(LayoutGraph graph, const LayoutConfig& config);
+    void Cancel();
+
+    // Applies next batch of finished layout and moves animated nodes.
+    void Update(EditorContext* editor);
+
+    bool IsRunning() const { return m_Job || m_NextNode < static_cast<int>(m_Result.m_Nodes.size()) || !m_Moves.empty(); }
+
+private:
+    struct Move
+    {
+        NodeId m_ID;
+        ImVec2 m_From;
+        ImVec2 m_To;
+        float  m_Time;
+    };
+
+    LayoutConfig               m_Config;
+    std::unique_ptr<LayoutJob> m_Job;
+    LayoutGraph                m_Result;
+    int                        m_NextNode; // first node of result not moved yet
+    vector<Move>               m_Moves;
+    vector<NodeId>             m_BatchNodes;
+    vector<ImVec2>             m_BatchPositions;
 };
 
 enum class SuspendFlags : uint8_t
@@ -1251,10 +2037,16 @@ struct EditorContext
 
     Style& GetStyle() { return m_Style; }
 
+    // Current QualityGovernor settings, full quality unless Config::FrameBudget is set.
+    const QualityLevel& GetQuality() const { return m_Governor.GetQuality(); }
+    float GetLodReducedZoom() const { return ImMax(m_Style.LodReducedZoom, GetQuality().LodReducedZoom); }
+    float GetLodOverviewZoom() const { return ImMax(m_Style.LodOverviewZoom, GetQuality().LodOverviewZoom); }
+
     void Begin(const char* id, const ImVec2& size = ImVec2(0, 0));
     void End();
 
     bool DoLink(LinkId id, PinId startPinId, PinId endPinId, ImU32 color, float thickness);
+    bool DoLink(Link* link, Pin* startPin, Pin* endPin, ImU32 color, float thickness);
 
 
     NodeBuilder& GetNodeBuilder() { return m_NodeBuilder; }
@@ -1271,16 +2063,63 @@ struct EditorContext
     const ImRect& GetViewRect() const { return m_Canvas.ViewRect(); }
     const ImRect& GetRect() const { return m_Canvas.Rect(); }
 
+    LevelOfDetail GetLOD() const { return m_LOD; }
+
+    bool NeedsRedraw() const { return m_NeedsRedraw; }
+    float GetNextWakeupTime() const;
+
+    // Releases render and scratch buffers and compacts object maps, see
+    // HibernateEditor(). Next Begin() wakes editor up, buffers grow back as
+    // they are used. Must not be called between Begin() and End().
+    void Hibernate();
+    bool IsHibernated() const { return m_IsHibernated; }
+
+    // Returns buffers grown by large graphs to size needed by current one
+    // and drops settings of deleted nodes, see TrimMemory(). Must not be
+    // called between Begin() and End().
+    void TrimMemory();
+    MemoryStats GetMemoryStats() const;
+
+    StateSnapshot* SaveStateSnapshot(const StateSnapshot* base);
+    void RestoreStateSnapshot(const StateSnapshot* snapshot);
+
+    // See BeginTraceRecording(). Recorder is null when editor does not record.
+    void BeginTraceRecording();
+    Trace* EndTraceRecording();
+    TraceRecorder* GetTraceRecorder() const { return m_TraceRecorder.get(); }
+    // Replays calls recorded in frame, including Begin() and End().
+    void ReplayTrace(const Trace& trace, int frame);
+
     void SetNodePosition(NodeId nodeId, const ImVec2& screenPosition);
     ImVec2 GetNodePosition(NodeId nodeId);
     ImVec2 GetNodeSize(NodeId nodeId);
 
+    void SetNodePositions(const NodeId* nodeIds, const ImVec2* positions, int count);
+    void GetNodeBounds(const NodeId* nodeIds, ImVec2* positions, ImVec2* sizes, int count);
+
+    // See AutoLayout().
+    void AutoLayout(const LayoutConfig& config);
+    bool IsAutoLayoutRunning() const { return m_Layout.IsRunning(); }
+    void CancelAutoLayout() { m_Layout.Cancel(); }
+
     void MarkNodeToRestoreState(Node* node);
     void RestoreNodeState(Node* node);
+    void ApplyNodeSettings(Node* node, const NodeSettings& settings);
+
+    bool IsNodeVisible(NodeId nodeId);
+    void ForgetNode(Node* node);
+
+    void InvalidateNodeImpostor(Node* node) { m_Impostors.Remove(node); }
+    void InvalidateNodeImpostors() { m_Impostors.Clear(); }
+    bool DrawNodeImpostor(ImDrawList* drawList, Node* node);
+
+    void SetObjectSelected(Object* object, bool selected);
+    void CommitSelectionChanges();
 
     void ClearSelection();
     void SelectObject(Object* object);
     void DeselectObject(Object* object);
+    void DeselectObjects(const vector<Object*>& objects);
     void SetSelectedObject(Object* object);
     void ToggleObjectSelection(Object* object);
     bool IsSelected(Object* object);
@@ -1295,6 +2134,7 @@ struct EditorContext
     void FindLinksInRect(const ImRect& r, vector<Link*>& result, bool append = false);
 
     void FindLinksForNode(NodeId nodeId, vector<Link*>& result, bool add = false);
+    void FindLinksForPin(PinId pinId, vector<Link*>& result, bool add = false);
 
     bool PinHadAnyLinks(PinId pinId);
 
@@ -1302,6 +2142,37 @@ struct EditorContext
     ImVec2 ToScreen(const ImVec2& point) const { return m_Canvas.FromLocal(point); }
 
     void NotifyLinkDeleted(Link* link);
+    void NotifyNodeBoundsChanged(Node* node);
+    void NotifyContentBoundsChanged(const Node* node, const ImRect* lastBounds);
+    void NotifyNodeOrderChanged() { m_IsNodeOrderDirty = true; m_IsNodeStateOrderDirty = true; }
+    void NotifyNodeTypeChanged(Node* node);
+    void NotifyGroupBoundsChanged(Node* node) { node->m_IsGroupedNodesDirty = true; }
+
+    // Rounding too small to be seen at current zoom is dropped, corners
+    // would cost vertices without changing a pixel.
+    float GetVisibleRounding(float rounding) const;
+
+    // Dragged nodes move every frame, they leave spatial index and skip
+    // group membership updates until dropped. Queries test them directly.
+    void BeginNodeDrag(Node* node);
+    void EndNodeDrags();
+
+    // Appends nodes within group, nested groups are expanded. Every node is
+    // reported once, in z-order.
+    void GetGroupedNodes(Node* group, vector<Node*>& result);
+
+    // Invalidates results of hit-tests done in previous frames.
+    void NotifyGeometryChanged() { ++m_GeometryGeneration; }
+    uint64_t GetGeometryGeneration() const { return m_GeometryGeneration; }
+
+    // Timings and draw counts of recent frames, see FrameProfiler.
+    FrameStats GetFrameStats() const;
+    // Node, pin and link may share id value, type is hashed too.
+    void NotifyObjectSubmitted(ObjectId id)
+    {
+        m_SubmitHash = (m_SubmitHash ^ static_cast<uint64_t>(id.Type())) * 1099511628211ull;
+        m_SubmitHash = (m_SubmitHash ^ reinterpret_cast<uintptr_t>(id.AsPointer())) * 1099511628211ull;
+    }
 
     void Suspend(SuspendFlags flags = SuspendFlags::None);
     void Resume(SuspendFlags flags = SuspendFlags::None);
@@ -1325,15 +2196,33 @@ struct EditorContext
     Pin*   GetPin(PinId id, PinKind kind);
     Link*  GetLink(LinkId id);
 
+    // Objects created to be referenced by handle are not live until submitted.
+    NodeHandle AcquireNode(NodeId id);
+    PinHandle  AcquirePin(PinId id);
+    LinkHandle AcquireLink(LinkId id);
+
+    // Object referenced by handle, null when handle is stale. Objects are
+    // never freed, so pointer in handle is safe to dereference.
+    template <typename T, typename Id>
+    T* FromHandle(const ObjectHandle<Id>& handle) const
+    {
+        auto object = static_cast<T*>(handle.Object);
+        IM_ASSERT(!object || object->Editor == this);
+        return object && object->m_Generation == handle.Generation ? object : nullptr;
+    }
+
     Link* FindLinkAt(const ImVec2& p);
 
+    // Fills m_QueryResult with nodes which bounds may touch the rect.
+    void QueryNodes(const ImRect& rect);
+
     template <typename T>
     ImRect GetBounds(const std::vector<T*>& objects)
     {
         ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
 
         for (auto object : objects)
-            if (object->m_IsLive)
+            if (object->IsLive())
                 bounds.Add(object->GetBounds());
 
         if (ImRect_IsEmpty(bounds))
@@ -1348,7 +2237,7 @@ struct EditorContext
         ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
 
         for (auto object : objects)
-            if (object.m_Object->m_IsLive)
+            if (object.m_Object->IsLive())
                 bounds.Add(object.m_Object->GetBounds());
 
         if (ImRect_IsEmpty(bounds))
@@ -1357,14 +2246,17 @@ struct EditorContext
         return bounds;
     }
 
-    ImRect GetSelectionBounds() { return GetBounds(m_SelectedObjects); }
-    ImRect GetContentBounds() { return GetBounds(m_Nodes); }
+    // Both are cached, see m_ContentBounds and m_SelectionBounds.
+    ImRect GetSelectionBounds();
+    ImRect GetContentBounds();
 
     ImU32 GetColor(StyleColor colorIndex) const;
     ImU32 GetColor(StyleColor colorIndex, float alpha) const;
 
     void NavigateTo(const ImRect& bounds, bool zoomIn = false, float duration = -1) { m_NavigateAction.NavigateTo(bounds, zoomIn, duration); }
 
+    void ShowMinimap(const ImVec2& size, MinimapLocation location);
+
     void RegisterAnimation(Animation* animation);
     void UnregisterAnimation(Animation* animation);
 
@@ -1402,31 +2294,183 @@ private:
 
     void ShowMetrics(const Control& control);
 
+    bool HadInput() const;
+
     void UpdateAnimations();
 
+    void UpdateNodeOrder();
+    void SortObjects();
+    void UpdateNodeStateOrder();
+
+    bool RenderImpostors(ImDrawList* drawList);
+    bool RenderImpostor(ImDrawList* drawList, Node* node);
+
+    // Tessellates visible links without cached geometry on Config::ParallelFor.
+    void BuildLinkGeometry(ImDrawList* drawList);
+
+    void DrawMinimap(ImDrawList* drawList);
+
+    // Object under mouse cursor found by BuildControl(). Stays valid while
+    // mouse and geometry do not change.
+    struct HoverCache
+    {
+        bool       m_IsValid;
+        uint64_t   m_Generation;
+        ImVec2     m_MousePos;
+        Object*    m_HitObject;
+        NodeRegion m_HitRegion;
+        bool       m_HasHotLink;
+        Link*      m_HotLink;
+        int        m_FrameIndex;    // frame hit-test was done in
+    };
+
+    // Overview requested by ShowMinimap(). Node rects are kept as vertices
+    // relative to minimap corner, four per node state. Only rects of nodes
+    // which bounds changed are rewritten, all of them when content bounds
+    // or minimap size change.
+    struct MinimapCache
+    {
+        struct Key
+        {
+            ImRect m_Content;           // canvas space
+            ImVec2 m_Size;
+            ImU32  m_NodeColor;
+            ImU32  m_GroupColor;
+            ImVec2 m_TexUvWhitePixel;
+        };
+
+        bool               m_IsShown;   // ShowMinimap() was called this frame
+        bool               m_IsHovered; // or active
+        bool               m_IsDirty;   // order of node states changed
+        bool               m_HasKey;
+        ImRect             m_Rect;      // screen space
+        Key                m_Key;
+        ImVec2             m_Offset;    // of m_Key.m_Content.Min, relative to m_Rect.Min
+        float              m_Scale;
+        uint64_t           m_Generation;
+        vector<ImRect>     m_Bounds;    // canvas space, parallel to m_NodeStates
+        vector<ImDrawVert> m_Vertices;
+    };
+
     bool                m_IsFirstFrame;
     bool                m_IsWindowActive;
+    bool                m_IsHibernated;
 
     bool                m_ShortcutsEnabled;
 
     Style               m_Style;
+    mutable ImU32       m_StyleColors[StyleColor_Count]; // Packed m_Style.Colors, see GetColor().
+    mutable int         m_StyleColorsGeneration;
 
     vector<ObjectWrapper<Node>> m_Nodes;
     vector<ObjectWrapper<Pin>>  m_Pins;
     vector<ObjectWrapper<Link>> m_Links;
 
+    ObjectPool<Node>    m_NodePool;
+    ObjectPool<Pin>     m_PinPool;
+    ObjectPool<Link>    m_LinkPool;
+    ObjectStates        m_NodeStates;
+    ObjectStates        m_PinStates;
+    ObjectStates        m_LinkStates;
+    ObjectMap<Node>     m_NodeMap;
+    ObjectMap<Pin>      m_PinMap;
+    ObjectMap<Link>     m_LinkMap;
+    bool                m_IsPinOrderDirty;
+    bool                m_IsLinkOrderDirty;
+
+    SpatialIndex        m_NodeIndex;
+    SpatialIndex        m_LinkIndex;
+    vector<Object*>     m_QueryResult;
+    vector<Link*>       m_QueryLinks;
+    vector<ImCubicBezierPoints> m_QueryCurves;
+    vector<ImProjectResult> m_QueryProjections;
+    vector<Link*>       m_StaleLinks;
+
+    // Links built by BuildLinkGeometry() are split into chunks, each one has
+    // its own scratch list and output. Workers never allocate through ImGui.
+    struct LinkGeometryChunk
+    {
+        std::unique_ptr<ImDrawList> m_Scratch;
+        vector<ImDrawVert>          m_Vertices;
+        vector<ImDrawIdx>           m_Indices;
+    };
+
+    // Where geometry of stale link landed in its chunk, vertex count is -1
+    // when link could not be cached.
+    struct LinkGeometryRange
+    {
+        int m_Chunk;
+        int m_FirstVertex;
+        int m_VertexCount;
+        int m_FirstIndex;
+        int m_IndexCount;
+    };
+
+    vector<LinkGeometryChunk> m_LinkGeometryChunks;
+    vector<LinkGeometryRange> m_LinkGeometryRanges;
+    bool                m_IsNodeOrderDirty;
+    bool                m_IsNodeStateOrderDirty;
+    bool                m_IsNodeLayerDirty;
+    vector<Node*>       m_Groups;
+    unsigned            m_GroupedStamp;
+    vector<Node*>       m_DraggedNodes;
+
+    // Union of live node bounds. Grows with nodes moving out of it and is
+    // rebuilt on query after node on its edge moved inward or set of live
+    // nodes changed. Rebuild done before End() sees set of live nodes from
+    // the middle of submission, so it's dropped there.
+    ImRect              m_ContentBounds;
+    bool                m_IsContentBoundsValid;
+    int                 m_ContentBoundsFrame;
+
+    // Bounds of selected objects, valid until selection or geometry changes.
+    ImRect              m_SelectionBounds;
+    bool                m_IsSelectionBoundsValid;
+    int                 m_SelectionBoundsFrame;
+    uint64_t            m_SelectionBoundsGeneration;
+
     vector<Object*>     m_SelectedObjects;
 
-    vector<Object*>     m_LastSelectedObjects;
+    vector<Object*>     m_SelectionChangedObjects;
+    int                 m_SelectionChangeCount;
     uint64_t            m_SelectionId;
 
     Link*               m_LastActiveLink;
+    Object*             m_LastActiveObject;
+    NodeRegion          m_LastActiveRegion;
+
+    uint64_t            m_GeometryGeneration;
+    uint64_t            m_SubmitHash;
+    uint64_t            m_LastSubmitHash;
+    ImRect              m_LastViewRect;
+    HoverCache          m_HoverCache;
+    MinimapCache        m_Minimap;
+
+    FrameProfiler       m_Profiler;
+    QualityGovernor     m_Governor;
+    LayoutEngine        m_Layout;
+    std::unique_ptr<TraceRecorder> m_TraceRecorder;
+    int                 m_FrameFirstVertex;
+    int                 m_FrameFirstIndex;
+    int                 m_FrameFirstCommand;
+    FrameStats          m_FrameStats;
+
+    bool                m_NeedsRedraw;
+    uint64_t            m_LastFrameGeneration;
+    Object*             m_LastHotObject;
 
     vector<Animation*>  m_LiveAnimations;
     vector<Animation*>  m_LastLiveAnimations;
 
     ImGuiEx::Canvas     m_Canvas;
     bool                m_IsCanvasVisible;
+    LevelOfDetail       m_LOD;
+
+    ImpostorCache       m_Impostors;
+    bool                m_UseImpostors;
+    bool                m_RenderImpostors;
+    float               m_LastZoom;
+    int                 m_FrameIndex; // incremented by every Begin()
 
     NodeBuilder         m_NodeBuilder;
     HintBuilder         m_HintBuilder;
@@ -1456,6 +2500,7 @@ private:
     Config              m_Config;
 
     int                 m_ExternalChannel;
+    vector<int>         m_DrawOrder;
     ImDrawListSplitter  m_Splitter;
 };
 
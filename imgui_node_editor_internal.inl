@@ -45,6 +45,293 @@ inline ImRect ImGui_GetItemRect()
 }
 
 
+//------------------------------------------------------------------------------
+template <typename T, typename Id>
+inline T* ObjectMap<T, Id>::Find(Id id) const
+{
+    if (m_Slots.empty())
+        return nullptr;
+
+    const auto key  = id.Get();
+    const auto mask = m_Slots.size() - 1;
+
+    for (auto index = Hash(key) & mask; ; index = (index + 1) & mask)
+    {
+        auto& slot = m_Slots[index];
+        if (!slot.m_Object)
+            return nullptr;
+        if (slot.m_Key == key)
+            return slot.m_Object;
+    }
+}
+
+template <typename T, typename Id>
+inline void ObjectMap<T, Id>::Insert(Id id, T* object)
+{
+    IM_ASSERT(object != nullptr);
+
+    // Keep load factor below 1/2, probe sequences stay short.
+    if ((m_Count + 1) * 2 > m_Slots.size())
+        Rehash(ImMax<size_t>(16, m_Slots.size() * 2));
+
+    const auto key  = id.Get();
+    const auto mask = m_Slots.size() - 1;
+
+    for (auto index = Hash(key) & mask; ; index = (index + 1) & mask)
+    {
+        auto& slot = m_Slots[index];
+        if (!slot.m_Object)
+        {
+            slot.m_Key    = key;
+            slot.m_Object = object;
+            ++m_Count;
+            return;
+        }
+
+        if (slot.m_Key == key)
+        {
+            slot.m_Object = object;
+            return;
+        }
+    }
+}
+
+template <typename T, typename Id>
+inline bool ObjectMap<T, Id>::Remove(Id id)
+{
+    if (m_Slots.empty())
+        return false;
+
+    const auto key  = id.Get();
+    const auto mask = m_Slots.size() - 1;
+
+    auto index = Hash(key) & mask;
+    while (m_Slots[index].m_Key != key || !m_Slots[index].m_Object)
+    {
+        if (!m_Slots[index].m_Object)
+            return false;
+        index = (index + 1) & mask;
+    }
+
+    // Backward shift deletion, no tombstones are left behind.
+    auto hole = index;
+    for (auto next = (hole + 1) & mask; m_Slots[next].m_Object; next = (next + 1) & mask)
+    {
+        const auto home = Hash(m_Slots[next].m_Key) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_Slots[hole] = m_Slots[next];
+            hole = next;
+        }
+    }
+
+    m_Slots[hole].m_Object = nullptr;
+    --m_Count;
+
+    return true;
+}
+
+template <typename T, typename Id>
+inline void ObjectMap<T, Id>::Reserve(size_t count)
+{
+    size_t capacity = 16;
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    if (capacity > m_Slots.size())
+        Rehash(capacity);
+}
+
+template <typename T, typename Id>
+inline void ObjectMap<T, Id>::Clear()
+{
+    m_Slots.clear();
+    m_Count = 0;
+}
+
+template <typename T, typename Id>
+inline void ObjectMap<T, Id>::Compact()
+{
+    if (m_Count == 0)
+    {
+        vector<Slot>().swap(m_Slots);
+        return;
+    }
+
+    size_t capacity = 16;
+    while (capacity < m_Count * 2)
+        capacity *= 2;
+
+    if (capacity < m_Slots.size())
+        Rehash(capacity);
+}
+
+template <typename T, typename Id>
+inline size_t ObjectMap<T, Id>::Hash(uintptr_t key)
+{
+    // Ids are often small consecutive integers or aligned pointers,
+    // mix bits so both spread well over the table.
+    auto x = static_cast<ImU64>(key);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+
+template <typename T, typename Id>
+inline void ObjectMap<T, Id>::Rehash(size_t capacity)
+{
+    IM_ASSERT((capacity & (capacity - 1)) == 0);
+
+    vector<Slot> slots(capacity, Slot{ 0, nullptr });
+    slots.swap(m_Slots);
+    m_Count = 0;
+
+    for (auto& slot : slots)
+        if (slot.m_Object)
+            Insert(Id(slot.m_Key), slot.m_Object);
+}
+
+
+//------------------------------------------------------------------------------
+template <typename Predicate>
+inline void Settings::RemoveNodes(Predicate predicate)
+{
+    // Records keep their order, indices of the rest are remapped.
+    const auto c_Removed = static_cast<size_t>(-1);
+
+    vector<size_t> remap(m_Nodes.size(), c_Removed);
+
+    size_t count = 0;
+    for (size_t i = 0; i < m_Nodes.size(); ++i)
+    {
+        if (predicate(static_cast<const NodeSettings&>(m_Nodes[i])))
+        {
+            m_NodeIndices.erase(m_Nodes[i].m_ID.Get());
+            continue;
+        }
+
+        if (count != i)
+            m_Nodes[count] = m_Nodes[i];
+        remap[i] = count++;
+    }
+
+    if (count == m_Nodes.size())
+        return;
+
+    m_Nodes.erase(m_Nodes.begin() + count, m_Nodes.end());
+    m_Nodes.shrink_to_fit();
+
+    for (auto& entry : m_NodeIndices)
+        entry.second = remap[entry.second];
+
+    size_t dirtyCount = 0;
+    for (auto index : m_DirtyNodes)
+        if (remap[index] != c_Removed)
+            m_DirtyNodes[dirtyCount++] = remap[index];
+    m_DirtyNodes.resize(dirtyCount);
+}
+
+
+//------------------------------------------------------------------------------
+template <typename T, int BlockSize>
+template <typename... Args>
+inline T* ObjectPool<T, BlockSize>::Create(Args&&... args)
+{
+    if (m_UsedInLastBlock == BlockSize)
+    {
+        m_Blocks.emplace_back(new Slot[BlockSize]);
+        m_UsedInLastBlock = 0;
+    }
+
+    auto slot = &m_Blocks.back()[m_UsedInLastBlock++];
+    auto object = new (&slot->m_Storage) T(std::forward<Args>(args)...);
+    ++m_Count;
+
+    return object;
+}
+
+template <typename T, int BlockSize>
+inline void ObjectPool<T, BlockSize>::Clear()
+{
+    for (size_t i = 0; i < m_Blocks.size(); ++i)
+    {
+        auto block = m_Blocks[i].get();
+        auto used  = i + 1 < m_Blocks.size() ? BlockSize : m_UsedInLastBlock;
+        for (int j = 0; j < used; ++j)
+            reinterpret_cast<T*>(&block[j].m_Storage)->~T();
+    }
+
+    m_Blocks.clear();
+    m_UsedInLastBlock = BlockSize;
+    m_Count           = 0;
+}
+
+
+//------------------------------------------------------------------------------
+inline void ObjectStates::Add(Object* object, bool isLive)
+{
+    object->m_States     = this;
+    object->m_StateIndex = Size();
+
+    m_IsLive.push_back(isLive ? 1 : 0);
+    m_IsVisible.push_back(0);
+    m_Bounds.push_back(ImRect());
+}
+
+inline void ObjectStates::ResetLive()
+{
+    if (!m_IsLive.empty())
+        memset(m_IsLive.data(), 0, m_IsLive.size());
+}
+
+inline void ObjectStates::ShrinkToFit()
+{
+    m_IsLive.shrink_to_fit();
+    m_IsVisible.shrink_to_fit();
+    m_Bounds.shrink_to_fit();
+}
+
+inline void ObjectStates::Cull(const ImRect& rect)
+{
+    const auto count   = m_IsLive.size();
+    const auto isLive  = m_IsLive.data();
+    const auto bounds  = m_Bounds.data();
+    auto       visible = m_IsVisible.data();
+
+    // Plain loop without branches, compiler is free to vectorize it.
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& b = bounds[i];
+        visible[i] = isLive[i]
+            & static_cast<ImU8>(b.Min.y < rect.Max.y)
+            & static_cast<ImU8>(b.Max.y > rect.Min.y)
+            & static_cast<ImU8>(b.Min.x < rect.Max.x)
+            & static_cast<ImU8>(b.Max.x > rect.Min.x);
+    }
+}
+
+template <typename T>
+inline void ObjectStates::Reorder(const vector<ObjectWrapper<T>>& objects)
+{
+    IM_ASSERT(static_cast<int>(objects.size()) == Size());
+
+    vector<ImU8>   isLive(objects.size());
+    vector<ImRect> bounds(objects.size());
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        auto object = objects[i].m_Object;
+        isLive[i] = m_IsLive[object->m_StateIndex];
+        bounds[i] = m_Bounds[object->m_StateIndex];
+        object->m_StateIndex = static_cast<int>(i);
+    }
+
+    m_IsLive.swap(isLive);
+    m_Bounds.swap(bounds);
+}
+
+
 //------------------------------------------------------------------------------
 } // namespace Detail
 } // namespace Editor
@@ -8,6 +8,7 @@ endif()
 #add_subdirectory(${_imgui_node_editor_SourceDir} ${_imgui_node_editor_BinaryDir})
 
 find_package(imgui REQUIRED)
+find_package(Threads REQUIRED)
 
 set(_imgui_node_editor_Sources
     ${IMGUI_NODE_EDITOR_ROOT_DIR}/crude_json.cpp
@@ -36,7 +37,7 @@ target_include_directories(imgui_node_editor PUBLIC
     ${IMGUI_NODE_EDITOR_ROOT_DIR}
 )
 
-target_link_libraries(imgui_node_editor PUBLIC imgui)
+target_link_libraries(imgui_node_editor PUBLIC imgui Threads::Threads)
 
 source_group(TREE ${IMGUI_NODE_EDITOR_ROOT_DIR} FILES ${_imgui_node_editor_Sources})
 